@@ -29,6 +29,7 @@
 #include <graphene/app/api_access.hpp>
 #include <graphene/app/application.hpp>
 #include <graphene/app/impacted.hpp>
+#include <graphene/chain/config.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/get_config.hpp>
 #include <graphene/utilities/key_conversion.hpp>
@@ -40,6 +41,8 @@
 #include <fc/crypto/hex.hpp>
 #include <fc/smart_ref_impl.hpp>
 
+#include <boost/thread/locks.hpp>
+
 namespace decent { namespace seeding {
       fc::promise<decent::seeding::seeding_plugin_startup_options>::ptr seeding_promise;
 }}
@@ -81,7 +84,7 @@ namespace graphene { namespace app {
     {
        if( api_name == "database_api" )
        {
-          _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ) );
+          _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ), _app.get_api_worker_pool() );
        }
        else if( api_name == "network_broadcast_api" )
        {
@@ -105,6 +108,10 @@ namespace graphene { namespace app {
           if( _app.get_plugin( "debug_miner" ) )
              _debug_api = std::make_shared< graphene::debug_miner::debug_api >( std::ref(_app) );
        }
+       else if( api_name == "raw_api" )
+       {
+          _raw_api = std::make_shared< raw_api >( std::ref( _app ) );
+       }
        return;
     }
 
@@ -119,10 +126,12 @@ namespace graphene { namespace app {
        {
           /// we need to ensure the database_api is not deleted for the life of the async operation
           auto capture_this = shared_from_this();
+          // the ids were already computed while the block was applied
+          const auto& applied = _app.chain_database()->get_applied_transactions();
           for( uint32_t trx_num = 0; trx_num < b.transactions.size(); ++trx_num )
           {
              const auto& trx = b.transactions[trx_num];
-             auto id = trx.id();
+             auto id = applied.size() == b.transactions.size() ? applied[trx_num]->id() : trx.id();
              auto itr = _callbacks.find(id);
              if( itr != _callbacks.end() )
              {
@@ -140,7 +149,7 @@ namespace graphene { namespace app {
     void network_broadcast_api::broadcast_transaction(const signed_transaction& trx)
     {
        trx.validate();
-       _app.chain_database()->push_transaction(trx);
+       _app.chain_database()->push_transaction( std::make_shared<transaction_metadata>( trx ) );
        _app.p2p_node()->broadcast_transaction(trx);
     }
 
@@ -162,8 +171,9 @@ namespace graphene { namespace app {
     void network_broadcast_api::broadcast_transaction_with_callback(confirmation_callback cb, const signed_transaction& trx)
     {
        trx.validate();
-       _callbacks[trx.id()] = cb;
-       _app.chain_database()->push_transaction(trx);
+       auto trx_meta = std::make_shared<transaction_metadata>( trx );
+       _callbacks[trx_meta->id()] = cb;
+       _app.chain_database()->push_transaction( trx_meta );
        _app.p2p_node()->broadcast_transaction(trx);
     }
 
@@ -193,6 +203,18 @@ namespace graphene { namespace app {
        return _app.p2p_node()->get_potential_peers();
     }
 
+    std::vector<graphene::chain::committed_operation_queue_stats> network_node_api::get_committed_operation_stats() const
+    {
+       return _app.chain_database()->committed_operations().get_stats();
+    }
+
+    std::vector<graphene::db::index_memory_stats> network_node_api::get_index_memory_stats() const
+    {
+       std::shared_ptr<graphene::chain::database> db = _app.chain_database();
+       boost::shared_lock<boost::shared_mutex> lock( db->state_mutex() );
+       return db->get_memory_stats();
+    }
+
     fc::variant_object network_node_api::get_advanced_node_parameters() const
     {
        return _app.p2p_node()->get_advanced_node_parameters();
@@ -259,6 +281,12 @@ namespace graphene { namespace app {
        return *_debug_api;
     }
 
+    fc::api<raw_api> login_api::raw() const
+    {
+       FC_ASSERT(_raw_api);
+       return *_raw_api;
+    }
+
     vector<account_id_type> get_relevant_accounts( const object* obj )
     {
        vector<account_id_type> result;
@@ -415,6 +443,57 @@ namespace graphene { namespace app {
        return result;
     }
     
+    raw_api::raw_api(application& a)
+    : _database_api( std::ref( *a.chain_database() ) ),
+      _history_api( a )
+    {
+    }
+
+    string raw_api::layout_version()
+    {
+       return std::to_string( RAW_API_LAYOUT_VERSION ) + "-" + GRAPHENE_CURRENT_DB_VERSION;
+    }
+
+    string raw_api::get_layout_version() const
+    {
+       return layout_version();
+    }
+
+    vector<char> raw_api::get_block(uint32_t block_num) const
+    {
+       return fc::raw::pack( _database_api.get_block( block_num ) );
+    }
+
+    vector<char> raw_api::get_blocks(uint32_t block_num, uint32_t count) const
+    {
+       return fc::raw::pack( _database_api.get_blocks( block_num, count ) );
+    }
+
+    vector<char> raw_api::get_full_accounts(const vector<string>& names_or_ids)
+    {
+       return fc::raw::pack( _database_api.get_full_accounts( names_or_ids, false ) );
+    }
+
+    vector<char> raw_api::search_content(const string& term,
+                                         const string& order,
+                                         const string& user,
+                                         const string& region_code,
+                                         const object_id_type& id,
+                                         const string& type,
+                                         uint32_t count) const
+    {
+       return fc::raw::pack( _database_api.search_content( term, order, user, region_code, id, type, count ) );
+    }
+
+    vector<char> raw_api::get_account_history(account_id_type account,
+                                              const string& order,
+                                              operation_history_id_type stop,
+                                              unsigned limit,
+                                              operation_history_id_type start) const
+    {
+       return fc::raw::pack( _history_api.get_account_history( account, order, stop, limit, start ) );
+    }
+
     vector<operation_history_object> history_api::get_relative_account_history( account_id_type account, 
                                                                                 uint32_t stop, 
                                                                                 unsigned limit, 
@@ -24,6 +24,7 @@
  */
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/api_worker_pool.hpp>
 #include <graphene/app/application.hpp>
 #include <graphene/app/plugin.hpp>
 
@@ -207,7 +208,7 @@ namespace detail {
          _websocket_server->on_connection([&]( const fc::http::websocket_connection_ptr& c ){
             auto wsc = std::make_shared<fc::rpc::websocket_api_connection>(*c);
             auto login = std::make_shared<graphene::app::login_api>( std::ref(*_self) );
-            auto db_api = std::make_shared<graphene::app::database_api>( std::ref(*_self->chain_database()) );
+            auto db_api = std::make_shared<graphene::app::database_api>( std::ref(*_self->chain_database()), _api_worker_pool );
             wsc->register_api(fc::api<graphene::app::database_api>(db_api));
             wsc->register_api(fc::api<graphene::app::login_api>(login));
             c->set_session_data( wsc );
@@ -235,7 +236,7 @@ namespace detail {
          _websocket_tls_server->on_connection([&]( const fc::http::websocket_connection_ptr& c ){
             auto wsc = std::make_shared<fc::rpc::websocket_api_connection>(*c);
             auto login = std::make_shared<graphene::app::login_api>( std::ref(*_self) );
-            auto db_api = std::make_shared<graphene::app::database_api>( std::ref(*_self->chain_database()) );
+            auto db_api = std::make_shared<graphene::app::database_api>( std::ref(*_self->chain_database()), _api_worker_pool );
             wsc->register_api(fc::api<graphene::app::database_api>(db_api));
             wsc->register_api(fc::api<graphene::app::login_api>(login));
             c->set_session_data( wsc );
@@ -430,14 +431,62 @@ namespace detail {
             wild_access.allowed_apis.push_back( "history_api" );
             wild_access.allowed_apis.push_back( "crypto_api" );
             wild_access.allowed_apis.push_back( "network_node_api" );
+            wild_access.allowed_apis.push_back( "raw_api" );
             _apiaccess.permission_map["*"] = wild_access;
          }
 
+         if( _options->count("api-worker-threads") && _options->at("api-worker-threads").as<uint32_t>() > 0 )
+         {
+            _api_worker_pool = std::make_shared<api_worker_pool>( std::ref(*_chain_db), _options->at("api-worker-threads").as<uint32_t>() );
+            ilog( "Running read-only database API calls on ${n} worker threads", ("n", _api_worker_pool->thread_count()) );
+         }
+
+         if( _options->count("memory-stats-interval") && _options->at("memory-stats-interval").as<uint32_t>() > 0 )
+         {
+            const uint32_t interval = _options->at("memory-stats-interval").as<uint32_t>();
+            _chain_db->applied_block.connect( [this, interval]( const signed_block& b ) {
+               if( b.block_num() % interval == 0 )
+                  log_memory_stats();
+            });
+         }
+
          reset_p2p_node(_data_dir);
          reset_websocket_server();
          reset_websocket_tls_server();
       } FC_LOG_AND_RETHROW() }
 
+      /**
+       * Logs the estimated total memory of the object database and the indices using most of it
+       */
+      void log_memory_stats()const
+      {
+         try
+         {
+            vector<index_memory_stats> stats = _chain_db->get_memory_stats();
+            std::sort( stats.begin(), stats.end(), []( const index_memory_stats& a, const index_memory_stats& b ) {
+               return a.total_bytes() > b.total_bytes();
+            });
+            uint64_t total = 0;
+            uint64_t undo = 0;
+            for( const auto& item : stats )
+            {
+               total += item.total_bytes();
+               undo += item.undo_bytes;
+            }
+            ilog( "Object database memory at block ${b}: ${t} bytes estimated, ${u} bytes in undo states",
+                  ("b", _chain_db->head_block_num())("t", total)("u", undo) );
+            for( size_t i = 0; i < stats.size() && i < 10 && stats[i].object_count > 0; ++i )
+               ilog( "  index ${s}.${y}: ${n} objects, ${t} bytes (objects ${o}, nodes ${i}, dynamic ${d}, secondary ${x}, undo ${u})",
+                     ("s", stats[i].space_id)("y", stats[i].type_id)("n", stats[i].object_count)("t", stats[i].total_bytes())
+                     ("o", stats[i].object_bytes)("i", stats[i].node_overhead_bytes)("d", stats[i].dynamic_bytes)
+                     ("x", stats[i].secondary_index_bytes)("u", stats[i].undo_bytes) );
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "unable to collect memory stats: ${e}", ("e", e.to_detail_string()) );
+         }
+      }
+
       optional< api_access_info > get_api_access_info(const string& username)const
       {
          optional< api_access_info > result;
@@ -502,7 +551,19 @@ namespace detail {
             // you can help the network code out by throwing a block_older_than_undo_history exception.
             // when the net code sees that, it will stop trying to push blocks from that chain, but
             // leave that peer connected so that they can get sync blocks from us
-            bool result = _chain_db->push_block(blk_msg.block,
+            // sync blocks come with the transactions hashed on the prevalidation threads, the others are
+            // hashed here once for the chain and for the message ids below
+            block_metadata_ptr metadata = blk_msg.metadata;
+            if (!metadata)
+            {
+               std::shared_ptr<block_metadata> referenced = std::make_shared<block_metadata>();
+               referenced->trx_metadata.reserve(blk_msg.block.transactions.size());
+               for (const processed_transaction& transaction : blk_msg.block.transactions)
+                  referenced->trx_metadata.push_back(transaction_metadata::reference(transaction));
+               metadata = referenced;
+            }
+
+            bool result = _chain_db->push_block(blk_msg.block, *metadata,
                                                 (_is_block_producer | _force_validate) ? database::skip_nothing
                                                                                        : database::skip_transaction_signatures,
                                                 sync_mode);
@@ -515,10 +576,13 @@ namespace detail {
                // happens, there's no reason to fetch the transactions, so  construct a list of the
                // transaction message ids we no longer need.
                // during sync, it is unlikely that we'll see any old
-               for (const processed_transaction& transaction : blk_msg.block.transactions)
+               for (const transaction_metadata_ptr& transaction : metadata->trx_metadata)
                {
-                  graphene::net::trx_message transaction_message(transaction);
-                  contained_transaction_message_ids.push_back(graphene::net::message(transaction_message).id());
+                  // a trx_message packs to the signed transaction, i.e. the cached unsigned part followed by the signatures
+                  fc::ripemd160::encoder enc;
+                  enc.write(transaction->packed().data(), transaction->packed().size());
+                  fc::raw::pack(enc, transaction->get_transaction().signatures);
+                  contained_transaction_message_ids.push_back(enc.result());
                }
             }
 
@@ -539,6 +603,25 @@ namespace detail {
          }
       } FC_CAPTURE_AND_RETHROW( (blk_msg)(sync_mode) ) }
 
+      virtual size_t handle_sync_blocks(const std::vector<graphene::net::block_message>& blk_msgs,
+                                        fc::exception_ptr& error) override
+      {
+         std::vector<fc::uint160_t> contained_transaction_message_ids;
+         for (size_t i = 0; i < blk_msgs.size(); ++i)
+         {
+            try {
+               handle_block(blk_msgs[i], true, contained_transaction_message_ids);
+            } catch ( const fc::canceled_exception& ) {
+               throw;
+            } catch ( const fc::exception& e ) {
+               // the copy keeps the type of the exception, the p2p code tells the rejections apart by it
+               error = e.dynamic_copy_exception();
+               return i;
+            }
+         }
+         return blk_msgs.size();
+      }
+
       virtual void handle_transaction(const graphene::net::trx_message& transaction_message) override
       { try {
          static fc::time_point last_call;
@@ -551,7 +634,14 @@ namespace detail {
             trx_count = 0;
          }
 
-         _chain_db->push_transaction( transaction_message.trx );
+         // the signing keys are recovered before the database is locked for writing, an invalid signature
+         // is left to push_transaction to report
+         transaction_metadata_ptr trx = std::make_shared<transaction_metadata>( transaction_message.trx );
+         try {
+            trx->signature_keys( _chain_db->get_chain_id() );
+         } catch( const fc::exception& ) {
+         }
+         _chain_db->push_transaction( trx );
       } FC_CAPTURE_AND_RETHROW( (transaction_message) ) }
 
       virtual void handle_message(const message& message_to_process) override
@@ -894,6 +984,7 @@ namespace detail {
       api_access _apiaccess;
 
       std::shared_ptr<graphene::chain::database>            _chain_db;
+      std::shared_ptr<api_worker_pool>                      _api_worker_pool;
       std::shared_ptr<graphene::net::node>                  _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
@@ -941,6 +1032,10 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("genesis-json", bpo::value<boost::filesystem::path>(), "File to read Genesis State from")
          ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init miners, overrides genesis file")
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
+         ("api-worker-threads", bpo::value<uint32_t>()->default_value(0), "Number of threads serving read-only database API calls "
+                                                                         "off the block processing thread, 0 to serve every call on it")
+         ("memory-stats-interval", bpo::value<uint32_t>()->default_value(0), "Log the estimated memory used by each object index "
+                                                                            "every N blocks, 0 to disable")
          ("ipfs-api", bpo::value<string>(), "IPFS control API")
          ;
    command_line_options.add(configuration_file_options);
@@ -1017,6 +1112,11 @@ std::shared_ptr<chain::database> application::chain_database() const
    return my->_chain_db;
 }
 
+std::shared_ptr<api_worker_pool> application::get_api_worker_pool() const
+{
+   return my->_api_worker_pool;
+}
+
 void application::set_block_production(bool producing_blocks)
 {
    my->_is_block_producer = producing_blocks;
@@ -24,6 +24,7 @@
  */
 
 #include <graphene/app/database_api.hpp>
+#include <graphene/app/api_worker_pool.hpp>
 #include <graphene/chain/get_config.hpp>
 
 
@@ -45,6 +46,7 @@
 
 #include <cfenv>
 #include <iostream>
+#include <mutex>
 #include "json.hpp"
 
 #define GET_REQUIRED_FEES_MAX_RECURSION 4
@@ -82,8 +84,18 @@ namespace graphene { namespace app {
    class database_api_impl : public std::enable_shared_from_this<database_api_impl>
    {
    public:
-      database_api_impl( graphene::chain::database& db );
+      database_api_impl( graphene::chain::database& db, std::shared_ptr<api_worker_pool> worker_pool );
       ~database_api_impl();
+
+      /// runs f on the worker pool if there is one, on the calling thread otherwise. f may outlive the calling
+      /// fiber, so it must hold what it uses by value
+      template<typename Functor>
+      auto read_only( Functor&& f )const -> decltype(f())
+      {
+         if( _worker_pool )
+            return _worker_pool->run_read_only( std::forward<Functor>( f ) );
+         return f();
+      }
       
       // Objects
       fc::variants get_objects(const vector<object_id_type>& ids)const;
@@ -91,6 +103,13 @@ namespace graphene { namespace app {
       // Subscriptions
       void set_subscribe_callback( std::function<void(const variant&)> cb, bool clear_filter );
       void set_content_update_callback( const string & URI, std::function<void()> cb );
+      void set_content_catalogue_callback( std::function<void(const variant&)> cb,
+                                           const string& term,
+                                           const string& order,
+                                           const string& user,
+                                           const string& region_code,
+                                           const string& type );
+      void cancel_content_catalogue_callback();
       void set_pending_transaction_callback( std::function<void(const variant&)> cb );
       void set_block_applied_callback( std::function<void(const variant& block_id)> cb );
       void cancel_all_subscriptions();
@@ -98,6 +117,7 @@ namespace graphene { namespace app {
       // Blocks and transactions
       optional<block_header> get_block_header(uint32_t block_num)const;
       optional<signed_block> get_block(uint32_t block_num)const;
+      vector<signed_block> get_blocks(uint32_t block_num, uint32_t count)const;
       processed_transaction get_transaction( uint32_t block_num, uint32_t trx_in_block )const;
       fc::time_point_sec head_block_time()const;
       
@@ -216,6 +236,25 @@ namespace graphene { namespace app {
       void on_objects_changed(const vector<object_id_type>& ids);
       void on_objects_removed(const vector<const object*>& objs);
       void on_applied_block();
+
+      /** the filter of a catalogue subscription and the contents which matched it at the last delta */
+      struct content_catalogue_subscription
+      {
+         std::function<void(const fc::variant&)>                 callback;
+         string                                                  term;
+         string                                                  order;
+         string                                                  user;
+         string                                                  region_code;
+         ContentObjectTypeValue                                  type;
+         /// the matching contents and their expirations
+         std::map<content_id_type, time_point_sec>               members;
+         /// the members by expiration, the expiration does not change the content objects
+         std::set<std::pair<time_point_sec, content_id_type> >   expirations;
+         uint64_t                                                sequence = 0;
+      };
+
+      /** collects the changes of the set of matching contents caused by the changed contents */
+      void update_content_catalogue( const std::set<content_id_type>& ids, content_catalogue_delta& delta );
       
       mutable fc::bloom_filter                               _subscribe_filter;
       std::function<void(const fc::variant&)> _subscribe_callback;
@@ -227,7 +266,12 @@ namespace graphene { namespace app {
       boost::signals2::scoped_connection                                                                                           _applied_block_connection;
       boost::signals2::scoped_connection                                                                                           _pending_trx_connection;
       map< string, std::function<void()> >                              _content_subscriptions;
+      /// set and dropped holding the state mutex shared, so the chain thread never sees it change
+      std::unique_ptr<content_catalogue_subscription>                                                                             _content_catalogue;
+      /// orders the calls of one connection running on different workers
+      std::mutex                                                                                                                   _content_catalogue_mutex;
       graphene::chain::database&                                                                                                   _db;
+      std::shared_ptr<api_worker_pool>                                                                                             _worker_pool;
    };
    
    //////////////////////////////////////////////////////////////////////
@@ -236,12 +280,13 @@ namespace graphene { namespace app {
    //                                                                  //
    //////////////////////////////////////////////////////////////////////
    
-   database_api::database_api( graphene::chain::database& db )
-   : my( new database_api_impl( db ) ) {}
+   database_api::database_api( graphene::chain::database& db, std::shared_ptr<api_worker_pool> worker_pool )
+   : my( new database_api_impl( db, worker_pool ) ) {}
    
    database_api::~database_api() {}
    
-   database_api_impl::database_api_impl( graphene::chain::database& db ):_db(db)
+   database_api_impl::database_api_impl( graphene::chain::database& db, std::shared_ptr<api_worker_pool> worker_pool )
+   :_db(db), _worker_pool(worker_pool)
    {
       wlog("creating database api ${x}", ("x",int64_t(this)) );
       _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids) {
@@ -339,6 +384,31 @@ namespace graphene { namespace app {
       _content_subscriptions[ URI ] = cb;
    }
 
+   void database_api::set_content_catalogue_callback( std::function<void(const variant&)> cb,
+                                                      const string& term,
+                                                      const string& order,
+                                                      const string& user,
+                                                      const string& region_code,
+                                                      const string& type )
+   {
+      // the initial scan and the subscription happen under the same read lock, so no change of the contents is missed
+      std::shared_ptr<database_api_impl> impl = my;
+      my->read_only( [=]() { impl->set_content_catalogue_callback( cb, term, order, user, region_code, type ); } );
+   }
+
+   void database_api::cancel_content_catalogue_callback()
+   {
+      // the chain thread reads the subscription while it applies a block, it is dropped under the same read lock
+      std::shared_ptr<database_api_impl> impl = my;
+      my->read_only( [=]() { impl->cancel_content_catalogue_callback(); } );
+   }
+
+   void database_api_impl::cancel_content_catalogue_callback()
+   {
+      std::lock_guard<std::mutex> guard( _content_catalogue_mutex );
+      _content_catalogue.reset();
+   }
+
    void database_api::set_pending_transaction_callback( std::function<void(const variant&)> cb )
    {
       my->set_pending_transaction_callback( cb );
@@ -362,6 +432,7 @@ namespace graphene { namespace app {
    void database_api::cancel_all_subscriptions()
    {
       my->cancel_all_subscriptions();
+      cancel_content_catalogue_callback();
    }
    
    void database_api_impl::cancel_all_subscriptions()
@@ -398,6 +469,26 @@ namespace graphene { namespace app {
       return _db.fetch_block_by_number(block_num);
    }
    
+   vector<signed_block> database_api::get_blocks(uint32_t block_num, uint32_t count)const
+   {
+      return my->get_blocks( block_num, count );
+   }
+   
+   vector<signed_block> database_api_impl::get_blocks(uint32_t block_num, uint32_t count)const
+   {
+      FC_ASSERT( count <= 100 );
+      vector<signed_block> result;
+      result.reserve( count );
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         optional<signed_block> block = _db.fetch_block_by_number( block_num + i );
+         if( !block )
+            break;
+         result.push_back( std::move( *block ) );
+      }
+      return result;
+   }
+   
    processed_transaction database_api::get_transaction( uint32_t block_num, uint32_t trx_in_block )const
    {
       return my->get_transaction( block_num, trx_in_block );
@@ -511,7 +602,7 @@ namespace graphene { namespace app {
          subscribe_to_item( key );
          
          const auto& idx = _db.get_index_type<account_index>();
-         const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
+         const auto& aidx = dynamic_cast<const base_primary_index&>(idx);
          const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
          auto itr = refs.account_to_key_memberships.find(key);
          vector<account_id_type> result;
@@ -558,7 +649,11 @@ namespace graphene { namespace app {
    
    std::map<string,full_account> database_api::get_full_accounts( const vector<string>& names_or_ids, bool subscribe )
    {
-      return my->get_full_accounts( names_or_ids, subscribe );
+      // subscribing touches the per-connection filter, which only the calling thread may do
+      if( subscribe )
+         return my->get_full_accounts( names_or_ids, subscribe );
+      std::shared_ptr<database_api_impl> impl = my;
+      return my->read_only( [=]() { return impl->get_full_accounts( names_or_ids, false ); } );
    }
    
    std::map<std::string, full_account> database_api_impl::get_full_accounts( const vector<std::string>& names_or_ids, bool subscribe)
@@ -659,7 +754,7 @@ namespace graphene { namespace app {
    vector<account_id_type> database_api_impl::get_account_references( account_id_type account_id )const
    {
       const auto& idx = _db.get_index_type<account_index>();
-      const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
+      const auto& aidx = dynamic_cast<const base_primary_index&>(idx);
       const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
       auto itr = refs.account_to_account_memberships.find(account_id);
       vector<account_id_type> result;
@@ -692,7 +787,8 @@ namespace graphene { namespace app {
    
    
    vector<account_object> database_api::search_accounts(const string& search_term, const string order, const object_id_type& id, uint32_t limit) const {
-      return my->search_accounts( search_term, order, id, limit );
+      std::shared_ptr<database_api_impl> impl = my;
+      return my->read_only( [=]() { return impl->search_accounts( search_term, order, id, limit ); } );
    }
 
    vector<transaction_detail_object> database_api::search_account_history(account_id_type const& account,
@@ -700,13 +796,15 @@ namespace graphene { namespace app {
                                                                           object_id_type const& id,
                                                                           int limit) const
    {
-      return my->search_account_history(account, order, id, limit);
+      std::shared_ptr<database_api_impl> impl = my;
+      return my->read_only( [=]() { return impl->search_account_history(account, order, id, limit); } );
    }
 
 
    map<string,account_id_type> database_api::lookup_accounts(const string& lower_bound_name, uint32_t limit)const
    {
-      return my->lookup_accounts( lower_bound_name, limit );
+      std::shared_ptr<database_api_impl> impl = my;
+      return my->read_only( [=]() { return impl->lookup_accounts( lower_bound_name, limit ); } );
    }
 
    namespace
@@ -912,7 +1010,8 @@ namespace graphene { namespace app {
    
    vector<asset> database_api::get_account_balances(account_id_type id, const flat_set<asset_id_type>& assets)const
    {
-      return my->get_account_balances( id, assets );
+      std::shared_ptr<database_api_impl> impl = my;
+      return my->read_only( [=]() { return impl->get_account_balances( id, assets ); } );
    }
    
    vector<asset> database_api_impl::get_account_balances(account_id_type acnt, const flat_set<asset_id_type>& assets)const
@@ -1371,21 +1470,20 @@ namespace graphene { namespace app {
       return my->get_proposed_transactions( id );
    }
    
-   /** TODO: add secondary index that will accelerate this process */
    vector<proposal_object> database_api_impl::get_proposed_transactions( account_id_type id )const
    {
       const auto& idx = _db.get_index_type<proposal_index>();
+      const auto& pidx = dynamic_cast<const base_primary_index&>(idx);
+      const auto& proposals_by_account = pidx.get_secondary_index<graphene::chain::required_approval_index>();
       vector<proposal_object> result;
       
-      idx.inspect_all_objects( [&](const object& obj){
-         const proposal_object& p = static_cast<const proposal_object&>(obj);
-         if( p.required_active_approvals.find( id ) != p.required_active_approvals.end() )
-            result.push_back(p);
-         else if ( p.required_owner_approvals.find( id ) != p.required_owner_approvals.end() )
-            result.push_back(p);
-         else if ( p.available_active_approvals.find( id ) != p.available_active_approvals.end() )
-            result.push_back(p);
-      });
+      auto itr = proposals_by_account._account_to_proposals.find( id );
+      if( itr != proposals_by_account._account_to_proposals.end() )
+      {
+         result.reserve( itr->second.size() );
+         for( auto proposal_id : itr->second )
+            result.push_back( proposal_id(_db) );
+      }
       return result;
    }
    
@@ -1446,8 +1544,12 @@ namespace graphene { namespace app {
    {
       try
       {
-         auto range = _db.get_index_type<buying_index>().indices().get<by_URI_open>().equal_range( std::make_tuple( URI, true ) );
          vector<buying_object> result;
+         const content_object* content = find_content( _db, URI );
+         if( content == nullptr )
+            return result;
+
+         auto range = _db.get_index_type<buying_index>().indices().get<by_content_open>().equal_range( std::make_tuple( content->get_id(), true ) );
          result.reserve(distance(range.first, range.second));
          std::for_each(range.first, range.second, [&](const buying_object& element) {
             if( element.expiration_time >= _db.head_block_time() )
@@ -1681,13 +1783,13 @@ namespace
       template <bool is_ascending, class sort_tag>
       void search_rating_template(graphene::chain::database& db,
                                   uint32_t count,
-                                  const string& URI,
+                                  content_id_type content,
                                   const object_id_type& id,
                                   vector<rating_object>& result)
       {
          const auto& idx_by_sort_tag = db.get_index_type<rating_index>().indices().get<sort_tag>();
 
-         auto range_equal = idx_by_sort_tag.equal_range(URI);
+         auto range_equal = idx_by_sort_tag.equal_range(content);
          auto range_begin = range_equal.first;
          auto range_end = range_equal.second;
 
@@ -1722,6 +1824,10 @@ namespace
 
       try
       {
+         const content_object* content = find_content( _db, URI );
+         if( content == nullptr )
+            return result;
+
          const auto& idx_account = _db.get_index_type<account_index>().indices().get<by_name>();
          const auto account_itr = idx_account.find(user);
 
@@ -1729,15 +1835,15 @@ namespace
          {
             if (account_itr != idx_account.end())
             {
-               const auto& idx = _db.get_index_type<rating_index>().indices().get<by_consumer_URI>();
-               auto itr = idx.find(std::make_tuple(account_itr->id, URI));
+               const auto& idx = _db.get_index_type<rating_index>().indices().get<by_consumer_content>();
+               auto itr = idx.find(std::make_tuple(account_itr->id, content->get_id()));
                if(itr != idx.end())
                   result.push_back(*itr);
             }
          }
          else
          {
-            search_rating_template<false, by_URI_time>(_db, count, URI, id, result);
+            search_rating_template<false, by_content_time>(_db, count, content->get_id(), id, result);
          }
       }FC_CAPTURE_AND_RETHROW( (user)(URI) );
 
@@ -1752,9 +1858,12 @@ namespace
    optional <buying_object> database_api_impl::get_buying_by_consumer_URI( const account_id_type& consumer, const string& URI)const
    {
       try{
-         const auto & idx = _db.get_index_type<buying_index>().indices().get<by_consumer_URI>();
-         auto itr = idx.find(std::make_tuple(consumer, URI));
-         vector<buying_object> result;
+         const content_object* content = find_content( _db, URI );
+         if( content == nullptr )
+            return optional<buying_object>();
+
+         const auto & idx = _db.get_index_type<buying_index>().indices().get<by_consumer_content>();
+         auto itr = idx.find(std::make_tuple(consumer, content->get_id()));
          if(itr!=idx.end()){
             return *itr;
          }
@@ -1892,12 +2001,112 @@ namespace
                                                         const string& type,
                                                         uint32_t count)const
    {
-      return my->search_content(term, order, user, region_code, id, type, count);
+      std::shared_ptr<database_api_impl> impl = my;
+      return my->read_only( [=]() { return impl->search_content(term, order, user, region_code, id, type, count); } );
    }
    
    
    namespace {
-      
+
+      // the orderings by rating and by purchases are indices of the content statistics
+      template <class sort_tag>
+      struct content_sort_index
+      {
+         typedef content_index index_type;
+         typedef content_object object_type;
+
+         static object_id_type start_id(graphene::chain::database& db, const object_id_type& id) { return id; }
+         static const content_object& content(graphene::chain::database& db, const content_object& co) { return co; }
+      };
+
+      template <>
+      struct content_sort_index<by_AVG_rating>
+      {
+         typedef content_statistics_index index_type;
+         typedef content_statistics_object object_type;
+
+         static object_id_type start_id(graphene::chain::database& db, const object_id_type& id)
+         {
+            if( id.is<content_id_type>() )
+            {
+               const content_object* co = db.find(content_id_type(id));
+               if( co )
+                  return co->statistics;
+            }
+            return id;
+         }
+         static const content_object& content(graphene::chain::database& db, const content_statistics_object& cs) { return db.get(cs.content); }
+      };
+
+      /// adds the summary of the content to the result if the content matches the search, returns true if it was added
+      bool add_matching_content(graphene::chain::database& db,
+                                const content_object& co,
+                                const string& search_term,
+                                const string& user,
+                                const string& region_code,
+                                const ContentObjectTypeValue& filter_type,
+                                vector<content_summary>& result)
+      {
+         const auto& idx_account = db.get_index_type<account_index>().indices().get<by_id>();
+         const auto account_itr = idx_account.find(co.author);
+         if ( false == user.empty() )
+         {
+            if ( account_itr->name != user )
+               return false;
+         }
+
+         if (false == co.price.Valid(region_code))
+         {
+            // this is going to be possible if a content object does not have
+            // a price defined for this region
+            // we allow such objects be placed in db index anyway, but simply skip those
+            // during enumeration
+            return false;
+         }
+
+         if ( user.empty() && false == recent_proof(db, co, 60*60*24)  )
+            return false;
+
+         if ( co.is_blocked ) // Content can be cancelled by an author. In such a case content is not available to purchase.
+            return false;
+
+         content_summary content;
+         content.set( db, co, *account_itr, region_code );
+         if (content.expiration <= fc::time_point::now())
+            return false;
+
+         std::string term = search_term;
+         std::string title = content.synopsis;
+         std::string desc = "";
+         std::string author = content.author;
+         ContentObjectTypeValue content_type;
+
+
+         try {
+            ContentObjectPropertyManager synopsis_parser(content.synopsis);
+            title = synopsis_parser.get<ContentObjectTitle>();
+            desc = synopsis_parser.get<ContentObjectDescription>();
+            content_type = synopsis_parser.get<ContentObjectType>();
+         } catch (...) {}
+
+         boost::algorithm::to_lower(term);
+         boost::algorithm::to_lower(title);
+         boost::algorithm::to_lower(desc);
+         boost::algorithm::to_lower(author);
+
+         if (false == term.empty() &&
+             author.find(term) == std::string::npos &&
+             title.find(term) == std::string::npos &&
+             desc.find(term) == std::string::npos)
+            return false;
+
+         if (false == content_type.filter(filter_type))
+            return false;
+
+         result.push_back( content );
+         return true;
+      }
+
       template <bool is_ascending, class sort_tag>
       void search_content_template(graphene::chain::database& db,
                                    const string& search_term,
@@ -1908,97 +2117,74 @@ namespace
                                    const string& type,
                                    vector<content_summary>& result)
       {
-         const auto& idx_by_sort_tag = db.get_index_type<content_index>().indices().get<sort_tag>();
+         typedef content_sort_index<sort_tag> sort_index;
+         const auto& idx_by_sort_tag = db.get_index_type<typename sort_index::index_type>().indices().template get<sort_tag>();
          
          auto itr_begin = return_one<is_ascending>::choose(idx_by_sort_tag.cbegin(), idx_by_sort_tag.crbegin());
          auto itr_end = return_one<is_ascending>::choose(idx_by_sort_tag.cend(), idx_by_sort_tag.crend());
 
-         correct_iterator<content_index, content_object, sort_tag, decltype(itr_begin), is_ascending>(db, id, itr_begin);
-
-         content_summary content;
-         const auto& idx_account = db.get_index_type<account_index>().indices().get<by_id>();
+         correct_iterator<typename sort_index::index_type, typename sort_index::object_type, sort_tag, decltype(itr_begin), is_ascending>(db, sort_index::start_id(db, id), itr_begin);
 
          ContentObjectTypeValue filter_type;
          filter_type.from_string(type);
          
          while(count && itr_begin != itr_end)
          {
-            const auto account_itr = idx_account.find(itr_begin->author);
-            if ( false == user.empty() )
-            {
-               if ( account_itr->name != user )
-               {
-                  ++itr_begin;
-                  continue;
-               }
-            }
+            if( add_matching_content(db, sort_index::content(db, *itr_begin), search_term, user, region_code, filter_type, result) )
+               count--;
+            ++itr_begin;
+         }
+      }
 
-            if (false == itr_begin->price.Valid(region_code))
-            {
-               // this is going to be possible if a content object does not have
-               // a price defined for this region
-               // we allow such objects be placed in db index anyway, but simply skip those
-               // during enumeration
-               ++itr_begin;
-               continue;
-            }
+      // the prices differ by region, so the search walks only the entries of the requested region
+      template <bool is_ascending>
+      void search_content_by_price(graphene::chain::database& db,
+                                   const string& search_term,
+                                   uint32_t count,
+                                   const string& user,
+                                   const string& region_code,
+                                   const object_id_type& id,
+                                   const string& type,
+                                   vector<content_summary>& result)
+      {
+         auto region_itr = RegionCodes::s_mapNameToCode.find(region_code);
+         if (region_itr == RegionCodes::s_mapNameToCode.end())
+            return;
+         const uint32_t region = region_itr->second;
 
-            if ( user.empty() && false == itr_begin->recent_proof(60*60*24)  )
-            {
-               ++itr_begin;
-               continue;
-            }
+         const auto& cidx = dynamic_cast<const base_primary_index&>(db.get_index_type<content_index>());
+         const auto& price_idx = cidx.get_secondary_index<graphene::chain::content_price_index>();
+         auto range = price_idx.region_range(region);
 
-            if ( itr_begin->is_blocked ) // Content can be cancelled by an author. In such a case content is not available to purchase.
-            {
-               ++itr_begin;
-               continue;
-            }
+         auto itr_begin = return_one<is_ascending>::choose(range.first, boost::reverse_iterator<decltype(range.second)>(range.second));
+         auto itr_end = return_one<is_ascending>::choose(range.second, boost::reverse_iterator<decltype(range.first)>(range.first));
 
-            content.set( *itr_begin , *account_itr, region_code );
-            if (content.expiration > fc::time_point::now())
+         // continue with the content with id
+         if (id.is<content_id_type>())
+         {
+            const content_object* start = db.find(content_id_type(id));
+            optional<asset> price = start ? start->price.GetPrice(region) : optional<asset>();
+            if (price.valid())
             {
-               std::string term = search_term;
-               std::string title = content.synopsis;
-               std::string desc = "";
-               std::string author = content.author;
-               ContentObjectTypeValue content_type;
-
-
-               try {
-                  ContentObjectPropertyManager synopsis_parser(content.synopsis);
-                  title = synopsis_parser.get<ContentObjectTitle>();
-                  desc = synopsis_parser.get<ContentObjectDescription>();
-                  content_type = synopsis_parser.get<ContentObjectType>();
-               } catch (...) {}
-               
-               boost::algorithm::to_lower(term);
-               boost::algorithm::to_lower(title);
-               boost::algorithm::to_lower(desc);
-               boost::algorithm::to_lower(author);
-
-               if (false == term.empty() &&
-                   author.find(term) == std::string::npos &&
-                   title.find(term) == std::string::npos &&
-                   desc.find(term) == std::string::npos)
+               auto itr_find = price_idx._region_price_to_content.find(std::make_tuple(region, price->amount, start->get_id()));
+               if (itr_find != price_idx._region_price_to_content.end())
                {
-                  ++itr_begin;
-                  continue;
+                  itr_begin = return_one<is_ascending>::choose(itr_find, boost::reverse_iterator<decltype(itr_find)>(itr_find));
+                  if (false == is_ascending)
+                     --itr_begin;
                }
+            }
+         }
 
-               if (false == content_type.filter(filter_type))
-               {
-                  ++itr_begin;
-                  continue;
-               }
+         ContentObjectTypeValue filter_type;
+         filter_type.from_string(type);
 
+         while(count && itr_begin != itr_end)
+         {
+            if( add_matching_content(db, db.get(std::get<2>(*itr_begin)), search_term, user, region_code, filter_type, result) )
                count--;
-               result.push_back( content );
-            }
-            
             ++itr_begin;
          }
-         
       }
    }
    
@@ -2023,7 +2209,7 @@ namespace
       else if (order == "+size")
          search_content_template<true, by_size>(_db, search_term, count, user, region_code, id, type, result);
       else if (order == "+price")
-         search_content_template<true, by_price>(_db, search_term, count, user, region_code, id, type, result);
+         search_content_by_price<true>(_db, search_term, count, user, region_code, id, type, result);
       else if (order == "+created")
          search_content_template<true, by_created>(_db, search_term, count, user, region_code, id, type, result);
       else if (order == "+expiration")
@@ -2036,7 +2222,7 @@ namespace
       else if (order == "-size")
          search_content_template<false, by_size>(_db, search_term, count, user, region_code, id, type, result);
       else if (order == "-price")
-         search_content_template<false, by_price>(_db, search_term, count, user, region_code, id, type, result);
+         search_content_by_price<false>(_db, search_term, count, user, region_code, id, type, result);
       else if (order == "-expiration")
          search_content_template<false, by_expiration>(_db, search_term, count, user, region_code, id, type, result);
       else// if (order == "-created")
@@ -2045,6 +2231,117 @@ namespace
       return result;
    }
    
+   namespace {
+
+      /// orders the contents like search_content does for the order
+      void sort_like_search_content( const string& order, vector<content_summary>& contents )
+      {
+         typedef std::function<bool(const content_summary&, const content_summary&)> less_type;
+         const string field = order.empty() ? string() : order.substr( 1 );
+         bool descending = order.empty() || order[0] != '+';
+
+         less_type less;
+         if( field == "author" )
+            less = []( const content_summary& a, const content_summary& b ) { return a.author < b.author; };
+         else if( field == "rating" )
+            less = []( const content_summary& a, const content_summary& b ) { return a.AVG_rating < b.AVG_rating; };
+         else if( field == "size" )
+            less = []( const content_summary& a, const content_summary& b ) { return a.size < b.size; };
+         else if( field == "price" )
+            less = []( const content_summary& a, const content_summary& b ) { return a.price.amount < b.price.amount; };
+         else if( field == "expiration" )
+            less = []( const content_summary& a, const content_summary& b ) { return a.expiration < b.expiration; };
+         else
+         {
+            if( field != "created" )
+               descending = true;
+            less = []( const content_summary& a, const content_summary& b ) { return a.created < b.created; };
+         }
+
+         std::stable_sort( contents.begin(), contents.end(), [&]( const content_summary& a, const content_summary& b ) {
+            return descending ? less( b, a ) : less( a, b );
+         } );
+      }
+   }
+
+   void database_api_impl::set_content_catalogue_callback( std::function<void(const variant&)> cb,
+                                                           const string& term,
+                                                           const string& order,
+                                                           const string& user,
+                                                           const string& region_code,
+                                                           const string& type )
+   {
+      std::unique_ptr<content_catalogue_subscription> subscription( new content_catalogue_subscription );
+      subscription->callback = cb;
+      subscription->term = term;
+      subscription->order = order;
+      subscription->user = user;
+      subscription->region_code = region_code;
+      subscription->type.from_string( type );
+
+      // the deltas report the changes of the contents matching now
+      const auto& idx = _db.get_index_type<content_index>().indices().get<by_id>();
+      vector<content_summary> matching;
+      for( const content_object& co : idx )
+      {
+         if( add_matching_content( _db, co, term, user, region_code, subscription->type, matching ) )
+         {
+            subscription->members[ co.get_id() ] = matching.back().expiration;
+            subscription->expirations.insert( std::make_pair( matching.back().expiration, co.get_id() ) );
+            matching.clear();
+         }
+      }
+
+      std::lock_guard<std::mutex> guard( _content_catalogue_mutex );
+      _content_catalogue = std::move( subscription );
+   }
+
+   void database_api_impl::update_content_catalogue( const std::set<content_id_type>& ids, content_catalogue_delta& delta )
+   {
+      content_catalogue_subscription& subscription = *_content_catalogue;
+      vector<content_summary> matching;
+
+      for( const content_id_type& id : ids )
+      {
+         const content_object* co = _db.find( id );
+         auto member = subscription.members.find( id );
+         const bool was_member = member != subscription.members.end();
+         if( was_member )
+            subscription.expirations.erase( std::make_pair( member->second, id ) );
+
+         if( co && add_matching_content( _db, *co, subscription.term, subscription.user, subscription.region_code, subscription.type, matching ) )
+         {
+            const content_summary& content = matching.back();
+            subscription.members[ id ] = content.expiration;
+            subscription.expirations.insert( std::make_pair( content.expiration, id ) );
+            ( was_member ? delta.changed : delta.added ).push_back( content );
+            matching.clear();
+         }
+         else if( was_member )
+         {
+            subscription.members.erase( member );
+            if( co == nullptr || co->expiration <= fc::time_point::now() )
+               delta.expired.push_back( id );
+            else if( co->is_blocked )
+               delta.blocked.push_back( id );
+            else
+               delta.removed.push_back( id );
+         }
+      }
+
+      const time_point_sec now = fc::time_point::now();
+      while( false == subscription.expirations.empty() && subscription.expirations.begin()->first <= now )
+      {
+         const content_id_type id = subscription.expirations.begin()->second;
+         subscription.expirations.erase( subscription.expirations.begin() );
+         subscription.members.erase( id );
+         delta.expired.push_back( id );
+      }
+
+      sort_like_search_content( subscription.order, delta.added );
+      sort_like_search_content( subscription.order, delta.changed );
+   }
+   
    vector<seeder_object> database_api::list_publishers_by_price( uint32_t count )const
    {
       return my->list_publishers_by_price( count );
@@ -2080,8 +2377,12 @@ namespace
    {
       try
       {
-         auto range = _db.get_index_type<rating_index>().indices().get<by_URI_consumer>().equal_range(URI);
          map<string, string> result;
+         const content_object* content = find_content( _db, URI );
+         if( content == nullptr )
+            return result;
+
+         auto range = _db.get_index_type<rating_index>().indices().get<by_content_consumer>().equal_range(content->get_id());
          std::for_each(range.first, range.second, [&result](const rating_object& element) {
             if( !element.comment.empty() )
               result[ std::string( object_id_type ( element.consumer ) ) ] = element.comment;
@@ -2100,8 +2401,12 @@ namespace
    {
       try
       {
-         auto range = _db.get_index_type<rating_index>().indices().get<by_URI_consumer>().equal_range(URI);
          vector<uint64_t> result;
+         const content_object* content = find_content( _db, URI );
+         if( content == nullptr )
+            return result;
+
+         auto range = _db.get_index_type<rating_index>().indices().get<by_content_consumer>().equal_range(content->get_id());
          result.reserve(distance(range.first, range.second));
          std::for_each(range.first, range.second,
                        [&result](const rating_object& element) {
@@ -2196,6 +2501,9 @@ namespace
             if( obj )
             {
                const content_object* content = dynamic_cast<const content_object*>(obj);
+               const content_statistics_object* stats = dynamic_cast<const content_statistics_object*>(obj);
+               if( stats )
+                  content = _db.find( stats->content );
                if(content && _content_subscriptions[ content->URI ] )
                   content_update_queue.emplace_back( content->URI );
             }
@@ -2203,6 +2511,41 @@ namespace
          }
       }
       
+      if( _content_catalogue )
+      {
+         // the statistics and the proofs of seeders change the summaries and the matching of their contents
+         std::set<content_id_type> content_ids;
+         for( const object_id_type& id : ids )
+         {
+            if( id.is<content_id_type>() )
+               content_ids.insert( content_id_type( id ) );
+            else if( id.is<content_statistics_id_type>() )
+            {
+               const content_statistics_object* stats = _db.find( content_statistics_id_type( id ) );
+               if( stats )
+                  content_ids.insert( stats->content );
+            }
+            else if( id.is<content_proof_id_type>() )
+            {
+               const content_proof_object* proof = _db.find( content_proof_id_type( id ) );
+               if( proof )
+                  content_ids.insert( proof->content );
+            }
+         }
+
+         content_catalogue_delta delta;
+         update_content_catalogue( content_ids, delta );
+         if( delta.added.size() || delta.changed.size() || delta.expired.size() || delta.blocked.size() || delta.removed.size() )
+         {
+            delta.sequence = ++_content_catalogue->sequence;
+            auto capture_this = shared_from_this();
+            std::function<void(const fc::variant&)> callback = _content_catalogue->callback;
+            fc::async([capture_this,callback,delta](){
+               callback( fc::variant( delta ) );
+            });
+         }
+      }
+
       auto capture_this = shared_from_this();
       
       /// pushing the future back / popping the prior future if it is complete.
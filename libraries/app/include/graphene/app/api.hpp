@@ -26,6 +26,7 @@
 
 #include <graphene/app/database_api.hpp>
 
+#include <graphene/chain/committed_operation_bus.hpp>
 #include <graphene/chain/protocol/types.hpp>
 
 #include <graphene/debug_miner/debug_api.hpp>
@@ -36,6 +37,7 @@
 #include <fc/optional.hpp>
 #include <fc/crypto/elliptic.hpp>
 #include <fc/network/ip.hpp>
+#include <fc/io/raw.hpp>
 
 #include <boost/container/flat_set.hpp>
 
@@ -44,11 +46,18 @@
 #include <string>
 #include <vector>
 
+/**
+ * Bumped whenever a result packed by raw_api changes its layout in a way the database version doesn't mark,
+ * e.g. an api-only struct such as full_account or content_summary gains a field
+ */
+#define RAW_API_LAYOUT_VERSION 1
+
 /**
  * @defgroup HistoryAPI History API
  * @defgroup Network_broadcastAPI Network broadcastAPI
  * @defgroup Network_NodeAPI Network NodeAPI
  * @defgroup LoginAPI LoginAPI
+ * @defgroup RawAPI Raw API
  */
 namespace graphene { namespace app {
    using namespace graphene::chain;
@@ -120,6 +129,97 @@ namespace graphene { namespace app {
            application& _app;
    };
 
+   /**
+    * @brief The raw_api class serves the heaviest database and history calls in binary form
+    *
+    * Each result is packed with fc::raw, the same reflection-based encoding used for on-chain
+    * serialization, and returned as a single blob.  The server never builds a variant tree for
+    * the result, and the packed form carries no field names.  Clients opt in by requesting this API
+    * from the login API and decode the blobs with unpack_raw_result() into the types returned by
+    * the corresponding database_api/history_api calls.
+    *
+    * The packed form has no self-description, so a client must compare get_layout_version() with
+    * its own layout_version() before decoding anything and use the JSON calls when they differ.
+    */
+   class raw_api
+   {
+      public:
+         raw_api(application& a);
+
+         /**
+          * @brief Layout of the packed results built into this binary
+          * @return RAW_API_LAYOUT_VERSION followed by the database version, whose change marks changed objects
+          */
+         static string layout_version();
+
+         /**
+          * @brief Layout of the packed results served by the node, must match the layout_version() of the client
+          * @return layout version string
+          * @ingroup RawAPI
+          */
+         string get_layout_version()const;
+
+         /**
+          * @brief Binary form of database_api::get_block
+          * @return packed optional<signed_block>
+          * @ingroup RawAPI
+          */
+         vector<char> get_block(uint32_t block_num)const;
+
+         /**
+          * @brief Binary form of database_api::get_blocks
+          * @return packed vector<signed_block>
+          * @ingroup RawAPI
+          */
+         vector<char> get_blocks(uint32_t block_num, uint32_t count)const;
+
+         /**
+          * @brief Binary form of database_api::get_full_accounts, without subscribing to the accounts
+          * @return packed std::map<string,full_account>
+          * @ingroup RawAPI
+          */
+         vector<char> get_full_accounts(const vector<string>& names_or_ids);
+
+         /**
+          * @brief Binary form of database_api::search_content
+          * @return packed vector<content_summary>
+          * @ingroup RawAPI
+          */
+         vector<char> search_content(const string& term,
+                                     const string& order,
+                                     const string& user,
+                                     const string& region_code,
+                                     const object_id_type& id,
+                                     const string& type,
+                                     uint32_t count)const;
+
+         /**
+          * @brief Binary form of history_api::get_account_history
+          * @return packed vector<operation_history_object>
+          * @ingroup RawAPI
+          */
+         vector<char> get_account_history(account_id_type account,
+                                          const string& order,
+                                          operation_history_id_type stop = operation_history_id_type(),
+                                          unsigned limit = 100,
+                                          operation_history_id_type start = operation_history_id_type())const;
+
+      private:
+         database_api _database_api;
+         history_api  _history_api;
+   };
+
+   /**
+    * @brief Decode a result returned by raw_api
+    * @param data blob returned by one of the raw_api calls
+    * @return the value the matching database_api/history_api call would have returned
+    */
+   template<typename T>
+   T unpack_raw_result( const vector<char>& data )
+   {
+      return fc::raw::unpack<T>( data );
+   }
+
    /**
     * @brief The network_broadcast_api class allows broadcasting of transactions.
     */
@@ -233,6 +333,21 @@ namespace graphene { namespace app {
           */
          std::vector<net::potential_peer_record> get_potential_peers() const;
 
+         /**
+          * @brief Get the queues delivering committed operations to the plugins: pending operations,
+          *        lag in blocks and the time block application waited for them
+          * @ingroup Network_NodeAPI
+          */
+         std::vector<graphene::chain::committed_operation_queue_stats> get_committed_operation_stats() const;
+
+         /**
+          * @brief Get the estimated memory footprint of every object index
+          * @return one entry per (space, type) index with object count, heap, undo and secondary index estimates
+          * @note this walks all objects of the database holding its lock, block application waits meanwhile
+          * @ingroup Network_NodeAPI
+          */
+         std::vector<graphene::db::index_memory_stats> get_index_memory_stats() const;
+
         /**
          * @brief This method allows user to start seeding plugin from running application
          * @param account_id ID of account controlling this seeder
@@ -345,6 +460,11 @@ namespace graphene { namespace app {
           * @ingroup LoginAPI
           */
          fc::api<graphene::debug_miner::debug_api> debug()const;
+         /**
+          * @brief Retrieve the binary-encoded API (if enabled for this user)
+          * @ingroup LoginAPI
+          */
+         fc::api<raw_api> raw()const;
 
       private:
          /**
@@ -361,6 +481,7 @@ namespace graphene { namespace app {
          optional< fc::api<history_api> >  _history_api;
          optional< fc::api<crypto_api> > _crypto_api;
          optional< fc::api<graphene::debug_miner::debug_api> > _debug_api;
+         optional< fc::api<raw_api> > _raw_api;
    };
 
 }}  // graphene::app
@@ -378,6 +499,14 @@ FC_API(graphene::app::history_api,
        (get_account_history)
        (get_relative_account_history)
      )
+FC_API(graphene::app::raw_api,
+       (get_layout_version)
+       (get_block)
+       (get_blocks)
+       (get_full_accounts)
+       (search_content)
+       (get_account_history)
+     )
 FC_API(graphene::app::network_broadcast_api,
        (broadcast_transaction)
        (broadcast_transaction_with_callback)
@@ -388,6 +517,8 @@ FC_API(graphene::app::network_node_api,
        (add_node)
        (get_connected_peers)
        (get_potential_peers)
+       (get_committed_operation_stats)
+       (get_index_memory_stats)
        (get_advanced_node_parameters)
        (set_advanced_node_parameters)
        (seeding_startup)
@@ -411,4 +542,5 @@ FC_API(graphene::app::login_api,
        (network_node)
        (crypto)
        (debug)
+       (raw)
      )
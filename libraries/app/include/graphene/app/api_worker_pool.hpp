@@ -0,0 +1,60 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <boost/thread/locks.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   /**
+    * @brief Runs read-only API calls on a pool of worker threads
+    *
+    * Every call holds the database state mutex shared while it runs, so it sees the state between two
+    * blocks or transactions while the chain thread keeps applying them.  The calling fiber yields until
+    * the result is ready.  Calls that subscribe, read the block log or change anything must stay on the
+    * chain thread.
+    */
+   class api_worker_pool
+   {
+      public:
+         api_worker_pool( graphene::chain::database& db, uint32_t thread_count )
+            : _db(db), _next_thread(0)
+         {
+            FC_ASSERT( thread_count > 0 );
+            for( uint32_t i = 0; i < thread_count; ++i )
+               _threads.emplace_back( new fc::thread( "api_worker_" + std::to_string(i) ) );
+         }
+
+         template<typename Functor>
+         auto run_read_only( Functor&& f ) -> decltype(f())
+         {
+            // the wait can be canceled while the call is queued or running, so the call owns its functor
+            typedef typename std::decay<Functor>::type functor_type;
+            std::shared_ptr<functor_type> call = std::make_shared<functor_type>( std::forward<Functor>( f ) );
+            fc::thread& worker = *_threads[_next_thread++ % _threads.size()];
+            graphene::chain::database* db = &_db;
+            return worker.async( [db, call]() {
+               boost::shared_lock<boost::shared_mutex> lock( db->state_mutex() );
+               return (*call)();
+            }, "read_only_api_call" ).wait();
+         }
+
+         size_t thread_count()const { return _threads.size(); }
+
+      private:
+         graphene::chain::database&                  _db;
+         std::vector<std::unique_ptr<fc::thread> >   _threads;
+         std::atomic<uint32_t>                        _next_thread;
+   };
+
+} }
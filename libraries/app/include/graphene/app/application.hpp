@@ -34,6 +34,7 @@ namespace graphene { namespace app {
    using std::string;
 
    class abstract_plugin;
+   class api_worker_pool;
 
    class application
    {
@@ -79,6 +80,8 @@ namespace graphene { namespace app {
 
          net::node_ptr                    p2p_node();
          std::shared_ptr<chain::database> chain_database()const;
+         /// Pool running read-only database_api calls off the chain thread, null unless --api-worker-threads is set
+         std::shared_ptr<api_worker_pool> get_api_worker_pool()const;
 
          void set_block_production(bool producing_blocks);
          fc::optional< api_access_info > get_api_access_info( const string& username )const;
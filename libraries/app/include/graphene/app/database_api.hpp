@@ -110,6 +110,24 @@ namespace graphene { namespace app {
          double                     value;
       };
 
+      /**
+       * Changes of the contents matching the filter of a catalogue subscription,
+       * see database_api::set_content_catalogue_callback
+       */
+      struct content_catalogue_delta
+      {
+         /// increases by one with each delta of the subscription, a gap means a missed delta and the client searches again
+         uint64_t                   sequence = 0;
+         /// contents which started to match the filter, ordered like search_content with the order of the subscription
+         vector<content_summary>    added;
+         /// matching contents which changed, ordered the same way
+         vector<content_summary>    changed;
+         vector<content_id_type>    expired;
+         vector<content_id_type>    blocked;
+         /// contents which stopped to match for another reason, like an edited synopsis or no recent proof of a seeder
+         vector<content_id_type>    removed;
+      };
+
 /**
  * @brief The database_api class implements the RPC API for the chain database.
  *
@@ -117,10 +135,17 @@ namespace graphene { namespace app {
  * read-only; all modifications to the database must be performed via transactions. Transactions are broadcast via
  * the @ref network_broadcast_api.
  */
+      class api_worker_pool;
+
       class database_api
       {
       public:
-         database_api(graphene::chain::database& db);
+         /**
+          * @param db the chain database to query
+          * @param worker_pool if set, the heavy read-only calls (searches, full accounts, balances) run on its
+          *        threads instead of the calling one
+          */
+         database_api(graphene::chain::database& db, std::shared_ptr<api_worker_pool> worker_pool = std::shared_ptr<api_worker_pool>());
          ~database_api();
 
          /////////////
@@ -171,6 +196,32 @@ namespace graphene { namespace app {
           */
          void set_content_update_callback( std::function<void()>cb, const string & URI );
 
+         /**
+          * @brief Receive the changes of the contents matching a search instead of repeating the search
+          *
+          * The callback receives a content_catalogue_delta whenever an applied block or transaction changes the set of
+          * the matching contents or one of them. A new call replaces the previous subscription.
+          * @param cb Callback
+          * @param term Search term
+          * @param order Ordering field of the added and changed contents, as in search_content
+          * @param user Content owner
+          * @param region_code Two letter region code
+          * @param type the application and content type to be filtered
+          * @ingroup DatabaseAPI
+          */
+         void set_content_catalogue_callback( std::function<void(const variant&)> cb,
+                                              const string& term,
+                                              const string& order,
+                                              const string& user,
+                                              const string& region_code,
+                                              const string& type );
+
+         /**
+          * @brief Stop receiving the changes of the contents matching a search
+          * @ingroup DatabaseAPI
+          */
+         void cancel_content_catalogue_callback();
+
          /**
           * @brief Stop receiving any notifications
           * @ingroup DatabaseAPI
@@ -199,6 +250,15 @@ namespace graphene { namespace app {
           */
          optional<signed_block> get_block(uint32_t block_num)const;
 
+         /**
+          * @brief Retrieve a range of full, signed blocks
+          * @param block_num Height of the first block to be returned
+          * @param count Maximum number of blocks to return, up to 100
+          * @return the consecutive blocks starting at \c block_num; the list ends early at the first missing block
+          * @ingroup DatabaseAPI
+          */
+         vector<signed_block> get_blocks(uint32_t block_num, uint32_t count)const;
+
          /**
           * @brief used to fetch an individual transaction.
           * @param block_num id of the block
@@ -776,6 +836,7 @@ FC_REFLECT( graphene::app::order_book, (base)(quote)(bids)(asks) );
 FC_REFLECT( graphene::app::market_ticker, (base)(quote)(latest)(lowest_ask)(highest_bid)(percent_change)(base_volume)(quote_volume) );
 FC_REFLECT( graphene::app::market_volume, (base)(quote)(base_volume)(quote_volume) );
 FC_REFLECT( graphene::app::market_trade, (date)(price)(amount)(value) );
+FC_REFLECT( graphene::app::content_catalogue_delta, (sequence)(added)(changed)(expired)(blocked)(removed) );
 
 FC_API(graphene::app::database_api,
 // Objects
@@ -787,10 +848,13 @@ FC_API(graphene::app::database_api,
           (set_block_applied_callback)
           (cancel_all_subscriptions)
           (set_content_update_callback)
+          (set_content_catalogue_callback)
+          (cancel_content_catalogue_callback)
 
           // Blocks and transactions
           (get_block_header)
           (get_block)
+          (get_blocks)
           (get_transaction)
           (head_block_time)
           (get_recent_transaction_by_id)
@@ -155,4 +155,14 @@ void account_member_index::object_modified(const object& after)
 }
 
 
+uint64_t account_member_index::memory_usage()const
+{
+   uint64_t result = 0;
+   for( const auto& item : account_to_account_memberships )
+      result += tree_node_overhead + sizeof(item) + item.second.size() * ( tree_node_overhead + sizeof(account_id_type) );
+   for( const auto& item : account_to_key_memberships )
+      result += tree_node_overhead + sizeof(item) + item.second.size() * ( tree_node_overhead + sizeof(account_id_type) );
+   return result;
+}
+
 } } // graphene::chain
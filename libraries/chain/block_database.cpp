@@ -26,8 +26,57 @@
 #include <fc/io/raw.hpp>
 #include <fc/smart_ref_impl.hpp>
 
+#include <chrono>
+
+#include <fcntl.h>
+#ifdef _WIN32
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
 namespace graphene { namespace chain {
 
+namespace {
+
+   /** a descriptor of a file written through an fstream, which can not sync it to the disk itself */
+   int open_for_sync( const fc::path& file )
+   {
+#ifdef _WIN32
+      int fd = _open( file.generic_string().c_str(), _O_RDWR | _O_BINARY );
+#else
+      int fd = ::open( file.generic_string().c_str(), O_RDWR );
+#endif
+      FC_ASSERT( fd >= 0, "Unable to open ${f}", ("f", file) );
+      return fd;
+   }
+
+   void sync_to_disk( int fd, const fc::path& file )
+   {
+#ifdef _WIN32
+      FC_ASSERT( _commit( fd ) == 0, "Unable to sync ${f} to the disk", ("f", file) );
+#else
+      FC_ASSERT( fsync( fd ) == 0, "Unable to sync ${f} to the disk", ("f", file) );
+#endif
+   }
+
+   /** how long the I/O thread waits before it writes a failed batch again */
+   const std::chrono::seconds write_retry_delay( 1 );
+
+   void close_for_sync( int& fd )
+   {
+      if( fd < 0 )
+         return;
+#ifdef _WIN32
+      _close( fd );
+#else
+      ::close( fd );
+#endif
+      fd = -1;
+   }
+
+}
+
 struct index_entry
 {
    uint64_t      block_pos = 0;
@@ -39,9 +88,22 @@ FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
+block_database::~block_database()
+{
+   try
+   {
+      if( _io_thread.joinable() )
+         close();
+   }
+   catch( ... )
+   {
+   }
+}
+
 void block_database::open( const fc::path& dbdir )
 { try {
    fc::create_directories(dbdir);
+   _dbdir = dbdir;
    _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
@@ -49,12 +111,33 @@ void block_database::open( const fc::path& dbdir )
    {
      _block_num_to_pos.open( (dbdir/"index").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
      _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+#ifndef _WIN32
+     // the new files have to be found after a crash as well
+     int dir_fd = ::open( dbdir.generic_string().c_str(), O_RDONLY );
+     if( dir_fd >= 0 )
+     {
+        fsync( dir_fd );
+        ::close( dir_fd );
+     }
+#endif
    }
    else
    {
      _block_num_to_pos.open( (dbdir/"index").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
      _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+     repair();
    }
+   _blocks_fd = open_for_sync( dbdir/"blocks" );
+   _block_num_to_pos_fd = open_for_sync( dbdir/"index" );
+
+   // a journal given up at the last close() is gone, open() repaired what it left on the disk
+   _journal.clear();
+   _unwritten.clear();
+   _queued_seq = 0;
+   _written_seq = 0;
+   _io_error.reset();
+   _stopping = false;
+   _io_thread = std::thread( [this]() { write_journal(); } );
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
 bool block_database::is_open()const
@@ -64,12 +147,35 @@ bool block_database::is_open()const
 
 void block_database::close()
 {
+  if( _io_thread.joinable() )
+  {
+     {
+        std::lock_guard<std::mutex> lock( _journal_mutex );
+        _stopping = true;
+     }
+     _journal_cv.notify_all();
+     // the I/O thread drains the journal before it exits
+     _io_thread.join();
+  }
+
+  std::lock_guard<std::mutex> lock( _file_mutex );
   _blocks.close();
   _block_num_to_pos.close();
+  close_for_sync( _blocks_fd );
+  close_for_sync( _block_num_to_pos_fd );
 }
 
 void block_database::flush()
 {
+  uint64_t seq;
+  {
+     std::lock_guard<std::mutex> lock( _journal_mutex );
+     seq = _queued_seq;
+  }
+  wait_written( seq );
+  check_written( seq );
+
+  std::lock_guard<std::mutex> lock( _file_mutex );
   _blocks.flush();
   _block_num_to_pos.flush();
 }
@@ -82,65 +188,292 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
       id = b.id();
       elog( "id argument of block_database::store() was not initialized for block ${id}", ("id", id) );
    }
+   queue( id, std::make_shared<signed_block>( b ) );
+}
+
+void block_database::remove( const block_id_type& id )
+{
+   {
+      std::lock_guard<std::mutex> lock( _journal_mutex );
+      auto itr = _unwritten.find( block_header::num_from_id( id ) );
+      // a different block is queued at this height, removing id would not change it
+      if( itr != _unwritten.end() && itr->second.id != id )
+         return;
+   }
+   queue( id, nullptr );
+}
+
+void block_database::sync( uint32_t block_num )
+{
+   uint64_t seq = 0;
+   {
+      std::lock_guard<std::mutex> lock( _journal_mutex );
+      for( const journal_entry& e : _journal )
+         if( block_header::num_from_id( e.id ) <= block_num )
+            seq = e.seq;
+   }
+   if( seq != 0 )
+   {
+      wait_written( seq );
+      check_written( seq );
+   }
+}
+
+void block_database::check_written( uint64_t seq )const
+{
+   std::lock_guard<std::mutex> lock( _journal_mutex );
+   if( _written_seq < seq && _io_error.valid() )
+      FC_THROW( "Block log is not writable: ${e}", ("e", _io_error->to_detail_string()) );
+}
+
+void block_database::queue( const block_id_type& id, std::shared_ptr<const signed_block> block )
+{
+   std::lock_guard<std::mutex> lock( _journal_mutex );
+   journal_entry e;
+   e.seq = ++_queued_seq;
+   e.id = id;
+   e.block = std::move( block );
+   _unwritten[ block_header::num_from_id( id ) ] = e;
+   _journal.push_back( std::move( e ) );
+   _journal_cv.notify_one();
+}
+
+void block_database::write_journal()
+{
+   std::unique_lock<std::mutex> lock( _journal_mutex );
+   while( true )
+   {
+      _journal_cv.wait( lock, [this]() { return _stopping || !_journal.empty(); } );
+      if( _journal.empty() )
+         break;
+
+      // the entries stay in the journal, and readable through _unwritten, until they are on disk.  Everything
+      // queued so far is written at once, so the files are synced to the disk once per batch
+      const std::vector<journal_entry> batch( _journal.begin(), _journal.end() );
+      lock.unlock();
+      optional<fc::exception> failure;
+      try
+      {
+         std::lock_guard<std::mutex> file_lock( _file_mutex );
+         // writing an entry of a failed batch again appends the block once more and points its index entry to it
+         _blocks.clear();
+         _block_num_to_pos.clear();
+         for( const journal_entry& e : batch )
+         {
+            if( e.block )
+               disk_store( e.id, *e.block );
+            else
+               disk_remove( e.id );
+         }
+         sync_to_disk( _blocks_fd, _dbdir/"blocks" );
+         sync_to_disk( _block_num_to_pos_fd, _dbdir/"index" );
+      }
+      catch( const fc::exception& ex )
+      {
+         failure = ex;
+      }
+      catch( const std::exception& ex )
+      {
+         failure = fc::exception( FC_LOG_MESSAGE( error, "${what}", ("what", ex.what()) ) );
+      }
+      if( failure.valid() )
+      {
+         // the readers must not find the files in the failed state
+         std::lock_guard<std::mutex> file_lock( _file_mutex );
+         _blocks.clear();
+         _block_num_to_pos.clear();
+      }
+      lock.lock();
+
+      if( failure.valid() )
+      {
+         // the batch stays in the journal, so the blocks stay readable and are written by the next attempt.
+         // The callers waiting for it are woken up, sync() reports the failure to them
+         elog( "Failed to write blocks ${first} to ${last} to the block log: ${e}",
+               ("first", batch.front().id)("last", batch.back().id)("e", failure->to_detail_string()) );
+         _io_error = failure;
+         _written_cv.notify_all();
+         if( _stopping )
+         {
+            elog( "Giving up writing ${n} changes of the block log", ("n", _journal.size()) );
+            break;
+         }
+         _journal_cv.wait_for( lock, write_retry_delay, [this]() { return _stopping; } );
+         continue;
+      }
+
+      _io_error.reset();
+      for( const journal_entry& e : batch )
+      {
+         _journal.pop_front();
+         auto itr = _unwritten.find( block_header::num_from_id( e.id ) );
+         if( itr != _unwritten.end() && itr->second.seq == e.seq )
+            _unwritten.erase( itr );
+      }
+      _written_seq = batch.back().seq;
+      _written_cv.notify_all();
+   }
+}
+
+void block_database::wait_written( uint64_t seq )
+{
+   std::unique_lock<std::mutex> lock( _journal_mutex );
+   _written_cv.wait( lock, [this, seq]() { return _written_seq >= seq || _journal.empty() || _io_error.valid(); } );
+}
+
+void block_database::repair()
+{
+   _blocks.seekg( 0, _blocks.end );
+   const uint64_t blocks_size = _blocks.tellg();
+   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
+   const uint64_t index_size = _block_num_to_pos.tellg();
+
+   // walk back from the end until an entry points to a complete block
+   uint64_t entries = index_size / sizeof(index_entry);
+   while( entries > 0 )
+   {
+      index_entry e;
+      _block_num_to_pos.seekg( (entries - 1) * sizeof(index_entry) );
+      _block_num_to_pos.read( (char*)&e, sizeof(e) );
+      if( e.block_size == 0 )
+         break;
+      if( e.block_pos + e.block_size <= blocks_size )
+      {
+         try
+         {
+            vector<char> data( e.block_size );
+            _blocks.seekg( e.block_pos );
+            _blocks.read( data.data(), e.block_size );
+            if( fc::raw::unpack<signed_block>( data ).id() == e.block_id )
+               break;
+         }
+         catch( const fc::exception& )
+         {
+         }
+         _blocks.clear();
+      }
+      --entries;
+   }
+
+   if( entries * sizeof(index_entry) != index_size )
+   {
+      wlog( "Dropping ${n} bytes of incomplete entries from the end of the block index", ("n", index_size - entries * sizeof(index_entry)) );
+      _block_num_to_pos.close();
+      fc::resize_file( _dbdir/"index", entries * sizeof(index_entry) );
+      _block_num_to_pos.open( (_dbdir/"index").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+   }
+}
+
+optional<block_database::journal_entry> block_database::find_unwritten( uint32_t block_num )const
+{
+   std::lock_guard<std::mutex> lock( _journal_mutex );
+   auto itr = _unwritten.find( block_num );
+   if( itr == _unwritten.end() )
+      return optional<journal_entry>();
+   return itr->second;
+}
+
+void block_database::disk_store( const block_id_type& id, const signed_block& b )
+{
    auto num = block_header::num_from_id(id);
-   _block_num_to_pos.seekp( sizeof( index_entry ) * num );
    index_entry e;
    _blocks.seekp( 0, _blocks.end );
    auto vec = fc::raw::pack( b );
    e.block_pos  = _blocks.tellp();
    e.block_size = vec.size();
    e.block_id   = id;
+   // the block has to be complete before the index entry refers to it
    _blocks.write( vec.data(), vec.size() );
+   _blocks.flush();
+   _block_num_to_pos.seekp( sizeof( index_entry ) * num );
    _block_num_to_pos.write( (char*)&e, sizeof(e) );
+   _block_num_to_pos.flush();
 }
 
-void block_database::remove( const block_id_type& id )
-{ try {
+void block_database::disk_remove( const block_id_type& id )
+{
    index_entry e;
-   auto index_pos = sizeof(e)*block_header::num_from_id(id);
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
-      FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block ${id} not contained in block database", ("id", id));
-
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
+   if( !disk_read_entry( block_header::num_from_id(id), e ) )
+      return;
 
    if( e.block_id == id )
    {
       e.block_size = 0;
       _block_num_to_pos.seekp( sizeof(e)*block_header::num_from_id(id) );
       _block_num_to_pos.write( (char*)&e, sizeof(e) );
+      _block_num_to_pos.flush();
    }
-} FC_CAPTURE_AND_RETHROW( (id) ) }
+}
+
+bool block_database::disk_read_entry( uint32_t block_num, index_entry& e )const
+{
+   auto index_pos = sizeof(e)*block_num;
+   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
+   if ( _block_num_to_pos.tellg() <= int64_t(index_pos) )
+      return false;
+
+   _block_num_to_pos.seekg( index_pos );
+   _block_num_to_pos.read( (char*)&e, sizeof(e) );
+   return true;
+}
+
+optional<signed_block> block_database::disk_read_block( const index_entry& e )const
+{
+   if( e.block_size == 0 )
+      return optional<signed_block>();
+
+   vector<char> data( e.block_size );
+   _blocks.seekg( e.block_pos );
+   _blocks.read( data.data(), e.block_size );
+   auto result = fc::raw::unpack<signed_block>(data);
+   FC_ASSERT( result.id() == e.block_id );
+   return result;
+}
+
+optional<index_entry> block_database::disk_last( const std::map<uint32_t, journal_entry>& overrides )const
+{
+   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
+   int64_t pos = int64_t(_block_num_to_pos.tellg()) - int64_t(sizeof(index_entry));
+   for( ; pos >= 0; pos -= sizeof(index_entry) )
+   {
+      index_entry e;
+      _block_num_to_pos.seekg( pos );
+      _block_num_to_pos.read( (char*)&e, sizeof(e) );
+      if( e.block_size == 0 || overrides.find( pos / sizeof(index_entry) ) != overrides.end() )
+         continue;
+      return e;
+   }
+   return optional<index_entry>();
+}
 
 bool block_database::contains( const block_id_type& id )const
 {
    if( id == block_id_type() )
       return false;
 
+   auto unwritten = find_unwritten( block_header::num_from_id(id) );
+   if( unwritten.valid() )
+      return unwritten->id == id && unwritten->block;
+
+   std::lock_guard<std::mutex> lock( _file_mutex );
    index_entry e;
-   auto index_pos = sizeof(e)*block_header::num_from_id(id);
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   if( !disk_read_entry( block_header::num_from_id(id), e ) )
       return false;
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
    return e.block_id == id && e.block_size > 0;
 }
 
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
    assert( block_num != 0 );
+   auto unwritten = find_unwritten( block_num );
+   if( unwritten.valid() )
+      return unwritten->id;
+
+   std::lock_guard<std::mutex> lock( _file_mutex );
    index_entry e;
-   auto index_pos = sizeof(e)*block_num;
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= int64_t(index_pos) )
+   if( !disk_read_entry( block_num, e ) )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block number ${block_num} not contained in block database", ("block_num", block_num));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
    FC_ASSERT( e.block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
    return e.block_id;
 }
@@ -149,24 +482,20 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
 {
    try
    {
+      auto unwritten = find_unwritten( block_header::num_from_id(id) );
+      if( unwritten.valid() )
+      {
+         if( unwritten->id != id || !unwritten->block )
+            return optional<signed_block>();
+         return *unwritten->block;
+      }
+
+      std::lock_guard<std::mutex> lock( _file_mutex );
       index_entry e;
-      auto index_pos = sizeof(e)*block_header::num_from_id(id);
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
+      if( !disk_read_entry( block_header::num_from_id(id), e ) )
          return {};
-
-      _block_num_to_pos.seekg( index_pos );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
       if( e.block_id != id ) return optional<signed_block>();
-
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      if (e.block_size)
-         _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+      return disk_read_block( e );
    }
    catch (const fc::exception&)
    {
@@ -181,21 +510,19 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
 {
    try
    {
+      auto unwritten = find_unwritten( block_num );
+      if( unwritten.valid() )
+      {
+         if( !unwritten->block )
+            return optional<signed_block>();
+         return *unwritten->block;
+      }
+
+      std::lock_guard<std::mutex> lock( _file_mutex );
       index_entry e;
-      auto index_pos = sizeof(e)*block_num;
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
+      if( !disk_read_entry( block_num, e ) )
          return {};
-
-      _block_num_to_pos.seekg( index_pos, _block_num_to_pos.beg );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+      return disk_read_block( e );
    }
    catch (const fc::exception&)
    {
@@ -210,30 +537,21 @@ optional<signed_block> block_database::last()const
 {
    try
    {
-      index_entry e;
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-
-      if( _block_num_to_pos.tellp() < sizeof(index_entry) )
-         return optional<signed_block>();
-
-      _block_num_to_pos.seekg( -sizeof(index_entry), _block_num_to_pos.end );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-      uint64_t pos = _block_num_to_pos.tellg();
-      while( e.block_size == 0 && pos > 0 )
+      std::map<uint32_t, journal_entry> unwritten;
       {
-         pos -= sizeof(index_entry);
-         _block_num_to_pos.seekg( pos );
-         _block_num_to_pos.read( (char*)&e, sizeof(e) );
+         std::lock_guard<std::mutex> lock( _journal_mutex );
+         unwritten = _unwritten;
       }
-
-      if( e.block_size == 0 )
-         return optional<signed_block>();
-
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      return result;
+      std::shared_ptr<const signed_block> queued;
+      for( auto itr = unwritten.rbegin(); itr != unwritten.rend() && !queued; ++itr )
+         queued = itr->second.block;
+
+      std::lock_guard<std::mutex> lock( _file_mutex );
+      auto e = disk_last( unwritten );
+      if( e.valid() && ( !queued || block_header::num_from_id( e->block_id ) > queued->block_num() ) )
+         return disk_read_block( *e );
+      if( queued )
+         return *queued;
    }
    catch (const fc::exception&)
    {
@@ -248,26 +566,21 @@ optional<block_id_type> block_database::last_id()const
 {
    try
    {
-      index_entry e;
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-
-      if( _block_num_to_pos.tellp() < sizeof(index_entry) )
-         return optional<block_id_type>();
-
-      _block_num_to_pos.seekg( -sizeof(index_entry), _block_num_to_pos.end );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-      uint64_t pos = _block_num_to_pos.tellg();
-      while( e.block_size == 0 && pos > 0 )
+      std::map<uint32_t, journal_entry> unwritten;
       {
-         pos -= sizeof(index_entry);
-         _block_num_to_pos.seekg( pos );
-         _block_num_to_pos.read( (char*)&e, sizeof(e) );
+         std::lock_guard<std::mutex> lock( _journal_mutex );
+         unwritten = _unwritten;
       }
-
-      if( e.block_size == 0 )
-         return optional<block_id_type>();
-
-      return e.block_id;
+      optional<block_id_type> queued;
+      for( auto itr = unwritten.rbegin(); itr != unwritten.rend() && !queued.valid(); ++itr )
+         if( itr->second.block )
+            queued = itr->second.id;
+
+      std::lock_guard<std::mutex> lock( _file_mutex );
+      auto e = disk_last( unwritten );
+      if( e.valid() && ( !queued.valid() || block_header::num_from_id( e->block_id ) > block_header::num_from_id( *queued ) ) )
+         return e->block_id;
+      return queued;
    }
    catch (const fc::exception&)
    {
@@ -0,0 +1,263 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#include <graphene/chain/committed_operation_bus.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace chain {
+
+committed_operation_bus::committed_operation_bus( database& db )
+   : _db(db), _chain_thread(&fc::thread::current()), _alive(std::make_shared<bool>(true))
+{
+}
+
+committed_operation_bus::~committed_operation_bus()
+{
+   close();
+}
+
+template<typename Predicate>
+void committed_operation_bus::wait_on_chain_thread( std::unique_lock<std::mutex>& lock, Predicate done )
+{
+   for( ;; )
+   {
+      // the handlers we wait for may be waiting for their chain tasks
+      if( !_chain_tasks.empty() )
+      {
+         std::function<void()> task = std::move( _chain_tasks.front() );
+         _chain_tasks.pop_front();
+         lock.unlock();
+         task();
+         lock.lock();
+         continue;
+      }
+      if( done() )
+         return;
+      _chain_cv.wait( lock );
+   }
+}
+
+std::shared_ptr<committed_operation_queue> committed_operation_bus::subscribe( const string& name, handler_type handler,
+                                                                               uint32_t capacity )
+{
+   FC_ASSERT( capacity > 0 );
+   FC_ASSERT( handler );
+   std::shared_ptr<committed_operation_queue> queue( new committed_operation_queue( name, std::move(handler), capacity ) );
+   queue->_stats.name = name;
+   queue->_stats.capacity = capacity;
+
+   std::lock_guard<std::mutex> lock( _mutex );
+   FC_ASSERT( !_closed, "committed operation bus is closed" );
+   committed_operation_queue* q = queue.get();
+   queue->_thread = std::thread( [this, q]() { consume( *q ); } );
+   _queues.push_back( queue );
+   return queue;
+}
+
+void committed_operation_bus::unsubscribe( const std::shared_ptr<committed_operation_queue>& queue )
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   auto itr = std::find( _queues.begin(), _queues.end(), queue );
+   if( itr == _queues.end() )
+      return;
+   _queues.erase( itr );
+   stop_queue( lock, *queue );
+}
+
+void committed_operation_bus::stop_queue( std::unique_lock<std::mutex>& lock, committed_operation_queue& queue )
+{
+   if( !queue._entries.empty() )
+      wlog( "Dropping ${n} committed operations not handled by ${q}", ("n", queue._entries.size())("q", queue._name) );
+   queue._entries.clear();
+   queue._stopping = true;
+   queue._cv.notify_all();
+   // the handler still running may be waiting for one of its chain tasks
+   wait_on_chain_thread( lock, [&queue]() { return !queue._busy; } );
+
+   lock.unlock();
+   if( queue._thread.joinable() )
+      queue._thread.join();
+   lock.lock();
+}
+
+void committed_operation_bus::publish( const operation_history_object& op, bool sync_mode )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   for( const auto& queue : _queues )
+   {
+      queue->_entries.push_back( committed_operation_queue::entry{ op, sync_mode } );
+      committed_operation_queue_stats& stats = queue->_stats;
+      stats.last_published_block = op.block_num;
+      stats.max_pending = std::max<uint32_t>( stats.max_pending, queue->_entries.size() );
+      queue->_cv.notify_one();
+   }
+}
+
+void committed_operation_bus::discard_from( uint32_t block_num )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   for( const auto& queue : _queues )
+   {
+      // the operations are queued in block order
+      while( !queue->_entries.empty() && queue->_entries.back().op.block_num >= block_num )
+         queue->_entries.pop_back();
+      queue->_stats.last_published_block = std::min( queue->_stats.last_published_block, block_num - 1 );
+   }
+   _chain_cv.notify_all();
+}
+
+void committed_operation_bus::wait_for_capacity()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   std::vector<std::shared_ptr<committed_operation_queue> > full;
+   for( const auto& queue : _queues )
+      if( queue->_entries.size() >= queue->_capacity )
+         full.push_back( queue );
+   if( full.empty() && _chain_tasks.empty() )
+      return;
+
+   for( const auto& queue : full )
+      wlog( "Block application waits for plugin queue ${q}, ${n} operations pending",
+            ("q", queue->_name)("n", queue->_entries.size()) );
+
+   fc::time_point start = fc::time_point::now();
+   wait_on_chain_thread( lock, [this]() {
+      for( const auto& queue : _queues )
+         if( queue->_entries.size() >= queue->_capacity && !queue->_stopping )
+            return false;
+      return true;
+   });
+
+   uint64_t waited = ( fc::time_point::now() - start ).count();
+   for( const auto& queue : full )
+   {
+      ++queue->_stats.stalls;
+      queue->_stats.stall_time_us += waited;
+   }
+}
+
+void committed_operation_bus::flush()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   wait_on_chain_thread( lock, [this]() {
+      for( const auto& queue : _queues )
+         if( ( !queue->_entries.empty() || queue->_busy ) && !queue->_stopping )
+            return false;
+      return true;
+   });
+}
+
+std::future<void> committed_operation_bus::run_on_chain_thread( std::function<void()> task )
+{
+   database& db = _db;
+   auto job = std::make_shared<std::packaged_task<void()> >( [&db, task]() {
+      database::write_scope scope( db );
+      task();
+   });
+   std::future<void> result = job->get_future();
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( _closed )
+      {
+         std::promise<void> canceled;
+         canceled.set_exception( std::make_exception_ptr(
+            fc::canceled_exception( FC_LOG_MESSAGE( warn, "committed operation bus is closed" ) ) ) );
+         return canceled.get_future();
+      }
+      _chain_tasks.push_back( [job]() { (*job)(); } );
+      _chain_cv.notify_all();
+   }
+
+   std::weak_ptr<bool> alive = _alive;
+   _chain_thread->async( [this, alive]() {
+      if( alive.lock() )
+         run_chain_tasks();
+   }, "committed_operation_bus chain task" );
+   return result;
+}
+
+void committed_operation_bus::run_chain_tasks()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   while( !_chain_tasks.empty() )
+   {
+      std::function<void()> task = std::move( _chain_tasks.front() );
+      _chain_tasks.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+   }
+}
+
+void committed_operation_bus::consume( committed_operation_queue& queue )
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   for( ;; )
+   {
+      queue._cv.wait( lock, [&queue]() { return queue._stopping || !queue._entries.empty(); } );
+      if( queue._stopping )
+         return;
+
+      committed_operation_queue::entry e = std::move( queue._entries.front() );
+      queue._entries.pop_front();
+      queue._busy = true;
+      lock.unlock();
+
+      bool failed = true;
+      try {
+         queue._handler( e.op, e.sync_mode );
+         failed = false;
+      } catch( const fc::exception& ex ) {
+         elog( "Plugin queue ${q} failed to handle operation of block ${b}:\n${e}",
+               ("q", queue._name)("b", e.op.block_num)("e", ex.to_detail_string()) );
+      } catch( const std::exception& ex ) {
+         elog( "Plugin queue ${q} failed to handle operation of block ${b}: ${e}",
+               ("q", queue._name)("b", e.op.block_num)("e", ex.what()) );
+      }
+
+      lock.lock();
+      queue._busy = false;
+      if( failed )
+         ++queue._stats.failed;
+      else
+         ++queue._stats.processed;
+      queue._stats.last_processed_block = e.op.block_num;
+      _chain_cv.notify_all();
+   }
+}
+
+std::vector<committed_operation_queue_stats> committed_operation_bus::get_stats()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   std::vector<committed_operation_queue_stats> result;
+   result.reserve( _queues.size() );
+   for( const auto& queue : _queues )
+   {
+      committed_operation_queue_stats stats = queue->_stats;
+      stats.pending = queue->_entries.size();
+      if( stats.pending > 0 || queue->_busy )
+         stats.lag_blocks = stats.last_published_block - stats.last_processed_block;
+      result.push_back( stats );
+   }
+   return result;
+}
+
+void committed_operation_bus::close()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   if( _closed )
+      return;
+   _closed = true;
+   // handlers waiting for these get a broken promise
+   _chain_tasks.clear();
+   _alive.reset();
+
+   std::vector<std::shared_ptr<committed_operation_queue> > queues;
+   queues.swap( _queues );
+   for( const auto& queue : queues )
+      stop_queue( lock, *queue );
+}
+
+} }
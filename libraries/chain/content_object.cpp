@@ -3,6 +3,8 @@
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/database.hpp>
 
+#include <limits>
+
 namespace graphene { namespace chain {
 
    map<uint32_t, string> RegionCodes::s_mapCodeToName;
@@ -80,7 +82,7 @@ namespace graphene { namespace chain {
       return false;
    }
    //
-   content_summary& content_summary::set( const content_object& co, const account_object& ao, uint32_t region_code )
+   content_summary& content_summary::set( const database& db, const content_object& co, const account_object& ao, uint32_t region_code )
    {
       this->id = string(co.id);
       this->author = ao.name;
@@ -88,17 +90,21 @@ namespace graphene { namespace chain {
       FC_ASSERT(op_price.valid());
       this->price = *op_price;
 
+      const content_statistics_object& stats = db.get(co.statistics);
+
       this->synopsis = co.synopsis;
       this->URI = co.URI;
-      this->AVG_rating = co.AVG_rating;
+      this->AVG_rating = stats.AVG_rating;
       this->_hash = co._hash;
       this->size = co.size;
       this->expiration = co.expiration;
       this->created = co.created;
-      this->times_bought = co.times_bought;
-      if(co.last_proof.size() >= co.quorum)
+      this->times_bought = stats.times_bought;
+
+      const uint32_t seeders = proven_seeders(db, co);
+      if(seeders >= co.quorum)
          this->status = "Uploaded";
-      else if( co.last_proof.size() > 0 )
+      else if( seeders > 0 )
          this->status = "Partially uploaded";
       else
          this->status = "Uploading";
@@ -107,12 +113,100 @@ namespace graphene { namespace chain {
          this->status = "Expired";
       return *this;
    }
-   content_summary& content_summary::set( const content_object& co, const account_object& ao, string const& region_code )
+   content_summary& content_summary::set( const database& db, const content_object& co, const account_object& ao, string const& region_code )
    {
       auto it = RegionCodes::s_mapNameToCode.find(region_code);
       FC_ASSERT(it != RegionCodes::s_mapNameToCode.end());
 
-      return set(co, ao, it->second);
+      return set(db, co, ao, it->second);
+   }
+
+   bool recent_proof( const database& db, const content_object& content, uint64_t validity_seconds )
+   {
+      const auto now = fc::time_point::now();
+      const auto& idx = db.get_index_type<content_proof_index>().indices().get<by_content_seeder>();
+      auto range = idx.equal_range( content.get_id() );
+      for( auto itr = range.first; itr != range.second; ++itr )
+      {
+         if( itr->last_proof > now - fc::seconds(validity_seconds) )
+            return true;
+      }
+      return false;
+   }
+
+   uint32_t proven_seeders( const database& db, const content_object& content )
+   {
+      const auto& idx = db.get_index_type<content_proof_index>().indices().get<by_content_seeder>();
+      auto range = idx.equal_range( content.get_id() );
+      return std::distance( range.first, range.second );
+   }
+
+   const content_object* find_content( const database& db, const string& URI )
+   {
+      const auto& idx = db.get_index_type<content_index>().indices().get<by_URI>();
+      auto itr = idx.find( URI );
+      return itr == idx.end() ? nullptr : &*itr;
+   }
+
+   std::vector<content_price_index::key_type> content_price_index::get_keys( const content_object& content )
+   {
+      std::vector<key_type> result;
+      for( const auto& region : RegionCodes::s_mapCodeToName )
+      {
+         optional<asset> price = content.price.GetPrice( region.first );
+         if( price.valid() )
+            result.push_back( std::make_tuple( region.first, price->amount, content.get_id() ) );
+      }
+      return result;
+   }
+
+   void content_price_index::object_inserted( const object& obj )
+   {
+      assert( dynamic_cast<const content_object*>(&obj) );
+      for( const auto& key : get_keys( static_cast<const content_object&>(obj) ) )
+         _region_price_to_content.insert( key );
+   }
+
+   void content_price_index::object_removed( const object& obj )
+   {
+      assert( dynamic_cast<const content_object*>(&obj) );
+      for( const auto& key : get_keys( static_cast<const content_object&>(obj) ) )
+         _region_price_to_content.erase( key );
+   }
+
+   void content_price_index::about_to_modify( const object& before )
+   {
+      object_removed( before );
+   }
+
+   void content_price_index::object_modified( const object& after )
+   {
+      object_inserted( after );
+   }
+
+   uint64_t content_price_index::memory_usage()const
+   {
+      return _region_price_to_content.size() * ( tree_node_overhead + sizeof(key_type) );
+   }
+
+   std::pair<std::set<content_price_index::key_type>::const_iterator, std::set<content_price_index::key_type>::const_iterator>
+   content_price_index::region_range( uint32_t region_code )const
+   {
+      auto first = _region_price_to_content.lower_bound( std::make_tuple( region_code, share_type( std::numeric_limits<int64_t>::min() ), content_id_type( 0 ) ) );
+      auto last = _region_price_to_content.lower_bound( std::make_tuple( region_code + 1, share_type( std::numeric_limits<int64_t>::min() ), content_id_type( 0 ) ) );
+      return std::make_pair( first, last );
+   }
+
+   uint64_t dynamic_memory_usage( const content_object& content )
+   {
+      uint64_t result = content.synopsis.capacity() + content.URI.capacity();
+      result += content.co_authors.size() * ( tree_node_overhead + sizeof(std::pair<account_id_type, uint32_t>) );
+      result += content.price.map_price.size() * ( tree_node_overhead + sizeof(decltype(content.price.map_price)::value_type) );
+      for( const auto& item : content.key_parts )
+         result += tree_node_overhead + sizeof(item) + item.second.C1.s.capacity() + item.second.D1.s.capacity();
+      if( content.cd.valid() )
+         result += fc::raw::pack_size( *content.cd );
+      return result;
    }
 
 }}
@@ -112,21 +112,32 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
  * @return true if we switched forks as a result of this push.
  */
 bool database::push_block(const signed_block &new_block, uint32_t skip, bool sync_mode)
+{
+   return push_block( new_block, block_metadata(), skip, sync_mode );
+}
+
+bool database::push_block(const signed_block &new_block, const block_metadata& metadata, uint32_t skip, bool sync_mode)
 {
    //idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
+   // a plugin far behind the chain holds up the next block, not the one it was handed.  Plugin threads read
+   // holding the state mutex shared, so we must not wait holding it: a nested push (generate_block) has been
+   // waited for by the outermost scope
+   if( _write_scope_depth == 0 )
+      _committed_operations.wait_for_capacity();
+   write_scope scope( *this );
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
       detail::without_pending_transactions( *this, std::move(_pending_tx),
       [&]()
       {
-         result = _push_block( new_block, sync_mode );
+         result = _push_block( new_block, sync_mode, metadata );
       });
    });
    return result;
 }
 
-bool database::_push_block(const signed_block &new_block, bool sync_mode)
+bool database::_push_block(const signed_block &new_block, bool sync_mode, const block_metadata& metadata)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
    if( !(skip&skip_fork_db) )
@@ -181,7 +192,7 @@ bool database::_push_block(const signed_block &new_block, bool sync_mode)
                    {
                       auto session = _undo_db.start_undo_session();
                       apply_block( (*ritr)->data, skip );
-                      _block_id_to_block.store( new_block.id(), (*ritr)->data );
+                      _block_id_to_block.store( (*ritr)->id, (*ritr)->data );
                       session.commit();
                    }
                    throw *except;
@@ -195,8 +206,10 @@ bool database::_push_block(const signed_block &new_block, bool sync_mode)
 
    try {
       auto session = _undo_db.start_undo_session();
-      apply_block(new_block, skip);
+      apply_block(new_block, skip, metadata);
       _block_id_to_block.store(new_block.id(), new_block);
+      // the block log is written behind, only the irreversible part has to be on disk before we go on
+      _block_id_to_block.sync( get_dynamic_global_properties().last_irreversible_block_num );
       session.commit();
       //we will notify after session commit, since we want to be sure that seeding plugin works and generated tx will refer to commited block_objects
 
@@ -208,15 +221,18 @@ bool database::_push_block(const signed_block &new_block, bool sync_mode)
    auto session = _undo_db.start_undo_session();
    try {
 
-      for( const auto &trx : new_block.transactions ) {
-         for( const auto &op : trx.operations ) {
-            operation_history_object oh(op);
+      for( uint16_t trx_in_block = 0; trx_in_block < new_block.transactions.size(); ++trx_in_block ) {
+         const auto& trx = new_block.transactions[trx_in_block];
+         for( uint16_t op_in_trx = 0; op_in_trx < trx.operations.size(); ++op_in_trx ) {
+            operation_history_object oh(trx.operations[op_in_trx]);
             oh.block_num = new_block.block_num();
-            oh.op = op;
+            oh.trx_in_block = trx_in_block;
+            oh.op_in_trx = op_in_trx;
             if(sync_mode)
                on_new_commited_operation_during_sync(oh);
             else
                on_new_commited_operation(oh);
+            _committed_operations.publish( oh, sync_mode );
          }
       }
       session.merge();
@@ -241,16 +257,27 @@ bool database::_push_block(const signed_block &new_block, bool sync_mode)
  * queues.
  */
 processed_transaction database::push_transaction( const signed_transaction& trx, uint32_t skip )
+{
+   return push_transaction( std::make_shared<transaction_metadata>( trx ), skip );
+}
+
+processed_transaction database::push_transaction( const transaction_metadata_ptr& trx, uint32_t skip )
 { try {
+   write_scope scope( *this );
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
       result = _push_transaction( trx );
    } );
    return result;
-} FC_CAPTURE_AND_RETHROW( (trx) ) }
+} FC_CAPTURE_AND_RETHROW( (trx->get_transaction()) ) }
 
 processed_transaction database::_push_transaction( const signed_transaction& trx )
+{
+   return _push_transaction( std::make_shared<transaction_metadata>( trx ) );
+}
+
+processed_transaction database::_push_transaction( const transaction_metadata_ptr& trx )
 {
    // If this is the first transaction pushed after applying a block, start a new undo session.
    // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
@@ -263,15 +290,15 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    // apply the changes.
 
    auto temp_session = _undo_db.start_undo_session();
-   auto processed_trx = _apply_transaction( trx );
-   _pending_tx.push_back(processed_trx);
+   auto processed_trx = _apply_transaction( *trx );
+   _pending_tx.push_back(trx);
 
    notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
    temp_session.merge();
 
    // notify anyone listening to pending transactions
-   on_pending_transaction( trx );
+   on_pending_transaction( trx->get_transaction() );
    return processed_trx;
 }
 
@@ -314,6 +341,10 @@ signed_block database::generate_block(
    uint32_t skip /* = 0 */
    )
 { try {
+   // the block is pushed within our write scope, see push_block
+   if( _write_scope_depth == 0 )
+      _committed_operations.wait_for_capacity();
+   write_scope scope( *this );
    signed_block result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -361,10 +392,12 @@ signed_block database::_generate_block(
    _pending_tx_session = _undo_db.start_undo_session();
 
    uint64_t postponed_tx_count = 0;
+   vector<digest_type> merkle_digests;
+   merkle_digests.reserve( _pending_tx.size() );
    // pop pending state (reset to head block state)
-   for( const processed_transaction& tx : _pending_tx )
+   for( const transaction_metadata_ptr& tx : _pending_tx )
    {
-      size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+      size_t new_total_size = total_block_size + tx->packed_size();
 
       // postpone transaction if it would make block too big
       if( new_total_size >= maximum_block_size )
@@ -376,20 +409,21 @@ signed_block database::_generate_block(
       try
       {
          auto temp_session = _undo_db.start_undo_session();
-         processed_transaction ptx = _apply_transaction( tx );
+         processed_transaction ptx = _apply_transaction( *tx );
          temp_session.merge();
 
          // We have to recompute pack_size(ptx) because it may be different
          // than pack_size(tx) (i.e. if one or more results increased
          // their size)
-         total_block_size += fc::raw::pack_size( ptx );
-         pending_block.transactions.push_back( ptx );
+         total_block_size += tx->packed_size() + fc::raw::pack_size( ptx.operation_results );
+         merkle_digests.push_back( tx->merkle_digest( ptx.operation_results ) );
+         pending_block.transactions.push_back( std::move( ptx ) );
       }
       catch ( const fc::exception& e )
       {
          // Do nothing, transaction will not be re-applied
          wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
-         wlog( "The transaction was ${t}", ("t", tx) );
+         wlog( "The transaction was ${t}", ("t", tx->get_transaction()) );
       }
    }
    if( postponed_tx_count > 0 )
@@ -407,7 +441,7 @@ signed_block database::_generate_block(
 
    pending_block.previous = head_block_id();
    pending_block.timestamp = when;
-   pending_block.transaction_merkle_root = pending_block.calculate_merkle_root();
+   pending_block.transaction_merkle_root = signed_block::calculate_merkle_root( std::move( merkle_digests ) );
    pending_block.miner = miner_id;
 
    if( !(skip & skip_miner_signature) )
@@ -430,6 +464,7 @@ signed_block database::_generate_block(
  */
 void database::pop_block()
 { try {
+   write_scope scope( *this );
    auto current_block_no = head_block_num();
    _pending_tx_session.reset();
    auto head_id = head_block_id();
@@ -439,6 +474,8 @@ void database::pop_block()
    _fork_db.pop_block();
    _block_id_to_block.remove( head_id );
    pop_undo();
+   _plugin_changes_block = std::min( _plugin_changes_block, head_block_num() );
+   _committed_operations.discard_from( current_block_no );
 
    _popped_tx.insert( _popped_tx.begin(), head_block->transactions.begin(), head_block->transactions.end() );
 
@@ -446,11 +483,50 @@ void database::pop_block()
 
 void database::clear_pending()
 { try {
+   write_scope scope( *this );
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
    _pending_tx_session.reset();
 } FC_CAPTURE_AND_RETHROW() }
 
+void database::apply_plugin_changes( uint32_t block_num, const std::function<void()>& changes )
+{
+   write_scope scope( *this );
+   if( block_num > head_block_num() )
+   {
+      wlog( "Dropping plugin changes for popped block ${b}", ("b", block_num) );
+      return;
+   }
+   detail::without_pending_transactions( *this, std::move(_pending_tx), [&]()
+   {
+      if( !_undo_db.enabled() )
+      {
+         changes();
+         return;
+      }
+      const uint32_t bound_block = std::max( block_num == 0 ? head_block_num() : block_num, _plugin_changes_block );
+      // one undo state per block, the head block's is the last one, starting a session may drop the first
+      const uint32_t depth = head_block_num() - bound_block;
+      if( depth >= std::min( _undo_db.size(), _undo_db.max_size() ) )
+      {
+         // the block is out of the undo history, nothing can unwind the changes
+         _undo_db.disable();
+         try {
+            changes();
+         } catch( ... ) {
+            _undo_db.enable();
+            throw;
+         }
+         _undo_db.enable();
+         return;
+      }
+      auto session = _undo_db.start_undo_session();
+      changes();
+      session.merge( depth );
+      _plugin_changes_block = bound_block;
+   });
+}
+
 uint32_t database::push_applied_operation( const operation& op )
 {
    _applied_ops.emplace_back(op);
@@ -480,9 +556,14 @@ const vector<optional< operation_history_object > >& database::get_applied_opera
    return _applied_ops;
 }
 
+const vector<transaction_metadata_ptr>& database::get_applied_transactions() const
+{
+   return _applied_trxs;
+}
+
 //////////////////// private methods ////////////////////
 
-void database::apply_block( const signed_block& next_block, uint32_t skip )
+void database::apply_block( const signed_block& next_block, uint32_t skip, const block_metadata& metadata )
 {
    auto block_num = next_block.block_num();
    if( _checkpoints.size() && _checkpoints.rbegin()->second != block_id_type() )
@@ -497,67 +578,100 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
 
    detail::with_skip_flags( *this, skip, [&]()
    {
-      _apply_block( next_block );
+      _apply_block( next_block, metadata );
    } );
    return;
 }
 
-void database::_apply_block( const signed_block& next_block )
+void database::_apply_block( const signed_block& next_block, const block_metadata& metadata )
 { try {
-   uint32_t next_block_num = next_block.block_num();
-   uint32_t skip = get_node_properties().skip_flags;
-   _applied_ops.clear();
+   try {
+      uint32_t next_block_num = next_block.block_num();
+      uint32_t skip = get_node_properties().skip_flags;
+      _applied_ops.clear();
+
+      _applied_trxs.clear();
+      if( metadata.trx_metadata.size() == next_block.transactions.size() )
+         _applied_trxs = metadata.trx_metadata;
+      else
+      {
+         // the block outlives its metadata, so the transactions are referenced rather than copied
+         _applied_trxs.reserve( next_block.transactions.size() );
+         for( const auto& trx : next_block.transactions )
+            _applied_trxs.push_back( transaction_metadata::reference( trx ) );
+      }
 
-   FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
+      if( !(skip & skip_merkle_check) )
+      {
+         checksum_type merkle_root;
+         if( metadata.merkle_root )
+            merkle_root = *metadata.merkle_root;
+         else
+         {
+            vector<digest_type> merkle_digests;
+            merkle_digests.reserve( next_block.transactions.size() );
+            for( size_t i = 0; i < next_block.transactions.size(); ++i )
+               merkle_digests.push_back( _applied_trxs[i]->merkle_digest( next_block.transactions[i].operation_results ) );
+            merkle_root = signed_block::calculate_merkle_root( std::move( merkle_digests ) );
+         }
+         FC_ASSERT( next_block.transaction_merkle_root == merkle_root, "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",merkle_root)("next_block",next_block)("id",next_block.id()) );
+      }
 
-   const miner_object& signing_miner = validate_block_header(skip, next_block);
-   const auto& global_props = get_global_properties();
-   const auto& dynamic_global_props = get<dynamic_global_property_object>(dynamic_global_property_id_type());
-   bool maint_needed = (dynamic_global_props.next_maintenance_time <= next_block.timestamp)  ;
+      const miner_object& signing_miner = validate_block_header(skip, next_block, metadata);
+      const auto& global_props = get_global_properties();
+      const auto& dynamic_global_props = get<dynamic_global_property_object>(dynamic_global_property_id_type());
+      bool maint_needed = (dynamic_global_props.next_maintenance_time <= next_block.timestamp)  ;
 
-   _current_block_num    = next_block_num;
-   _current_trx_in_block = 0;
+      _current_block_num    = next_block_num;
+      _current_trx_in_block = 0;
 
-   for( const auto& trx : next_block.transactions )
-   {
-      /* We do not need to push the undo state for each transaction
-       * because they either all apply and are valid or the
-       * entire block fails to apply.  We only need an "undo" state
-       * for transactions when validating broadcast transactions or
-       * when building a block.
-       */
-      apply_transaction( trx, skip | skip_transaction_signatures );
-      ++_current_trx_in_block;
-   }
+      for( const auto& trx : _applied_trxs )
+      {
+         /* We do not need to push the undo state for each transaction
+          * because they either all apply and are valid or the
+          * entire block fails to apply.  We only need an "undo" state
+          * for transactions when validating broadcast transactions or
+          * when building a block.
+          */
+         apply_transaction( *trx, skip | skip_transaction_signatures );
+         ++_current_trx_in_block;
+      }
 
-   update_global_dynamic_data(next_block);
-   update_signing_miner(signing_miner, next_block);
-   update_last_irreversible_block();
-
-   // Are we at the maintenance interval?
-   if( maint_needed )
-      perform_chain_maintenance(next_block, global_props);
-
-   create_block_summary(next_block);
-   clear_expired_transactions();
-   clear_expired_proposals();
-   update_expired_feeds();
-   update_withdraw_permissions();
-
-   // n.b., update_maintenance_flag() happens this late
-   // because get_slot_time() / get_slot_at_time() is needed above
-   // TODO:  figure out if we could collapse this function into
-   // update_global_dynamic_data() as perhaps these methods only need
-   // to be called for header validation?
-   update_maintenance_flag( maint_needed );
-   update_miner_schedule();
-   if( !_node_property_object.debug_updates.empty() )
-      apply_debug_updates();
-
-   // notify observers that the block has been applied
-   applied_block( next_block ); //emit
+      update_global_dynamic_data(next_block);
+      update_signing_miner(signing_miner, next_block);
+      update_last_irreversible_block();
+
+      // Are we at the maintenance interval?
+      if( maint_needed )
+         perform_chain_maintenance(next_block, global_props);
+
+      create_block_summary(next_block);
+      clear_expired_transactions();
+      clear_expired_proposals();
+      update_expired_feeds();
+      update_withdraw_permissions();
+
+      // n.b., update_maintenance_flag() happens this late
+      // because get_slot_time() / get_slot_at_time() is needed above
+      // TODO:  figure out if we could collapse this function into
+      // update_global_dynamic_data() as perhaps these methods only need
+      // to be called for header validation?
+      update_maintenance_flag( maint_needed );
+      update_miner_schedule();
+      if( !_node_property_object.debug_updates.empty() )
+         apply_debug_updates();
+
+      // notify observers that the block has been applied
+      applied_block( next_block ); //emit
+   } catch( ... ) {
+      // the metadata refers to the transactions of a block which may go away with the failure
+      _applied_ops.clear();
+      _applied_trxs.clear();
+      throw;
+   }
 
    _applied_ops.clear();
+   _applied_trxs.clear();
 
    notify_changed_objects();
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num()) )  }
@@ -582,6 +696,11 @@ void database::notify_changed_objects()
 } FC_CAPTURE_AND_RETHROW() }
 
 processed_transaction database::apply_transaction(const signed_transaction& trx, uint32_t skip)
+{
+   return apply_transaction( *transaction_metadata::reference( trx ), skip );
+}
+
+processed_transaction database::apply_transaction(const transaction_metadata& trx, uint32_t skip)
 {
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
@@ -592,7 +711,13 @@ processed_transaction database::apply_transaction(const signed_transaction& trx,
 }
 
 processed_transaction database::_apply_transaction(const signed_transaction& trx)
+{
+   return _apply_transaction( *transaction_metadata::reference( trx ) );
+}
+
+processed_transaction database::_apply_transaction(const transaction_metadata& trx_meta)
 { try {
+   const signed_transaction& trx = trx_meta.get_transaction();
    uint32_t skip = get_node_properties().skip_flags;
 
    if( true || !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
@@ -600,7 +725,7 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
    const chain_id_type& chain_id = get_chain_id();
-   auto trx_id = trx.id();
+   const auto& trx_id = trx_meta.id();
    FC_ASSERT( (skip & skip_transaction_dupe_check) ||
               trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end() );
    transaction_evaluation_state eval_state(this);
@@ -611,7 +736,8 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    {
       auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
       auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
-      trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
+      graphene::chain::verify_authority( trx.operations, trx_meta.signature_keys( chain_id ), get_active, get_owner,
+                                         get_global_properties().parameters.max_authority_depth );
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -660,7 +786,7 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    std::for_each(range.first, range.second, [](const account_balance_object& b) { FC_ASSERT(b.balance == 0); });
 
    return ptrx;
-} FC_CAPTURE_AND_RETHROW( (trx) ) }
+} FC_CAPTURE_AND_RETHROW( (trx_meta.get_transaction()) ) }
 
 operation_result database::apply_operation(transaction_evaluation_state& eval_state, const operation& op)
 { try {
@@ -679,14 +805,14 @@ operation_result database::apply_operation(transaction_evaluation_state& eval_st
    return result;
 } FC_CAPTURE_AND_RETHROW(  ) }
 
-const miner_object& database::validate_block_header( uint32_t skip, const signed_block& next_block )const
+const miner_object& database::validate_block_header( uint32_t skip, const signed_block& next_block, const block_metadata& metadata )const
 {
    FC_ASSERT( head_block_id() == next_block.previous, "", ("head_block_id",head_block_id())("next.prev",next_block.previous) );
    FC_ASSERT( head_block_time() < next_block.timestamp, "", ("head_block_time",head_block_time())("next",next_block.timestamp)("blocknum",next_block.block_num()) );
    const miner_object& miner = next_block.miner(*this);
 
    if( !(skip&skip_miner_signature) ) 
-      FC_ASSERT( next_block.validate_signee( miner.signing_key ) );
+      FC_ASSERT( metadata.signee ? *metadata.signee == miner.signing_key : next_block.validate_signee( miner.signing_key ) );
 
    if( !(skip&skip_miner_schedule_check) )
    {
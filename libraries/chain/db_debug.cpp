@@ -171,7 +171,12 @@ void database::debug_update( const fc::variant_object& update )
    optional<signed_block> head_block = fetch_block_by_id( head_id );
    FC_ASSERT( head_block.valid() );
 
-   // What the last block does has been changed by adding to node_property_object, so we have to re-apply it
+   // What the last block does has been changed by adding to node_property_object, so we have to re-apply it.
+   // Readers must not see the state with the block popped, the push nested in our scope does not wait for the
+   // plugins, so we do before taking it
+   if( _write_scope_depth == 0 )
+      _committed_operations.wait_for_capacity();
+   write_scope scope( *this );
    pop_block();
    push_block( *head_block );
 }
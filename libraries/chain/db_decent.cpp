@@ -32,6 +32,8 @@
 #include <graphene/chain/buying_object.hpp>
 #include <graphene/chain/subscription_object.hpp>
 
+#include <algorithm>
+
 
 namespace graphene { namespace chain {
 
@@ -45,9 +47,10 @@ void database::buying_expire(const buying_object& buying){
 }
 
 void database::content_expire(const content_object& content){
-   adjust_balance( content.author, content.publishing_fee_escrow );
-   modify<content_object>(content, [&](content_object& co){
-        co.publishing_fee_escrow.amount = 0;
+   const auto& stats = get(content.statistics);
+   adjust_balance( content.author, stats.publishing_fee_escrow );
+   modify<content_statistics_object>(stats, [&](content_statistics_object& s){
+        s.publishing_fee_escrow.amount = 0;
    });
 }
 
@@ -93,12 +96,16 @@ void database::disallow_automatic_renewal_of_subscription(const subscription_obj
 
 void database::decent_housekeeping()
 {
+   const auto now = head_block_time();
+   const auto& dgp = get_dynamic_global_properties();
+
+   // content that expired up to the previous run has returned its escrow already
    const auto& cidx = get_index_type<content_index>().indices().get<by_expiration>();
-   auto citr = cidx.begin();
-   while( citr != cidx.end() && citr->expiration <= head_block_time() )
+   auto citr = cidx.upper_bound( dgp.last_housekeeping_time );
+   while( citr != cidx.end() && citr->expiration <= now )
    {
       return_escrow_submission_operation resop;
-      resop.escrow = citr->publishing_fee_escrow;
+      resop.escrow = get(citr->statistics).publishing_fee_escrow;
 
       content_expire(*citr);
 
@@ -109,57 +116,72 @@ void database::decent_housekeeping()
       ++citr;
    }
 
-   const auto& bidx = get_index_type<buying_index>().indices().get<by_expiration_time>();
-   auto bitr = bidx.begin();
-   while( bitr != bidx.end() && bitr->expiration_time <= head_block_time() )
-   {
-      if(!bitr->delivered) {
-         buying_expire(*bitr);
+   // expiring a buying closes it, so only the open ones that expired since the last run are in the range
+   const auto& bidx = get_index_type<buying_index>().indices().get<by_open_expiration>();
+   vector<buying_id_type> expired_buyings;
+   for( auto bitr = bidx.lower_bound( true ); bitr != bidx.end() && bitr->expiration_time <= now; ++bitr )
+      expired_buyings.push_back( bitr->id );
 
-         return_escrow_buying_operation rebop;
-         rebop.escrow = bitr->price;
-         rebop.consumer = bitr->consumer;
-         rebop.buying = bitr->id;
-         push_applied_operation(rebop);
-
-      }
-      ++bitr;
+   for( const buying_id_type& id : expired_buyings )
+   {
+      const buying_object& buying = get( id );
+      buying_expire( buying );
+
+      return_escrow_buying_operation rebop;
+      rebop.escrow = buying.price;
+      rebop.consumer = buying.consumer;
+      rebop.buying = buying.id;
+      push_applied_operation(rebop);
    }
 
-   const auto& sidx = get_index_type<subscription_index>().indices().get<by_renewal>();
+   // renewing moves a subscription forward, collect the due ones first so each is renewed at most once per run
+   const auto& sidx = get_index_type<subscription_index>().indices().get<by_renewal_expiration>();
    const auto& aidx = get_index_type<account_index>().indices().get<by_id>();
-   auto sitr = sidx.begin();
-   while( sitr != sidx.end() && sitr->automatic_renewal )
+   vector<subscription_id_type> due_subscriptions;
+   for( auto sitr = sidx.lower_bound( true ); sitr != sidx.end() && sitr->automatic_renewal && sitr->expiration <= now; ++sitr )
+      due_subscriptions.push_back( sitr->id );
+
+   // the renewals are paid in the order of the subscription ids, and a run ends with the first subscription that
+   // loses its automatic renewal, the rest is renewed by the next block. Both decide which subscriptions an account
+   // short of funds keeps, so they are consensus and must stay as they were.
+   std::sort( due_subscriptions.begin(), due_subscriptions.end() );
+   for( const subscription_id_type& id : due_subscriptions )
    {
-      if(sitr->expiration <= head_block_time()) {
-         const auto &author = aidx.find(sitr->to);
-
-         try {
-            asset price = author->options.price_per_subscribe;
-            auto ao = get( price.asset_id );
-            asset dct_price;
-            //if the price is in fiat, calculate price in DCT with current exchange rate...
-            if( ao.is_monitored_asset() ){
-               auto rate = ao.monitored_asset_opts->current_feed.core_exchange_rate;
-               FC_ASSERT(!rate.is_null(), "No price feed for asset");
-               dct_price = price * rate;
-            }else{
-               dct_price = price;
-            }
-
-            if( dct_price <= get_balance( sitr->from, dct_price.asset_id ))
-               renew_subscription(*sitr, author->options.subscription_period, dct_price);
-            else
-               disallow_automatic_renewal_of_subscription(*sitr);
+      const subscription_object& subscription = get( id );
+      const auto &author = aidx.find(subscription.to);
+
+      try {
+         asset price = author->options.price_per_subscribe;
+         auto ao = get( price.asset_id );
+         asset dct_price;
+         //if the price is in fiat, calculate price in DCT with current exchange rate...
+         if( ao.is_monitored_asset() ){
+            auto rate = ao.monitored_asset_opts->current_feed.core_exchange_rate;
+            FC_ASSERT(!rate.is_null(), "No price feed for asset");
+            dct_price = price * rate;
+         }else{
+            dct_price = price;
          }
-         catch( fc::assert_exception& e ){
-            elog("Failed to automatically renew expired subscription : ${id} . ${error}",
-                 ("id", sitr->id)("error", e.to_detail_string()));
-            disallow_automatic_renewal_of_subscription(*sitr);
+
+         if( dct_price <= get_balance( subscription.from, dct_price.asset_id ))
+            renew_subscription(subscription, author->options.subscription_period, dct_price);
+         else
+         {
+            disallow_automatic_renewal_of_subscription(subscription);
+            break;
          }
       }
-      ++sitr;
+      catch( fc::assert_exception& e ){
+         elog("Failed to automatically renew expired subscription : ${id} . ${error}",
+              ("id", subscription.id)("error", e.to_detail_string()));
+         disallow_automatic_renewal_of_subscription(subscription);
+         break;
+      }
    }
+
+   modify( dgp, [&]( dynamic_global_property_object& _dgp ) {
+      _dgp.last_housekeeping_time = now;
+   });
 }
 
 bool database::is_reward_switch_time() const
@@ -271,11 +293,11 @@ real_supply database::get_real_supply()const
       ++vbitr;
    }
 
-   const auto& cidx = get_index_type<content_index>().indices().get<by_id>();
-   auto citr = cidx.begin();
-   while( citr != cidx.end() ){
-      total.escrows += citr->publishing_fee_escrow.amount;
-      ++citr;
+   const auto& csidx = get_index_type<content_statistics_index>().indices().get<by_id>();
+   auto csitr = csidx.begin();
+   while( csitr != csidx.end() ){
+      total.escrows += csitr->publishing_fee_escrow.amount;
+      ++csitr;
    }
 
    const auto& bidx = get_index_type<buying_index>().indices().get<by_id>();
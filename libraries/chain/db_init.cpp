@@ -43,6 +43,8 @@
 #include <graphene/chain/miner_schedule_object.hpp>
 #include <graphene/chain/transaction_detail_object.hpp>
 
+#include <graphene/db/dense_index.hpp>
+
 #include <graphene/chain/account_evaluator.hpp>
 #include <graphene/chain/asset_evaluator.hpp>
 #include <graphene/chain/assert_evaluator.hpp>
@@ -155,7 +157,7 @@ void database::initialize_indexes()
    //Protocol object indexes
    add_index< primary_index<asset_index> >();
 
-   auto acnt_index = add_index< primary_index<account_index> >();
+   auto acnt_index = add_index< primary_index< dense_index<account_index> > >();
    acnt_index->add_secondary_index<account_member_index>();
 
    add_index< primary_index<miner_index> >();
@@ -168,7 +170,7 @@ void database::initialize_indexes()
 
    //Implementation object indexes
    add_index< primary_index<transaction_index                             > >();
-   add_index< primary_index<account_balance_index                         > >();
+   add_index< primary_index< dense_index<account_balance_index>          > >();
    add_index< primary_index<simple_index<global_property_object          >> >();
    add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
    add_index< primary_index<simple_index<account_statistics_object       >> >();
@@ -179,8 +181,11 @@ void database::initialize_indexes()
    add_index< primary_index<simple_index<budget_record_object           > > >();
    add_index< primary_index< seeder_index                                 > >();
    add_index< primary_index< rating_index                                 > >();
-   add_index< primary_index< content_index                                > >();
-   add_index< primary_index< buying_index                                 > >();
+   auto content_idx = add_index< primary_index< dense_index<content_index> > >();
+   content_idx->add_secondary_index<content_price_index>();
+   add_index< primary_index< dense_index<content_statistics_index>       > >();
+   add_index< primary_index< content_proof_index                          > >();
+   add_index< primary_index< dense_index<buying_index>                   > >();
    add_index< primary_index< subscription_index                                 > >();
    add_index< primary_index< transaction_detail_index                     > >();
    add_index< primary_index< seeding_statistics_index                     > >();
@@ -37,6 +37,7 @@
 namespace graphene { namespace chain {
 
 database::database()
+   : _committed_operations( *this )
 {
    initialize_indexes();
    initialize_evaluators();
@@ -44,6 +45,7 @@ database::database()
 
 database::~database()
 {
+   _committed_operations.close();
    clear_pending();
 }
 
@@ -88,6 +90,10 @@ void database::reindex(fc::path data_dir, const genesis_state_type& initial_allo
          wlog( "Dropped ${n} blocks from after the gap", ("n", dropped_count) );
          break;
       }
+      // replayed blocks change the state like pushed ones, see push_block
+      if( _write_scope_depth == 0 )
+         _committed_operations.wait_for_capacity();
+      write_scope scope( *this );
       apply_block(*block, skip_miner_signature |
                           skip_transaction_signatures |
                           skip_transaction_dupe_check |
@@ -116,6 +122,7 @@ void database::open(
 {
    try
    {
+      write_scope scope( *this );
       object_database::open(data_dir );
 
       _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
@@ -144,6 +151,10 @@ void database::open(
 
 void database::close(bool rewind)
 {
+   // let the plugins finish the operations they were given before the state goes away
+   _committed_operations.flush();
+   // API calls still served from other threads must not read the state while it is popped and closed
+   write_scope scope( *this );
    // TODO:  Save pending tx's on close()
    clear_pending();
    // pop all of the blocks that we can given our undo history, this should
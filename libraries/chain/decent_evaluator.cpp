@@ -295,7 +295,6 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
                                         co.size = o.size;
                                         co.synopsis = o.synopsis;
                                         co.URI = o.URI;
-                                        co.publishing_fee_escrow = o.publishing_fee;
                                         auto itr1 = o.seeders.begin();
                                         auto itr2 = o.key_parts.begin();
                                         while ( itr1 != o.seeders.end() && itr2 != o.key_parts.end() )
@@ -309,9 +308,10 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
                                         co.quorum = o.quorum;
                                         co.expiration = o.expiration;
                                         co.created = db().head_block_time();
-                                        co.times_bought = 0;
-                                        co.AVG_rating = 0;
-                                        co.num_of_ratings = 0;
+                                        co.statistics = db().create<content_statistics_object>([&](content_statistics_object& s) {
+                                           s.content = co.id;
+                                           s.publishing_fee_escrow = o.publishing_fee;
+                                        }).id;
                                      });
 
          db().adjust_balance(o.author,-o.publishing_fee);  //pay the escrow from author's account
@@ -426,14 +426,14 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
                                                          bo.paid_price = price;
 
                                                          {
-                                                            const auto& idx = db().get_index_type<content_index>().indices().get<by_URI>();
-                                                            auto itr = idx.find(o.URI);
-                                                            if (itr != idx.end())
+                                                            const content_object* content = find_content(db(), o.URI);
+                                                            if (content != nullptr)
                                                             {
-                                                               bo.synopsis = itr->synopsis;
-                                                               bo.size = itr->size;
-                                                               bo.created = itr->created;
-                                                               bo.average_rating = itr->AVG_rating;
+                                                               bo.content = content->get_id();
+                                                               bo.synopsis = content->synopsis;
+                                                               bo.size = content->size;
+                                                               bo.created = content->created;
+                                                               bo.average_rating = db().get(content->statistics).AVG_rating;
                                                             }
                                                          }
                                                          bo.region_code_from = o.region_code_from;
@@ -464,10 +464,8 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
    void_result deliver_keys_evaluator::do_evaluate(const deliver_keys_operation& o )
    {try{
       const auto& buying = db().get<buying_object>(o.buying);
-      auto& idx = db().get_index_type<content_index>().indices().get<by_URI>();
-
-      const auto& content = idx.find( buying.URI );
-      FC_ASSERT( content != idx.end() );
+      const content_object* content = db().find(buying.content);
+      FC_ASSERT( content != nullptr );
 
       auto& sidx = db().get_index_type<seeder_index>().indices().get<by_seeder>();
       const auto& seeder = sidx.find(o.seeder);
@@ -486,8 +484,7 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
       //start with getting the buying and content objects...
       const auto& buying = db().get<buying_object>(o.buying);
       bool expired = ( buying.expiration_time < db().head_block_time() );
-      auto& idx = db().get_index_type<content_index>().indices().get<by_URI>();
-      const auto& content = idx.find( buying.URI );
+      const content_object* content = &buying.content(db());
       bool delivered;
       // if the response (key particle) has not been seen before, note it
       if( std::find(buying.seeders_answered.begin(), buying.seeders_answered.end(), o.seeder) == buying.seeders_answered.end() )
@@ -503,7 +500,7 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
       if( delivered )
       {
          asset price = buying.price;
-         db().modify<content_object>( *content, []( content_object& co ){ co.times_bought++; });
+         db().modify<content_statistics_object>( db().get(content->statistics), []( content_statistics_object& s ){ s.times_bought++; });
 
          if( content->co_authors.empty() )
             db().adjust_balance( content->author, price.amount );
@@ -546,11 +543,11 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
    void_result leave_rating_evaluator::do_evaluate(const leave_rating_and_comment_operation& o )
    {try{
       //check in buying history if the object exists
-      auto& idx = db().get_index_type<content_index>().indices().get<by_URI>();
-      const auto& content = idx.find( o.URI );
-      auto& bidx = db().get_index_type<buying_index>().indices().get<by_consumer_URI>();
-      const auto& bo = bidx.find( std::make_tuple(o.consumer, o.URI) );
-      FC_ASSERT( content != idx.end() && bo != bidx.end() );
+      const content_object* content = find_content( db(), o.URI );
+      FC_ASSERT( content != nullptr );
+      auto& bidx = db().get_index_type<buying_index>().indices().get<by_consumer_content>();
+      const auto& bo = bidx.find( std::make_tuple(o.consumer, content->get_id()) );
+      FC_ASSERT( bo != bidx.end() );
       FC_ASSERT( bo->delivered, "not delivered" );
       FC_ASSERT( !bo->rated_or_commented, "already rated or commented" );
    }FC_CAPTURE_AND_RETHROW( (o) ) }
@@ -558,14 +555,14 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
    void_result leave_rating_evaluator::do_apply(const leave_rating_and_comment_operation& o )
    {try{
       //create rating object and adjust content statistics
-      auto& bidx = db().get_index_type<buying_index>().indices().get<by_consumer_URI>();
-      const auto& bo = bidx.find( std::make_tuple(o.consumer, o.URI) );
-      auto& idx = db().get_index_type<content_index>().indices().get<by_URI>();
-      const auto& content = idx.find( o.URI );
+      const content_object* content = find_content( db(), o.URI );
+      auto& bidx = db().get_index_type<buying_index>().indices().get<by_consumer_content>();
+      const auto& bo = bidx.find( std::make_tuple(o.consumer, content->get_id()) );
 
       db().create<rating_object>([&]( rating_object& ro ){
            ro.buying = bo->id;
            ro.consumer = o.consumer;
+           ro.content = content->get_id();
            ro.URI = o.URI;
            ro.rating = o.rating;
            ro.comment = o.comment;
@@ -576,16 +573,16 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
            b.rating = o.rating;
       });
 
-      db().modify<content_object> ( *content, [&](content_object& co){
+      db().modify<content_statistics_object> ( db().get(content->statistics), [&](content_statistics_object& s){
 
-           if(co.num_of_ratings == 0) {
-              co.AVG_rating = o.rating * 1000;
-              co.num_of_ratings++;
+           if(s.num_of_ratings == 0) {
+              s.AVG_rating = o.rating * 1000;
+              s.num_of_ratings++;
            }
            else {
-              //co.AVG_rating = (co.AVG_rating * co.num_of_ratings + o.rating * 1000) / (++co.num_of_ratings); different result between ms compiler and clang, Bug - 35
-              co.AVG_rating = (co.AVG_rating * co.num_of_ratings + o.rating * 1000) / (co.num_of_ratings + 1);
-              co.num_of_ratings++;
+              //s.AVG_rating = (s.AVG_rating * s.num_of_ratings + o.rating * 1000) / (++s.num_of_ratings); different result between ms compiler and clang, Bug - 35
+              s.AVG_rating = (s.AVG_rating * s.num_of_ratings + o.rating * 1000) / (s.num_of_ratings + 1);
+              s.num_of_ratings++;
            }
       });
 
@@ -679,19 +676,22 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
       FC_ASSERT(sitr!=sidx.end(), "seeder not found");
       const seeder_object& seeder = *sitr;
 
-      auto last_proof = content->last_proof.find( o.seeder );
-      if( last_proof == content->last_proof.end() ) //initial PoR
+      const auto& pidx = db().get_index_type<content_proof_index>().indices().get<by_content_seeder>();
+      auto last_proof = pidx.find( std::make_tuple( content->get_id(), o.seeder ) );
+      if( last_proof == pidx.end() ) //initial PoR
       {
          //the initial proof, no payments yet
-         db().modify<content_object>(*content, [&](content_object& co){
-              co.last_proof.emplace(std::make_pair(o.seeder, db().head_block_time()));
+         db().create<content_proof_object>([&](content_proof_object& cp){
+              cp.content = content->get_id();
+              cp.seeder = o.seeder;
+              cp.last_proof = db().head_block_time();
          });
       }else{
          //recurrent PoR, calculate payment
          //the PoR shall be ideally broadcasted once per 24h. if the seeder pushes them too often, he is penalized by a
          // loss factor equal to one forth of the time remaining to 24h. E.g. by pushing it in 12h he is penalized by
          // loss = (12/24)/4 = 12,5%; if it is pushed in 18h (i.e. 6 hours prematurely) the loss = (6/24)/4=6,25%.
-         fc::microseconds diff = db().head_block_time() - last_proof->second;
+         fc::microseconds diff = db().head_block_time() - last_proof->last_proof;
          if( diff > fc::days( 1 ) )
             diff = fc::days( 1 ) ;
          uint64_t ratio = 10000 * diff.count() / fc::days( 1 ).count();
@@ -699,9 +699,11 @@ void_result set_publishing_right_evaluator::do_evaluate( const set_publishing_ri
          uint64_t total_reward_ratio = ( ratio * ( 10000 - loss ) ) / 10000;
          asset reward ( seeder.price.amount * total_reward_ratio * content->size / 10000 );
          //take care of the payment
-         db().modify<content_object>( *content, [&] (content_object& co ){
-              co.last_proof[o.seeder] = db().head_block_time();
-              co.publishing_fee_escrow -= reward;
+         db().modify<content_proof_object>( *last_proof, [&] (content_proof_object& cp ){
+              cp.last_proof = db().head_block_time();
+         });
+         db().modify<content_statistics_object>( db().get(content->statistics), [&] (content_statistics_object& s ){
+              s.publishing_fee_escrow -= reward;
          });
          db().adjust_balance(seeder.seeder, reward );
          pay_seeder_operation op;
@@ -23,19 +23,50 @@
  */
 #pragma once
 #include <fstream>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <graphene/chain/protocol/block.hpp>
 
 namespace graphene { namespace chain {
+   struct index_entry;
+
+   /**
+    * Block log on disk, written behind the callers.
+    *
+    * store() and remove() only queue the change in an in-memory journal, a dedicated I/O thread
+    * applies the journal to the files in the order the changes were made.  All reads see the queued
+    * changes, so callers can not tell the difference.  sync() waits until everything up to a given
+    * block number has been synced to the disk, the database calls it for the last irreversible block.
+    *
+    * Block data is written before its index entry, so a process killed in the middle of a write leaves
+    * at most a torn entry at the end of the log; open() drops such entries.
+    *
+    * A batch that fails to be written stays in the journal, readable as before, and the I/O thread
+    * writes it again a second later.  The failure surfaces in one place only: sync() and flush() throw
+    * while the changes they wait for are not written.
+    */
    class block_database 
    {
       public:
+         ~block_database();
+
          void open( const fc::path& dbdir );
          bool is_open()const;
+         /** waits until the journal is empty and flushes the files, throws if the journal could not be written */
          void flush();
          void close();
 
          void store( const block_id_type& id, const signed_block& b );
          void remove( const block_id_type& id );
+         /**
+          * waits until all changes of blocks up to block_num queued so far are written and synced to the disk,
+          * throws if writing them failed, they are written again later
+          */
+         void sync( uint32_t block_num );
 
          bool                   contains( const block_id_type& id )const;
          block_id_type          fetch_block_id( uint32_t block_num )const;
@@ -44,7 +75,48 @@ namespace graphene { namespace chain {
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
       private:
-         mutable std::fstream _blocks;
-         mutable std::fstream _block_num_to_pos;
+         struct journal_entry
+         {
+            uint64_t                             seq = 0;
+            block_id_type                        id;
+            /// null for a removal
+            std::shared_ptr<const signed_block>  block;
+         };
+
+         void queue( const block_id_type& id, std::shared_ptr<const signed_block> block );
+         void write_journal();
+         /** returns once the change seq is written, or once writing it failed */
+         void wait_written( uint64_t seq );
+         void check_written( uint64_t seq )const;
+         void repair();
+
+         /** the queued state of block_num, if a change of it was not written yet */
+         optional<journal_entry> find_unwritten( uint32_t block_num )const;
+
+         void disk_store( const block_id_type& id, const signed_block& b );
+         void disk_remove( const block_id_type& id );
+         bool disk_read_entry( uint32_t block_num, index_entry& e )const;
+         optional<signed_block> disk_read_block( const index_entry& e )const;
+         /** last entry with a block, skipping entries overridden by the journal */
+         optional<index_entry> disk_last( const std::map<uint32_t, journal_entry>& overrides )const;
+
+         fc::path                            _dbdir;
+         mutable std::fstream                _blocks;
+         mutable std::fstream                _block_num_to_pos;
+         /// descriptors of the same files, to sync them to the disk
+         int                                 _blocks_fd = -1;
+         int                                 _block_num_to_pos_fd = -1;
+         mutable std::mutex                  _file_mutex;
+
+         mutable std::mutex                  _journal_mutex;
+         std::condition_variable             _journal_cv;
+         std::condition_variable             _written_cv;
+         std::deque<journal_entry>           _journal;
+         std::map<uint32_t, journal_entry>   _unwritten;
+         uint64_t                            _queued_seq = 0;
+         uint64_t                            _written_seq = 0;
+         optional<fc::exception>             _io_error;
+         bool                                _stopping = false;
+         std::thread                         _io_thread;
    };
 } }
@@ -24,10 +24,11 @@ using decent::encrypt::DInteger;
       static const uint8_t type_id  = impl_buying_object_type;
 
       account_id_type consumer;
+      content_id_type content;   //< the content published under URI, the indices refer to the content by this ID
       string URI;
       uint64_t size = uint64_t(-1); //< initialized by content.size
       uint64_t rating = uint64_t(-1);  //< this is the user rating
-      uint64_t average_rating = uint64_t(-1);   //< initialized by content_object.AVG_rating
+      uint64_t average_rating = uint64_t(-1);   //< initialized by content_statistics_object.AVG_rating
       asset price;  //< this is an escrow, initialized by request_to_buy_operation.price then reset to 0 for escrow system and inflation calculations
       asset paid_price; //< initialized by request_to_buy_operation.price
       std::string synopsis;   //< initialized by content.synopsis
@@ -51,11 +52,11 @@ using decent::encrypt::DInteger;
    };
 
 
-   struct by_URI_consumer;
-   struct by_consumer_URI;
+   struct by_content_consumer;
+   struct by_consumer_content;
    struct by_expiration_time;
    struct by_consumer_time;
-   struct by_URI_open;
+   struct by_content_open;
    struct by_open_expiration;
    struct by_consumer_open;
    struct by_size;
@@ -117,16 +118,16 @@ using decent::encrypt::DInteger;
             ordered_unique< tag<by_id>,
                member< object, object_id_type, &object::id >
             >,
-            ordered_unique< tag< by_URI_consumer>,
+            ordered_unique< tag< by_content_consumer>,
                composite_key< buying_object,
-                  member<buying_object, string, &buying_object::URI>,
+                  member<buying_object, content_id_type, &buying_object::content>,
                   member<buying_object, account_id_type, &buying_object::consumer>
                >
             >,
-            ordered_unique< tag< by_consumer_URI>,
+            ordered_unique< tag< by_consumer_content>,
                composite_key< buying_object,
                   member<buying_object, account_id_type, &buying_object::consumer>,
-                  member<buying_object, string, &buying_object::URI>
+                  member<buying_object, content_id_type, &buying_object::content>
                >
             >,
             ordered_non_unique<tag<by_expiration_time>,
@@ -138,9 +139,9 @@ using decent::encrypt::DInteger;
                   member<buying_object, time_point_sec, &buying_object::expiration_or_delivery_time>
                >
             >,
-            ordered_non_unique< tag< by_URI_open>,
+            ordered_non_unique< tag< by_content_open>,
                composite_key< buying_object,
-                  member<buying_object, string, &buying_object::URI>,
+                  member<buying_object, content_id_type, &buying_object::content>,
                   const_mem_fun<buying_object, bool, &buying_object::is_open>
                >
             >,
@@ -178,5 +179,5 @@ using decent::encrypt::DInteger;
 
 FC_REFLECT_DERIVED(graphene::chain::buying_object,
                    (graphene::db::object),
-                   (consumer)(URI)(synopsis)(price)(paid_price)(seeders_answered)(size)(rating)(average_rating)(expiration_time)(pubKey)(key_particles)
+                   (consumer)(content)(URI)(synopsis)(price)(paid_price)(seeders_answered)(size)(rating)(average_rating)(expiration_time)(pubKey)(key_particles)
                    (expired)(delivered)(expiration_or_delivery_time)(rated_or_commented)(created)(expiration)(region_code_from) )
@@ -0,0 +1,143 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#pragma once
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fc { class thread; }
+
+namespace graphene { namespace chain {
+   class database;
+   class committed_operation_bus;
+
+   struct committed_operation_queue_stats
+   {
+      string   name;
+      uint32_t capacity = 0;
+      /// operations waiting for the handler
+      uint32_t pending = 0;
+      uint32_t max_pending = 0;
+      uint64_t processed = 0;
+      /// operations whose handler threw
+      uint64_t failed = 0;
+      uint32_t last_published_block = 0;
+      uint32_t last_processed_block = 0;
+      /// number of blocks the handler is behind the chain
+      uint32_t lag_blocks = 0;
+      /// how many times, and for how long, block application waited for this queue
+      uint64_t stalls = 0;
+      uint64_t stall_time_us = 0;
+   };
+
+   /**
+    * @brief Queue of committed operations handled on a thread of its own, see committed_operation_bus
+    */
+   class committed_operation_queue
+   {
+      public:
+         typedef std::function<void(const operation_history_object&, bool sync_mode)> handler_type;
+
+         const string& name()const { return _name; }
+
+      private:
+         friend class committed_operation_bus;
+
+         struct entry
+         {
+            operation_history_object op;
+            bool                     sync_mode;
+         };
+
+         committed_operation_queue( const string& name, handler_type handler, uint32_t capacity )
+            : _name(name), _handler(std::move(handler)), _capacity(capacity) {}
+
+         string                           _name;
+         handler_type                     _handler;
+         uint32_t                         _capacity;
+         std::deque<entry>                _entries;
+         bool                             _busy = false;
+         bool                             _stopping = false;
+         std::condition_variable          _cv;
+         committed_operation_queue_stats  _stats;
+         std::thread                      _thread;
+   };
+
+   /**
+    * @brief Delivers the operations of committed blocks to plugins on their own threads
+    *
+    * Every subscriber gets a queue and a thread which calls its handler for each operation, with the block
+    * number and the position in the block set, in the order the blocks were applied.  The chain thread only
+    * copies the operations into the queues.  A queue may grow past its capacity while a block is published,
+    * the next block is not applied before every queue is back below its capacity.
+    *
+    * Handlers must not change the object database from their thread.  They hand such work to
+    * run_on_chain_thread() and may wait for the returned future; plugin objects should be changed through
+    * database::apply_plugin_changes() there, passing the block number of the operation so the changes are
+    * undone with its block.  Reads can be done holding database::state_mutex() shared.
+    */
+   class committed_operation_bus
+   {
+      public:
+         typedef committed_operation_queue::handler_type handler_type;
+         static const uint32_t default_capacity = 1024;
+
+         explicit committed_operation_bus( database& db );
+         ~committed_operation_bus();
+
+         std::shared_ptr<committed_operation_queue> subscribe( const string& name, handler_type handler,
+                                                               uint32_t capacity = default_capacity );
+         /** stops the thread of the queue, operations not handled yet are dropped */
+         void unsubscribe( const std::shared_ptr<committed_operation_queue>& queue );
+
+         /** queues an operation of a committed block for every subscriber, never blocks */
+         void publish( const operation_history_object& op, bool sync_mode );
+         /** drops the queued operations of block_num and the later blocks, which have been popped */
+         void discard_from( uint32_t block_num );
+         /** blocks the chain thread until every queue is below its capacity, running chain tasks meanwhile */
+         void wait_for_capacity();
+         /** blocks the chain thread until every queue is empty, running chain tasks meanwhile */
+         void flush();
+
+         /**
+          * Queues a task for the chain thread, it runs holding the database write lock.  Must not be waited for
+          * from the chain thread itself.
+          */
+         std::future<void> run_on_chain_thread( std::function<void()> task );
+         /** runs the chain tasks queued so far, must be called on the chain thread */
+         void run_chain_tasks();
+
+         std::vector<committed_operation_queue_stats> get_stats()const;
+
+         /** stops all queues, drops their pending operations and the pending chain tasks */
+         void close();
+
+      private:
+         void consume( committed_operation_queue& queue );
+         template<typename Predicate>
+         void wait_on_chain_thread( std::unique_lock<std::mutex>& lock, Predicate done );
+         void stop_queue( std::unique_lock<std::mutex>& lock, committed_operation_queue& queue );
+
+         database&                                                  _db;
+         fc::thread*                                                _chain_thread;
+         mutable std::mutex                                         _mutex;
+         std::condition_variable                                    _chain_cv;
+         std::vector<std::shared_ptr<committed_operation_queue> >   _queues;
+         std::deque<std::function<void()> >                         _chain_tasks;
+         /// expires with the bus, chain tasks posted to the chain thread check it before running
+         std::shared_ptr<bool>                                      _alive;
+         bool                                                       _closed = false;
+   };
+
+} }
+
+FC_REFLECT( graphene::chain::committed_operation_queue_stats,
+            (name)(capacity)(pending)(max_pending)(processed)(failed)(last_published_block)
+            (last_processed_block)(lag_blocks)(stalls)(stall_time_us) )
@@ -11,7 +11,12 @@
 #include <fc/reflect/reflect.hpp>
 #include <fc/io/json.hpp>
 
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+
 #include <stdint.h>
+#include <set>
+#include <tuple>
 #include <vector>
 #include <utility>
 
@@ -401,6 +406,8 @@ using namespace decent::encrypt;
       string m_str_synopsis;
    };
 
+   class database;
+
    struct content_summary
    {
       string id;
@@ -416,8 +423,8 @@ using namespace decent::encrypt;
       time_point_sec created;
       uint32_t times_bought = 0;
 
-      content_summary& set( const content_object& co, const account_object& ao, uint32_t region_code );
-      content_summary& set( const content_object& co, const account_object& ao, string const& region_code );
+      content_summary& set( const database& db, const content_object& co, const account_object& ao, uint32_t region_code );
+      content_summary& set( const database& db, const content_object& co, const account_object& ao, string const& region_code );
    };
 
    struct content_keys {
@@ -445,50 +452,66 @@ using namespace decent::encrypt;
       uint32_t quorum;
       string URI;
       map<account_id_type, CiphertextString> key_parts;
-      map<account_id_type, time_point_sec> last_proof;
       bool is_blocked = false;
 
       fc::ripemd160 _hash;
+      fc::optional<decent::encrypt::CustodyData> cd;
+
+      /// The fields changed by purchases, ratings and proofs of retrievability are kept in a separate object, so
+      /// those operations do not copy the content metadata. This field contains the ID of that object.
+      content_statistics_id_type statistics;
+
+      content_id_type get_id()const { return id; }
+   };
+
+   /**
+    * @class content_statistics_object
+    * @brief Tracks the frequently changing data of a content
+    */
+   class content_statistics_object : public graphene::db::abstract_object<content_statistics_object>
+   {
+   public:
+      static const uint8_t space_id = implementation_ids;
+      static const uint8_t type_id  = impl_content_statistics_object_type;
+
+      content_id_type content;
+
       uint64_t AVG_rating = 0;
       uint32_t num_of_ratings = 0;
       uint32_t times_bought = 0;
       asset publishing_fee_escrow;
-      fc::optional<decent::encrypt::CustodyData> cd;
-
-      template <RegionCodes::RegionCode code>
-      share_type get_price_amount_template() const
-      {
-         // this function is used only by db index
-         // later will avoid using index for prices
-         // but anyway, make sure the index will not throw
-         // for regions not having a price
-         // use fallback to any other region price that is defined
-         // (at least one price will be defined)
-         // corresponding code that uses the index "by_price" will check
-         // for such wrongly placed content items and skip those
-         optional<asset> region_price = price.GetPrice(code);
-         if (false == region_price.valid())
-         {
-            FC_ASSERT(false == price.map_price.empty());
-            auto it_any_price = price.map_price.begin();
-            region_price = it_any_price->second;
-         }
+   };
 
-         return region_price->amount;
-      }
+   /**
+    * @class content_proof_object
+    * @brief Time of the last proof of retrievability of a content by one of its seeders
+    */
+   class content_proof_object : public graphene::db::abstract_object<content_proof_object>
+   {
+   public:
+      static const uint8_t space_id = implementation_ids;
+      static const uint8_t type_id  = impl_content_proof_object_type;
 
-      bool recent_proof( uint64_t validity_seconds ) const {
-         auto  now = fc::time_point::now();
-         for( auto i: last_proof ){
-            if( i.second > now - fc::seconds(validity_seconds) )
-               return true;
-         }
-         return false;
-      }
+      content_id_type content;
+      account_id_type seeder;
+      time_point_sec last_proof;
    };
+
+   /// True if any seeder of the content proved it within the validity period
+   bool recent_proof( const database& db, const content_object& content, uint64_t validity_seconds );
+   /// Number of seeders which proved the content at least once
+   uint32_t proven_seeders( const database& db, const content_object& content );
+   /// The content published under the URI, nullptr if there is none. Objects referring to a content keep its ID,
+   /// URIs are resolved only where they enter from operations and API calls.
+   const content_object* find_content( const database& db, const string& URI );
+
+   /// Estimates the heap owned by the strings and maps of a content, key_parts grow with the seeders
+   uint64_t dynamic_memory_usage( const content_object& content );
    
    struct by_author;
    struct by_URI;
+   struct by_content;
+   struct by_content_seeder;
    struct by_AVG_rating;
    struct by_size;
    struct by_price;
@@ -518,9 +541,9 @@ using namespace decent::encrypt;
    };
 
    template <>
-   struct key_extractor<by_AVG_rating, content_object>
+   struct key_extractor<by_AVG_rating, content_statistics_object>
    {
-      static uint64_t get(content_object const& ob)
+      static uint64_t get(content_statistics_object const& ob)
       {
          return ob.AVG_rating;
       }
@@ -535,15 +558,6 @@ using namespace decent::encrypt;
       }
    };
 
-   template <>
-   struct key_extractor<by_price, content_object>
-   {
-      static share_type get(content_object const& ob)
-      {
-         return ob.get_price_amount_template<RegionCodes::OO_none>();
-      }
-   };
-
    template <>
    struct key_extractor<by_expiration, content_object>
    {
@@ -573,23 +587,13 @@ using namespace decent::encrypt;
             ordered_non_unique<tag<by_author>,
                member<content_object, account_id_type, &content_object::author>
             >,
-            ordered_unique<tag<by_URI>,
+            hashed_unique<tag<by_URI>,
                member<content_object, string, &content_object::URI>
             >,
-            ordered_non_unique<tag<by_price>,
-            const_mem_fun<content_object, share_type, &content_object::get_price_amount_template<RegionCodes::OO_none>>
-            >,
             ordered_non_unique<tag<by_size>,
                member<content_object, uint64_t, &content_object::size>
             >,
-            ordered_non_unique<tag<by_AVG_rating>,
-               member<content_object, uint64_t, &content_object::AVG_rating>
-            >,
-            ordered_non_unique<tag<by_times_bought>,
-               member<content_object, uint32_t, &content_object::times_bought>,
-               std::greater<uint32_t>
-            >,
-   
+
             ordered_non_unique<tag<by_expiration>,
                member<content_object, time_point_sec, &content_object::expiration>
             >,
@@ -603,14 +607,87 @@ using namespace decent::encrypt;
    
    
    typedef generic_index< content_object, content_object_multi_index_type > content_index;
+
+   /**
+    *  @brief orders the contents by their price in every region
+    *
+    *  This is a secondary index on the content_index. A content has an entry for each region where it can be bought,
+    *  with the price PriceRegions::GetPrice returns for that region, so a price ordered search of one region is a
+    *  range of this index.
+    */
+   class content_price_index : public secondary_index
+   {
+      public:
+         /// region code, price amount, content
+         typedef std::tuple<uint32_t, share_type, content_id_type> key_type;
+
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after ) override;
+         virtual uint64_t memory_usage()const override;
+
+         /// entries of the region, ordered by price
+         std::pair<std::set<key_type>::const_iterator, std::set<key_type>::const_iterator> region_range( uint32_t region_code )const;
+
+         std::set<key_type> _region_price_to_content;
+
+      private:
+         static std::vector<key_type> get_keys( const content_object& content );
+   };
+
+   typedef multi_index_container<
+      content_statistics_object,
+         indexed_by<
+            ordered_unique< tag<by_id>,
+               member< object, object_id_type, &object::id >
+            >,
+            ordered_unique< tag<by_content>,
+               member<content_statistics_object, content_id_type, &content_statistics_object::content>
+            >,
+            ordered_non_unique<tag<by_AVG_rating>,
+               member<content_statistics_object, uint64_t, &content_statistics_object::AVG_rating>
+            >,
+            ordered_non_unique<tag<by_times_bought>,
+               member<content_statistics_object, uint32_t, &content_statistics_object::times_bought>,
+               std::greater<uint32_t>
+            >
+         >
+   > content_statistics_object_multi_index_type;
+
+   typedef generic_index< content_statistics_object, content_statistics_object_multi_index_type > content_statistics_index;
+
+   typedef multi_index_container<
+      content_proof_object,
+         indexed_by<
+            ordered_unique< tag<by_id>,
+               member< object, object_id_type, &object::id >
+            >,
+            ordered_unique< tag<by_content_seeder>,
+               composite_key< content_proof_object,
+                  member<content_proof_object, content_id_type, &content_proof_object::content>,
+                  member<content_proof_object, account_id_type, &content_proof_object::seeder>
+               >
+            >
+         >
+   > content_proof_object_multi_index_type;
+
+   typedef generic_index< content_proof_object, content_proof_object_multi_index_type > content_proof_index;
    
 }}
 
 FC_REFLECT_DERIVED(graphene::chain::content_object,
                    (graphene::db::object),
                    (author)(co_authors)(expiration)(created)(price)(size)(synopsis)
-                   (URI)(quorum)(key_parts)(_hash)(last_proof)(is_blocked)
-                   (AVG_rating)(num_of_ratings)(times_bought)(publishing_fee_escrow)(cd) )
+                   (URI)(quorum)(key_parts)(_hash)(is_blocked)(cd)(statistics) )
+
+FC_REFLECT_DERIVED(graphene::chain::content_statistics_object,
+                   (graphene::db::object),
+                   (content)(AVG_rating)(num_of_ratings)(times_bought)(publishing_fee_escrow) )
+
+FC_REFLECT_DERIVED(graphene::chain::content_proof_object,
+                   (graphene::db::object),
+                   (content)(seeder)(last_proof) )
 
 FC_REFLECT( graphene::chain::content_summary, (id)(author)(price)(synopsis)(status)(URI)(_hash)(AVG_rating)(size)(expiration)(created)(times_bought) )
 FC_REFLECT( graphene::chain::PriceRegions, (map_price) )
@@ -29,6 +29,7 @@
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/fork_database.hpp>
 #include <graphene/chain/block_database.hpp>
+#include <graphene/chain/committed_operation_bus.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
 
@@ -38,9 +39,12 @@
 #include <fc/signals.hpp>
 
 #include <graphene/chain/protocol/protocol.hpp>
+#include <graphene/chain/protocol/transaction_metadata.hpp>
 
 #include <fc/log/logger.hpp>
 
+#include <boost/thread/shared_mutex.hpp>
+
 #include <map>
 
 namespace graphene { namespace chain {
@@ -114,6 +118,33 @@ namespace graphene { namespace chain {
          void wipe(const fc::path& data_dir, bool include_blocks);
          void close(bool rewind = true);
 
+         /**
+          * @brief Holds the state mutex exclusively while the chain thread changes the object database
+          *
+          * API calls that read the database from other threads hold the mutex shared, so they never observe
+          * a half-applied block or transaction.  Entry points nest (generate_block pushes the block it has
+          * just built), and all of them run on the chain thread, so only the outermost scope locks.
+          */
+         class write_scope
+         {
+            public:
+               explicit write_scope( database& db ) : _db(db)
+               {
+                  if( _db._write_scope_depth++ == 0 )
+                     _db._state_mutex.lock();
+               }
+               ~write_scope()
+               {
+                  if( --_db._write_scope_depth == 0 )
+                     _db._state_mutex.unlock();
+               }
+            private:
+               database& _db;
+         };
+
+         /// Mutex to hold shared while reading the object database from a thread other than the chain thread
+         boost::shared_mutex& state_mutex()const { return _state_mutex; }
+
          //////////////////// db_block.cpp ////////////////////
 
          /**
@@ -139,10 +170,15 @@ namespace graphene { namespace chain {
          bool before_last_checkpoint()const;
 
          bool push_block(const signed_block &b, uint32_t skip = skip_nothing, bool sync_mode = false );
+         /** pushes a block whose transactions may already be hashed, @p metadata must be computed from @p b */
+         bool push_block(const signed_block &b, const block_metadata& metadata, uint32_t skip = skip_nothing, bool sync_mode = false );
          //bool ( const signed_block& b, uint32_t skip = skip_nothing );
          processed_transaction push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
-         bool _push_block(const signed_block &b, bool sync_mode = false );
+         /** pushes a transaction whose id and signature keys may already be known, they are cached in @p trx */
+         processed_transaction push_transaction( const transaction_metadata_ptr& trx, uint32_t skip = skip_nothing );
+         bool _push_block(const signed_block &b, bool sync_mode = false, const block_metadata& metadata = block_metadata() );
          processed_transaction _push_transaction( const signed_transaction& trx );
+         processed_transaction _push_transaction( const transaction_metadata_ptr& trx );
 
          ///@throws fc::exception if the proposed transaction fails to apply.
          processed_transaction push_proposal( const proposal_object& proposal );
@@ -174,6 +210,11 @@ namespace graphene { namespace chain {
          uint32_t  push_applied_operation( const operation& op );
          void      set_applied_operation_result( uint32_t op_id, const operation_result& r );
          const vector<optional< operation_history_object > >& get_applied_operations()const;
+         /**
+          *  @return the transactions of the block being applied, with their digests cached; valid
+          *  during the applied_block signal, in the same order as the transactions of the block
+          */
+         const vector<transaction_metadata_ptr>& get_applied_transactions()const;
 
          string to_pretty_string( const asset& a )const;
 
@@ -184,6 +225,22 @@ namespace graphene { namespace chain {
          fc::signal<void(const operation_history_object&)> on_new_commited_operation;
          fc::signal<void(const operation_history_object&)> on_new_commited_operation_during_sync;
 
+         /**
+          * The operations of committed blocks, delivered to plugin threads.  Unlike the two signals above
+          * a slow handler does not hold up block application.
+          */
+         committed_operation_bus& committed_operations() { return _committed_operations; }
+
+         /**
+          * Runs changes of plugin objects on the chain thread, outside of the pending transactions.  Changes
+          * made for an operation of block block_num go into the undo state of that block, so they are unwound
+          * when it is popped, and are dropped if it has been popped already.  Changes not tied to a block
+          * (block_num 0) go into the head block's.  Plugin objects are changed by plugin changes only, which
+          * keeps the undo states consistent as long as no change goes below the state an earlier one went
+          * into, so such a change goes into that state too.
+          */
+         void apply_plugin_changes( uint32_t block_num, const std::function<void()>& changes );
+
          /**
           *  This signal is emitted after all operations and virtual operation for a
           *  block have been applied but before the get_applied_operations() are cleared.
@@ -409,17 +466,21 @@ namespace graphene { namespace chain {
 
        public:
          // these were formerly private, but they have a fairly well-defined API, so let's make them public
-         void                  apply_block( const signed_block& next_block, uint32_t skip = skip_nothing );
+         void                  apply_block( const signed_block& next_block, uint32_t skip = skip_nothing,
+                                            const block_metadata& metadata = block_metadata() );
          processed_transaction apply_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
+         processed_transaction apply_transaction( const transaction_metadata& trx, uint32_t skip = skip_nothing );
          operation_result      apply_operation( transaction_evaluation_state& eval_state, const operation& op );
       private:
-         void                  _apply_block( const signed_block& next_block );
+         void                  _apply_block( const signed_block& next_block, const block_metadata& metadata );
          processed_transaction _apply_transaction( const signed_transaction& trx );
+         processed_transaction _apply_transaction( const transaction_metadata& trx );
 
          ///Steps involved in applying a new block
          ///@{
 
-         const miner_object& validate_block_header( uint32_t skip, const signed_block& next_block )const;
+         const miner_object& validate_block_header( uint32_t skip, const signed_block& next_block,
+                                                    const block_metadata& metadata = block_metadata() )const;
          const miner_object& _validate_block_header( const signed_block& next_block )const;
          void create_block_summary(const signed_block& next_block);
 
@@ -448,7 +509,7 @@ namespace graphene { namespace chain {
          ///@}
          ///@}
 
-         vector< processed_transaction >        _pending_tx;
+         vector< transaction_metadata_ptr >     _pending_tx;
          fork_database                          _fork_db;
 
          /**
@@ -470,6 +531,9 @@ namespace graphene { namespace chain {
           */
          vector<optional<operation_history_object> >  _applied_ops;
 
+         /** The transactions of the block being applied, cleared together with _applied_ops */
+         vector<transaction_metadata_ptr>             _applied_trxs;
+
          uint32_t                          _current_block_num    = 0;
          uint16_t                          _current_trx_in_block = 0;
          uint16_t                          _current_op_in_trx    = 0;
@@ -482,6 +546,14 @@ namespace graphene { namespace chain {
          flat_map<uint32_t,block_id_type>  _checkpoints;
 
          node_property_object              _node_property_object;
+
+         mutable boost::shared_mutex       _state_mutex;
+         uint32_t                          _write_scope_depth = 0;
+         /// the latest block whose undo state plugin changes went into
+         uint32_t                          _plugin_changes_block = 0;
+
+         /// declared last, so its threads are stopped before anything they use goes away
+         committed_operation_bus           _committed_operations;
    };
 
    namespace detail
@@ -68,7 +68,7 @@ struct skip_flags_restorer
  */
 struct pending_transactions_restorer
 {
-   pending_transactions_restorer( database& db, std::vector<processed_transaction>&& pending_transactions )
+   pending_transactions_restorer( database& db, std::vector<transaction_metadata_ptr>&& pending_transactions )
       : _db(db), _pending_transactions( std::move(pending_transactions) )
    {
       _db.clear_pending();
@@ -88,13 +88,12 @@ struct pending_transactions_restorer
          }
       }
       _db._popped_tx.clear();
-      for( const processed_transaction& tx : _pending_transactions )
+      for( const transaction_metadata_ptr& tx : _pending_transactions )
       {
          try
          {
-            if( !_db.is_known_transaction( tx.id() ) ) {
-               // since push_transaction() takes a signed_transaction,
-               // the operation_results field will be ignored.
+            // the id and the signature keys are still cached from the first push
+            if( !_db.is_known_transaction( tx->id() ) ) {
                _db._push_transaction( tx );
             }
          }
@@ -109,7 +108,7 @@ struct pending_transactions_restorer
    }
 
    database& _db;
-   std::vector< processed_transaction > _pending_transactions;
+   std::vector< transaction_metadata_ptr > _pending_transactions;
 };
 
 /**
@@ -139,7 +138,7 @@ void with_skip_flags(
 template< typename Lambda >
 void without_pending_transactions(
    database& db,
-   std::vector<processed_transaction>&& pending_transactions,
+   std::vector<transaction_metadata_ptr>&& pending_transactions,
    Lambda callback )
 {
     pending_transactions_restorer restorer( db, std::move(pending_transactions) );
@@ -111,6 +111,12 @@ namespace graphene { namespace chain {
 
          uint32_t last_irreversible_block_num = 0;
 
+         /**
+          * Head block time of the last decent_housekeeping() run.  Content that expired up to this time
+          * has already returned its escrow.
+          */
+         time_point_sec    last_housekeeping_time;
+
          enum dynamic_flag_bits
          {
             /**
@@ -144,6 +150,7 @@ FC_REFLECT_DERIVED( graphene::chain::dynamic_global_property_object, (graphene::
                     (recent_slots_filled)
                     (dynamic_flags)
                     (last_irreversible_block_num)
+                    (last_housekeeping_time)
                   )
 
 FC_REFLECT_DERIVED( graphene::chain::global_property_object, (graphene::db::object),
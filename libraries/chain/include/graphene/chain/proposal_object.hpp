@@ -61,21 +61,29 @@ class proposal_object : public abstract_object<proposal_object>
  *  @ingroup object
  *  @ingroup protocol
  *
- *  This is a secondary index on the proposal_index
+ *  This is a secondary index on the proposal_index, it maps every account to the proposals where it is a required
+ *  or an available approver.
  *
- *  @note the set of required approvals is constant
+ *  @note the set of required approvals is constant, the available approvals change when a proposal is updated
  */
 class required_approval_index : public secondary_index
 {
    public:
       virtual void object_inserted( const object& obj ) override;
       virtual void object_removed( const object& obj ) override;
-      virtual void about_to_modify( const object& before ) override{};
-      virtual void object_modified( const object& after  ) override{};
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
+      virtual uint64_t memory_usage()const override;
 
       void remove( account_id_type a, proposal_id_type p );
 
       map<account_id_type, set<proposal_id_type> > _account_to_proposals;
+
+   private:
+      static flat_set<account_id_type> get_approvers( const proposal_object& p );
+
+      /// approvers of the proposal being modified, as they were before the modification
+      flat_set<account_id_type> _approvers_before_modify;
 };
 
 struct by_expiration{};
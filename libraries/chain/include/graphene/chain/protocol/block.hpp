@@ -52,6 +52,8 @@ namespace graphene { namespace chain {
    struct signed_block : public signed_block_header
    {
       checksum_type calculate_merkle_root()const;
+      /** computes the root from already known processed_transaction::merkle_digest() values, in block order */
+      static checksum_type calculate_merkle_root( vector<digest_type> merkle_digests );
       vector<processed_transaction> transactions;
    };
 
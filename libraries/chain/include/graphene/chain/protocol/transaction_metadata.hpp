@@ -0,0 +1,80 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#pragma once
+#include <graphene/chain/protocol/block.hpp>
+#include <graphene/chain/protocol/transaction.hpp>
+
+#include <memory>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @brief caches the serialization and the digests of a signed transaction
+    *
+    *  A transaction is hashed for its id, for signature recovery and for the merkle root of the block
+    *  that includes it. This wrapper packs the transaction once and computes each digest on first use,
+    *  so the same instance can be passed from the network to the pending pool, to block generation and
+    *  to the API callbacks without hashing the transaction again.
+    *
+    *  @note the wrapped transaction must not be modified while the metadata exists, and the lazily
+    *  computed members are not synchronized, so an instance must not be shared between threads
+    */
+   class transaction_metadata;
+   typedef std::shared_ptr<transaction_metadata> transaction_metadata_ptr;
+
+   class transaction_metadata
+   {
+      public:
+         explicit transaction_metadata( const signed_transaction& trx );
+         explicit transaction_metadata( signed_transaction&& trx );
+         explicit transaction_metadata( std::shared_ptr<const signed_transaction> trx );
+
+         /**
+          * Wraps a transaction without copying it, e.g. one contained in a block being applied.
+          * The caller must keep @p trx alive as long as the returned metadata is used.
+          */
+         static transaction_metadata_ptr reference( const signed_transaction& trx );
+
+         const signed_transaction&         get_transaction()const { return *_trx; }
+
+         /** serialization of the unsigned transaction, this is what the digests are calculated from */
+         const vector<char>&               packed()const;
+         /** size of the serialized signed transaction */
+         size_t                            packed_size()const;
+
+         const digest_type&                digest()const;
+         const transaction_id_type&        id()const;
+         const digest_type&                sig_digest( const chain_id_type& chain_id )const;
+         const flat_set<public_key_type>&  signature_keys( const chain_id_type& chain_id )const;
+
+         /** the same value as processed_transaction::merkle_digest() of this transaction with the given results */
+         digest_type                       merkle_digest( const vector<operation_result>& operation_results )const;
+
+      private:
+         std::shared_ptr<const signed_transaction>     _trx;
+         mutable optional<vector<char>>                _packed;
+         mutable optional<digest_type>                 _digest;
+         mutable optional<transaction_id_type>         _id;
+         mutable optional<chain_id_type>               _sig_chain_id;
+         mutable digest_type                           _sig_digest;
+         mutable optional<flat_set<public_key_type>>   _signature_keys;
+   };
+
+   /**
+    *  @brief caches of a signed block computed before the block is pushed
+    *
+    *  The p2p layer fills it in on its prevalidation threads, so the chain thread finds the transactions
+    *  serialized and hashed, their signing keys recovered and the merkle root and the signee calculated. It describes the one block it was computed
+    *  from and is never sent over the network.
+    */
+   struct block_metadata
+   {
+      /** one per transaction of the block and in block order, each owns its transaction */
+      vector<transaction_metadata_ptr>  trx_metadata;
+      /** root calculated from the transactions of the block */
+      optional<checksum_type>           merkle_root;
+      /** key recovered from the miner signature, the chain thread only compares it with the key of the miner */
+      optional<public_key_type>         signee;
+   };
+   typedef std::shared_ptr<const block_metadata> block_metadata_ptr;
+
+} } // graphene::chain
@@ -143,7 +143,9 @@ namespace graphene { namespace chain {
       impl_rating_object_type,
       impl_subscription_object_type,
       impl_seeding_statistics_object_type,
-      impl_transaction_detail_object_type
+      impl_transaction_detail_object_type,
+      impl_content_statistics_object_type,
+      impl_content_proof_object_type
    };
 
    //typedef fc::unsigned_int            object_id_type;
@@ -186,6 +188,8 @@ namespace graphene { namespace chain {
    class subscription_object;
    class seeding_statistics_object;
    class transaction_detail_object;
+   class content_statistics_object;
+   class content_proof_object;
 
    typedef object_id< implementation_ids, impl_global_property_object_type,  global_property_object>                    global_property_id_type;
    typedef object_id< implementation_ids, impl_dynamic_global_property_object_type,  dynamic_global_property_object>    dynamic_global_property_id_type;
@@ -208,6 +212,8 @@ namespace graphene { namespace chain {
    typedef object_id< implementation_ids, impl_subscription_object_type, subscription_object >                          subscription_id_type;
    typedef object_id< implementation_ids, impl_seeding_statistics_object_type, seeding_statistics_object >              seeding_statistics_id_type;
    typedef object_id< implementation_ids, impl_transaction_detail_object_type, transaction_detail_object >              transaction_detail_id_type;
+   typedef object_id< implementation_ids, impl_content_statistics_object_type, content_statistics_object >              content_statistics_id_type;
+   typedef object_id< implementation_ids, impl_content_proof_object_type, content_proof_object >                        content_proof_id_type;
 
    typedef fc::array<char, GRAPHENE_MAX_ASSET_SYMBOL_LENGTH>    symbol_type;
    typedef fc::ripemd160                                        block_id_type;
@@ -350,6 +356,8 @@ FC_REFLECT_ENUM( graphene::chain::impl_object_type,
                  (impl_subscription_object_type)
                  (impl_seeding_statistics_object_type)
                  (impl_transaction_detail_object_type)
+                 (impl_content_statistics_object_type)
+                 (impl_content_proof_object_type)
                )
 
 FC_REFLECT_TYPENAME( graphene::chain::share_type )
@@ -378,5 +386,7 @@ FC_REFLECT_TYPENAME( graphene::chain::rating_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::subscription_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::seeding_statistics_id_type )
 FC_REFLECT_TYPENAME( graphene::chain::transaction_detail_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::content_statistics_id_type )
+FC_REFLECT_TYPENAME( graphene::chain::content_proof_id_type )
 
 FC_REFLECT_EMPTY( graphene::chain::void_t )
@@ -18,25 +18,26 @@ namespace graphene { namespace chain {
       static const uint8_t type_id  = impl_rating_object_type;
       
       account_id_type consumer;
+      content_id_type content;   //< the content published under URI, the indices refer to the content by this ID
       string URI;
       uint64_t rating;
       string comment; // up to 1000 characters
       buying_id_type buying;
    };
    
-   struct by_URI_consumer;
-   struct by_consumer_URI;
-   struct by_URI_time;
+   struct by_content_consumer;
+   struct by_consumer_content;
+   struct by_content_time;
 
    template <typename TAG, typename _t_object>
    struct key_extractor;
 
    template <>
-   struct key_extractor<by_URI_time, rating_object>
+   struct key_extractor<by_content_time, rating_object>
    {
-      static std::tuple<string, object_id_type> get(rating_object const& ob)
+      static std::tuple<content_id_type, object_id_type> get(rating_object const& ob)
       {
-         return std::make_tuple(ob.URI, ob.id);
+         return std::make_tuple(ob.content, ob.id);
       }
    };
    
@@ -46,21 +47,21 @@ namespace graphene { namespace chain {
             ordered_unique< tag<by_id>,
                member< object, object_id_type, &object::id >
             >,
-            ordered_unique< tag< by_URI_consumer>,
+            ordered_unique< tag< by_content_consumer>,
                composite_key< rating_object,
-                  member<rating_object, string, &rating_object::URI>,
+                  member<rating_object, content_id_type, &rating_object::content>,
                   member<rating_object, account_id_type, &rating_object::consumer>
                >
             >,
-            ordered_unique< tag< by_consumer_URI>,
+            ordered_unique< tag< by_consumer_content>,
                composite_key< rating_object,
                   member<rating_object, account_id_type, &rating_object::consumer>,
-                  member<rating_object, string, &rating_object::URI>
+                  member<rating_object, content_id_type, &rating_object::content>
                >
             >,
-            ordered_unique< tag< by_URI_time>,
+            ordered_unique< tag< by_content_time>,
                composite_key< rating_object,
-                  member<rating_object, string, &rating_object::URI>,
+                  member<rating_object, content_id_type, &rating_object::content>,
                   member<object, object_id_type, &object::id>
                >
             >
@@ -73,4 +74,4 @@ namespace graphene { namespace chain {
 
 FC_REFLECT_DERIVED(graphene::chain::rating_object,
                    (graphene::db::object),
-                   (consumer)(URI)(rating)(comment)(buying) )
+                   (consumer)(content)(URI)(rating)(comment)(buying) )
@@ -31,8 +31,8 @@ namespace graphene { namespace chain {
    struct by_from_to;
    struct by_from_expiration;
    struct by_to_expiration;
-   struct by_renewal;
    struct by_to_renewal;
+   struct by_renewal_expiration;
 
    typedef multi_index_container<
       subscription_object,
@@ -75,14 +75,17 @@ namespace graphene { namespace chain {
                   std::greater< time_point_sec >
                   >
             >,
-            ordered_non_unique< tag< by_renewal>,
-               member<subscription_object, bool, &subscription_object::automatic_renewal>, std::greater<bool>
-            >,
             ordered_non_unique< tag< by_to_renewal>,
                composite_key< subscription_object,
                   member<subscription_object, account_id_type, &subscription_object::to>,
                   member<subscription_object, bool, &subscription_object::automatic_renewal>
                >
+            >,
+            ordered_non_unique< tag< by_renewal_expiration>,
+               composite_key< subscription_object,
+                  member<subscription_object, bool, &subscription_object::automatic_renewal>,
+                  member<subscription_object, time_point_sec, &subscription_object::expiration>
+               >
             >
          >
    >subscription_object_multi_index_type;
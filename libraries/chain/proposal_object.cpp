@@ -51,18 +51,24 @@ bool proposal_object::is_authorized_to_execute(database& db) const
 }
 
 
+flat_set<account_id_type> required_approval_index::get_approvers( const proposal_object& p )
+{
+    flat_set<account_id_type> result;
+    result.reserve( p.required_active_approvals.size() + p.required_owner_approvals.size() +
+                    p.available_active_approvals.size() + p.available_owner_approvals.size() );
+    result.insert( p.required_active_approvals.begin(), p.required_active_approvals.end() );
+    result.insert( p.required_owner_approvals.begin(), p.required_owner_approvals.end() );
+    result.insert( p.available_active_approvals.begin(), p.available_active_approvals.end() );
+    result.insert( p.available_owner_approvals.begin(), p.available_owner_approvals.end() );
+    return result;
+}
+
 void required_approval_index::object_inserted( const object& obj )
 {
     assert( dynamic_cast<const proposal_object*>(&obj) );
     const proposal_object& p = static_cast<const proposal_object&>(obj);
 
-    for( const auto& a : p.required_active_approvals )
-       _account_to_proposals[a].insert( p.id );
-    for( const auto& a : p.required_owner_approvals )
-       _account_to_proposals[a].insert( p.id );
-    for( const auto& a : p.available_active_approvals )
-       _account_to_proposals[a].insert( p.id );
-    for( const auto& a : p.available_owner_approvals )
+    for( const auto& a : get_approvers( p ) )
        _account_to_proposals[a].insert( p.id );
 }
 
@@ -82,14 +88,38 @@ void required_approval_index::object_removed( const object& obj )
     assert( dynamic_cast<const proposal_object*>(&obj) );
     const proposal_object& p = static_cast<const proposal_object&>(obj);
 
-    for( const auto& a : p.required_active_approvals )
-       remove( a, p.id );
-    for( const auto& a : p.required_owner_approvals )
-       remove( a, p.id );
-    for( const auto& a : p.available_active_approvals )
-       remove( a, p.id );
-    for( const auto& a : p.available_owner_approvals )
+    for( const auto& a : get_approvers( p ) )
        remove( a, p.id );
 }
 
+void required_approval_index::about_to_modify( const object& before )
+{
+    assert( dynamic_cast<const proposal_object*>(&before) );
+    _approvers_before_modify = get_approvers( static_cast<const proposal_object&>(before) );
+}
+
+void required_approval_index::object_modified( const object& after )
+{
+    assert( dynamic_cast<const proposal_object*>(&after) );
+    const proposal_object& p = static_cast<const proposal_object&>(after);
+    const flat_set<account_id_type> approvers = get_approvers( p );
+
+    for( const auto& a : _approvers_before_modify )
+       if( approvers.find( a ) == approvers.end() )
+          remove( a, p.id );
+    for( const auto& a : approvers )
+       if( _approvers_before_modify.find( a ) == _approvers_before_modify.end() )
+          _account_to_proposals[a].insert( p.id );
+
+    _approvers_before_modify.clear();
+}
+
+uint64_t required_approval_index::memory_usage()const
+{
+   uint64_t result = 0;
+   for( const auto& item : _account_to_proposals )
+      result += tree_node_overhead + sizeof(item) + item.second.size() * ( tree_node_overhead + sizeof(proposal_id_type) );
+   return result;
+}
+
 } } // graphene::chain
@@ -0,0 +1,100 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#include <graphene/chain/protocol/transaction_metadata.hpp>
+#include <graphene/chain/exceptions.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+namespace graphene { namespace chain {
+
+transaction_metadata::transaction_metadata( const signed_transaction& trx )
+:_trx( std::make_shared<signed_transaction>( trx ) ) {}
+
+transaction_metadata::transaction_metadata( signed_transaction&& trx )
+:_trx( std::make_shared<signed_transaction>( std::move( trx ) ) ) {}
+
+transaction_metadata::transaction_metadata( std::shared_ptr<const signed_transaction> trx )
+:_trx( std::move( trx ) )
+{
+   FC_ASSERT( _trx );
+}
+
+transaction_metadata_ptr transaction_metadata::reference( const signed_transaction& trx )
+{
+   // aliasing constructor with an empty owner, nothing is released when the metadata goes away
+   return std::make_shared<transaction_metadata>( std::shared_ptr<const signed_transaction>( std::shared_ptr<const signed_transaction>(), &trx ) );
+}
+
+const vector<char>& transaction_metadata::packed()const
+{
+   if( !_packed )
+      _packed = fc::raw::pack( static_cast<const transaction&>( *_trx ) );
+   return *_packed;
+}
+
+size_t transaction_metadata::packed_size()const
+{
+   return packed().size() + fc::raw::pack_size( _trx->signatures );
+}
+
+const digest_type& transaction_metadata::digest()const
+{
+   if( !_digest )
+      _digest = digest_type::hash( packed().data(), packed().size() );
+   return *_digest;
+}
+
+const transaction_id_type& transaction_metadata::id()const
+{
+   if( !_id )
+   {
+      const digest_type& h = digest();
+      transaction_id_type result;
+      memcpy( result._hash, h._hash, std::min( sizeof(result), sizeof(h) ) );
+      _id = result;
+   }
+   return *_id;
+}
+
+const digest_type& transaction_metadata::sig_digest( const chain_id_type& chain_id )const
+{
+   if( !_sig_chain_id || *_sig_chain_id != chain_id )
+   {
+      digest_type::encoder enc;
+      fc::raw::pack( enc, chain_id );
+      enc.write( packed().data(), packed().size() );
+      _sig_digest = enc.result();
+      _sig_chain_id = chain_id;
+      _signature_keys.reset();
+   }
+   return _sig_digest;
+}
+
+const flat_set<public_key_type>& transaction_metadata::signature_keys( const chain_id_type& chain_id )const
+{ try {
+   const digest_type& d = sig_digest( chain_id );
+   if( !_signature_keys )
+   {
+      flat_set<public_key_type> result;
+      for( const auto& sig : _trx->signatures )
+      {
+         GRAPHENE_ASSERT(
+            result.insert( fc::ecc::public_key( sig, d ) ).second,
+            tx_duplicate_sig,
+            "Duplicate Signature detected" );
+      }
+      _signature_keys = std::move( result );
+   }
+   return *_signature_keys;
+} FC_CAPTURE_AND_RETHROW() }
+
+digest_type transaction_metadata::merkle_digest( const vector<operation_result>& operation_results )const
+{
+   // processed_transaction serializes as the transaction, its signatures and the results
+   digest_type::encoder enc;
+   enc.write( packed().data(), packed().size() );
+   fc::raw::pack( enc, _trx->signatures );
+   fc::raw::pack( enc, operation_results );
+   return enc.result();
+}
+
+} } // graphene::chain
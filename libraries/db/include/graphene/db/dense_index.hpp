@@ -0,0 +1,77 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#pragma once
+#include <graphene/db/generic_index.hpp>
+
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  Adds a vector of object pointers, indexed by the instance of the object ID, to a generic_index, so that find()
+    *  is an array access instead of a search of the by_id tree. The multi_index container still owns the objects and
+    *  provides all other orderings; its nodes never move, so the pointers stay valid across modify().
+    *
+    *  Instances are only reused when an undone create rewinds the next ID, a removed object leaves an empty slot
+    *  behind. This suits object types whose instances are dense, i.e. which are rarely removed. Undo goes through
+    *  insert() and remove(), so it keeps the slots in step. The index is derived from BaseIndex, so
+    *  get_index_type<BaseIndex>() keeps working and the index can be enabled per object type:
+    *
+    *     add_index< primary_index< dense_index<account_index> > >();
+    */
+   template<typename BaseIndex>
+   class dense_index : public BaseIndex
+   {
+      public:
+         typedef typename BaseIndex::object_type object_type;
+
+         virtual const object& insert( object&& obj )override
+         {
+            const object& result = BaseIndex::insert( std::move( obj ) );
+            set_slot( result );
+            return result;
+         }
+
+         virtual const object& create( const std::function<void(object&)>& constructor )override
+         {
+            const object& result = BaseIndex::create( constructor );
+            set_slot( result );
+            return result;
+         }
+
+         virtual void remove( const object& obj )override
+         {
+            const uint64_t instance = obj.id.instance();
+            BaseIndex::remove( obj );
+            if( instance < _slots.size() )
+               _slots[instance] = nullptr;
+         }
+
+         virtual const object* find( object_id_type id )const override
+         {
+            const uint64_t instance = id.instance();
+            if( instance >= _slots.size() )
+               return nullptr;
+            const object* result = _slots[instance];
+            // an id of another type with the same instance must not match
+            return ( result != nullptr && result->id == id ) ? result : nullptr;
+         }
+
+         virtual void get_memory_stats( index_memory_stats& stats )const override
+         {
+            BaseIndex::get_memory_stats( stats );
+            stats.node_overhead_bytes += _slots.capacity() * sizeof(const object*);
+         }
+
+      private:
+         void set_slot( const object& obj )
+         {
+            const uint64_t instance = obj.id.instance();
+            if( instance >= _slots.size() )
+               _slots.resize( instance + 1, nullptr );
+            _slots[instance] = &obj;
+         }
+
+         std::vector<const object*> _slots;
+   };
+
+} }
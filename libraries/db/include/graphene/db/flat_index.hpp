@@ -101,6 +101,16 @@ namespace graphene { namespace db {
             return result;
          }
 
+         virtual void get_memory_stats( index_memory_stats& stats )const override
+         {
+            stats.object_count = _objects.size();
+            stats.object_bytes = _objects.capacity() * sizeof(T);
+            stats.node_overhead_bytes = 0;
+            stats.dynamic_bytes = 0;
+            for( const auto& item : _objects )
+               stats.dynamic_bytes += dynamic_memory_usage( item );
+         }
+
          class const_iterator
          {
             public:
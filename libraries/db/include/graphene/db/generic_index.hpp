@@ -27,6 +27,7 @@
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/mpl/size.hpp>
 
 namespace graphene { namespace chain {
 
@@ -107,6 +108,18 @@ namespace graphene { namespace chain {
             return result;
          }
 
+         virtual void get_memory_stats( index_memory_stats& stats )const override
+         {
+            // every index of the container links each node into a tree of three pointers
+            const uint64_t index_count = boost::mpl::size<typename MultiIndexType::index_type_list>::value;
+            stats.object_count = _indices.size();
+            stats.object_bytes = stats.object_count * sizeof(ObjectType);
+            stats.node_overhead_bytes = stats.object_count * index_count * 3 * sizeof(void*);
+            stats.dynamic_bytes = 0;
+            for( const auto& item : _indices )
+               stats.dynamic_bytes += dynamic_memory_usage( item );
+         }
+
       private:
          fc::uint128 _current_hash;
          index_type  _indices;
@@ -28,12 +28,66 @@
 #include <fc/io/raw.hpp>
 #include <fc/io/json.hpp>
 #include <fc/crypto/sha256.hpp>
+#include <fc/uint128.hpp>
 #include <fstream>
 
 namespace graphene { namespace db {
    class object_database;
    using fc::path;
 
+   /**
+    * @brief Estimated memory footprint of a single (space, type) index.
+    *
+    * All byte counts are estimates: node overhead assumes red-black tree nodes for every
+    * multi_index ordered index and dynamic bytes are derived from the payload of the
+    * containers and strings owned by the objects, not from the allocator itself.
+    */
+   struct index_memory_stats
+   {
+      uint8_t  space_id = 0;
+      uint8_t  type_id = 0;
+      uint64_t object_count = 0;
+      /** sizeof the stored objects */
+      uint64_t object_bytes = 0;
+      /** bookkeeping of the container holding the objects */
+      uint64_t node_overhead_bytes = 0;
+      /** heap owned by members of the objects (strings, maps, vectors) */
+      uint64_t dynamic_bytes = 0;
+      uint64_t secondary_index_bytes = 0;
+      /** object copies held by the undo stack */
+      uint64_t undo_object_count = 0;
+      uint64_t undo_bytes = 0;
+
+      uint64_t total_bytes()const
+      { return object_bytes + node_overhead_bytes + dynamic_bytes + secondary_index_bytes + undo_bytes; }
+   };
+
+   /** approximate size of a node of std::map/std::set, excluding the value */
+   const uint64_t tree_node_overhead = 4 * sizeof(void*);
+
+   /**
+    * @brief State hash of a single (space, type) index, see index::state_hash()
+    */
+   struct index_state_hash
+   {
+      uint8_t     space_id = 0;
+      uint8_t     type_id = 0;
+      fc::uint128 hash;
+   };
+
+   /**
+    * Estimates the heap owned by the members of an object. The default uses the serialized size
+    * in excess of the fixed object size, which is a lower bound for objects with strings and
+    * containers. Object types with large dynamic members provide a more precise overload in
+    * their own namespace, it is found by argument dependent lookup.
+    */
+   template<typename T>
+   uint64_t dynamic_memory_usage( const T& obj )
+   {
+      const uint64_t packed = fc::raw::pack_size( obj );
+      return packed > sizeof(T) ? packed - sizeof(T) : 0;
+   }
+
    /**
     * @class index_observer
     * @brief used to get callbacks when objects change
@@ -129,10 +183,22 @@ namespace graphene { namespace db {
 
          virtual void               inspect_all_objects(std::function<void(const object&)> inspector)const = 0;
          virtual fc::uint128        hash()const = 0;
+         /**
+          *  Sum of the hashes of all objects in the index. It is updated by every create, modify and remove, so it does
+          *  not depend on the order of the changes, it follows the undo of a block and reading it costs nothing.
+          *  hash() computes the same value by walking all objects.
+          */
+         virtual fc::uint128        state_hash()const = 0;
          virtual void               add_observer( const shared_ptr<index_observer>& ) = 0;
 
          virtual void               object_from_variant( const fc::variant& var, object& obj )const = 0;
          virtual void               object_default( object& obj )const = 0;
+
+         /**
+          *  Fills the object count and the object, node and dynamic byte estimates of this index.
+          *  This walks all objects, so it is meant for diagnostics only.
+          */
+         virtual void               get_memory_stats( index_memory_stats& stats )const = 0;
    };
 
    class secondary_index
@@ -143,6 +209,8 @@ namespace graphene { namespace db {
          virtual void object_removed( const object& obj ){};
          virtual void about_to_modify( const object& before ){};
          virtual void object_modified( const object& after  ){};
+         /** @return estimated heap used by this secondary index */
+         virtual uint64_t memory_usage()const { return 0; }
    };
 
    /**
@@ -182,6 +250,14 @@ namespace graphene { namespace db {
             FC_THROW_EXCEPTION( fc::assert_exception, "invalid index type" );
          }
 
+         uint64_t secondary_index_memory_usage()const
+         {
+            uint64_t result = 0;
+            for( const auto& item : _sindex )
+               result += item->memory_usage();
+            return result;
+         }
+
       protected:
          vector< shared_ptr<index_observer> >   _observers;
          vector< unique_ptr<secondary_index> >  _sindex;
@@ -264,9 +340,19 @@ namespace graphene { namespace db {
             const auto& result = DerivedIndex::insert( fc::raw::unpack<object_type>( data ) );
             for( const auto& item : _sindex )
                item->object_inserted( result );
+            _state_hash += result.hash();
             return result;
          }
 
+         /** used by the undo database to restore removed objects */
+         virtual const object&  insert( object&& obj )override
+         {
+            const auto& result = DerivedIndex::insert( std::move( obj ) );
+            for( const auto& item : _sindex )
+               item->object_inserted( result );
+            _state_hash += result.hash();
+            return result;
+         }
 
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
@@ -274,6 +360,7 @@ namespace graphene { namespace db {
             for( const auto& item : _sindex )
                item->object_inserted( result );
             on_add( result );
+            _state_hash += result.hash();
             return result;
          }
 
@@ -282,20 +369,26 @@ namespace graphene { namespace db {
             for( const auto& item : _sindex )
                item->object_removed( obj );
             on_remove(obj);
+            _state_hash -= obj.hash();
             DerivedIndex::remove(obj);
          }
 
          virtual void modify( const object& obj, const std::function<void(object&)>& m )override
          {
             save_undo( obj );
+            const fc::uint128 before = obj.hash();
             for( const auto& item : _sindex )
                item->about_to_modify( obj );
             DerivedIndex::modify( obj, m );
             for( const auto& item : _sindex )
                item->object_modified( obj );
+            _state_hash -= before;
+            _state_hash += obj.hash();
             on_modify( obj );
          }
 
+         virtual fc::uint128 state_hash()const override { return _state_hash; }
+
          virtual void add_observer( const shared_ptr<index_observer>& o ) override
          {
             _observers.emplace_back( o );
@@ -319,8 +412,21 @@ namespace graphene { namespace db {
             obj.id = id;
          }
 
+         virtual void get_memory_stats( index_memory_stats& stats )const override
+         {
+            DerivedIndex::get_memory_stats( stats );
+            stats.secondary_index_bytes = secondary_index_memory_usage();
+         }
+
       private:
          object_id_type _next_id;
+         fc::uint128    _state_hash;
    };
 
 } } // graphene::db
+
+FC_REFLECT( graphene::db::index_memory_stats,
+            (space_id)(type_id)(object_count)(object_bytes)(node_overhead_bytes)(dynamic_bytes)
+            (secondary_index_bytes)(undo_object_count)(undo_bytes) )
+
+FC_REFLECT( graphene::db::index_state_hash, (space_id)(type_id)(hash) )
@@ -32,6 +32,16 @@
 
 namespace graphene { namespace db {
 
+   /**
+    * @brief Commitment to the content of all indices, two databases with the same objects have the same digest
+    */
+   struct state_digest
+   {
+      /** hash of the state hashes of all indices, in the order of their space and type */
+      fc::sha256                 digest;
+      vector<index_state_hash>   indices;
+   };
+
    /**
     *   @class object_database
     *   @brief maintains a set of indexed objects that can be modified with multi-level rollback support
@@ -141,6 +151,17 @@ namespace graphene { namespace db {
 
          void pop_undo();
 
+         /**
+          * Collects the estimated memory footprint of every registered index, including the
+          * copies of its objects held by the undo stack. This walks all objects.
+          */
+         vector<index_memory_stats> get_memory_stats()const;
+
+         /**
+          * Collects the incrementally maintained state hashes of all indices, this does not walk the objects.
+          */
+         state_digest get_state_digest()const;
+
          fc::path get_data_dir()const { return _data_dir; }
 
          /** public for testing purposes only... should be private in practice. */
@@ -170,4 +191,4 @@ namespace graphene { namespace db {
 
 } } // graphene::db
 
-
+FC_REFLECT( graphene::db::state_digest, (digest)(indices) )
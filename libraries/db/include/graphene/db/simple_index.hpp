@@ -106,6 +106,20 @@ namespace graphene { namespace db {
             return result;
          }
 
+         virtual void get_memory_stats( index_memory_stats& stats )const override
+         {
+            stats.object_count = 0;
+            stats.dynamic_bytes = 0;
+            for( const auto& ptr : _objects )
+            {
+               if( !ptr ) continue;
+               ++stats.object_count;
+               stats.dynamic_bytes += dynamic_memory_usage( static_cast<const T&>(*ptr) );
+            }
+            stats.object_bytes = stats.object_count * sizeof(T);
+            stats.node_overhead_bytes = _objects.capacity() * sizeof(unique_ptr<object>);
+         }
+
          class const_iterator
          {
             public:
@@ -24,6 +24,7 @@
 #pragma once
 #include <graphene/db/object.hpp>
 #include <deque>
+#include <map>
 #include <fc/exception/exception.hpp>
 
 namespace graphene { namespace db {
@@ -72,12 +73,16 @@ namespace graphene { namespace db {
                }
                void commit() { _apply_undo = false; _db.commit();  }
                void undo()   { if( _apply_undo ) _db.undo(); _apply_undo = false; }
-               void merge()  {
+               /**
+                * Merges this session into the one depth sessions below the previous one.  With a depth over 0
+                * the changed objects must not have been changed by the sessions in between.
+                */
+               void merge( size_t depth = 0 )  {
                   if( _apply_undo ) {
                      if( _disable_on_exit )
                         _db.commit();
                      else
-                        _db.merge();
+                        _db.merge( depth );
                   }
                   _apply_undo = false;
                }
@@ -140,9 +145,12 @@ namespace graphene { namespace db {
 
          const undo_state& head()const;
 
+         /** @return number of object copies held by all undo states, keyed by (space, type) */
+         std::map< std::pair<uint8_t,uint8_t>, uint64_t > object_counts()const;
+
       private:
          void undo();
-         void merge();
+         void merge( size_t depth );
          void commit();
 
          uint32_t                _active_sessions = 0;
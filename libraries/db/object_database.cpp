@@ -111,6 +111,58 @@ void object_database::pop_undo()
    _undo_db.pop_commit();
 } FC_CAPTURE_AND_RETHROW() }
 
+vector<index_memory_stats> object_database::get_memory_stats()const
+{ try {
+   vector<index_memory_stats> result;
+   const auto undo_counts = _undo_db.object_counts();
+   for( uint32_t space = 0; space < _index.size(); ++space )
+   {
+      for( uint32_t type = 0; type < _index[space].size(); ++type )
+      {
+         const auto& idx = _index[space][type];
+         if( !idx )
+            continue;
+         index_memory_stats stats;
+         stats.space_id = space;
+         stats.type_id = type;
+         idx->get_memory_stats( stats );
+
+         auto itr = undo_counts.find( std::make_pair( uint8_t(space), uint8_t(type) ) );
+         if( itr != undo_counts.end() )
+         {
+            // undo copies are heap clones of the object kept in an unordered_map node
+            const uint64_t average_object_bytes = stats.object_count ?
+               ( stats.object_bytes + stats.dynamic_bytes ) / stats.object_count : 0;
+            stats.undo_object_count = itr->second;
+            stats.undo_bytes = itr->second * ( average_object_bytes + 4 * sizeof(void*) );
+         }
+         result.push_back( stats );
+      }
+   }
+   return result;
+} FC_CAPTURE_AND_RETHROW() }
+
+state_digest object_database::get_state_digest()const
+{ try {
+   state_digest result;
+   for( uint32_t space = 0; space < _index.size(); ++space )
+   {
+      for( uint32_t type = 0; type < _index[space].size(); ++type )
+      {
+         const auto& idx = _index[space][type];
+         if( !idx )
+            continue;
+         index_state_hash item;
+         item.space_id = space;
+         item.type_id = type;
+         item.hash = idx->state_hash();
+         result.indices.push_back( item );
+      }
+   }
+   result.digest = fc::sha256::hash( result.indices );
+   return result;
+} FC_CAPTURE_AND_RETHROW() }
+
 void object_database::save_undo( const object& obj )
 {
    _undo_db.on_modify( obj );
@@ -124,12 +124,12 @@ void undo_database::undo()
    --_active_sessions;
 } FC_CAPTURE_AND_RETHROW() }
 
-void undo_database::merge()
+void undo_database::merge( size_t depth )
 {
    FC_ASSERT( _active_sessions > 0 );
-   FC_ASSERT( _stack.size() >=2 );
+   FC_ASSERT( _stack.size() >= 2 + depth );
    auto& state = _stack.back();
-   auto& prev_state = _stack[_stack.size()-2];
+   auto& prev_state = _stack[_stack.size()-2-depth];
 
    // An object's relationship to a state can be:
    // in new_ids            : new
@@ -287,4 +287,17 @@ const undo_state& undo_database::head()const
    return _stack.back();
 }
 
+std::map< std::pair<uint8_t,uint8_t>, uint64_t > undo_database::object_counts()const
+{
+   std::map< std::pair<uint8_t,uint8_t>, uint64_t > result;
+   for( const undo_state& state : _stack )
+   {
+      for( const auto& item : state.old_values )
+         ++result[ std::make_pair( item.first.space(), item.first.type() ) ];
+      for( const auto& item : state.removed )
+         ++result[ std::make_pair( item.first.space(), item.first.type() ) ];
+   }
+   return result;
+}
+
 } } // graphene::db
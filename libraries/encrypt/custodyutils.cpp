@@ -10,6 +10,14 @@
 #include <iomanip>
 #include <fc/thread/thread.hpp>
 
+#ifdef _WIN32
+#include <mutex>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #define DECENT_CUSTODY_THREADS 4
 //#define _CUSTODY_STATS
@@ -46,6 +54,90 @@ int add = 0;
 #endif
 }
 
+/*
+ * Read only file accessed by offset. The length is taken once when the file is opened and reads do not move a shared
+ * file position, so there is no seek to the end and back for every block read.
+ */
+class custody_file {
+public:
+   explicit custody_file(const path& file);
+   ~custody_file();
+
+   bool is_open() const;
+   uint64_t size() const { return _size; }
+   /*
+    * Reads len bytes at offset, the part behind the end of the file is zero filled
+    */
+   void read_at(uint64_t offset, char buffer[], uint64_t len) const;
+
+private:
+#ifdef _WIN32
+   mutable std::mutex _mutex;
+   mutable std::ifstream _stream;
+#else
+   int _fd;
+#endif
+   uint64_t _size = 0;
+};
+
+#ifdef _WIN32
+custody_file::custody_file(const path& file) : _stream(file.string().c_str(), std::ios::binary | std::ios::in) {
+   if( _stream.is_open()) {
+      _stream.seekg(0, _stream.end);
+      _size = (uint64_t) _stream.tellg();
+   }
+}
+
+custody_file::~custody_file() {
+}
+
+bool custody_file::is_open() const {
+   return _stream.is_open();
+}
+
+void custody_file::read_at(uint64_t offset, char buffer[], uint64_t len) const {
+   uint64_t available = offset < _size ? std::min(len, _size - offset) : 0;
+   if( available ) {
+      std::lock_guard<std::mutex> guard(_mutex);
+      _stream.clear();
+      _stream.seekg(offset, _stream.beg);
+      _stream.read(buffer, available);
+      if( (uint64_t) _stream.gcount() != available )
+         FC_THROW("Failed to read ${l} bytes at ${o}", ("l", available)("o", offset));
+   }
+   memset(buffer + available, 0, len - available);
+}
+#else
+custody_file::custody_file(const path& file) : _fd(::open(file.c_str(), O_RDONLY)) {
+   struct stat st;
+   if( _fd >= 0 && ::fstat(_fd, &st) == 0 )
+      _size = (uint64_t) st.st_size;
+}
+
+custody_file::~custody_file() {
+   if( _fd >= 0 )
+      ::close(_fd);
+}
+
+bool custody_file::is_open() const {
+   return _fd >= 0;
+}
+
+void custody_file::read_at(uint64_t offset, char buffer[], uint64_t len) const {
+   uint64_t available = offset < _size ? std::min(len, _size - offset) : 0;
+   uint64_t done = 0;
+   while( done < available ) {
+      ssize_t r = ::pread(_fd, buffer + done, available - done, offset + done);
+      if( r < 0 && errno == EINTR )
+         continue;
+      if( r <= 0 )
+         FC_THROW("Failed to read ${l} bytes at ${o}", ("l", available - done)("o", offset + done));
+      done += r;
+   }
+   memset(buffer + available, 0, len - available);
+}
+#endif
+
 CustodyUtils::CustodyUtils() {
    pairing_init_set_str(pairing, _DECENT_PAIRING_PARAM_);
 
@@ -88,12 +180,11 @@ int CustodyUtils::get_u_from_seed(const mpz_t &seedU, element_t out[]) {
    return 0;
 }
 
-int CustodyUtils::get_n(std::fstream &file) {
+int CustodyUtils::get_n(const custody_file &file) {
 
    if( !file.is_open())
       return -1;
-   file.seekg(0, file.end);
-   long long length = (long long) file.tellg();
+   uint64_t length = file.size();
    int n = length / (DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS);
    if( length % (DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS))
       n += 1;
@@ -101,46 +192,18 @@ int CustodyUtils::get_n(std::fstream &file) {
    return n;
 }
 
-inline int CustodyUtils::get_data(std::fstream &file, uint32_t i, char buffer[]) {
-   uint64_t position = DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS * i;
-
-   file.seekg(0, file.end);
-   uint64_t realLen = file.tellg();
-   file.seekg(std::min(position, realLen), file.beg);
-
-   if( realLen > ((long long) (file.tellg()) + DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS))
-      file.read(buffer, DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS);
-   else {
-      if( file.eof())
-         memset(buffer, 0, DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS);
-      else {
-         int left = realLen - (long long) (file.tellg());
-         file.read(buffer, left);
-         memset(buffer + left, 0, (DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS) - left);
-      }
-   }
+inline int CustodyUtils::get_data(const custody_file &file, uint32_t i, char buffer[]) {
+   uint64_t position = (uint64_t) DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS * i;
+   file.read_at(position, buffer, DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS);
    return 0;
 }
 
 
-inline int CustodyUtils::get_m(std::fstream &file, uint32_t i, uint32_t j, mpz_t &out) {
+inline int CustodyUtils::get_m(const custody_file &file, uint32_t i, uint32_t j, mpz_t &out) {
    mpz_init2(out, DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * 8);
-   uint64_t position = DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * (j + DECENT_SECTORS * i);
+   uint64_t position = DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * (j + (uint64_t) DECENT_SECTORS * i);
    char buffer[DECENT_SIZE_OF_NUMBER_IN_THE_FIELD];
-   file.seekg(0, file.end);
-   uint64_t realLen = file.tellg();
-   if( realLen < position ) { //we are either close or behinf EoF
-      memset(buffer, 0, DECENT_SIZE_OF_NUMBER_IN_THE_FIELD);
-   } else {
-      file.seekg(position, file.beg);
-      if( realLen < position + DECENT_SIZE_OF_NUMBER_IN_THE_FIELD ) { //we can't read the whole string
-         int left = realLen - (uint64_t) (file.tellg());
-         file.read(buffer, left);
-         memset(buffer + left, 0, DECENT_SIZE_OF_NUMBER_IN_THE_FIELD - left);
-      } else {
-         file.read(buffer, DECENT_SIZE_OF_NUMBER_IN_THE_FIELD);
-      }
-   }
+   file.read_at(position, buffer, DECENT_SIZE_OF_NUMBER_IN_THE_FIELD);
 
    //mpz_import is too slow for our purposes - since we don't care about the exact parameters as much as about the uniqueness of the import, let's replace it with memcpy
    memcpy((char *) out->_mp_d, buffer, DECENT_SIZE_OF_NUMBER_IN_THE_FIELD);
@@ -197,7 +260,7 @@ int CustodyUtils::get_sigma(uint64_t idx, mpz_t mi[], element_pp_t u_pp[], eleme
 }
 
 int
-CustodyUtils::get_sigmas(std::fstream &file, const unsigned int n, element_t *u, element_t pk, element_t **sigmas) {
+CustodyUtils::get_sigmas(const custody_file &file, const unsigned int n, element_t *u, element_t pk, element_t **sigmas) {
    element_t *ret = new element_t[n];
    //start threads
    fc::thread t[DECENT_CUSTODY_THREADS];
@@ -252,7 +315,7 @@ CustodyUtils::get_sigmas(std::fstream &file, const unsigned int n, element_t *u,
 }
 
 
-int CustodyUtils::compute_mu(std::fstream &file, unsigned int q, uint64_t indices[], element_t v[], element_t mu[]) {
+int CustodyUtils::compute_mu(const custody_file &file, unsigned int q, uint64_t indices[], element_t v[], element_t mu[]) {
 
    for( int j = 0; j < DECENT_SECTORS; j++ ) {
       element_init_Zr(mu[j], pairing);
@@ -413,7 +476,7 @@ int CustodyUtils::unpack_proof(valtype proof, element_t &sigma, element_t **mu)
 }
 
 int
-CustodyUtils::compute_sigma(element_t sigmas[], unsigned int q, uint64_t indices[], element_t v[], element_t &sigma) {
+CustodyUtils::compute_sigma(element_t sigmas[], unsigned int q, element_t v[], element_t &sigma) {
    element_init_G1(sigma, pairing);
    element_set1(sigma);
 
@@ -421,7 +484,7 @@ CustodyUtils::compute_sigma(element_t sigmas[], unsigned int q, uint64_t indices
    element_init_G1(temp, pairing);
 
    for( int i = 0; i < q; i++ ) {
-      element_pow_zn(temp, sigmas[indices[i]], v[i]);
+      element_pow_zn(temp, sigmas[i], v[i]);
       element_mul(sigma, sigma, temp);
 #ifdef _CUSTODY_STATS
       pow++;
@@ -499,9 +562,8 @@ int CustodyUtils::verify_by_miner(const uint32_t &n, const char *u_seed, unsigne
 
 int CustodyUtils::create_custody_data(path content, uint32_t &n, char u_seed[], unsigned char pubKey[]) {
    //prepare the files
-   std::fstream infile(content.c_str(), std::fstream::binary | std::fstream::in);
+   custody_file infile(content);
    std::ofstream outfile((content.parent_path() / "content.cus").c_str(), std::fstream::binary | std::ios_base::trunc);
-   infile.seekg(0, infile.beg);
    outfile.seekp(0);
 
    //prepare elements _u, m, seedForU and keys
@@ -562,19 +624,16 @@ int CustodyUtils::create_custody_data(path content, uint32_t &n, char u_seed[],
    delete[](sigmas);
    mpz_clear(seedForU);
    outfile.close();
-   infile.close();
    return 0;
 }
 
 int CustodyUtils::create_proof_of_custody(path content, const uint32_t n, const char u_seed[], unsigned char pubKey[],
                                            unsigned char sigma[], std::vector<std::string> &mus, mpz_t seed) {
    //open files
-   std::fstream infile(content.c_str(), std::fstream::binary | std::fstream::in);
-   std::fstream cusfile((content.parent_path() / "content.cus").c_str(), std::fstream::binary | std::fstream::in);
+   custody_file infile(content);
+   custody_file cusfile(content.parent_path() / "content.cus");
    if( !infile.is_open() || !cusfile.is_open())
       return -10;
-   cusfile.seekg(0);
-   infile.seekg(0);
 
    //prepate public_key and u
    element_t public_key;
@@ -596,31 +655,17 @@ int CustodyUtils::create_proof_of_custody(path content, const uint32_t n, const
    free(buf_str);
    get_u_from_seed(seedForU, u);
 
-
-   //read sigmas
-   element_t* sigmas = new element_t[n];
-   char buffer[DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED];
-   try {
-   for( int i = 0; i < n; i++ ) {
-      uint64_t pos = cusfile.tellg();
-      cusfile.read(&buffer[0], DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED);
-//      if(cusfile.readsome(buffer, DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED) != DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED )
-//         return -9;
-      element_init_G1(sigmas[i], pairing);
-      element_from_bytes_compressed(sigmas[i], (unsigned char *) buffer);
-   } 
-   } catch (std::exception e){
-      wlog("Exception caught: ${s}", ("s", e.what() )); 
-      return -8;
-   }
-
    //read the file and get m's
 
    unsigned int nReal;
    nReal = get_n(infile);
    //split_file(infile, nReal, &m);
-   if( nReal != n )
-      return -7;
+   if( nReal != n || cusfile.size() < (uint64_t) n * DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED ) {
+      element_clear(public_key);
+      mpz_clear(seedForU);
+      clear_elements(u, DECENT_SECTORS);
+      return nReal != n ? -7 : -9;
+   }
 
    //generate query
    unsigned int q = get_number_of_query(n);
@@ -628,12 +673,21 @@ int CustodyUtils::create_proof_of_custody(path content, const uint32_t n, const
    element_t *v;
    generate_query_from_seed(seed, q, n, indices, &v);
 
+   //read the sigmas of the challenged blocks only
+   element_t sigmas[16];
+   char buffer[DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED];
+   for( int i = 0; i < q; i++ ) {
+      cusfile.read_at(indices[i] * DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED, buffer, DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED);
+      element_init_G1(sigmas[i], pairing);
+      element_from_bytes_compressed(sigmas[i], (unsigned char *) buffer);
+   }
+
    //calculate mu and sigma
    element_t mu[DECENT_SECTORS];
    compute_mu(infile, q, indices, v, mu);
 
    element_t _sigma;
-   compute_sigma(sigmas, q, indices, v, _sigma);
+   compute_sigma(sigmas, q, v, _sigma);
 
    //pack the proof
    element_to_bytes_compressed(sigma, _sigma);
@@ -651,7 +705,7 @@ int CustodyUtils::create_proof_of_custody(path content, const uint32_t n, const
    //TODO_DECENT
    int res = verify_by_miner(n, u_seed, pubKey, sigma, mus, seed);
 
-   clear_elements(sigmas, n);
+   clear_elements(sigmas, q);
    element_clear(_sigma);
 
    element_clear(public_key);
@@ -659,11 +713,35 @@ int CustodyUtils::create_proof_of_custody(path content, const uint32_t n, const
    clear_elements(u, DECENT_SECTORS);
    clear_elements(mu, DECENT_SECTORS);
    clear_elements(v, q);
-   delete[] (sigmas);
    delete[](v);
    return res;
 }
 
+void CustodyUtils::get_proof_ranges(const uint32_t n, const CustodyProof& proof,
+                                    std::vector<std::pair<uint64_t, uint64_t>>& content_ranges,
+                                    std::vector<std::pair<uint64_t, uint64_t>>& custody_ranges) {
+   mpz_t seed;
+   mpz_init(seed);
+   mpz_import(seed, 5, 1, sizeof(uint32_t), 0, 0, proof.seed.data);
+
+   unsigned int q = get_number_of_query(n);
+   uint64_t indices[16];
+   element_t *v;
+   generate_query_from_seed(seed, q, n, indices, &v);
+
+   content_ranges.clear();
+   custody_ranges.clear();
+   const uint64_t block_size = DECENT_SIZE_OF_NUMBER_IN_THE_FIELD * DECENT_SECTORS;
+   for( int i = 0; i < q; i++ ) {
+      content_ranges.emplace_back(indices[i] * block_size, block_size);
+      custody_ranges.emplace_back(indices[i] * DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED, DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED);
+   }
+
+   clear_elements(v, q);
+   delete[](v);
+   mpz_clear(seed);
+}
+
 
 }
 }
@@ -58,7 +58,7 @@ namespace encrypt{
 
 using namespace boost::filesystem;
 
-
+class custody_file;
 
 
 class CustodyUtils
@@ -147,6 +147,16 @@ public:
     */
    int create_proof_of_custody(boost::filesystem::path content, const uint32_t n, const char u_seed[], unsigned char pubKey[],
                                unsigned char sigma[], std::vector<std::string> &mus, mpz_t seed);
+   /**
+    * Byte ranges of content.zip.aes and content.cus read by create_proof_of_custody for the seed of the proof. Nothing
+    * else of the two files is read, so the proof can be created from sparse copies holding just these ranges.
+    * @param n number of signatures
+    * @param proof proof with the seed set
+    * @param content_ranges output - offset and size of the challenged blocks in content.zip.aes, may reach past its end
+    * @param custody_ranges output - offset and size of their signatures in content.cus
+    */
+   void get_proof_ranges(const uint32_t n, const CustodyProof& proof, std::vector<std::pair<uint64_t, uint64_t>>& content_ranges,
+                         std::vector<std::pair<uint64_t, uint64_t>>& custody_ranges);
 
 private:
    element_t generator;
@@ -156,22 +166,25 @@ private:
     * Calculate sigmas based on formula
     * TODO_DECENT rework to stram version
     */
-   int get_sigmas(std::fstream &file, const unsigned int n, element_t *u, element_t pk, element_t **sigmas);
+   int get_sigmas(const custody_file &file, const unsigned int n, element_t *u, element_t pk, element_t **sigmas);
    /*
     * Generates u from seed seedU. The array must be initalized to at least DECENT_SIZE_OF_POINT_ON_CURVE_COMPRESSED elements
     */
    int get_u_from_seed(const mpz_t &seedU, element_t out[]);
    int generate_query_from_seed(mpz_t seed, unsigned int q, unsigned int n, uint64_t indices[], element_t* v[]);
-   int compute_mu(std::fstream& file, unsigned int q, uint64_t indices[], element_t v[], element_t mu[]);
-   int compute_sigma(element_t *sigmas, unsigned int q, uint64_t *indices, element_t *v, element_t &sigma);
+   int compute_mu(const custody_file& file, unsigned int q, uint64_t indices[], element_t v[], element_t mu[]);
+   /*
+    * sigmas are the signatures of the challenged blocks, in the order of indices
+    */
+   int compute_sigma(element_t *sigmas, unsigned int q, element_t *v, element_t &sigma);
    int get_sigma( uint64_t pidx, mpz_t mi[], element_pp_t u_pp[], element_t pk, element_t out[]);
    int verify(element_t sigma, unsigned int q, uint64_t *indices, element_t *v, element_t *u, element_t *mu, element_t pubk);
    int clear_elements(element_t *array, int size);
    int unpack_proof(valtype proof, element_t &sigma, element_t **mu);
    int get_number_of_query(int blocks);
-   int get_n(std::fstream &file);
-   inline int get_m(std::fstream &file, uint32_t i, uint32_t j, mpz_t& out);
-   inline int get_data(std::fstream &file, uint32_t i, char buffer[]);
+   int get_n(const custody_file &file);
+   inline int get_m(const custody_file &file, uint32_t i, uint32_t j, mpz_t& out);
+   inline int get_data(const custody_file &file, uint32_t i, char buffer[]);
 };
 
 
@@ -102,4 +102,13 @@
  */
 #define GRAPHENE_NET_MIN_BLOCK_IDS_TO_PREFETCH               10000
 
+/**
+ * Sync blocks have their block id and merkle root checked on a small pool of
+ * worker threads before they are handed to the client.  The pool never grows
+ * beyond this many threads, and each pass over the backlog checks at most
+ * GRAPHENE_NET_SYNC_PREVALIDATION_BATCH_SIZE blocks before yielding
+ */
+#define GRAPHENE_NET_MAX_SYNC_PREVALIDATION_THREADS          4
+#define GRAPHENE_NET_SYNC_PREVALIDATION_BATCH_SIZE           200
+
 #define GRAPHENE_NET_MAX_TRX_PER_SECOND                      1000
@@ -26,6 +26,7 @@
 
 #include <graphene/net/config.hpp>
 #include <graphene/chain/protocol/block.hpp>
+#include <graphene/chain/protocol/transaction_metadata.hpp>
 
 #include <fc/crypto/ripemd160.hpp>
 #include <fc/crypto/elliptic.hpp>
@@ -45,6 +46,7 @@ namespace graphene { namespace net {
   using graphene::chain::block_id_type;
   using graphene::chain::transaction_id_type;
   using graphene::chain::signed_block;
+  using graphene::chain::block_metadata_ptr;
 
   typedef fc::ecc::public_key_data node_id_t;
   typedef fc::ripemd160 item_hash_t;
@@ -114,6 +116,8 @@ namespace graphene { namespace net {
       signed_block    block;
       block_id_type   block_id;
 
+      /** computed locally by the prevalidation threads and handed to the chain with the block, not serialized */
+      block_metadata_ptr metadata;
    };
 
   struct item_ids_inventory_message
@@ -80,6 +80,18 @@ namespace graphene { namespace net {
           */
          virtual bool handle_block( const graphene::net::block_message& blk_msg, bool sync_mode, 
                                     std::vector<fc::uint160_t>& contained_transaction_message_ids ) = 0;
+
+         /**
+          *  @brief Called with a run of sync blocks in chain order
+          *
+          *  The blocks are handled in order like handle_block() in sync mode, in one call so the run
+          *  crosses to the client's thread once.  Handling stops at the first block the client rejects.
+          *
+          *  @param error set to the exception the rejected block was rejected with
+          *  @returns the number of blocks accepted, the rejected block (if any) is the one following them
+          */
+         virtual size_t handle_sync_blocks( const std::vector<graphene::net::block_message>& blk_msgs,
+                                            fc::exception_ptr& error ) = 0;
          
          /**
           *  @brief Called when a new transaction comes in from the network
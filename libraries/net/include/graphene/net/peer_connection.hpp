@@ -230,6 +230,10 @@ namespace graphene { namespace net
       item_hash_t last_block_delegate_has_seen; /// the hash of the last block  this peer has told us about that the peer knows
       fc::time_point_sec last_block_time_delegate_has_seen;
       bool inhibit_fetching_sync_blocks;
+      uint32_t number_of_sync_blocks_received; /// sync blocks this peer has delivered to us, used to report per-peer sync throughput
+      uint64_t sync_block_bytes_received;
+      fc::time_point first_sync_block_received_time;
+      fc::time_point last_sync_block_received_time;
       /// @}
 
       /// non-synchronization state data
@@ -308,6 +312,7 @@ namespace graphene { namespace net
       bool is_inventory_advertised_to_us_list_full_for_transactions() const;
       bool is_inventory_advertised_to_us_list_full() const;
       bool performing_firewall_check() const;
+      double get_sync_blocks_per_second() const;
       fc::optional<fc::ip::endpoint> get_endpoint_for_connecting() const;
     private:
       void send_queued_messages_task();
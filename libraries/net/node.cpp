@@ -31,6 +31,7 @@
 #include <iostream>
 #include <algorithm>
 #include <tuple>
+#include <thread>
 #include <boost/tuple/tuple.hpp>
 #include <boost/circular_buffer.hpp>
 
@@ -289,6 +290,7 @@ namespace graphene { namespace net { namespace detail {
 #define NODE_DELEGATE_METHOD_NAMES (has_item) \
                                    (handle_message) \
                                    (handle_block) \
+                                   (handle_sync_blocks) \
                                    (handle_transaction) \
                                    (get_block_ids) \
                                    (get_item) \
@@ -385,6 +387,7 @@ namespace graphene { namespace net { namespace detail {
       bool has_item( const net::item_id& id ) override;
       void handle_message( const message& ) override;
       bool handle_block( const graphene::net::block_message& block_message, bool sync_mode, std::vector<fc::uint160_t>& contained_transaction_message_ids ) override;
+      size_t handle_sync_blocks( const std::vector<graphene::net::block_message>& block_messages, fc::exception_ptr& error ) override;
       void handle_transaction( const graphene::net::trx_message& transaction_message ) override;
       std::vector<item_hash_t> get_block_ids(const std::vector<item_hash_t>& blockchain_synopsis,
                                              uint32_t& remaining_item_count,
@@ -406,6 +409,32 @@ namespace graphene { namespace net { namespace detail {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+    /** a block we've received during sync but not yet handed to the client.  The block id, the
+     * merkle root and the signatures of the block and its transactions are checked on one of the
+     * prevalidation threads before the block is allowed to leave the backlog, and the hashes and
+     * keys computed for the checks go along with the block */
+    struct received_sync_item
+    {
+      enum prevalidation_state_enum
+      {
+        prevalidation_pending,
+        prevalidation_in_progress,
+        prevalidation_passed,
+        prevalidation_failed
+      };
+
+      graphene::net::block_message block_message;
+      prevalidation_state_enum     prevalidation_state;
+      fc::oexception               prevalidation_error;
+
+      received_sync_item(const graphene::net::block_message& block_message) :
+        block_message(block_message),
+        prevalidation_state(prevalidation_pending)
+      {}
+      bool prevalidation_done() const { return prevalidation_state == prevalidation_passed || prevalidation_state == prevalidation_failed; }
+    };
+    typedef std::unordered_map<graphene::net::block_id_type, received_sync_item> received_sync_items_map;
+
     class node_impl : public peer_connection_delegate
     {
     public:
@@ -450,11 +479,13 @@ namespace graphene { namespace net { namespace detail {
       typedef std::unordered_map<graphene::net::block_id_type, fc::time_point> active_sync_requests_map;
 
       active_sync_requests_map              _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
-      std::list<graphene::net::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
-      std::list<graphene::net::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+      received_sync_items_map               _received_sync_items; /// sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+      std::list<graphene::net::block_id_type> _sync_items_awaiting_prevalidation; /// ids of entries in _received_sync_items whose header checks haven't been started yet
       // @}
 
       fc::future<void> _process_backlog_of_sync_blocks_done;
+      fc::future<void> _prevalidate_sync_blocks_done;
+      std::vector<std::unique_ptr<fc::thread> > _sync_prevalidation_threads; /// worker threads that check block ids and merkle roots of sync blocks off the p2p thread
       bool _suspend_fetching_sync_blocks;
 
       /// used by the task that fetches items during normal operation
@@ -681,9 +712,19 @@ namespace graphene { namespace net { namespace detail {
 
       void on_connection_closed(peer_connection* originating_peer) override;
 
-      void send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send);
+      void send_sync_blocks_to_node_delegate(const std::vector<graphene::net::block_message>& blocks_to_send,
+                                             const fc::oexception& prevalidation_error = fc::oexception());
+      void process_sync_block_result(const graphene::net::block_message& block_message_to_send,
+                                     bool client_accepted_block,
+                                     bool discontinue_fetching_blocks_from_peer,
+                                     const fc::oexception& handle_message_exception,
+                                     std::set<peer_connection_ptr>& peers_with_newly_empty_item_lists,
+                                     std::set<peer_connection_ptr>& peers_we_need_to_sync_to,
+                                     std::map<peer_connection_ptr, std::pair<std::string, fc::oexception> >& peers_to_disconnect);
       void process_backlog_of_sync_blocks();
       void trigger_process_backlog_of_sync_blocks();
+      void prevalidate_sync_blocks();
+      void trigger_prevalidate_sync_blocks();
       void process_block_during_sync(peer_connection* originating_peer, const graphene::net::block_message& block_message, const message_hash_type& message_hash);
       void process_block_during_normal_operation(peer_connection* originating_peer, const graphene::net::block_message& block_message, const message_hash_type& message_hash);
       void process_block_message(peer_connection* originating_peer, const message& message_to_process, const message_hash_type& message_hash);
@@ -830,6 +871,11 @@ namespace graphene { namespace net { namespace detail {
     {
       _rate_limiter.set_actual_rate_time_constant(fc::seconds(2));
       fc::rand_pseudo_bytes(&_node_id.data[0], (int)_node_id.size());
+
+      unsigned number_of_prevalidation_threads = std::min<unsigned>(GRAPHENE_NET_MAX_SYNC_PREVALIDATION_THREADS,
+                                                                    std::max<unsigned>(1, std::thread::hardware_concurrency()));
+      for (unsigned i = 0; i < number_of_prevalidation_threads; ++i)
+        _sync_prevalidation_threads.emplace_back(new fc::thread("p2p_sync_prevalidation_" + std::to_string(i)));
     }
 
     node_impl::~node_impl()
@@ -995,10 +1041,7 @@ namespace graphene { namespace net { namespace detail {
     bool node_impl::have_already_received_sync_item( const item_hash_t& item_hash )
     {
       VERIFY_CORRECT_THREAD();
-      return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _received_sync_items.end() ||
-             std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();                          ;
+      return _received_sync_items.find(item_hash) != _received_sync_items.end();
     }
 
     void node_impl::request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request )
@@ -3009,54 +3052,127 @@ namespace graphene { namespace net { namespace detail {
       schedule_peer_for_deletion(originating_peer_ptr);
     }
 
-    void node_impl::send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send)
+    void node_impl::send_sync_blocks_to_node_delegate(const std::vector<graphene::net::block_message>& blocks_to_send,
+                                                      const fc::oexception& prevalidation_error /* = fc::oexception() */)
     {
-      dlog("in send_sync_block_to_node_delegate()");
-      bool client_accepted_block = false;
-      bool discontinue_fetching_blocks_from_peer = false;
+      dlog("in send_sync_blocks_to_node_delegate()");
 
-      fc::oexception handle_message_exception;
+      // build up lists for any potentially-blocking operations we need to do, then do them
+      // at the end of this function
+      std::set<peer_connection_ptr> peers_with_newly_empty_item_lists;
+      std::set<peer_connection_ptr> peers_we_need_to_sync_to;
+      std::map<peer_connection_ptr, std::pair<std::string, fc::oexception> > peers_to_disconnect; // map peer -> pair<reason_string, exception>
 
-      try
+      size_t next_block = 0;
+      while (next_block < blocks_to_send.size())
       {
-        std::vector<fc::uint160_t> contained_transaction_message_ids;
-        _delegate->handle_block(block_message_to_send, true, contained_transaction_message_ids);
-        ilog("Successfully pushed sync block ${num} (id:${id})",
-             ("num", block_message_to_send.block.block_num())
-             ("id", block_message_to_send.block_id));
-        _most_recent_blocks_accepted.push_back(block_message_to_send.block_id);
+        size_t blocks_accepted = 0;
+        fc::exception_ptr rejection;
+        try
+        {
+          // a block that failed the header checks on the prevalidation threads never reaches the client,
+          // but it goes through the same rejection path so the peers that offered it get disconnected
+          if (prevalidation_error)
+            throw *prevalidation_error;
+
+          // the run crosses to the client's thread in one call.  The client stops at the first block it
+          // rejects, the blocks after that one are handed over again in the next call
+          if (next_block == 0)
+            blocks_accepted = _delegate->handle_sync_blocks(blocks_to_send, rejection);
+          else
+            blocks_accepted = _delegate->handle_sync_blocks(std::vector<graphene::net::block_message>(blocks_to_send.begin() + next_block,
+                                                                                                      blocks_to_send.end()),
+                                                            rejection);
+        }
+        catch (const fc::canceled_exception&)
+        {
+          throw;
+        }
+        catch (const fc::exception& e)
+        {
+          rejection = e.dynamic_copy_exception();
+        }
 
-        client_accepted_block = true;
-      }
-      catch (const block_older_than_undo_history& e)
-      {
-        wlog("Failed to push sync block ${num} (id:${id}): block is on a fork older than our undo history would "
-             "allow us to switch to: ${e}",
-             ("num", block_message_to_send.block.block_num())
-             ("id", block_message_to_send.block_id)
-             ("e", (fc::exception)e));
-        handle_message_exception = e;
-        discontinue_fetching_blocks_from_peer = true;
-      }
-      catch (const fc::canceled_exception&)
-      {
-        throw;
+        for (size_t i = next_block; i < next_block + blocks_accepted; ++i)
+        {
+          const graphene::net::block_message& block_message_to_send = blocks_to_send[i];
+          ilog("Successfully pushed sync block ${num} (id:${id})",
+               ("num", block_message_to_send.block.block_num())
+               ("id", block_message_to_send.block_id));
+          _most_recent_blocks_accepted.push_back(block_message_to_send.block_id);
+          process_sync_block_result(block_message_to_send, true, false, fc::oexception(),
+                                    peers_with_newly_empty_item_lists, peers_we_need_to_sync_to, peers_to_disconnect);
+        }
+        next_block += blocks_accepted;
+        if (next_block == blocks_to_send.size())
+          break;
+
+        const graphene::net::block_message& block_message_to_send = blocks_to_send[next_block];
+        bool discontinue_fetching_blocks_from_peer = false;
+        fc::oexception handle_message_exception;
+        try
+        {
+          FC_ASSERT(rejection, "client stopped before sync block ${num} without rejecting it",
+                    ("num", block_message_to_send.block.block_num()));
+          rejection->dynamic_rethrow_exception();
+        }
+        catch (const block_older_than_undo_history& e)
+        {
+          wlog("Failed to push sync block ${num} (id:${id}): block is on a fork older than our undo history would "
+               "allow us to switch to: ${e}",
+               ("num", block_message_to_send.block.block_num())
+               ("id", block_message_to_send.block_id)
+               ("e", (fc::exception)e));
+          handle_message_exception = e;
+          discontinue_fetching_blocks_from_peer = true;
+        }
+        catch (const fc::exception& e)
+        {
+          wlog("Failed to push sync block ${num} (id:${id}): client rejected sync block sent by peer: ${e}",
+               ("num", block_message_to_send.block.block_num())
+               ("id", block_message_to_send.block_id)
+               ("e", e));
+          handle_message_exception = e;
+        }
+        process_sync_block_result(block_message_to_send, false, discontinue_fetching_blocks_from_peer, handle_message_exception,
+                                  peers_with_newly_empty_item_lists, peers_we_need_to_sync_to, peers_to_disconnect);
+        ++next_block;
       }
-      catch (const fc::exception& e)
+
+      for (auto& peer_to_disconnect : peers_to_disconnect)
       {
-        wlog("Failed to push sync block ${num} (id:${id}): client rejected sync block sent by peer: ${e}",
-             ("num", block_message_to_send.block.block_num())
-             ("id", block_message_to_send.block_id)
-             ("e", e));
-        handle_message_exception = e;
+        const peer_connection_ptr& peer = peer_to_disconnect.first;
+        std::string reason_string;
+        fc::oexception reason_exception;
+        std::tie(reason_string, reason_exception) = peer_to_disconnect.second;
+        wlog("disconnecting client ${endpoint} because it offered us the rejected block",
+             ("endpoint", peer->get_remote_endpoint()));
+        disconnect_from_peer(peer.get(), reason_string, true, reason_exception);
       }
+      for (const peer_connection_ptr& peer : peers_with_newly_empty_item_lists)
+        fetch_next_batch_of_item_ids_from_peer(peer.get());
 
-      // build up lists for any potentially-blocking operations we need to do, then do them
-      // at the end of this function
-      std::set<peer_connection_ptr> peers_with_newly_empty_item_lists;
-      std::set<peer_connection_ptr> peers_we_need_to_sync_to;
-      std::map<peer_connection_ptr, std::pair<std::string, fc::oexception> > peers_to_disconnect; // map peer -> pair<reason_string, exception>
+      for (const peer_connection_ptr& peer : peers_we_need_to_sync_to)
+        start_synchronizing_with_peer(peer);
+
+      dlog("Leaving send_sync_blocks_to_node_delegate");
+
+      if (// _suspend_fetching_sync_blocks && <-- you can use this if "maximum_number_of_blocks_to_handle_at_one_time" == "maximum_number_of_sync_blocks_to_prefetch"
+          !_node_is_shutting_down &&
+          (!_process_backlog_of_sync_blocks_done.valid() || _process_backlog_of_sync_blocks_done.ready()))
+        _process_backlog_of_sync_blocks_done = fc::async([=](){ process_backlog_of_sync_blocks(); },
+                                                         "process_backlog_of_sync_blocks");
+    }
 
+
+    void node_impl::process_sync_block_result(const graphene::net::block_message& block_message_to_send,
+                                              bool client_accepted_block,
+                                              bool discontinue_fetching_blocks_from_peer,
+                                              const fc::oexception& handle_message_exception,
+                                              std::set<peer_connection_ptr>& peers_with_newly_empty_item_lists,
+                                              std::set<peer_connection_ptr>& peers_we_need_to_sync_to,
+                                              std::map<peer_connection_ptr, std::pair<std::string, fc::oexception> >& peers_to_disconnect)
+    {
       if( client_accepted_block )
       {
         --_total_number_of_unfetched_items;
@@ -3153,30 +3269,6 @@ namespace graphene { namespace net { namespace detail {
           }
         }
       }
-
-      for (auto& peer_to_disconnect : peers_to_disconnect)
-      {
-        const peer_connection_ptr& peer = peer_to_disconnect.first;
-        std::string reason_string;
-        fc::oexception reason_exception;
-        std::tie(reason_string, reason_exception) = peer_to_disconnect.second;
-        wlog("disconnecting client ${endpoint} because it offered us the rejected block",
-             ("endpoint", peer->get_remote_endpoint()));
-        disconnect_from_peer(peer.get(), reason_string, true, reason_exception);
-      }
-      for (const peer_connection_ptr& peer : peers_with_newly_empty_item_lists)
-        fetch_next_batch_of_item_ids_from_peer(peer.get());
-
-      for (const peer_connection_ptr& peer : peers_we_need_to_sync_to)
-        start_synchronizing_with_peer(peer);
-
-      dlog("Leaving send_sync_block_to_node_delegate");
-
-      if (// _suspend_fetching_sync_blocks && <-- you can use this if "maximum_number_of_blocks_to_handle_at_one_time" == "maximum_number_of_sync_blocks_to_prefetch"
-          !_node_is_shutting_down &&
-          (!_process_backlog_of_sync_blocks_done.valid() || _process_backlog_of_sync_blocks_done.ready()))
-        _process_backlog_of_sync_blocks_done = fc::async([=](){ process_backlog_of_sync_blocks(); },
-                                                         "process_backlog_of_sync_blocks");
     }
 
     void node_impl::process_backlog_of_sync_blocks()
@@ -3215,79 +3307,97 @@ namespace graphene { namespace net { namespace detail {
       //fc::time_point start_time = fc::time_point::now();
       //fc::time_point when_we_should_yield = start_time + fc::seconds(1);
 
-      bool block_processed_this_iteration;
       unsigned blocks_processed = 0;
 
-      std::set<peer_connection_ptr> peers_with_newly_empty_item_lists;
-      std::set<peer_connection_ptr> peers_we_need_to_sync_to;
-      std::map<peer_connection_ptr, fc::oexception> peers_with_rejected_block;
+      // the blocks of a run go to the client in one call.  The call has an entry per block in
+      // _handle_message_calls_in_progress, so the limits keep counting blocks
+      std::vector<graphene::net::block_message> run_of_sync_blocks;
+      auto send_sync_blocks = [this](std::vector<graphene::net::block_message>& blocks_to_send, const fc::oexception& prevalidation_error) {
+        const size_t number_of_blocks = blocks_to_send.size();
+        if (number_of_blocks == 0)
+          return;
+        std::shared_ptr<const std::vector<graphene::net::block_message> > blocks =
+          std::make_shared<std::vector<graphene::net::block_message> >(std::move(blocks_to_send));
+        blocks_to_send.clear();
+        fc::future<void> handled = fc::async([this, blocks, prevalidation_error](){
+          send_sync_blocks_to_node_delegate(*blocks, prevalidation_error);
+        }, "send_sync_blocks_to_node_delegate");
+        _handle_message_calls_in_progress.insert(_handle_message_calls_in_progress.end(), number_of_blocks, handled);
+      };
 
-      do
+      // Blocks in the backlog are keyed by id, so instead of scanning the whole backlog for the next
+      // block to push we only look at the block each peer expects next.  Every pass costs O(number of
+      // peers), and consecutive passes walk down a contiguous run of blocks until we reach one that
+      // hasn't arrived yet or hasn't finished its header checks.
+      dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
+      while (_handle_message_calls_in_progress.size() + run_of_sync_blocks.size() < _maximum_number_of_blocks_to_handle_at_one_time)
       {
-        std::copy(std::make_move_iterator(_new_received_sync_items.begin()),
-                  std::make_move_iterator(_new_received_sync_items.end()),
-                  std::front_inserter(_received_sync_items));
-        _new_received_sync_items.clear();
-        dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
-
-        block_processed_this_iteration = false;
-        for (auto received_block_iter = _received_sync_items.begin();
-             received_block_iter != _received_sync_items.end();
-             ++received_block_iter)
+        received_sync_items_map::iterator next_block_iter = _received_sync_items.end();
+        for (const peer_connection_ptr& peer : _active_connections)
         {
-
-          // find out if this block is the next block on the active chain or one of the forks
-          bool potential_first_block = false;
-          for (const peer_connection_ptr& peer : _active_connections)
+          ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+          if (!peer->ids_of_items_to_get.empty())
           {
-            ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
-            if (!peer->ids_of_items_to_get.empty() &&
-                peer->ids_of_items_to_get.front() == received_block_iter->block_id)
+            received_sync_items_map::iterator iter = _received_sync_items.find(peer->ids_of_items_to_get.front());
+            if (iter != _received_sync_items.end() && iter->second.prevalidation_done())
             {
-              potential_first_block = true;
-              peer->ids_of_items_to_get.pop_front();
-              peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
+              next_block_iter = iter;
+              break;
             }
           }
+        }
+        if (next_block_iter == _received_sync_items.end())
+          break;
 
-          // if it is, process it, remove it from all sync peers lists
-          if (potential_first_block)
+        // remove it from all sync peers lists
+        const graphene::net::block_id_type next_block_id = next_block_iter->first;
+        for (const peer_connection_ptr& peer : _active_connections)
+        {
+          ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+          if (!peer->ids_of_items_to_get.empty() &&
+              peer->ids_of_items_to_get.front() == next_block_id)
           {
-            // we can get into an interesting situation near the end of synchronization.  We can be in
-            // sync with one peer who is sending us the last block on the chain via a regular inventory
-            // message, while at the same time still be synchronizing with a peer who is sending us the
-            // block through the sync mechanism.  Further, we must request both blocks because
-            // we don't know they're the same (for the peer in normal operation, it has only told us the
-            // message id, for the peer in the sync case we only known the block_id).
-            if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                          received_block_iter->block_id) == _most_recent_blocks_accepted.end())
-            {
-              graphene::net::block_message block_message_to_process = *received_block_iter;
-              _received_sync_items.erase(received_block_iter);
-              _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
-                send_sync_block_to_node_delegate(block_message_to_process);
-              }, "send_sync_block_to_node_delegate"));
-              ++blocks_processed;
-              block_processed_this_iteration = true;
-            }
-            else
-              dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+            peer->ids_of_items_to_get.pop_front();
+            peer->ids_of_items_being_processed.insert(next_block_id);
+          }
+        }
 
-            break; // start iterating _received_sync_items from the beginning
-          } // end if potential_first_block
-        } // end for each block in _received_sync_items
+        graphene::net::block_message block_message_to_process = std::move(next_block_iter->second.block_message);
+        fc::oexception prevalidation_error = next_block_iter->second.prevalidation_error;
+        _received_sync_items.erase(next_block_iter);
 
-        if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
+        // we can get into an interesting situation near the end of synchronization.  We can be in
+        // sync with one peer who is sending us the last block on the chain via a regular inventory
+        // message, while at the same time still be synchronizing with a peer who is sending us the
+        // block through the sync mechanism.  Further, we must request both blocks because
+        // we don't know they're the same (for the peer in normal operation, it has only told us the
+        // message id, for the peer in the sync case we only known the block_id).
+        if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                      next_block_id) == _most_recent_blocks_accepted.end())
         {
-          dlog("stopping processing sync block backlog because we have ${count} blocks in progress",
-               ("count", _handle_message_calls_in_progress.size()));
-          //ulog("stopping processing sync block backlog because we have ${count} blocks in progress, total on hand: ${received}",
-          //     ("count", _handle_message_calls_in_progress.size())("received", _received_sync_items.size()));
-          if (_received_sync_items.size() >= _maximum_number_of_sync_blocks_to_prefetch)
-            _suspend_fetching_sync_blocks = true;
-          break;
+          if (prevalidation_error)
+          {
+            // a block that failed its checks ends the run and is handed over on its own to be rejected
+            send_sync_blocks(run_of_sync_blocks, fc::oexception());
+            std::vector<graphene::net::block_message> rejected_block(1, std::move(block_message_to_process));
+            send_sync_blocks(rejected_block, prevalidation_error);
+          }
+          else
+            run_of_sync_blocks.push_back(std::move(block_message_to_process));
+          ++blocks_processed;
         }
-      } while (block_processed_this_iteration);
+        else
+          dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+      }
+      send_sync_blocks(run_of_sync_blocks, fc::oexception());
+
+      if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
+      {
+        dlog("stopping processing sync block backlog because we have ${count} blocks in progress",
+             ("count", _handle_message_calls_in_progress.size()));
+        if (_received_sync_items.size() >= _maximum_number_of_sync_blocks_to_prefetch)
+          _suspend_fetching_sync_blocks = true;
+      }
 
       dlog("leaving process_backlog_of_sync_blocks, ${count} processed", ("count", blocks_processed));
 
@@ -3308,10 +3418,111 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
       dlog( "received a sync block from peer ${endpoint}", ("endpoint", originating_peer->get_remote_endpoint() ) );
 
-      // add it to the front of _received_sync_items, then process _received_sync_items to try to
-      // pass as many messages as possible to the client.
-      _new_received_sync_items.push_front( block_message_to_process );
-      trigger_process_backlog_of_sync_blocks();
+      // add it to _received_sync_items and queue its header checks.  Once they finish, the backlog
+      // is processed to try to pass as many messages as possible to the client.
+      originating_peer->sync_block_bytes_received += fc::raw::pack_size( block_message_to_process );
+      originating_peer->last_sync_block_received_time = fc::time_point::now();
+      if( originating_peer->number_of_sync_blocks_received++ == 0 )
+        originating_peer->first_sync_block_received_time = originating_peer->last_sync_block_received_time;
+
+      if( _received_sync_items.emplace( block_message_to_process.block_id, received_sync_item( block_message_to_process ) ).second )
+      {
+        _sync_items_awaiting_prevalidation.push_back( block_message_to_process.block_id );
+        trigger_prevalidate_sync_blocks();
+      }
+    }
+
+    void node_impl::trigger_prevalidate_sync_blocks()
+    {
+      VERIFY_CORRECT_THREAD();
+      if (!_node_is_shutting_down &&
+          (!_prevalidate_sync_blocks_done.valid() || _prevalidate_sync_blocks_done.ready()))
+        _prevalidate_sync_blocks_done = fc::async([=](){ prevalidate_sync_blocks(); }, "prevalidate_sync_blocks");
+    }
+
+    void node_impl::prevalidate_sync_blocks()
+    {
+      VERIFY_CORRECT_THREAD();
+      while (!_sync_items_awaiting_prevalidation.empty() && !_node_is_shutting_down)
+      {
+        // hand out a batch of blocks round-robin to the prevalidation threads.  The blocks are copied
+        // into the tasks because _received_sync_items may change while we're waiting for them
+        std::vector<std::pair<graphene::net::block_id_type, fc::future<block_metadata_ptr> > > checks_in_progress;
+        while (!_sync_items_awaiting_prevalidation.empty() &&
+               checks_in_progress.size() < GRAPHENE_NET_SYNC_PREVALIDATION_BATCH_SIZE)
+        {
+          graphene::net::block_id_type block_id = _sync_items_awaiting_prevalidation.front();
+          _sync_items_awaiting_prevalidation.pop_front();
+          received_sync_items_map::iterator iter = _received_sync_items.find(block_id);
+          if (iter == _received_sync_items.end())
+            continue;
+          iter->second.prevalidation_state = received_sync_item::prevalidation_in_progress;
+
+          fc::thread* prevalidation_thread = _sync_prevalidation_threads[checks_in_progress.size() % _sync_prevalidation_threads.size()].get();
+          graphene::net::block_message block_message_to_check = iter->second.block_message;
+          const chain_id_type chain_id = _chain_id;
+          checks_in_progress.emplace_back(block_id, prevalidation_thread->async([block_message_to_check, chain_id]() -> block_metadata_ptr {
+            const signed_block& block = block_message_to_check.block;
+            FC_ASSERT(block.id() == block_message_to_check.block_id,
+                      "Block id ${actual} doesn't match the id the peer sent, ${claimed}",
+                      ("actual", block.id())("claimed", block_message_to_check.block_id));
+
+            // the transactions are serialized and hashed here once, the chain thread reuses the results.  The
+            // metadata owns copies of the transactions because the block message is copied on its way to the chain
+            std::shared_ptr<graphene::chain::block_metadata> metadata = std::make_shared<graphene::chain::block_metadata>();
+            std::vector<graphene::chain::digest_type> merkle_digests;
+            metadata->trx_metadata.reserve(block.transactions.size());
+            merkle_digests.reserve(block.transactions.size());
+            for (const graphene::chain::processed_transaction& transaction : block.transactions)
+            {
+              graphene::chain::transaction_metadata_ptr trx_metadata =
+                std::make_shared<graphene::chain::transaction_metadata>(static_cast<const signed_transaction&>(transaction));
+              merkle_digests.push_back(trx_metadata->merkle_digest(transaction.operation_results));
+              trx_metadata->id();
+              // a signature that can't be recovered, or signs twice, can't satisfy any authority
+              trx_metadata->signature_keys(chain_id);
+              metadata->trx_metadata.push_back(std::move(trx_metadata));
+            }
+            metadata->merkle_root = signed_block::calculate_merkle_root(std::move(merkle_digests));
+            FC_ASSERT(*metadata->merkle_root == block.transaction_merkle_root,
+                      "Merkle root of block ${id} doesn't match its transactions", ("id", block_message_to_check.block_id));
+
+            // whether the key belongs to the scheduled miner depends on the chain state, the chain thread compares them
+            metadata->signee = graphene::chain::public_key_type(block.signee());
+            return metadata;
+          }, "prevalidate_sync_block"));
+        }
+
+        for (auto& check : checks_in_progress)
+        {
+          fc::oexception prevalidation_error;
+          block_metadata_ptr metadata;
+          try
+          {
+            metadata = check.second.wait();
+          }
+          catch (const fc::canceled_exception&)
+          {
+            throw;
+          }
+          catch (const fc::exception& e)
+          {
+            wlog("Sync block ${id} failed prevalidation: ${e}", ("id", check.first)("e", e));
+            prevalidation_error = e;
+          }
+
+          received_sync_items_map::iterator iter = _received_sync_items.find(check.first);
+          if (iter != _received_sync_items.end())
+          {
+            iter->second.block_message.metadata = metadata;
+            iter->second.prevalidation_error = prevalidation_error;
+            iter->second.prevalidation_state = prevalidation_error ? received_sync_item::prevalidation_failed :
+                                                                     received_sync_item::prevalidation_passed;
+          }
+        }
+
+        trigger_process_backlog_of_sync_blocks();
+      }
     }
 
     void node_impl::process_block_during_normal_operation( peer_connection* originating_peer,
@@ -3934,6 +4145,24 @@ namespace graphene { namespace net { namespace detail {
         wlog( "Exception thrown while terminating P2P connect loop, ignoring" );
       }
 
+      try
+      {
+        _prevalidate_sync_blocks_done.cancel_and_wait("node_impl::close()");
+        dlog("Prevalidate sync blocks task terminated");
+      }
+      catch ( const fc::canceled_exception& )
+      {
+        dlog("Prevalidate sync blocks task terminated");
+      }
+      catch ( const fc::exception& e )
+      {
+        wlog( "Exception thrown while terminating Prevalidate sync blocks task, ignoring: ${e}", ("e", e) );
+      }
+      catch (...)
+      {
+        wlog( "Exception thrown while terminating Prevalidate sync blocks task, ignoring" );
+      }
+
       try
       {
         _process_backlog_of_sync_blocks_done.cancel_and_wait("node_impl::close()");
@@ -4668,6 +4897,10 @@ namespace graphene { namespace net { namespace detail {
           ilog( "              above peer has ${count} sync items we might need", ("count", peer->ids_of_items_to_get.size() ) );
         if (peer->inhibit_fetching_sync_blocks)
           ilog( "              we are not fetching sync blocks from the above peer (inhibit_fetching_sync_blocks == true)" );
+        if (peer->number_of_sync_blocks_received)
+          ilog( "              above peer has sent us ${count} sync blocks (${bytes} bytes), ${rate} blocks/sec",
+               ("count", peer->number_of_sync_blocks_received)("bytes", peer->sync_block_bytes_received)
+               ("rate", peer->get_sync_blocks_per_second()) );
 
       }
       for( const peer_connection_ptr& peer : _handshaking_connections )
@@ -4679,7 +4912,7 @@ namespace graphene { namespace net { namespace detail {
       ilog( "--------- MEMORY USAGE ------------" );
       ilog( "node._active_sync_requests size: ${size}", ("size", _active_sync_requests.size() ) );
       ilog( "node._received_sync_items size: ${size}", ("size", _received_sync_items.size() ) );
-      ilog( "node._new_received_sync_items size: ${size}", ("size", _new_received_sync_items.size() ) );
+      ilog( "node._sync_items_awaiting_prevalidation size: ${size}", ("size", _sync_items_awaiting_prevalidation.size() ) );
       ilog( "node._items_to_fetch size: ${size}", ("size", _items_to_fetch.size() ) );
       ilog( "node._new_inventory size: ${size}", ("size", _new_inventory.size() ) );
       ilog( "node._message_cache size: ${size}", ("size", _message_cache.size() ) );
@@ -4842,6 +5075,10 @@ namespace graphene { namespace net { namespace detail {
         peer_details["current_head_block_number"] = _delegate->get_block_number(peer->last_block_delegate_has_seen);
         peer_details["current_head_block_time"] = peer->last_block_time_delegate_has_seen;
 
+        peer_details["sync_blocks_received"] = peer->number_of_sync_blocks_received;
+        peer_details["sync_bytes_received"] = peer->sync_block_bytes_received;
+        peer_details["sync_blocks_per_second"] = peer->get_sync_blocks_per_second();
+
         this_peer_status.info = peer_details;
         statuses.push_back(this_peer_status);
       }
@@ -5402,6 +5639,11 @@ namespace graphene { namespace net { namespace detail {
       INVOKE_AND_COLLECT_STATISTICS(handle_block, block_message, sync_mode, contained_transaction_message_ids);
     }
 
+    size_t statistics_gathering_node_delegate_wrapper::handle_sync_blocks( const std::vector<graphene::net::block_message>& block_messages, fc::exception_ptr& error )
+    {
+      INVOKE_AND_COLLECT_STATISTICS(handle_sync_blocks, block_messages, error);
+    }
+
     void statistics_gathering_node_delegate_wrapper::handle_transaction( const graphene::net::trx_message& transaction_message )
     {
       INVOKE_AND_COLLECT_STATISTICS(handle_transaction, transaction_message);
@@ -84,6 +84,8 @@ namespace graphene { namespace net
       peer_needs_sync_items_from_us(true),
       we_need_sync_items_from_peer(true),
       inhibit_fetching_sync_blocks(false),
+      number_of_sync_blocks_received(0),
+      sync_block_bytes_received(0),
       transaction_fetching_inhibited_until(fc::time_point::min()),
       last_known_fork_block_number(0),
       firewall_check_state(nullptr)
@@ -507,6 +509,16 @@ namespace graphene { namespace net
       return firewall_check_state && firewall_check_state->requesting_peer != node_id_t();
     }
 
+    double peer_connection::get_sync_blocks_per_second() const
+    {
+      if (number_of_sync_blocks_received < 2)
+        return 0.0;
+      int64_t elapsed_microseconds = (last_sync_block_received_time - first_sync_block_received_time).count();
+      if (elapsed_microseconds <= 0)
+        return 0.0;
+      return (number_of_sync_blocks_received - 1) * 1000000.0 / elapsed_microseconds;
+    }
+
     fc::optional<fc::ip::endpoint> peer_connection::get_endpoint_for_connecting() const
     {
       if (inbound_port)
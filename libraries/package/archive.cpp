@@ -0,0 +1,562 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#include "archive.hpp"
+#include "detail.hpp"
+
+#include <fc/exception/exception.hpp>
+
+#include <boost/crc.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/restrict.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <thread>
+
+
+using namespace boost::filesystem;
+
+
+namespace decent { namespace package {
+
+
+namespace detail {
+
+
+    namespace {
+
+#pragma pack(push,4)
+        struct ArchiveHeader {
+           char version;       // version of header, first verison is 1
+           char reserved1;
+           char reserved2;
+           char reserved3;
+           char name[256];
+           char size[8];
+           char reserved4[36];
+        };
+
+        struct ArchiveFileHeader {
+            char      magic[8];
+            uint32_t  version;
+            uint32_t  reserved;
+        };
+
+        struct ArchiveIndexEntry {
+            uint64_t  offset;
+            uint64_t  stored_size;
+            uint64_t  size;
+            uint32_t  crc32;
+            uint16_t  compression;
+            uint16_t  name_size;
+        };
+
+        struct ArchiveTrailer {
+            uint64_t  index_offset;
+            uint64_t  entry_count;
+            uint32_t  index_crc32;
+            uint32_t  reserved;
+            char      magic[8];
+        };
+#pragma pack(pop)
+
+        static_assert(sizeof(ArchiveHeader) == 304, "Bad size of ArchiveHeader");
+        static_assert(sizeof(ArchiveFileHeader) == 16, "Bad size of ArchiveFileHeader");
+        static_assert(sizeof(ArchiveIndexEntry) == 32, "Bad size of ArchiveIndexEntry");
+        static_assert(sizeof(ArchiveTrailer) == 32, "Bad size of ArchiveTrailer");
+
+        const char ARCHIVE_MAGIC[8] = { 'D', 'C', 'T', 'A', 'R', 'C', 'H', '\0' };
+
+        const size_t ARCHIVE_BLOCK_SIZE = 1024 * 1024; // 1Mb
+
+        // files gzip does not save a tenth of the first block of, like video, audio or images, are stored
+        bool is_compressible(const char* data, size_t size) {
+            std::vector<char> compressed;
+
+            boost::iostreams::filtering_ostream out;
+            out.push(boost::iostreams::gzip_compressor());
+            out.push(boost::iostreams::back_inserter(compressed));
+            out.write(data, size);
+            out.reset();
+
+            return compressed.size() < size - size / 10;
+        }
+
+        void copy_blocks(std::istream& in, std::ostream& out, uint64_t size, boost::crc_32_type& crc, std::vector<char>& buffer) {
+            while (size > 0) {
+                const std::streamsize chunk = static_cast<std::streamsize>(std::min<uint64_t>(size, buffer.size()));
+
+                in.read(buffer.data(), chunk);
+                if (in.gcount() != chunk) {
+                    FC_THROW("Unexpected end of data");
+                }
+
+                crc.process_bytes(buffer.data(), chunk);
+
+                out.write(buffer.data(), chunk);
+                if (!out) {
+                    FC_THROW("Unable to write data");
+                }
+
+                size -= chunk;
+            }
+        }
+
+        // the name of a file in the archive must not lead out of the output directory
+        void open_output_file(std::ofstream& sink, const path& output_dir, const std::string& file_name) {
+            const path file_path = output_dir / file_name;
+            const path file_dir = file_path.parent_path();
+
+            if (file_name.empty() || path(file_name).is_absolute() || !is_nested(file_path, output_dir)) {
+                FC_THROW("Invalid file name ${name} in archive", ("name", file_name) );
+            }
+
+            if (!exists(file_dir) || !is_directory(file_dir)) {
+                try {
+                    if (!create_directories(file_dir) && !is_directory(file_dir)) {
+                        FC_THROW("Unable to create ${dir} directory", ("dir", file_dir.string()) );
+                    }
+                }
+                catch (const boost::filesystem::filesystem_error& ex) {
+                    if (!is_directory(file_dir)) {
+                        FC_THROW("Unable to create ${dir} directory: ${error}", ("dir", file_dir.string()) ("error", ex.what()) );
+                    }
+                }
+            }
+
+            sink.open(file_path.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+            if (!sink.is_open()) {
+                FC_THROW("Unable to open file ${file} for writing", ("file", file_path.string()) );
+            }
+        }
+
+    } // namespace
+
+
+    Archiver::Archiver(const path& archive_path, uint32_t version)
+        : _archive_path(archive_path)
+        , _version(version)
+        , _finalized(false)
+    {
+        if (_version != 1 && _version != 2) {
+            FC_THROW("Unsupported version ${version} of archive ${file}", ("version", _version) ("file", archive_path.string()) );
+        }
+
+        _out.open(archive_path.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+        if (!_out.is_open()) {
+            FC_THROW("Unable to open file ${file} for writing", ("file", archive_path.string()) );
+        }
+
+        if (_version == 1) {
+            _gzip.push(boost::iostreams::gzip_compressor(), ARCHIVE_BLOCK_SIZE);
+            _gzip.push(_out, ARCHIVE_BLOCK_SIZE);
+            return;
+        }
+
+        ArchiveFileHeader header;
+
+        std::memset((void*)&header, 0, sizeof(header));
+        std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+        header.version = 2;
+
+        _out.write((const char*)&header, sizeof(header));
+    }
+
+    void Archiver::put(const std::string& file_name, const path& source_file_path) {
+        if (_finalized) {
+            FC_THROW("Archive ${file} is already finalized", ("file", _archive_path.string()) );
+        }
+
+        if (file_name.size() > (_version == 1 ? sizeof(ArchiveHeader::name) - 1 : std::numeric_limits<uint16_t>::max())) {
+            FC_THROW("File name ${name} is too long", ("name", file_name) );
+        }
+
+        std::ifstream in(source_file_path.string(), std::ios::in | std::ios::binary);
+
+        if (!in.is_open()) {
+            FC_THROW("Unable to open file ${file} for reading", ("file", source_file_path.string()) );
+        }
+
+        ArchiveEntry entry;
+        entry.name = file_name;
+        entry.size = file_size(source_file_path);
+
+        if (_version == 1) {
+            put_version_1(entry, in);
+        } else {
+            put_version_2(entry, in, source_file_path);
+        }
+
+        if (!_out) {
+            FC_THROW("Unable to write to ${file}", ("file", _archive_path.string()) );
+        }
+
+        _entries.push_back(entry);
+    }
+
+    void Archiver::put_version_1(ArchiveEntry& entry, std::istream& in) {
+        // the readers of version 1 take the size for a signed int
+        if (entry.size > uint64_t(std::numeric_limits<int32_t>::max())) {
+            FC_THROW("File ${name} is too big for an archive of version 1", ("name", entry.name) );
+        }
+
+        ArchiveHeader header;
+
+        std::memset((void*)&header, 0, sizeof(header));
+        header.version = 1;
+        std::memcpy(header.name, entry.name.data(), entry.name.size());
+
+        const int32_t size = static_cast<int32_t>(entry.size);
+        std::memcpy(header.size, &size, sizeof(size));
+
+        _gzip.write((const char*)&header, sizeof(header));
+
+        std::vector<char> buffer(ARCHIVE_BLOCK_SIZE);
+        boost::crc_32_type crc;
+        copy_blocks(in, _gzip, entry.size, crc, buffer);
+
+        entry.compression = ArchiveEntry::GZIP;
+        entry.crc32 = crc.checksum();
+    }
+
+    void Archiver::put_version_2(ArchiveEntry& entry, std::istream& in, const path& source_file_path) {
+        entry.offset = _out.tellp();
+
+        std::vector<char> buffer(ARCHIVE_BLOCK_SIZE);
+        in.read(buffer.data(), buffer.size());
+        const std::streamsize first_block = in.gcount();
+
+        if (uint64_t(first_block) > entry.size) {
+            FC_THROW("File ${file} changed while it was archived", ("file", source_file_path.string()) );
+        }
+
+        entry.compression = is_compressible(buffer.data(), first_block) ? ArchiveEntry::GZIP : ArchiveEntry::STORED;
+
+        boost::crc_32_type crc;
+        crc.process_bytes(buffer.data(), first_block);
+
+        const uint64_t rest_size = entry.size - first_block;
+
+        if (entry.compression == ArchiveEntry::GZIP) {
+            boost::iostreams::filtering_ostream out;
+            out.push(boost::iostreams::gzip_compressor(), ARCHIVE_BLOCK_SIZE);
+            out.push(_out, ARCHIVE_BLOCK_SIZE);
+            out.write(buffer.data(), first_block);
+            copy_blocks(in, out, rest_size, crc, buffer);
+            out.reset(); // writes the end of the gzip stream
+        } else {
+            _out.write(buffer.data(), first_block);
+            copy_blocks(in, _out, rest_size, crc, buffer);
+        }
+
+        entry.stored_size = uint64_t(_out.tellp()) - entry.offset;
+        entry.crc32 = crc.checksum();
+    }
+
+    void Archiver::finalize() {
+        if (_finalized) {
+            return;
+        }
+
+        if (_version == 1) {
+            // a header with an empty name ends the archive
+            ArchiveHeader header;
+
+            std::memset((void*)&header, 0, sizeof(header));
+            _gzip.write((const char*)&header, sizeof(header));
+            _gzip.reset(); // writes the end of the gzip stream
+            _out.close();
+
+            if (_out.fail()) {
+                FC_THROW("Unable to write to ${file}", ("file", _archive_path.string()) );
+            }
+
+            _finalized = true;
+            return;
+        }
+
+        ArchiveTrailer trailer;
+
+        std::memset((void*)&trailer, 0, sizeof(trailer));
+        trailer.index_offset = _out.tellp();
+        trailer.entry_count = _entries.size();
+
+        std::vector<char> index;
+
+        for (const auto& entry : _entries) {
+            ArchiveIndexEntry item;
+
+            std::memset((void*)&item, 0, sizeof(item));
+            item.offset = entry.offset;
+            item.stored_size = entry.stored_size;
+            item.size = entry.size;
+            item.crc32 = entry.crc32;
+            item.compression = entry.compression;
+            item.name_size = static_cast<uint16_t>(entry.name.size());
+
+            index.insert(index.end(), (const char*)&item, (const char*)&item + sizeof(item));
+            index.insert(index.end(), entry.name.begin(), entry.name.end());
+        }
+
+        boost::crc_32_type crc;
+        crc.process_bytes(index.data(), index.size());
+        trailer.index_crc32 = crc.checksum();
+        std::memcpy(trailer.magic, ARCHIVE_MAGIC, sizeof(trailer.magic));
+
+        _out.write(index.data(), index.size());
+        _out.write((const char*)&trailer, sizeof(trailer));
+        _out.close();
+
+        if (_out.fail()) {
+            FC_THROW("Unable to write to ${file}", ("file", _archive_path.string()) );
+        }
+
+        _finalized = true;
+    }
+
+
+    Dearchiver::Dearchiver(const path& archive_path)
+        : _archive_path(archive_path)
+        , _version(1)
+    {
+        std::ifstream in(archive_path.string(), std::ios::in | std::ios::binary);
+
+        if (!in.is_open()) {
+            FC_THROW("Unable to open file ${file} for reading", ("file", archive_path.string()) );
+        }
+
+        ArchiveFileHeader header;
+
+        std::memset((void*)&header, 0, sizeof(header));
+        in.read((char*)&header, sizeof(header));
+
+        // version 1 is a gzip stream, which starts with its own magic
+        if (in.gcount() != sizeof(header) || std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0) {
+            return;
+        }
+
+        if (header.version != 2) {
+            FC_THROW("Unsupported version ${version} of archive ${file}", ("version", header.version) ("file", archive_path.string()) );
+        }
+
+        _version = 2;
+
+        const uint64_t archive_size = file_size(archive_path);
+        ArchiveTrailer trailer;
+
+        std::memset((void*)&trailer, 0, sizeof(trailer));
+
+        if (archive_size >= sizeof(header) + sizeof(trailer)) {
+            in.seekg(archive_size - sizeof(trailer));
+            in.read((char*)&trailer, sizeof(trailer));
+        }
+
+        if (std::memcmp(trailer.magic, ARCHIVE_MAGIC, sizeof(trailer.magic)) != 0 ||
+            trailer.index_offset < sizeof(header) ||
+            trailer.index_offset > archive_size - sizeof(trailer)) {
+            FC_THROW("Archive ${file} is truncated", ("file", archive_path.string()) );
+        }
+
+        std::vector<char> index(archive_size - sizeof(trailer) - trailer.index_offset);
+        in.seekg(trailer.index_offset);
+        in.read(index.data(), index.size());
+
+        boost::crc_32_type crc;
+        crc.process_bytes(index.data(), index.size());
+
+        if (in.gcount() != std::streamsize(index.size()) || crc.checksum() != trailer.index_crc32) {
+            FC_THROW("Index of archive ${file} is damaged", ("file", archive_path.string()) );
+        }
+
+        size_t pos = 0;
+        // two entries of the same name would be extracted to the same file concurrently
+        std::set<std::string> names;
+
+        for (uint64_t i = 0; i < trailer.entry_count; ++i) {
+            ArchiveIndexEntry item;
+
+            if (index.size() - pos < sizeof(item)) {
+                FC_THROW("Index of archive ${file} is damaged", ("file", archive_path.string()) );
+            }
+
+            std::memcpy((void*)&item, index.data() + pos, sizeof(item));
+            pos += sizeof(item);
+
+            if (index.size() - pos < item.name_size ||
+                item.compression > ArchiveEntry::GZIP ||
+                item.offset < sizeof(header) ||
+                item.offset > trailer.index_offset ||
+                item.stored_size > trailer.index_offset - item.offset) {
+                FC_THROW("Index of archive ${file} is damaged", ("file", archive_path.string()) );
+            }
+
+            ArchiveEntry entry;
+            entry.name.assign(index.data() + pos, item.name_size);
+            entry.offset = item.offset;
+            entry.stored_size = item.stored_size;
+            entry.size = item.size;
+            entry.crc32 = item.crc32;
+            entry.compression = static_cast<ArchiveEntry::Compression>(item.compression);
+            pos += item.name_size;
+
+            if (!names.insert(entry.name).second) {
+                FC_THROW("File ${name} is listed twice in archive ${file}", ("name", entry.name) ("file", archive_path.string()) );
+            }
+
+            _entries.push_back(entry);
+        }
+    }
+
+    void Dearchiver::extract(const path& output_dir, unsigned thread_count) const {
+        if (_version == 1) {
+            extract_version_1(output_dir);
+            return;
+        }
+
+        if (thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        thread_count = static_cast<unsigned>(std::min<size_t>(thread_count, _entries.size()));
+
+        // the entries are independent, each thread takes the next one not extracted yet
+        std::atomic<size_t> next_entry(0);
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        auto worker = [&]() {
+            try {
+                for (size_t i = next_entry++; i < _entries.size(); i = next_entry++) {
+                    {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (error) {
+                            return;
+                        }
+                    }
+                    extract_entry(_entries[i], output_dir);
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < thread_count; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void Dearchiver::extract_file(const std::string& file_name, const path& output_dir) const {
+        if (_version == 1) {
+            FC_THROW("Archive ${file} of version 1 can be extracted only as a whole", ("file", _archive_path.string()) );
+        }
+
+        auto it = std::find_if(_entries.begin(), _entries.end(), [&file_name](const ArchiveEntry& entry) {
+            return entry.name == file_name;
+        });
+
+        if (it == _entries.end()) {
+            FC_THROW("File ${name} not found in archive ${file}", ("name", file_name) ("file", _archive_path.string()) );
+        }
+
+        extract_entry(*it, output_dir);
+    }
+
+    void Dearchiver::extract_entry(const ArchiveEntry& entry, const path& output_dir) const {
+        std::ofstream sink;
+        open_output_file(sink, output_dir, entry.name);
+
+        std::vector<char> buffer(ARCHIVE_BLOCK_SIZE);
+        boost::crc_32_type crc;
+
+        if (entry.compression == ArchiveEntry::GZIP) {
+            using namespace boost::iostreams;
+
+            file_source source(_archive_path.string(), std::ios::in | std::ios::binary);
+
+            if (!source.is_open()) {
+                FC_THROW("Unable to open file ${file} for reading", ("file", _archive_path.string()) );
+            }
+
+            filtering_istream in;
+            in.push(gzip_decompressor(), ARCHIVE_BLOCK_SIZE);
+            in.push(restrict(source, static_cast<stream_offset>(entry.offset), static_cast<stream_offset>(entry.stored_size)), ARCHIVE_BLOCK_SIZE);
+            copy_blocks(in, sink, entry.size, crc, buffer);
+        } else {
+            std::ifstream in(_archive_path.string(), std::ios::in | std::ios::binary);
+
+            if (!in.is_open()) {
+                FC_THROW("Unable to open file ${file} for reading", ("file", _archive_path.string()) );
+            }
+
+            if (entry.size != entry.stored_size) {
+                FC_THROW("Unexpected size of ${name} in archive ${file}", ("name", entry.name) ("file", _archive_path.string()) );
+            }
+
+            in.seekg(entry.offset);
+            copy_blocks(in, sink, entry.size, crc, buffer);
+        }
+
+        if (crc.checksum() != entry.crc32) {
+            FC_THROW("Checksum of ${name} in archive ${file} does not match", ("name", entry.name) ("file", _archive_path.string()) );
+        }
+    }
+
+    void Dearchiver::extract_version_1(const path& output_dir) const {
+        using namespace boost::iostreams;
+
+        filtering_istream in;
+        in.push(gzip_decompressor(), ARCHIVE_BLOCK_SIZE);
+        in.push(file_source(_archive_path.string(), std::ios::in | std::ios::binary), ARCHIVE_BLOCK_SIZE);
+
+        std::vector<char> buffer(ARCHIVE_BLOCK_SIZE);
+
+        while (true) {
+            ArchiveHeader header;
+
+            std::memset((void*)&header, 0, sizeof(header));
+            in.read((char*)&header, sizeof(header));
+
+            const size_t name_size = strnlen(header.name, sizeof(header.name));
+
+            if (header.version != 1 || name_size == 0) {
+                break;
+            }
+
+            std::ofstream sink;
+            open_output_file(sink, output_dir, std::string(header.name, name_size));
+
+            // the size was written as an int, the files over 4 GB were truncated
+            uint32_t size = 0;
+            std::memcpy(&size, header.size, sizeof(size));
+
+            boost::crc_32_type crc;
+            copy_blocks(in, sink, size, crc, buffer);
+        }
+    }
+
+
+} // namespace detail
+
+
+} } // namespace decent::package
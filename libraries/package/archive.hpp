@@ -0,0 +1,100 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#pragma once
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace decent { namespace package {
+
+
+namespace detail {
+
+
+    /**
+     * Version 2 of the content archive:
+     *
+     *    ArchiveFileHeader
+     *    the data of the entries, each file is an independent gzip stream or is stored as is
+     *    the index, an ArchiveIndexEntry followed by the name of the file for each entry
+     *    ArchiveTrailer
+     *
+     * The sizes are 64-bit, every entry has the CRC-32 of its file and the index at the end allows to extract single
+     * files and to decompress the entries in parallel. The integers are stored in the byte order of the host, like in
+     * version 1, which is one gzip stream of 304 byte headers each followed by the file.
+     *
+     * Version 1 is written unless version 2 is asked for, the nodes not upgraded yet read only version 1.
+     */
+    struct ArchiveEntry {
+        enum Compression : uint16_t { STORED = 0, GZIP = 1 };
+
+        std::string  name;
+        uint64_t     offset = 0;       // of the data in the archive
+        uint64_t     stored_size = 0;  // of the data in the archive
+        uint64_t     size = 0;         // of the file
+        uint32_t     crc32 = 0;        // of the file
+        Compression  compression = STORED;
+    };
+
+
+    class Archiver {
+    public:
+        // version is 1 or 2, a file of a version 1 archive is limited to 2 GB and its name to 255 characters
+        explicit Archiver(const boost::filesystem::path& archive_path, uint32_t version = 1);
+
+        void put(const std::string& file_name, const boost::filesystem::path& source_file_path);
+        // writes the index of version 2 or the terminating header of version 1, the archive is incomplete without it
+        void finalize();
+
+        uint32_t version() const { return _version; }
+        const std::vector<ArchiveEntry>& entries() const { return _entries; }
+
+    private:
+        void put_version_1(ArchiveEntry& entry, std::istream& in);
+        void put_version_2(ArchiveEntry& entry, std::istream& in, const boost::filesystem::path& source_file_path);
+
+        boost::filesystem::path              _archive_path;
+        uint32_t                             _version;
+        std::ofstream                        _out;
+        // the single gzip stream of a version 1 archive
+        boost::iostreams::filtering_ostream  _gzip;
+        std::vector<ArchiveEntry>            _entries;
+        bool                                 _finalized;
+    };
+
+
+    class Dearchiver {
+    public:
+        // reads the index of a version 2 archive, a version 1 archive can only be extracted as a whole, an index
+        // naming a file twice is rejected
+        explicit Dearchiver(const boost::filesystem::path& archive_path);
+
+        int version() const { return _version; }
+        const std::vector<ArchiveEntry>& entries() const { return _entries; }
+
+        // extracts all the files, the entries of a version 2 archive are decompressed by thread_count threads,
+        // 0 means one per core
+        void extract(const boost::filesystem::path& output_dir, unsigned thread_count = 0) const;
+        // extracts one file of a version 2 archive
+        void extract_file(const std::string& file_name, const boost::filesystem::path& output_dir) const;
+
+    private:
+        void extract_entry(const ArchiveEntry& entry, const boost::filesystem::path& output_dir) const;
+        void extract_version_1(const boost::filesystem::path& output_dir) const;
+
+        boost::filesystem::path    _archive_path;
+        int                        _version;
+        std::vector<ArchiveEntry>  _entries;
+    };
+
+
+} // namespace detail
+
+
+} } // namespace decent::package
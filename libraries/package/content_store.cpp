@@ -0,0 +1,327 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include "content_store.hpp"
+#include "detail.hpp"
+
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+
+namespace decent { namespace package { namespace detail {
+
+
+    struct ScrubState {
+        std::map<fc::ripemd160, int64_t>    verified;
+        std::set<fc::ripemd160>             corrupt;
+        fc::ripemd160                       cursor;
+    };
+
+
+} } } // namespace decent::package::detail
+
+FC_REFLECT( decent::package::detail::ScrubState, (verified)(corrupt)(cursor) )
+
+
+using namespace boost::filesystem;
+
+
+namespace decent { namespace package { namespace detail {
+
+
+    ContentStore::ContentStore(const path& packages_path)
+        : _root(packages_path / ".store")
+    {
+        create_directories(_root / "objects");
+
+        // leftovers of tasks interrupted by a shutdown
+        remove_all(get_staging_dir());
+        create_directories(get_staging_dir());
+
+        try {
+            load_state();
+        }
+        catch (const fc::exception& ex) {
+            wlog("unable to read the scrub state of ${path}, objects will be verified again: ${error}", ("path", _root.string()) ("error", ex.to_detail_string()) );
+        }
+    }
+
+    path ContentStore::make_staging_dir() const {
+        return unique_path(get_staging_dir() / "%%%%-%%%%-%%%%-%%%%");
+    }
+
+    void ContentStore::add_package(const path& package_dir, const std::set<path>& paths_to_skip) {
+        std::vector<path> files;
+        get_files_recursive_except(package_dir, files, paths_to_skip);
+
+        manifest_t manifest;
+        bool linked = true;
+
+        for (const auto& file : files) {
+            ManifestEntry entry;
+            entry.path = get_relative(package_dir, file).generic_string();
+            entry.size = file_size(file);
+            entry.object = calculate_hash(file);
+            manifest.push_back(entry);
+
+            if (!linked) {
+                continue;
+            }
+
+            const path object_path = get_object_path(entry.object);
+            const path temp_path = object_path.string() + ".tmp";
+            boost::system::error_code ec;
+
+            std::lock_guard<std::mutex> guard(_mutex);
+
+            if (exists(object_path) && _corrupt.find(entry.object) == _corrupt.end()) {
+                if (equivalent(object_path, file)) {
+                    continue;
+                }
+
+                // the same content is stored already, the file is replaced by a link to it
+                create_hard_link(object_path, temp_path, ec);
+                if (!ec) {
+                    rename(temp_path, file);
+                }
+            }
+            else {
+                create_directories(object_path.parent_path());
+                create_hard_link(file, temp_path, ec);
+                if (!ec) {
+                    rename(temp_path, object_path);
+                    protect(object_path);
+                    _corrupt.erase(entry.object);
+                    _verified[entry.object] = last_write_time(object_path);
+                }
+            }
+
+            if (ec) {
+                wlog("unable to link ${path} to the content store, package files are not deduplicated: ${error}", ("path", file.string()) ("error", ec.message()) );
+                linked = false;
+            }
+        }
+
+        const path manifest_path = get_manifest_path(package_dir);
+        const path temp_manifest_path = manifest_path.string() + ".tmp";
+        create_directories(manifest_path.parent_path());
+        fc::json::save_to_file(manifest, temp_manifest_path);
+        rename(temp_manifest_path, manifest_path);
+    }
+
+    void ContentStore::release(const manifest_t& manifest) {
+        std::lock_guard<std::mutex> guard(_mutex);
+
+        for (const auto& entry : manifest) {
+            const path object_path = get_object_path(entry.object);
+            boost::system::error_code ec;
+
+            if (exists(object_path) && hard_link_count(object_path, ec) == 1 && !ec) {
+                remove(object_path);
+                _verified.erase(entry.object);
+                _corrupt.erase(entry.object);
+            }
+        }
+    }
+
+    bool ContentStore::has_manifest(const path& package_dir) {
+        return exists(get_manifest_path(package_dir));
+    }
+
+    manifest_t ContentStore::read_manifest(const path& package_dir) {
+        return fc::json::from_file(get_manifest_path(package_dir)).as<manifest_t>();
+    }
+
+    bool ContentStore::is_verified(const fc::ripemd160& object, const path& file) const {
+        const path object_path = get_object_path(object);
+        boost::system::error_code ec;
+
+        if (!exists(object_path, ec) || !equivalent(object_path, file, ec) || ec) {
+            return false;
+        }
+
+        const int64_t write_time = last_write_time(object_path, ec);
+        if (ec) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> guard(_mutex);
+        auto it = _verified.find(object);
+        return it != _verified.end() && it->second == write_time && _corrupt.find(object) == _corrupt.end();
+    }
+
+    bool ContentStore::is_corrupt(const fc::ripemd160& object) const {
+        std::lock_guard<std::mutex> guard(_mutex);
+        return _corrupt.find(object) != _corrupt.end();
+    }
+
+    std::vector<fc::ripemd160> ContentStore::scrub(uint64_t max_bytes, uint32_t max_objects) {
+        fc::ripemd160 cursor;
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+            cursor = _cursor;
+        }
+
+        // the objects are spread over 256 directories by the first byte of their hash, only the directory of the cursor
+        // is listed at a time: the objects following the cursor in it, the next directories and, after wrapping around,
+        // the objects up to the cursor
+        const std::string cursor_name = cursor.str();
+        const unsigned first_dir = std::stoul(cursor_name.substr(0, 2), nullptr, 16);
+
+        std::vector<fc::ripemd160> corrupt;
+        uint64_t bytes = 0;
+        uint32_t visited = 0;
+
+        for (unsigned step = 0; step <= 256 && bytes < max_bytes && visited < max_objects; ++step) {
+            for (const auto& object : list_objects((first_dir + step) % 256)) {
+                if ((step == 0 && !(cursor < object)) || (step == 256 && cursor < object)) {
+                    continue;
+                }
+                if (bytes >= max_bytes || visited >= max_objects) {
+                    break;
+                }
+
+                scrub_object(object, bytes, corrupt);
+                ++visited;
+            }
+        }
+
+        save_state();
+
+        return corrupt;
+    }
+
+    std::vector<fc::ripemd160> ContentStore::list_objects(unsigned dir_index) const {
+        char dir_name[3];
+        std::snprintf(dir_name, sizeof(dir_name), "%02x", dir_index);
+
+        const path dir = _root / "objects" / dir_name;
+        std::vector<fc::ripemd160> objects;
+        boost::system::error_code ec;
+
+        if (!is_directory(dir, ec)) {
+            return objects;
+        }
+
+        for (directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            const std::string name = dir_name + it->path().filename().string();
+            if (is_regular_file(it->status()) && is_correct_hash_str(name)) {
+                objects.push_back(fc::ripemd160(name));
+            }
+        }
+
+        std::sort(objects.begin(), objects.end());
+        return objects;
+    }
+
+    void ContentStore::scrub_object(const fc::ripemd160& object, uint64_t& bytes, std::vector<fc::ripemd160>& corrupt) {
+        const path object_path = get_object_path(object);
+        boost::system::error_code ec;
+
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+            _cursor = object;
+
+            if (hard_link_count(object_path, ec) == 1 && !ec) {
+                remove(object_path, ec);
+                _verified.erase(object);
+                _corrupt.erase(object);
+                return;
+            }
+
+            const int64_t write_time = last_write_time(object_path, ec);
+            auto it = _verified.find(object);
+            if (ec || (it != _verified.end() && it->second == write_time)) {
+                return;
+            }
+        }
+
+        try {
+            const int64_t write_time = last_write_time(object_path);
+            bytes += file_size(object_path);
+            const bool valid = (calculate_hash(object_path) == object);
+
+            std::lock_guard<std::mutex> guard(_mutex);
+            if (valid) {
+                _verified[object] = write_time;
+                _corrupt.erase(object);
+            }
+            else {
+                elog("object ${path} of the content store is corrupted", ("path", object_path.string()) );
+                _verified.erase(object);
+                _corrupt.insert(object);
+                corrupt.push_back(object);
+            }
+        }
+        catch (const fc::exception& ex) {
+            elog("unable to verify object ${path}: ${error}", ("path", object_path.string()) ("error", ex.to_detail_string()) );
+        }
+        catch (const std::exception& ex) {
+            elog("unable to verify object ${path}: ${error}", ("path", object_path.string()) ("error", ex.what()) );
+        }
+    }
+
+    void ContentStore::protect(const path& object_path) {
+#ifndef _WIN32
+        // the packages share the inode of the object, a write through any of them would change the content of all
+        boost::system::error_code ec;
+        permissions(object_path, owner_read | group_read | others_read, ec);
+        if (ec) {
+            wlog("unable to make ${path} read-only: ${error}", ("path", object_path.string()) ("error", ec.message()) );
+        }
+#endif
+    }
+
+    path ContentStore::get_object_path(const fc::ripemd160& object) const {
+        const std::string name = object.str();
+        return _root / "objects" / name.substr(0, 2) / name.substr(2);
+    }
+
+    path ContentStore::get_manifest_path(const path& package_dir) {
+        return package_dir / ".state" / "manifest.json";
+    }
+
+    void ContentStore::load_state() {
+        const path state_file = _root / "scrub.json";
+        if (!exists(state_file)) {
+            return;
+        }
+
+        ScrubState state = fc::json::from_file(state_file).as<ScrubState>();
+
+        std::lock_guard<std::mutex> guard(_mutex);
+        _verified = std::move(state.verified);
+        _corrupt = std::move(state.corrupt);
+        _cursor = state.cursor;
+    }
+
+    void ContentStore::save_state() const {
+        ScrubState state;
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+            state.verified = _verified;
+            state.corrupt = _corrupt;
+            state.cursor = _cursor;
+        }
+
+        const path state_file = _root / "scrub.json";
+        const path temp_state_file = state_file.string() + ".tmp";
+
+        try {
+            fc::json::save_to_file(state, temp_state_file);
+            rename(temp_state_file, state_file);
+        }
+        catch (const fc::exception& ex) {
+            elog("unable to save the scrub state of ${path}: ${error}", ("path", _root.string()) ("error", ex.to_detail_string()) );
+        }
+        catch (const std::exception& ex) {
+            elog("unable to save the scrub state of ${path}: ${error}", ("path", _root.string()) ("error", ex.what()) );
+        }
+    }
+
+
+} } } // namespace decent::package::detail
@@ -0,0 +1,100 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#pragma once
+
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace decent { namespace package { namespace detail {
+
+
+    struct ManifestEntry {
+        std::string     path;       // relative to the package directory, with '/' separators
+        fc::ripemd160   object;
+        uint64_t        size = 0;
+    };
+
+    typedef std::vector<ManifestEntry> manifest_t;
+
+
+    /**
+     * Content addressed store of package files, in the '.store' directory of the packages path. Every distinct file is
+     * kept once, as an object named by the RIPEMD-160 hash of its content, and the package directories hold hard links
+     * to the objects, so the transfer engines and the custody code still work with plain files. The number of links of
+     * an object is its reference count, an object linked only from the store is removed. The files of a package are
+     * listed in the manifest in its state directory.
+     *
+     * Packages are assembled in the staging directory of the store, which is on the same file system as the package
+     * directories, so moving them into place only renames the files.
+     *
+     * The objects are read-only, a package file written in place would change the files of every package sharing it.
+     * Windows does not remove read-only files, the objects stay writable there.
+     *
+     * scrub() verifies a few objects at a time and remembers them, a verified object is not hashed again by the package
+     * checks until its file is written. The position of the scrub is saved with the verified objects, each pass lists
+     * only the directories it visits.
+     */
+    class ContentStore {
+    public:
+        explicit ContentStore(const boost::filesystem::path& packages_path);
+
+        boost::filesystem::path get_root() const           { return _root; }
+        boost::filesystem::path get_staging_dir() const    { return _root / "staging"; }
+        /** new unique directory for assembling a package, the caller removes it */
+        boost::filesystem::path make_staging_dir() const;
+
+        /**
+         * Moves the files of the package directory into the store, links them back and writes the manifest.
+         * When the file system does not support hard links the files are left in place and only listed.
+         * @param package_dir Package directory
+         * @param paths_to_skip Paths which are not part of the package content (lock, state)
+         */
+        void add_package(const boost::filesystem::path& package_dir, const std::set<boost::filesystem::path>& paths_to_skip);
+        /** removes the objects of the manifest which are not linked from any package any more */
+        void release(const manifest_t& manifest);
+
+        static bool has_manifest(const boost::filesystem::path& package_dir);
+        static manifest_t read_manifest(const boost::filesystem::path& package_dir);
+
+        /** true if the file is a link to the object and the object was verified since it was last written */
+        bool is_verified(const fc::ripemd160& object, const boost::filesystem::path& file) const;
+        bool is_corrupt(const fc::ripemd160& object) const;
+
+        /**
+         * Verifies the objects following the last one visited, until at least max_bytes are read, max_objects are
+         * visited or all objects were, and removes the objects no package links to.
+         * @return Objects found corrupt in this pass
+         */
+        std::vector<fc::ripemd160> scrub(uint64_t max_bytes, uint32_t max_objects);
+
+    private:
+        boost::filesystem::path get_object_path(const fc::ripemd160& object) const;
+        // the objects of one of the 256 directories of the store, sorted
+        std::vector<fc::ripemd160> list_objects(unsigned dir_index) const;
+        void scrub_object(const fc::ripemd160& object, uint64_t& bytes, std::vector<fc::ripemd160>& corrupt);
+        static void protect(const boost::filesystem::path& object_path);
+        static boost::filesystem::path get_manifest_path(const boost::filesystem::path& package_dir);
+
+        void load_state();
+        void save_state() const;
+
+        mutable std::mutex                          _mutex;
+        const boost::filesystem::path               _root;
+        std::map<fc::ripemd160, int64_t>            _verified;    // write time of the object when it was verified
+        std::set<fc::ripemd160>                     _corrupt;
+        fc::ripemd160                               _cursor;
+    };
+
+
+} } } // namespace decent::package::detail
+
+FC_REFLECT( decent::package::detail::ManifestEntry, (path)(object)(size) )
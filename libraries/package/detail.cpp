@@ -203,6 +203,12 @@ namespace decent { namespace package { namespace detail {
         std::ofstream file(file_path.string());
     }
 
+    // the file system leaves holes for the parts not written later
+    void create_sparse_file(const boost::filesystem::path& file_path, uint64_t size) {
+        touch(file_path);
+        boost::filesystem::resize_file(file_path, size);
+    }
+
     std::string get_proto(const std::string& url) {
         const std::string ipfs = "ipfs:";
         const std::string magnet = "magnet:";
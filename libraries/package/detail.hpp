@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "event_dispatcher.hpp"
+
 #include <fc/crypto/ripemd160.hpp>
 #include <fc/thread/thread.hpp>
 #include <fc/network/url.hpp>
@@ -33,6 +35,7 @@ namespace detail {
     void remove_all_except(boost::filesystem::path dir, const std::set<boost::filesystem::path>& paths_to_skip);
     void move_all_except(boost::filesystem::path from_dir, boost::filesystem::path to_dir, const std::set<boost::filesystem::path>& paths_to_skip);
     void touch(const boost::filesystem::path& file_path);
+    void create_sparse_file(const boost::filesystem::path& file_path, uint64_t size);
     std::string get_proto(const std::string& url);
     bool is_correct_hash_str(const std::string& hash_str);
     fc::ripemd160 calculate_hash(const boost::filesystem::path& file_path);
@@ -66,25 +69,18 @@ namespace detail {
     };
 
 
-#define PACKAGE_INFO_GENERATE_EVENT(event_name, event_params)            \
-{                                                                        \
-    std::lock_guard<std::recursive_mutex> guard(_package._event_mutex);  \
-    for (auto& event_listener_ : _package._event_listeners)              \
-        if (event_listener_)                                             \
-            event_listener_-> event_name event_params ;                  \
-}                                                                        \
+// the listener arguments are evaluated here, the listeners are called later on the event dispatcher thread
+#define PACKAGE_INFO_GENERATE_EVENT(event_name, event_params)                                                             \
+{                                                                                                                         \
+    _package.post_event(#event_name, ::decent::package::detail::bind_event(&::decent::package::EventListenerInterface:: event_name) event_params ); \
+}                                                                                                                         \
 
 
 #define PACKAGE_INFO_CHANGE_DATA_STATE(state)                                    \
 {                                                                                \
     ilog("Package ${p} changed state ${s}", ("p", _package._url)("s", #state));       \
     PackageInfo::DataState new_state = PackageInfo:: state;                      \
-    PackageInfo::DataState old_state = new_state;                                \
-    {                                                                            \
-        std::lock_guard<std::recursive_mutex> guard(_package._mutex);            \
-        old_state = _package._data_state;                                        \
-        _package._data_state = new_state;                                        \
-    }                                                                            \
+    PackageInfo::DataState old_state = _package.exchange_data_state(new_state);  \
     if (old_state != new_state) {                                                \
         PACKAGE_INFO_GENERATE_EVENT(package_data_state_change, ( new_state ) );  \
     }     \
@@ -95,12 +91,7 @@ namespace detail {
 {                                                                                    \
     ilog("Package ${p} changed state ${s}", ("p", _package._url)("s", #state));           \
     PackageInfo::TransferState new_state = PackageInfo:: state;                      \
-    PackageInfo::TransferState old_state = new_state;                                \
-    {                                                                                \
-        std::lock_guard<std::recursive_mutex> guard(_package._mutex);                \
-        old_state = _package._transfer_state;                                        \
-        _package._transfer_state = new_state;                                        \
-    }                                                                                \
+    PackageInfo::TransferState old_state = _package.exchange_transfer_state(new_state); \
     if (old_state != new_state) {                                                    \
         PACKAGE_INFO_GENERATE_EVENT(package_transfer_state_change, ( new_state ) );  \
     }                                                                                \
@@ -0,0 +1,91 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include "event_dispatcher.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+
+namespace decent { namespace package { namespace detail {
+
+
+    EventDispatcher::EventDispatcher()
+        : _thread("package events")
+        , _pending(0)
+        , _delivered(0)
+        , _coalesced(0)
+    {
+    }
+
+    EventDispatcher::~EventDispatcher() {
+        _thread.quit();
+    }
+
+    void EventDispatcher::post(const PackageInfo* package, const std::string& event_name, const event_listener_handle_list_t& listeners, package_event_t event) {
+        if (listeners.empty()) {
+            return;
+        }
+
+        const bool coalesce = boost::algorithm::ends_with(event_name, "_progress");
+        const progress_key_t key(package, event_name);
+
+        if (coalesce) {
+            std::lock_guard<std::mutex> guard(_mutex);
+            auto it = _pending_progress.find(key);
+            if (it != _pending_progress.end()) {
+                // the queued delivery reports the latest progress
+                it->second = pending_event_t(listeners, event);
+                ++_coalesced;
+                return;
+            }
+            _pending_progress.emplace(key, pending_event_t(listeners, event));
+        }
+
+        ++_pending;
+        _thread.async([this, coalesce, key, listeners, event]() {
+            if (coalesce) {
+                pending_event_t latest;
+                {
+                    std::lock_guard<std::mutex> guard(_mutex);
+                    auto it = _pending_progress.find(key);
+                    latest = std::move(it->second);
+                    _pending_progress.erase(it);
+                }
+                deliver(latest.first, latest.second);
+            } else {
+                deliver(listeners, event);
+            }
+
+            --_pending;
+            ++_delivered;
+        }, "package event");
+    }
+
+    void EventDispatcher::deliver(const event_listener_handle_list_t& listeners, const package_event_t& event) {
+        for (auto& event_listener : listeners) {
+            if (!event_listener) {
+                continue;
+            }
+
+            try {
+                event(*event_listener);
+            }
+            catch (const fc::exception& ex) {
+                elog("package event listener failed: ${error}", ("error", ex.to_detail_string()) );
+            }
+            catch (const std::exception& ex) {
+                elog("package event listener failed: ${error}", ("error", ex.what()) );
+            }
+        }
+    }
+
+    void EventDispatcher::fill_stats(PackageManagerStats& stats) const {
+        stats.events_pending = _pending;
+        stats.events_delivered = _delivered;
+        stats.events_coalesced = _coalesced;
+    }
+
+
+} } } // namespace decent::package::detail
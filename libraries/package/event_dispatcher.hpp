@@ -0,0 +1,66 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#pragma once
+
+#include <decent/package/package.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+
+namespace decent { namespace package { namespace detail {
+
+
+    /**
+     * Delivers package events to their listeners on a thread of its own, in the order they were generated, so package
+     * tasks never wait for listeners. A progress event posted while the previous progress event of the same kind and
+     * package is still waiting for delivery replaces the payload of that one.
+     */
+    class EventDispatcher {
+    public:
+        EventDispatcher();
+        ~EventDispatcher();
+
+        void post(const PackageInfo* package, const std::string& event_name, const event_listener_handle_list_t& listeners, package_event_t event);
+        void fill_stats(PackageManagerStats& stats) const;
+
+    private:
+        typedef std::pair<const PackageInfo*, std::string> progress_key_t;
+        typedef std::pair<event_listener_handle_list_t, package_event_t> pending_event_t;
+
+        void deliver(const event_listener_handle_list_t& listeners, const package_event_t& event);
+
+        fc::thread                                  _thread;
+        mutable std::mutex                          _mutex;
+        std::map<progress_key_t, pending_event_t>   _pending_progress;
+        std::atomic<uint64_t>                       _pending;
+        std::atomic<uint64_t>                       _delivered;
+        std::atomic<uint64_t>                       _coalesced;
+    };
+
+
+    // binds the arguments of a listener method by value, they are evaluated when the event is generated
+    template<typename... Params>
+    struct event_binder {
+        void (EventListenerInterface::*method)(Params...);
+
+        template<typename... Args>
+        package_event_t operator()(Args&&... args) const {
+            return std::bind(method, std::placeholders::_1, typename std::decay<Params>::type(std::forward<Args>(args))...);
+        }
+    };
+
+    template<typename... Params>
+    event_binder<Params...> bind_event(void (EventListenerInterface::*method)(Params...)) {
+        return event_binder<Params...>{ method };
+    }
+
+
+} } } // namespace decent::package::detail
@@ -10,11 +10,14 @@
 #include <fc/crypto/ripemd160.hpp>
 #include <fc/crypto/sha256.hpp>
 #include <fc/network/url.hpp>
+#include <fc/reflect/reflect.hpp>
 
 #include <boost/filesystem.hpp>
 #include <boost/interprocess/sync/file_lock.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
 
+#include <atomic>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -22,6 +25,7 @@
 #include <set>
 #include <string>
 #include <thread>
+#include <vector>
 
 
 
@@ -82,6 +86,9 @@ namespace package {
         class RemovePackageTask;
         class UnpackPackageTask;
         class CheckPackageTask;
+        class PackageRegistry;
+        class EventDispatcher;
+        class ContentStore;
 
 
     } // namespace detail
@@ -94,6 +101,39 @@ namespace package {
     typedef std::shared_ptr<TransferEngineInterface>    transfer_engine_t;
     typedef std::map<std::string, transfer_engine_t>    proto_to_transfer_engine_map_t;
 
+    /**
+     * Byte range of a package file
+     */
+    struct PackageFileRange {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    /** ranges to fetch, by file name relative to the package directory */
+    typedef std::map<std::string, std::vector<PackageFileRange>> package_file_ranges_t;
+
+    namespace detail {
+        typedef std::function<void(EventListenerInterface&)> package_event_t;
+    }
+
+    /**
+     * Aggregate state of the known packages, counted as the packages change state
+     */
+    struct PackageManagerStats {
+        uint32_t packages           = 0;
+        uint32_t downloading        = 0;
+        uint32_t seeding            = 0;
+        uint32_t partial            = 0;
+        uint32_t unchecked          = 0;
+        uint32_t checked            = 0;
+        uint32_t invalid            = 0;
+        /// events waiting for delivery to the listeners
+        uint64_t events_pending     = 0;
+        uint64_t events_delivered   = 0;
+        /// progress events merged into the previous one, which was not delivered yet
+        uint64_t events_coalesced   = 0;
+    };
+
     /*! PackageInfo class, holds information about the particular packages */
     class PackageInfo {
     public:
@@ -146,6 +186,7 @@ namespace package {
         friend class detail::RemovePackageTask;
         friend class detail::UnpackPackageTask;
         friend class detail::CheckPackageTask;
+        friend class detail::PackageRegistry;
 
         /**
          * Creates new package from files on disk. Cannot be called directly, call PackageManager::get_package instead
@@ -238,6 +279,14 @@ namespace package {
          * @param proof Calculated proof, shall be pre-filled
          */
         void create_proof_of_custody(const decent::encrypt::CustodyData& cd, decent::encrypt::CustodyProof& proof)const;
+        /**
+         * Create PoC of a package whose data are not downloaded. Only the blocks challenged by the seed of the proof and
+         * their signatures are fetched, into a temporary directory removed afterwards.
+         * @param cd Custody data (received from author)
+         * @param proof Calculated proof, shall be pre-filled
+         * @return false if the transfer engine can not fetch parts of the package, it has to be downloaded then
+         */
+        bool create_sparse_proof_of_custody(const decent::encrypt::CustodyData& cd, decent::encrypt::CustodyProof& proof);
 
         void wait_for_current_task();
         void cancel_current_task(bool block = false);
@@ -250,6 +299,20 @@ namespace package {
         void lock_dir();
         void unlock_dir();
 
+        // the state setters keep the counts of the package manager, they return the previous state
+        DataState exchange_data_state(DataState state);
+        TransferState exchange_transfer_state(TransferState state);
+        void set_hash(const fc::ripemd160& hash);
+        void set_url(const std::string& url);
+        void post_event(const char* event_name, detail::package_event_t event);
+
+        // the files of the package are kept in the content store of the package manager
+        boost::filesystem::path make_staging_dir() const;
+        void store_files();
+        void remove_files();
+        bool is_content_verified() const;
+        void invalidate_if_uses(const std::set<fc::ripemd160>& objects);
+
         boost::filesystem::path get_package_state_dir() const  { return get_package_state_dir(get_package_dir()); }
         boost::filesystem::path get_lock_file_path() const     { return get_lock_file_path(get_package_dir()); }
         boost::filesystem::path get_custody_file() const       { return get_package_dir() / "content.cus"; }
@@ -279,6 +342,8 @@ namespace package {
         decent::encrypt::CustodyData  _custody_data;
         uint64_t                      _size;
         uint64_t                      _downloaded_size;
+        /// counted and indexed by the package manager
+        bool                          _registered = false;
 
         // File lock is temporary commented because in current directory locking implementation it does nothing
         // and I guess we dont need it.
@@ -360,6 +425,12 @@ namespace package {
         virtual std::shared_ptr<detail::PackageTask> create_download_task(PackageInfo& package) = 0;
         virtual std::shared_ptr<detail::PackageTask> create_start_seeding_task(PackageInfo& package) = 0;
         virtual std::shared_ptr<detail::PackageTask> create_stop_seeding_task(PackageInfo& package) = 0;
+        /**
+         * Fetches just the given ranges of the package files, blocking. Every file is written to dest_dir with its full
+         * size, the bytes outside of the ranges are left as holes.
+         * @return false if the engine can not fetch parts of files
+         */
+        virtual bool fetch_ranges(PackageInfo& package, const package_file_ranges_t& ranges, const boost::filesystem::path& dest_dir) { return false; }
 
     protected:
         fc::mutex   _mutex;
@@ -426,15 +497,41 @@ namespace package {
         bool release_package(package_handle_t& package);
 
         boost::filesystem::path get_packages_path() const;
-        //void set_libtorrent_config(const boost::filesystem::path& libtorrent_config_file);
+        void set_libtorrent_config(const boost::filesystem::path& libtorrent_config_file);
+
+        /**
+         * Selects the version of the archive new packages are created with. Version 1 is the default, version 2 can be
+         * read only by upgraded nodes.
+         */
+        void set_archive_version(uint32_t version);
+        uint32_t get_archive_version() const;
 
         TransferEngineInterface& get_proto_transfer_engine(const std::string& proto) const;
 
+        /**
+         * Returns the numbers of packages by state and the event delivery counters, without visiting the packages
+         */
+        PackageManagerStats get_stats() const;
+
     private:
-        mutable std::recursive_mutex    _mutex;
-        boost::filesystem::path         _packages_path;
-        package_handle_set_t            _packages;
-        proto_to_transfer_engine_map_t  _proto_transfer_engines;
+        friend class PackageInfo;
+
+        // verifies a slice of the content store and invalidates the packages using corrupted files, then reschedules
+        void scrub();
+
+        // serializes the creation and release of packages, lookups do not take it
+        mutable std::recursive_mutex                _mutex;
+        boost::filesystem::path                     _packages_path;
+        std::unique_ptr<detail::EventDispatcher>    _event_dispatcher;
+        std::unique_ptr<detail::PackageRegistry>    _registry;
+        std::unique_ptr<detail::ContentStore>       _content_store;
+        proto_to_transfer_engine_map_t              _proto_transfer_engines;
+        std::atomic<uint32_t>                       _archive_version;
+        fc::thread                                  _scrub_thread;
+        // guards the rescheduling of the scrub against the destructor
+        std::mutex                                  _scrub_mutex;
+        bool                                        _scrub_stopped = false;
+        fc::future<void>                            _scrub_task;
     };
 
 
@@ -443,3 +540,8 @@ namespace package {
 
 
 } } // namespace decent::package
+
+
+FC_REFLECT( decent::package::PackageManagerStats,
+            (packages)(downloading)(seeding)(partial)(unchecked)(checked)(invalid)
+            (events_pending)(events_delivered)(events_coalesced) )
@@ -5,9 +5,15 @@
 #include <decent/package/package.hpp>
 #include <decent/package/package_config.hpp>
 
+#include <fc/crypto/base58.hpp>
+
 #include <boost/filesystem/path.hpp>
 #include <boost/algorithm/string/trim.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
 #include <vector>
 #include <regex>
 
@@ -28,6 +34,174 @@ namespace decent { namespace package {
             return false;
         }
 
+        /**
+         * Reads the few protobuf messages of IPFS needed to walk the blocks of a file: the dag-pb node and its UnixFS data
+         */
+        class ProtobufReader {
+        public:
+            explicit ProtobufReader(const std::string& data) : _pos(data.data()), _end(data.data() + data.size()) {}
+
+            bool next_field(uint32_t& field, uint32_t& wire_type) {
+                if (_pos == _end) {
+                    return false;
+                }
+                const uint64_t key = read_varint();
+                field = uint32_t(key >> 3);
+                wire_type = uint32_t(key & 7);
+                return true;
+            }
+
+            bool at_end() const { return _pos == _end; }
+
+            uint64_t read_varint() {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    FC_ASSERT(_pos != _end, "Truncated IPFS object");
+                    const uint8_t byte = uint8_t(*_pos++);
+                    value |= uint64_t(byte & 0x7f) << shift;
+                    if ((byte & 0x80) == 0) {
+                        return value;
+                    }
+                }
+                FC_THROW("Malformed varint in IPFS object");
+            }
+
+            std::string read_bytes() {
+                const uint64_t size = read_varint();
+                FC_ASSERT(size <= uint64_t(_end - _pos), "Truncated IPFS object");
+                std::string result(_pos, size);
+                _pos += size;
+                return result;
+            }
+
+            void skip(uint32_t wire_type) {
+                switch (wire_type) {
+                    case 0: read_varint(); break;
+                    case 2: read_bytes(); break;
+                    case 1: FC_ASSERT(_end - _pos >= 8, "Truncated IPFS object"); _pos += 8; break;
+                    case 5: FC_ASSERT(_end - _pos >= 4, "Truncated IPFS object"); _pos += 4; break;
+                    default: FC_THROW("Unsupported protobuf wire type ${t} in IPFS object", ("t", wire_type));
+                }
+            }
+
+        private:
+            const char* _pos;
+            const char* _end;
+        };
+
+        /**
+         * A block of a file added to IPFS. Its own bytes come first, then those of the children
+         */
+        struct IPFSFileNode {
+            std::string                 data;
+            uint64_t                    file_size = 0;
+            std::vector<std::string>    children;
+            std::vector<uint64_t>       block_sizes;    // bytes of the file under each child
+        };
+
+        typedef std::map<std::string, IPFSFileNode> ipfs_file_nodes_t;
+
+        const IPFSFileNode& get_ipfs_file_node(ipfs::Client& client, const std::string& hash, ipfs_file_nodes_t& nodes) {
+            auto it = nodes.find(hash);
+            if (it != nodes.end()) {
+                return it->second;
+            }
+
+            std::stringstream block;
+            client.BlockGet(hash, &block);
+            const std::string raw = block.str();
+
+            IPFSFileNode node;
+            std::string unixfs;
+            uint32_t field, wire_type;
+
+            // PBNode { Data = 1, Links = 2 }, PBLink { Hash = 1, Name = 2, Tsize = 3 }
+            ProtobufReader pb_node(raw);
+            while (pb_node.next_field(field, wire_type)) {
+                if (field == 1 && wire_type == 2) {
+                    unixfs = pb_node.read_bytes();
+                }
+                else if (field == 2 && wire_type == 2) {
+                    const std::string link = pb_node.read_bytes();
+                    ProtobufReader pb_link(link);
+                    std::string link_hash;
+                    while (pb_link.next_field(field, wire_type)) {
+                        if (field == 1 && wire_type == 2) {
+                            link_hash = pb_link.read_bytes();
+                        } else {
+                            pb_link.skip(wire_type);
+                        }
+                    }
+                    FC_ASSERT(!link_hash.empty(), "IPFS object ${h} has a link without hash", ("h", hash));
+                    // a CIDv0 is the bare multihash, a CIDv1 needs the multibase prefix of base58
+                    const std::string encoded = fc::to_base58(link_hash.data(), link_hash.size());
+                    node.children.push_back(link_hash[0] == 1 ? "z" + encoded : encoded);
+                }
+                else {
+                    pb_node.skip(wire_type);
+                }
+            }
+
+            // UnixFS Data { Type = 1, Data = 2, filesize = 3, blocksizes = 4 }, the types Raw = 0 and File = 2 hold file bytes
+            uint64_t type = 1;
+            ProtobufReader pb_data(unixfs);
+            while (pb_data.next_field(field, wire_type)) {
+                if (field == 1 && wire_type == 0) {
+                    type = pb_data.read_varint();
+                }
+                else if (field == 2 && wire_type == 2) {
+                    node.data = pb_data.read_bytes();
+                }
+                else if (field == 3 && wire_type == 0) {
+                    node.file_size = pb_data.read_varint();
+                }
+                else if (field == 4 && wire_type == 0) {
+                    node.block_sizes.push_back(pb_data.read_varint());
+                }
+                else if (field == 4 && wire_type == 2) {
+                    const std::string packed = pb_data.read_bytes();
+                    ProtobufReader pb_sizes(packed);
+                    while (!pb_sizes.at_end()) {
+                        node.block_sizes.push_back(pb_sizes.read_varint());
+                    }
+                }
+                else {
+                    pb_data.skip(wire_type);
+                }
+            }
+
+            FC_ASSERT(type == 0 || type == 2, "IPFS object ${h} is not a file", ("h", hash));
+            FC_ASSERT(node.children.size() == node.block_sizes.size(), "IPFS object ${h} has inconsistent block sizes", ("h", hash));
+            return nodes.emplace(hash, std::move(node)).first->second;
+        }
+
+        /**
+         * Writes the bytes [begin, end) of the file under node, which starts at node_offset of the file, fetching only the blocks
+         * that hold them
+         */
+        void fetch_ipfs_file_range(ipfs::Client& client, const IPFSFileNode& node, uint64_t node_offset, uint64_t begin, uint64_t end,
+                                   std::fstream& out, ipfs_file_nodes_t& nodes) {
+            uint64_t pos = node_offset;
+            if (!node.data.empty()) {
+                const uint64_t from = std::max(begin, pos);
+                const uint64_t to = std::min(end, pos + node.data.size());
+                if (from < to) {
+                    out.seekp(from);
+                    out.write(node.data.data() + (from - pos), to - from);
+                }
+                pos += node.data.size();
+            }
+
+            for (size_t i = 0; i < node.children.size() && pos < end; ++i) {
+                const uint64_t child_end = pos + node.block_sizes[i];
+                if (child_end > begin) {
+                    const IPFSFileNode& child = get_ipfs_file_node(client, node.children[i], nodes);
+                    fetch_ipfs_file_range(client, child, pos, std::max(begin, pos), std::min(end, child_end), out, nodes);
+                }
+                pos = child_end;
+            }
+        }
+
     } // namespace detail
 
 
@@ -105,7 +279,7 @@ namespace decent { namespace package {
 
         using namespace boost::filesystem;
 
-        const auto temp_dir_path = unique_path(graphene::utilities::decent_path_finder::instance().get_decent_temp() / "%%%%-%%%%-%%%%-%%%%");
+        const auto temp_dir_path = _package.make_staging_dir();
 
         try {
             PACKAGE_TASK_EXIT_IF_REQUESTED;
@@ -129,7 +303,7 @@ namespace decent { namespace package {
 
             const auto content_file = temp_dir_path / "content.zip.aes";
 
-            _package._hash = detail::calculate_hash(content_file);
+            _package.set_hash(detail::calculate_hash(content_file));
             const auto package_dir = _package.get_package_dir();
 
             PACKAGE_TASK_EXIT_IF_REQUESTED;
@@ -150,6 +324,7 @@ namespace decent { namespace package {
             paths_to_skip.insert(_package.get_package_state_dir(temp_dir_path));
             paths_to_skip.insert(_package.get_lock_file_path(temp_dir_path));
             detail::move_all_except(temp_dir_path, package_dir, paths_to_skip);
+            _package.store_files();
 
             remove_all(temp_dir_path);
 
@@ -255,7 +430,7 @@ namespace decent { namespace package {
                 FC_THROW("Unable to find root hash in 'ipfs add' results");
             }
 
-            _package._url = "ipfs:" + root_hash;
+            _package.set_url("ipfs:" + root_hash);
 
             _client.PinAdd(root_hash); // just in case
 
@@ -318,6 +493,62 @@ namespace decent { namespace package {
         }
     }
 
+    bool IPFSTransferEngine::fetch_ranges(PackageInfo& package, const package_file_ranges_t& ranges, const boost::filesystem::path& dest_dir) {
+        std::string obj_id;
+
+        if (!detail::parse_ipfs_url(package.get_url(), obj_id)) {
+            FC_THROW("'${url}' is not an ipfs NURI", ("url", package.get_url()));
+        }
+
+        ipfs::Client client(PackageManagerConfigurator::instance().get_ipfs_host(), PackageManagerConfigurator::instance().get_ipfs_port());
+
+        std::map<std::string, std::string> file_hashes;
+        ipfs::Json objects;
+        client.Ls(obj_id, &objects);
+        for (auto nested_object : objects) {
+            ipfs::Json links = nested_object.at("Links");
+            for (auto& link : links) {
+                if ((int) link.at("Type") == 2) { //file
+                    const std::string file_name = link.at("Name");
+                    const std::string file_obj_id = link.at("Hash");
+                    file_hashes[file_name] = file_obj_id;
+                }
+            }
+        }
+
+        for (const auto& file_ranges : ranges) {
+            auto hash = file_hashes.find(file_ranges.first);
+            if (hash == file_hashes.end()) {
+                return false;
+            }
+
+            detail::ipfs_file_nodes_t nodes;
+            const detail::IPFSFileNode& root = detail::get_ipfs_file_node(client, hash->second, nodes);
+            const uint64_t size = root.file_size;
+            const boost::filesystem::path dest = dest_dir / file_ranges.first;
+            detail::create_sparse_file(dest, size);
+
+            std::fstream out(dest.string(), std::ios::binary | std::ios::in | std::ios::out);
+            if (!out.is_open()) {
+                FC_THROW("Unable to open ${fn}", ("fn", dest.string()) );
+            }
+
+            for (const auto& range : file_ranges.second) {
+                if (range.offset < size) {
+                    const uint64_t end = range.offset + std::min(range.size, size - range.offset);
+                    detail::fetch_ipfs_file_range(client, root, 0, range.offset, end, out, nodes);
+                }
+            }
+
+            out.flush();
+            if (!out.good()) {
+                FC_THROW("Unable to write ranges of ${fn}", ("fn", dest.string()) );
+            }
+        }
+
+        return true;
+    }
+
     std::shared_ptr<detail::PackageTask> IPFSTransferEngine::create_download_task(PackageInfo& package) {
         return std::make_shared<IPFSDownloadPackageTask>(package);
     }
@@ -60,6 +60,8 @@ namespace decent { namespace package {
         virtual std::shared_ptr<detail::PackageTask> create_download_task(PackageInfo& package) override;
         virtual std::shared_ptr<detail::PackageTask> create_start_seeding_task(PackageInfo& package) override;
         virtual std::shared_ptr<detail::PackageTask> create_stop_seeding_task(PackageInfo& package) override;
+        // reads only the blocks of the file DAG that hold the ranges
+        virtual bool fetch_ranges(PackageInfo& package, const package_file_ranges_t& ranges, const boost::filesystem::path& dest_dir) override;
     };
     
     
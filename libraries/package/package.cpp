@@ -1,8 +1,14 @@
 /* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
 #include <cstddef>
-//#include "torrent_transfer.hpp"
+#include "archive.hpp"
+#include "content_store.hpp"
 #include "ipfs_transfer.hpp"
 #include "local.hpp"
+#include "registry.hpp"
+
+#ifdef DECENT_PACKAGE_WITH_TORRENT
+#include "torrent_transfer.hpp"
+#endif
 
 #include <decent/encrypt/encryptionutils.hpp>
 #include <decent/package/package.hpp>
@@ -31,143 +37,6 @@ using namespace boost::filesystem;
 namespace decent { namespace package {
 
 
-    namespace detail {
-
-#pragma pack(push,4)
-        struct ArchiveHeader {
-           char version;       // version of header, first verison is 1
-           char reserved1;
-           char reserved2;
-           char reserved3;
-           char name[256];
-           char size[8];
-           char reserved4[36];
-        }; // sizeof == 304 bytes
-#pragma pack(pop)
-#define ArchiveHeader_sizeof_version_1 304
-
-        class Archiver {
-        public:
-            explicit Archiver(boost::iostreams::filtering_ostream& out)
-                : _out(out)
-            {
-            }
-
-            bool put(const std::string& file_name, const boost::filesystem::path& source_file_path) {
-                boost::iostreams::file_source in(source_file_path.string(), std::ios_base::in | std::ios_base::binary);
-
-                if (!in.is_open()) {
-                    FC_THROW("Unable to open file ${file} for reading", ("file", source_file_path.string()) );
-                }
-
-                const int file_size = boost::filesystem::file_size(source_file_path);
-
-                ArchiveHeader header;
-
-                if (sizeof(header) != ArchiveHeader_sizeof_version_1) {
-                   FC_THROW("Bad size of ArchiveHeader");
-                }
-
-                std::memset((void*)&header, 0, sizeof(header));
-
-                std::snprintf(header.name, sizeof(header.name), "%s", file_name.c_str());
-
-                header.version = 1;
-                *(int*)header.size = file_size;
-
-                _out.write((const char*)&header, sizeof(header));
-
-                boost::iostreams::stream<boost::iostreams::file_source> is(in);
-                _out << is.rdbuf();
-
-                return true;
-            }
-
-            ~Archiver() {
-                ArchiveHeader header;
-
-                std::memset((void*)&header, 0, sizeof(header));
-                _out.write((const char*)&header, sizeof(header));
-            }
-
-        private:
-            boost::iostreams::filtering_ostream& _out;
-        };
-
-
-        class Dearchiver {
-        public:
-            explicit Dearchiver(boost::iostreams::filtering_istream& in)
-                : _in(in)
-            {
-            }
-
-            bool extract(const boost::filesystem::path& output_dir) {
-                while (true) {
-                    ArchiveHeader header;
-
-                    if (sizeof(header) != ArchiveHeader_sizeof_version_1) {
-                       FC_THROW("Bad size of ArchiveHeader");
-                    }
-
-                    std::memset((void*)&header, 0, sizeof(header));
-            
-                    _in.read((char*)&header, sizeof(header));
-
-                    if (header.version != 1 || strlen(header.name) == 0) { 
-                        break;
-                    }
-
-                    using namespace boost::filesystem;
-
-                    const path file_path = output_dir / header.name;
-                    const path file_dir = file_path.parent_path();
-
-                    if (!exists(file_dir) || !is_directory(file_dir)) {
-                        try {
-                            if (!create_directories(file_dir) && !is_directory(file_dir)) {
-                                FC_THROW("Unable to create ${dir} directory", ("dir", file_dir.string()) );
-                            }
-                        }
-                        catch (const boost::filesystem::filesystem_error& ex) {
-                            if (!is_directory(file_dir)) {
-                                FC_THROW("Unable to create ${dir} directory: ${error}", ("dir", file_dir.string()) ("error", ex.what()) );
-                            }
-                        }
-                    }
-
-                    std::fstream sink(file_path.string(), std::ios::out | std::ios::binary);
-
-                    if (!sink.is_open()) {
-                        FC_THROW("Unable to open file ${file} for writing", ("file", file_path.string()) );
-                    }
-
-                    const int bytes_to_read = *(int*)header.size;
-
-                    if (bytes_to_read < 0) {
-                        FC_THROW("Unexpected size in header");
-                    }
-
-                    std::copy_n(std::istreambuf_iterator<char>(_in),
-                                bytes_to_read,
-                                std::ostreambuf_iterator<char>(sink)
-                    );
-
-                    char ch = 0;
-                    _in.read(&ch, 1);// BugFix:  copy_n does not move source file pointer to next header
-                }
-                
-                return true;
-            }
-
-        private:
-            boost::iostreams::filtering_istream& _in;
-        };
-
-
-    } // namespace detail
-
-
     namespace detail {
 
 
@@ -191,7 +60,7 @@ namespace decent { namespace package {
 
                 using namespace boost::filesystem;
 
-                const auto temp_dir_path = unique_path(graphene::utilities::decent_path_finder::instance().get_decent_temp() / "%%%%-%%%%-%%%%-%%%%");
+                const auto temp_dir_path = _package.make_staging_dir();
                 bool samples = false;
 
                 try {
@@ -228,13 +97,7 @@ namespace decent { namespace package {
                     const auto zip_file_path = temp_dir_path / "content.zip";
 
                     {
-                        using namespace boost::iostreams;
-
-                        filtering_ostream out;
-                        out.push(gzip_compressor());
-                        out.push(file_sink(zip_file_path.string(), std::ios::out | std::ios::binary));
-
-                        detail::Archiver archiver(out);
+                        detail::Archiver archiver(zip_file_path, PackageManager::instance().get_archive_version());
 
                         if (is_regular_file(_content_dir_path)) {
                             PACKAGE_TASK_EXIT_IF_REQUESTED;
@@ -247,6 +110,8 @@ namespace decent { namespace package {
                                 archiver.put(detail::get_relative(_content_dir_path, file).string(), file);
                             }
                         }
+
+                        archiver.finalize();
                     }
 
                     PACKAGE_TASK_EXIT_IF_REQUESTED;
@@ -272,7 +137,7 @@ namespace decent { namespace package {
                         PACKAGE_TASK_EXIT_IF_REQUESTED;
                         AES_encrypt_file(zip_file_path.string(), aes_file_path.string(), k);
                         PACKAGE_TASK_EXIT_IF_REQUESTED;
-                        _package._hash = detail::calculate_hash(aes_file_path);
+                        _package.set_hash(detail::calculate_hash(aes_file_path));
                         PACKAGE_TASK_EXIT_IF_REQUESTED;
                         //calculate custody...
                         decent::encrypt::CustodyUtils::instance().create_custody_data(aes_file_path, _package._custody_data);
@@ -328,6 +193,7 @@ namespace decent { namespace package {
                     paths_to_skip.insert(_package.get_lock_file_path(temp_dir_path));
                     paths_to_skip.insert(zip_file_path);
                     detail::move_all_except(temp_dir_path, package_dir, paths_to_skip);
+                    _package.store_files();
                     _package._size = size;
 
                     remove_all(temp_dir_path);
@@ -381,7 +247,7 @@ namespace decent { namespace package {
                 PACKAGE_TASK_EXIT_IF_REQUESTED;
                 PACKAGE_INFO_CHANGE_MANIPULATION_STATE(DELETTING);
 
-                boost::filesystem::remove_all(_package.get_package_dir());
+                _package.remove_files();
 
                 PACKAGE_INFO_CHANGE_DATA_STATE(DS_UNINITIALIZED);
                 PACKAGE_INFO_CHANGE_MANIPULATION_STATE(MS_IDLE);
@@ -467,13 +333,7 @@ namespace decent { namespace package {
                         PACKAGE_TASK_EXIT_IF_REQUESTED;
                         PACKAGE_INFO_CHANGE_MANIPULATION_STATE(UNPACKING);
 
-                        using namespace boost::iostreams;
-
-                        boost::iostreams::filtering_istream istr;
-                        istr.push(gzip_decompressor());
-                        istr.push(file_source(archive_file_path.string(), std::ios::in | std::ios::binary));
-
-                        detail::Dearchiver dearchiver(istr);
+                        detail::Dearchiver dearchiver(archive_file_path);
                         dearchiver.extract(_target_dir);
                     }
 
@@ -531,12 +391,15 @@ namespace decent { namespace package {
 //                  PACKAGE_INFO_GENERATE_EVENT(package_check_progress, ( ) );
 
 
-                    const auto aes_file_path = _package.get_content_file();
-                    const auto file_hash = detail::calculate_hash(aes_file_path);
+                    // the content store object is named by its hash, once scrubbed it needs no hashing here
+                    if (!_package.is_content_verified()) {
+                        const auto aes_file_path = _package.get_content_file();
+                        const auto file_hash = detail::calculate_hash(aes_file_path);
 
-                    if (_package._hash != file_hash) {
-                        FC_THROW("Package hash (${phash}) does not match ${fn} content file hash (${fhash})",
-                                  ("phash", _package._hash.str()) ("fn", aes_file_path.string()) ("fhash", file_hash.str()) );
+                        if (_package._hash != file_hash) {
+                            FC_THROW("Package hash (${phash}) does not match ${fn} content file hash (${fhash})",
+                                      ("phash", _package._hash.str()) ("fn", aes_file_path.string()) ("fhash", file_hash.str()) );
+                        }
                     }
                     //TODO_DECENT - we should check the size here...
 
@@ -606,9 +469,17 @@ namespace decent { namespace package {
 
             PACKAGE_INFO_CHANGE_DATA_STATE(UNCHECKED);
             PACKAGE_INFO_CHANGE_MANIPULATION_STATE(CHECKING);
-            auto hash = detail::calculate_hash(get_content_file());
 
-            FC_ASSERT( hash == _hash, "Package is corrupted");
+            // packages stored before the content store existed are moved into it
+            if (!detail::ContentStore::has_manifest(get_package_dir())) {
+                store_files();
+            }
+
+            if (!is_content_verified()) {
+                auto hash = detail::calculate_hash(get_content_file());
+
+                FC_ASSERT( hash == _hash, "Package is corrupted");
+            }
             //TODO_DECENT - we should also check for coruption in all other files
 
             PACKAGE_INFO_CHANGE_DATA_STATE(CHECKED);
@@ -683,8 +554,8 @@ namespace decent { namespace package {
                       "local").create_download_task(*this);
             }else { //TODO_DECENT - this shall never happen!
                 if( !_url.empty() ){
-                    _data_state = DS_UNINITIALIZED;
-                    _transfer_state =TS_IDLE;
+                    exchange_data_state(DS_UNINITIALIZED);
+                    exchange_transfer_state(TS_IDLE);
                     _parent_dir = manager.get_packages_path();
                     _download_task = manager.get_proto_transfer_engine(detail::get_proto(_url)).create_download_task(*this);
                 }else
@@ -765,6 +636,52 @@ namespace decent { namespace package {
        return;
     }
 
+    bool PackageInfo::create_sparse_proof_of_custody(const decent::encrypt::CustodyData& cd, decent::encrypt::CustodyProof& proof) {
+        using namespace boost::filesystem;
+
+        FC_ASSERT(cd.n < 10000000 );
+
+        std::vector<std::pair<uint64_t, uint64_t>> content_ranges;
+        std::vector<std::pair<uint64_t, uint64_t>> custody_ranges;
+        decent::encrypt::CustodyUtils::instance().get_proof_ranges(cd.n, proof, content_ranges, custody_ranges);
+
+        const std::string content_file = get_content_file().filename().string();
+        const std::string custody_file = get_custody_file().filename().string();
+
+        package_file_ranges_t ranges;
+        for (const auto& range : content_ranges) {
+            ranges[content_file].push_back(PackageFileRange{ range.first, range.second });
+        }
+        for (const auto& range : custody_ranges) {
+            ranges[custody_file].push_back(PackageFileRange{ range.first, range.second });
+        }
+
+        TransferEngineInterface& engine = PackageManager::instance().get_proto_transfer_engine(detail::get_proto(_url));
+        const auto temp_dir_path = unique_path(graphene::utilities::decent_path_finder::instance().get_decent_temp() / "%%%%-%%%%-%%%%-%%%%");
+
+        try {
+            create_directories(temp_dir_path);
+
+            if (!engine.fetch_ranges(*this, ranges, temp_dir_path)) {
+                remove_all(temp_dir_path);
+                return false;
+            }
+
+            int ret = decent::encrypt::CustodyUtils::instance().create_proof_of_custody(temp_dir_path / content_file, cd, proof);
+            if( ret != 0 ) {
+                ilog("create_proof_of_custody returned ${r}", ("r", ret));
+                FC_THROW("Failed to create custody data");
+            }
+        }
+        catch (...) {
+            remove_all(temp_dir_path);
+            throw;
+        }
+
+        remove_all(temp_dir_path);
+        return true;
+    }
+
     void PackageInfo::wait_for_current_task() {
         decltype(_current_task) current_task;
         {
@@ -816,6 +733,89 @@ namespace decent { namespace package {
     }
 
 
+    void PackageInfo::post_event(const char* event_name, detail::package_event_t event) {
+        event_listener_handle_list_t event_listeners;
+        {
+            std::lock_guard<std::recursive_mutex> guard(_event_mutex);
+            event_listeners = _event_listeners;
+        }
+
+        PackageManager::instance()._event_dispatcher->post(this, event_name, event_listeners, std::move(event));
+    }
+
+    PackageInfo::DataState PackageInfo::exchange_data_state(DataState state) {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
+        const DataState old_state = _data_state;
+        _data_state = state;
+        if (_registered && old_state != state) {
+            PackageManager::instance()._registry->data_state_changed(old_state, state);
+        }
+        return old_state;
+    }
+
+    PackageInfo::TransferState PackageInfo::exchange_transfer_state(TransferState state) {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
+        const TransferState old_state = _transfer_state;
+        _transfer_state = state;
+        if (_registered && old_state != state) {
+            PackageManager::instance()._registry->transfer_state_changed(old_state, state);
+        }
+        return old_state;
+    }
+
+    void PackageInfo::set_hash(const fc::ripemd160& hash) {
+        PackageManager::instance()._registry->change_keys(*this, &hash, nullptr);
+    }
+
+    void PackageInfo::set_url(const std::string& url) {
+        PackageManager::instance()._registry->change_keys(*this, nullptr, &url);
+    }
+
+    boost::filesystem::path PackageInfo::make_staging_dir() const {
+        return PackageManager::instance()._content_store->make_staging_dir();
+    }
+
+    void PackageInfo::store_files() {
+        std::set<boost::filesystem::path> paths_to_skip;
+        paths_to_skip.insert(get_package_state_dir());
+        paths_to_skip.insert(get_lock_file_path());
+
+        PackageManager::instance()._content_store->add_package(get_package_dir(), paths_to_skip);
+    }
+
+    void PackageInfo::remove_files() {
+        const auto package_dir = get_package_dir();
+
+        detail::manifest_t manifest;
+        if (detail::ContentStore::has_manifest(package_dir)) {
+            manifest = detail::ContentStore::read_manifest(package_dir);
+        }
+
+        boost::filesystem::remove_all(package_dir);
+        PackageManager::instance()._content_store->release(manifest);
+    }
+
+    bool PackageInfo::is_content_verified() const {
+        return PackageManager::instance()._content_store->is_verified(_hash, get_content_file());
+    }
+
+    void PackageInfo::invalidate_if_uses(const std::set<fc::ripemd160>& objects) {
+        auto& _package = *this; // For macros to work.
+
+        const auto package_dir = get_package_dir();
+        if (get_data_state() != CHECKED || !detail::ContentStore::has_manifest(package_dir)) {
+            return;
+        }
+
+        for (const auto& entry : detail::ContentStore::read_manifest(package_dir)) {
+            if (objects.find(entry.object) != objects.end()) {
+                elog("file ${file} of package ${hash} is corrupted", ("file", entry.path) ("hash", _hash.str()) );
+                PACKAGE_INFO_CHANGE_DATA_STATE(INVALID);
+                return;
+            }
+        }
+    }
+
     PackageInfo::DataState PackageInfo::get_data_state() const {
         std::lock_guard<std::recursive_mutex> guard(_mutex);
         return _data_state;
@@ -876,8 +876,22 @@ namespace decent { namespace package {
     }
 */
 
+    namespace {
+
+        // the scrubber reads at most this many bytes of the content store per pass
+        const uint64_t SCRUB_BYTES_PER_PASS = 64 * 1024 * 1024;
+        // and visits at most this many objects, verified ones included
+        const uint32_t SCRUB_OBJECTS_PER_PASS = 4096;
+        const int64_t SCRUB_INTERVAL_SECONDS = 60;
+
+    }
+
     PackageManager::PackageManager(const boost::filesystem::path& packages_path)
         : _packages_path(packages_path)
+        , _event_dispatcher(new detail::EventDispatcher())
+        , _registry(new detail::PackageRegistry())
+        , _archive_version(1)
+        , _scrub_thread("package scrubber")
     {
         if (!exists(_packages_path) || !is_directory(_packages_path)) {
             try {
@@ -892,16 +906,30 @@ namespace decent { namespace package {
             }
         }
 
-//      _proto_transfer_engines["magnet"] = std::make_shared<TorrentTransferEngine>();
+#ifdef DECENT_PACKAGE_WITH_TORRENT
+        _proto_transfer_engines["magnet"] = std::make_shared<TorrentTransferEngine>();
+#endif
         _proto_transfer_engines["ipfs"] = std::make_shared<IPFSTransferEngine>();
         _proto_transfer_engines["local"] = std::make_shared<LocalTransferEngine>();
 
-        //set_libtorrent_config(graphene::utilities::decent_path_finder::instance().get_decent_home() / "libtorrent.json");
+        _content_store.reset(new detail::ContentStore(_packages_path));
+        _scrub_task = _scrub_thread.schedule([this]() { scrub(); }, fc::time_point::now() + fc::seconds(SCRUB_INTERVAL_SECONDS), "package scrub");
+
+        set_libtorrent_config(graphene::utilities::decent_path_finder::instance().get_decent_home() / "libtorrent.json");
 
         // TODO: restore anything?
     }
 
     PackageManager::~PackageManager() {
+        // a running scrub sees the flag before it reschedules, the task to cancel is the last one scheduled
+        fc::future<void> scrub_task;
+        {
+            std::lock_guard<std::mutex> guard(_scrub_mutex);
+            _scrub_stopped = true;
+            scrub_task = _scrub_task;
+        }
+        scrub_task.cancel_and_wait("~PackageManager()");
+
         if (release_all_packages()) {
             elog("some of the packages are used elsewhere, while the package manager instance is shutting down");
         }
@@ -915,71 +943,59 @@ namespace decent { namespace package {
     {
         std::lock_guard<std::recursive_mutex> guard(_mutex);
         package_handle_t package(new PackageInfo(*this, content_dir_path, samples_dir_path, key));
-        return *_packages.insert(package).first;
+        _registry->insert(package);
+        return package;
     }
 
     package_handle_t PackageManager::get_package(const std::string& url, const fc::ripemd160&  hash)
     {
         std::lock_guard<std::recursive_mutex> guard(_mutex);
-        for (auto& package : _packages) {
-
-            if (package->_hash == hash && package->get_data_state() == decent::package::PackageInfo::CHECKED ) {
-                package->_url = url;
+        for (auto& package : _registry->find_all(hash)) {
+            if (package->get_data_state() == decent::package::PackageInfo::CHECKED ) {
+                package->set_url(url);
                 return package;
             }
         }
         package_handle_t package(new PackageInfo(*this, url));
-        return *_packages.insert(package).first;
+        _registry->insert(package);
+        return package;
     }
 
     package_handle_t PackageManager::get_package(const fc::ripemd160& hash)
     {
         std::lock_guard<std::recursive_mutex> guard(_mutex);
 
-        for (auto& package : _packages) {
-            if (package) {
-                if (package->_hash == hash) {
-                    return package;
-                }
-            }
+        package_handle_t package = _registry->find(hash);
+        if (package) {
+            return package;
         }
 
-        package_handle_t package(new PackageInfo(*this, hash));
-        return *_packages.insert(package).first;
+        package.reset(new PackageInfo(*this, hash));
+        _registry->insert(package);
+        return package;
     }
 
 
     package_handle_t PackageManager::find_package(const std::string& url)
     {
-        std::lock_guard<std::recursive_mutex> guard(_mutex);
-        
-        for (auto& pack: _packages) {
-            if (pack->get_url() == url) {
-                return pack;
-            }
-        }
-        return nullptr;
+        return _registry->find(url);
     }
 
     package_handle_t PackageManager::find_package(const fc::ripemd160& hash)
     {
-        std::lock_guard<std::recursive_mutex> guard(_mutex);
-
-        for (auto& package : _packages) {
-            if (package) {
-                if (package->_hash == hash) {
-                    return package;
-                }
-            }
-        }
-
-        return nullptr;
+        return _registry->find(hash);
     }
 
 
     package_handle_set_t PackageManager::get_all_known_packages() const {
-        std::lock_guard<std::recursive_mutex> guard(_mutex);
-        return _packages;
+        return _registry->get_all();
+    }
+
+    PackageManagerStats PackageManager::get_stats() const {
+        PackageManagerStats stats;
+        _registry->fill_stats(stats);
+        _event_dispatcher->fill_stats(stats);
+        return stats;
     }
 
     void PackageManager::recover_all_packages(const event_listener_handle_t& event_listener) {
@@ -990,6 +1006,10 @@ namespace decent { namespace package {
         using namespace boost::filesystem;
 
         for (directory_iterator entry(_packages_path); entry != directory_iterator(); ++entry) {
+            if (entry->path() == _content_store->get_root()) {
+                continue;
+            }
+
             try {
                 const std::string hash_str = entry->path().filename().string();
 
@@ -1005,7 +1025,7 @@ namespace decent { namespace package {
             }
         }
 
-        ilog("read ${size} packages", ("size", _packages.size()) );
+        ilog("read ${size} packages", ("size", _registry->size()) );
     }
 
     bool PackageManager::release_all_packages() {
@@ -1014,11 +1034,12 @@ namespace decent { namespace package {
         bool other_uses = false;
 
         if (!_packages_path.empty()) {
-            ilog("releasing ${size} packages", ("size", _packages.size()) );
+            ilog("releasing ${size} packages", ("size", _registry->size()) );
 
-            for (auto it = _packages.begin(); it != _packages.end(); ) {
-                other_uses = other_uses || it->use_count() > 1;
-                it = _packages.erase(it);
+            for (auto package : _registry->get_all()) {
+                _registry->erase(package);
+                // the copy in the set and this one
+                other_uses = other_uses || package.use_count() > 2;
             }
         }
 
@@ -1030,14 +1051,10 @@ namespace decent { namespace package {
 
         bool other_uses = false;
 
-        for (auto it = _packages.begin(); it != _packages.end(); ) {
-            if (!(*it) || (*it)->_hash == hash) {
-                other_uses = other_uses || it->use_count() > 1;
-                it = _packages.erase(it);
-            }
-            else {
-                ++it;
-            }
+        for (auto& package : _registry->find_all(hash)) {
+            _registry->erase(package);
+            // the copy in the vector
+            other_uses = other_uses || package.use_count() > 1;
         }
 
         return other_uses;
@@ -1045,7 +1062,9 @@ namespace decent { namespace package {
 
     bool PackageManager::release_package(package_handle_t& package) {
         std::lock_guard<std::recursive_mutex> guard(_mutex);
-        _packages.erase(package);
+        if (package) {
+            _registry->erase(package);
+        }
 
         const bool other_uses = (package.use_count() > 1);
         package.reset();
@@ -1053,12 +1072,49 @@ namespace decent { namespace package {
         return other_uses;
     }
 
+    void PackageManager::scrub() {
+        try {
+            const auto corrupt = _content_store->scrub(SCRUB_BYTES_PER_PASS, SCRUB_OBJECTS_PER_PASS);
+
+            if (!corrupt.empty()) {
+                const std::set<fc::ripemd160> objects(corrupt.begin(), corrupt.end());
+                for (auto& package : _registry->get_all()) {
+                    package->invalidate_if_uses(objects);
+                }
+            }
+        }
+        catch (const fc::exception& ex) {
+            elog("content store scrub failed: ${error}", ("error", ex.to_detail_string()) );
+        }
+        catch (const std::exception& ex) {
+            elog("content store scrub failed: ${error}", ("error", ex.what()) );
+        }
+
+        std::lock_guard<std::mutex> guard(_scrub_mutex);
+        if (!_scrub_stopped) {
+            _scrub_task = _scrub_thread.schedule([this]() { scrub(); }, fc::time_point::now() + fc::seconds(SCRUB_INTERVAL_SECONDS), "package scrub");
+        }
+    }
+
     boost::filesystem::path PackageManager::get_packages_path() const {
         std::lock_guard<std::recursive_mutex> guard(_mutex);
         return _packages_path;
     }
 
-    /*void PackageManager::set_libtorrent_config(const boost::filesystem::path& libtorrent_config_file) {
+    void PackageManager::set_archive_version(uint32_t version) {
+        if (version != 1 && version != 2) {
+            FC_THROW("Unsupported archive version ${version}", ("version", version) );
+        }
+
+        _archive_version = version;
+    }
+
+    uint32_t PackageManager::get_archive_version() const {
+        return _archive_version;
+    }
+
+    void PackageManager::set_libtorrent_config(const boost::filesystem::path& libtorrent_config_file) {
+#ifdef DECENT_PACKAGE_WITH_TORRENT
         std::lock_guard<std::recursive_mutex> guard(_mutex);
 
         for(auto& proto_transfer_engine : _proto_transfer_engines) {
@@ -1073,7 +1129,8 @@ namespace decent { namespace package {
                 }
             }
         }
-    }*/
+#endif
+    }
 
     TransferEngineInterface& PackageManager::get_proto_transfer_engine(const std::string& proto) const {
         std::lock_guard<std::recursive_mutex> guard(_mutex);
@@ -0,0 +1,210 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include "registry.hpp"
+
+#include <boost/thread/locks.hpp>
+
+
+namespace decent { namespace package { namespace detail {
+
+
+    PackageRegistry::PackageRegistry()
+        : _size(0)
+    {
+        for (auto& count : _data_states) {
+            count = 0;
+        }
+        for (auto& count : _transfer_states) {
+            count = 0;
+        }
+    }
+
+    void PackageRegistry::insert(const package_handle_t& package) {
+        std::lock_guard<std::mutex> write_guard(_write_mutex);
+
+        fc::ripemd160 hash;
+        std::string url;
+        {
+            std::lock_guard<std::recursive_mutex> guard(package->_mutex);
+            if (package->_registered) {
+                return;
+            }
+            package->_registered = true;
+            ++_data_states[package->_data_state];
+            ++_transfer_states[package->_transfer_state];
+            hash = package->_hash;
+            url = package->_url;
+        }
+
+        index(package, hash, url);
+        ++_size;
+    }
+
+    void PackageRegistry::erase(const package_handle_t& package) {
+        std::lock_guard<std::mutex> write_guard(_write_mutex);
+
+        fc::ripemd160 hash;
+        std::string url;
+        {
+            std::lock_guard<std::recursive_mutex> guard(package->_mutex);
+            if (!package->_registered) {
+                return;
+            }
+            package->_registered = false;
+            --_data_states[package->_data_state];
+            --_transfer_states[package->_transfer_state];
+            hash = package->_hash;
+            url = package->_url;
+        }
+
+        unindex(package.get(), hash, url);
+        --_size;
+    }
+
+    void PackageRegistry::change_keys(PackageInfo& package, const fc::ripemd160* hash, const std::string* url) {
+        std::lock_guard<std::mutex> write_guard(_write_mutex);
+
+        fc::ripemd160 old_hash;
+        std::string old_url;
+        bool registered = false;
+        {
+            std::lock_guard<std::recursive_mutex> guard(package._mutex);
+            old_hash = package._hash;
+            old_url = package._url;
+            registered = package._registered;
+            if (hash) {
+                package._hash = *hash;
+            }
+            if (url) {
+                package._url = *url;
+            }
+        }
+
+        if (!registered) {
+            return;
+        }
+
+        package_handle_t handle;
+        {
+            const hash_shard_t& shard = get_shard(old_hash);
+            boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+            auto range = shard.packages.equal_range(old_hash);
+            for (auto it = range.first; it != range.second && !handle; ++it) {
+                if (it->second.get() == &package) {
+                    handle = it->second;
+                }
+            }
+        }
+
+        if (handle) {
+            // indexed under the new keys first, so lookups never miss the package
+            index(handle, hash ? *hash : old_hash, url ? *url : old_url);
+            unindex(&package, old_hash, old_url);
+        }
+    }
+
+    package_handle_t PackageRegistry::find(const fc::ripemd160& hash) const {
+        const hash_shard_t& shard = get_shard(hash);
+        boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+        auto it = shard.packages.find(hash);
+        return (it == shard.packages.end() ? nullptr : it->second);
+    }
+
+    package_handle_t PackageRegistry::find(const std::string& url) const {
+        const url_shard_t& shard = get_shard(url);
+        boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+        auto it = shard.packages.find(url);
+        return (it == shard.packages.end() ? nullptr : it->second);
+    }
+
+    std::vector<package_handle_t> PackageRegistry::find_all(const fc::ripemd160& hash) const {
+        std::vector<package_handle_t> result;
+        const hash_shard_t& shard = get_shard(hash);
+        boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+        auto range = shard.packages.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            result.push_back(it->second);
+        }
+        return result;
+    }
+
+    package_handle_set_t PackageRegistry::get_all() const {
+        package_handle_set_t result;
+        for (const auto& shard : _by_hash) {
+            boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+            for (const auto& entry : shard.packages) {
+                result.insert(entry.second);
+            }
+        }
+        return result;
+    }
+
+    void PackageRegistry::data_state_changed(PackageInfo::DataState old_state, PackageInfo::DataState new_state) {
+        --_data_states[old_state];
+        ++_data_states[new_state];
+    }
+
+    void PackageRegistry::transfer_state_changed(PackageInfo::TransferState old_state, PackageInfo::TransferState new_state) {
+        --_transfer_states[old_state];
+        ++_transfer_states[new_state];
+    }
+
+    void PackageRegistry::fill_stats(PackageManagerStats& stats) const {
+        stats.packages = _size;
+        stats.downloading = _transfer_states[PackageInfo::DOWNLOADING];
+        stats.seeding = _transfer_states[PackageInfo::SEEDING];
+        stats.partial = _data_states[PackageInfo::PARTIAL];
+        stats.unchecked = _data_states[PackageInfo::UNCHECKED];
+        stats.checked = _data_states[PackageInfo::CHECKED];
+        stats.invalid = _data_states[PackageInfo::INVALID];
+    }
+
+    // _write_mutex must be held
+    void PackageRegistry::index(const package_handle_t& package, const fc::ripemd160& hash, const std::string& url) {
+        {
+            hash_shard_t& shard = get_shard(hash);
+            boost::unique_lock<boost::shared_mutex> lock(shard.mutex);
+            shard.packages.emplace(hash, package);
+        }
+
+        if (!url.empty()) {
+            url_shard_t& shard = get_shard(url);
+            boost::unique_lock<boost::shared_mutex> lock(shard.mutex);
+            shard.packages.emplace(url, package);
+        }
+    }
+
+    // _write_mutex must be held, removes the first entry of the package under each key
+    package_handle_t PackageRegistry::unindex(const PackageInfo* package, const fc::ripemd160& hash, const std::string& url) {
+        package_handle_t result;
+
+        {
+            hash_shard_t& shard = get_shard(hash);
+            boost::unique_lock<boost::shared_mutex> lock(shard.mutex);
+            auto range = shard.packages.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second.get() == package) {
+                    result = it->second;
+                    shard.packages.erase(it);
+                    break;
+                }
+            }
+        }
+
+        if (!url.empty()) {
+            url_shard_t& shard = get_shard(url);
+            boost::unique_lock<boost::shared_mutex> lock(shard.mutex);
+            auto range = shard.packages.equal_range(url);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second.get() == package) {
+                    shard.packages.erase(it);
+                    break;
+                }
+            }
+        }
+
+        return result;
+    }
+
+
+} } } // namespace decent::package::detail
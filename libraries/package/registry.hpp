@@ -0,0 +1,79 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#pragma once
+
+#include <decent/package/package.hpp>
+
+#include <boost/thread/shared_mutex.hpp>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace decent { namespace package { namespace detail {
+
+
+    /**
+     * Known packages, indexed by hash and by URL. Each index is split into shards behind shared mutexes, so a lookup
+     * waits only for a change of a package in the same shard, never for the package lock or a running task. Adding,
+     * removing and re-keying packages are serialized by a mutex of their own. The numbers of packages in every data and
+     * transfer state are counted as the packages change state.
+     */
+    class PackageRegistry {
+    public:
+        static const size_t SHARDS = 16;
+
+        PackageRegistry();
+
+        void insert(const package_handle_t& package);
+        void erase(const package_handle_t& package);
+        /** changes the hash and/or the URL of a package and moves it in the indices */
+        void change_keys(PackageInfo& package, const fc::ripemd160* hash, const std::string* url);
+
+        package_handle_t find(const fc::ripemd160& hash) const;
+        package_handle_t find(const std::string& url) const;
+        /** all packages with the hash, a known package and its new download may both exist */
+        std::vector<package_handle_t> find_all(const fc::ripemd160& hash) const;
+        package_handle_set_t get_all() const;
+        size_t size() const { return _size; }
+
+        // called holding the package mutex
+        void data_state_changed(PackageInfo::DataState old_state, PackageInfo::DataState new_state);
+        void transfer_state_changed(PackageInfo::TransferState old_state, PackageInfo::TransferState new_state);
+
+        void fill_stats(PackageManagerStats& stats) const;
+
+    private:
+        struct hash_hasher {
+            size_t operator()(const fc::ripemd160& hash) const { return hash._hash[0]; }
+        };
+
+        template<typename Key, typename Hasher>
+        struct shard {
+            mutable boost::shared_mutex                                  mutex;
+            std::unordered_multimap<Key, package_handle_t, Hasher>       packages;
+        };
+
+        typedef shard<fc::ripemd160, hash_hasher>           hash_shard_t;
+        typedef shard<std::string, std::hash<std::string>>  url_shard_t;
+
+        hash_shard_t& get_shard(const fc::ripemd160& hash) const { return _by_hash[hash_hasher()(hash) % SHARDS]; }
+        url_shard_t& get_shard(const std::string& url) const     { return _by_url[std::hash<std::string>()(url) % SHARDS]; }
+
+        void index(const package_handle_t& package, const fc::ripemd160& hash, const std::string& url);
+        package_handle_t unindex(const PackageInfo* package, const fc::ripemd160& hash, const std::string& url);
+
+        std::mutex                                  _write_mutex;
+        mutable std::array<hash_shard_t, SHARDS>    _by_hash;
+        mutable std::array<url_shard_t, SHARDS>     _by_url;
+        std::atomic<size_t>                         _size;
+        std::atomic<uint32_t>                       _data_states[PackageInfo::CHECKED + 1];
+        std::atomic<uint32_t>                       _transfer_states[PackageInfo::SEEDING + 1];
+    };
+
+
+} } } // namespace decent::package::detail
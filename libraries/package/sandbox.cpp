@@ -1,10 +1,15 @@
 /* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
 #include <cstddef>
 
+#include "archive.hpp"
+#include "detail.hpp"
+
 #include <decent/package/package.hpp>
 
 #include <boost/interprocess/sync/named_recursive_mutex.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <thread>
 #include <iostream>
 
@@ -254,10 +259,68 @@ void pm_sandbox()
 */
 }
 
+// throughput of archiving the content and of extracting it with one and with all the cores
+void archive_bench(const boost::filesystem::path& content_path, const boost::filesystem::path& work_dir)
+{
+    using namespace boost::filesystem;
+    using clock = std::chrono::steady_clock;
+
+    std::vector<path> all_files;
+    if (is_regular_file(content_path)) {
+        all_files.push_back(content_path);
+    } else {
+        detail::get_files_recursive(content_path, all_files);
+    }
+
+    uint64_t total_size = 0;
+    for (const auto& file : all_files) {
+        total_size += file_size(file);
+    }
+
+    auto report = [total_size](const std::string& what, clock::duration duration) {
+        const double seconds = std::chrono::duration<double>(duration).count();
+        std::cout << what << ": " << seconds << " s, " << total_size / seconds / (1024 * 1024) << " MB/s" << std::endl;
+    };
+
+    create_directories(work_dir);
+    const path archive_path = work_dir / "bench_content.zip";
+
+    auto start = clock::now();
+    {
+        detail::Archiver archiver(archive_path, 2);
+        for (const auto& file : all_files) {
+            archiver.put(is_regular_file(content_path) ? file.filename().string() : detail::get_relative(content_path, file).string(), file);
+        }
+        archiver.finalize();
+    }
+    report("archive " + std::to_string(all_files.size()) + " files", clock::now() - start);
+    std::cout << "archive size: " << file_size(archive_path) << " of " << total_size << " bytes" << std::endl;
+
+    detail::Dearchiver dearchiver(archive_path);
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned threads : { 1u, cores }) {
+        const path output_dir = work_dir / ("bench_extract_" + std::to_string(threads));
+        remove_all(output_dir);
+
+        start = clock::now();
+        dearchiver.extract(output_dir, threads);
+        report("extract with " + std::to_string(threads) + " threads", clock::now() - start);
+
+        remove_all(output_dir);
+    }
+
+    remove(archive_path);
+}
+
 int main(int argc, const char* argv[]) {
     try {
 
-        pm_sandbox();
+        if (argc == 4 && std::string(argv[1]) == "archive-bench") {
+            archive_bench(argv[2], argv[3]);
+        } else {
+            pm_sandbox();
+        }
 
     }
     catch (const fc::exception& ex) {
@@ -23,6 +23,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -772,10 +774,18 @@ namespace decent { namespace package { namespace detail {
     }
 
 
+    // download tasks are driven by torrent_finished, state_update, read_piece and error alerts
+    void add_required_alert_categories(libtorrent::settings_pack& settings_pack) {
+        const int required = libtorrent::alert::error_notification | libtorrent::alert::status_notification | libtorrent::alert::storage_notification;
+        const int current = (settings_pack.has_val(libtorrent::settings_pack::alert_mask) ? settings_pack.get_int(libtorrent::settings_pack::alert_mask) : int(libtorrent::alert::error_notification));
+        settings_pack.set_int(libtorrent::settings_pack::alert_mask, current | required);
+    }
+
     libtorrent::session_params get_default_session_params() {
         libtorrent::session_params p;
         detail::libtorrent_config_data config_data;
         detail::to_settings_pack(config_data.settings, p.settings);
+        detail::add_required_alert_categories(p.settings);
         p.dht_settings = config_data.dht_settings;
         return p;
     }
@@ -928,9 +938,55 @@ namespace decent { namespace package {
                     ("what", alert->what())
                     ("message", alert->message())
             );
+
+            if (auto a = libtorrent::alert_cast<libtorrent::state_update_alert>(alert)) {
+                for (const auto& st : a->status) {
+                    if (auto task = find_download_task(st.handle))
+                        task->on_state_update(st);
+                }
+            }
+            else if (auto a = libtorrent::alert_cast<libtorrent::torrent_finished_alert>(alert)) {
+                if (auto task = find_download_task(a->handle))
+                    task->on_finished();
+            }
+            else if (auto a = libtorrent::alert_cast<libtorrent::read_piece_alert>(alert)) {
+                if (auto task = find_download_task(a->handle)) {
+                    if (a->ec)
+                        task->on_error(a->ec.message());
+                    else
+                        task->on_piece_read(a->piece, a->buffer, a->size);
+                }
+            }
+            else if (auto a = libtorrent::alert_cast<libtorrent::torrent_error_alert>(alert)) {
+                if (auto task = find_download_task(a->handle))
+                    task->on_error(a->error.message());
+            }
+            else if (auto a = libtorrent::alert_cast<libtorrent::file_error_alert>(alert)) {
+                if (auto task = find_download_task(a->handle))
+                    task->on_error(a->error.message());
+            }
         }
     }
 
+    void TorrentTransferEngine::register_download_task(const libtorrent::torrent_handle& handle, TorrentDownloadPackageTask* task)
+    {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
+        _download_tasks[handle] = task;
+    }
+
+    void TorrentTransferEngine::unregister_download_task(const libtorrent::torrent_handle& handle)
+    {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
+        _download_tasks.erase(handle);
+    }
+
+    TorrentDownloadPackageTask* TorrentTransferEngine::find_download_task(const libtorrent::torrent_handle& handle) const
+    {
+        std::lock_guard<std::recursive_mutex> guard(_mutex);
+        auto it = _download_tasks.find(handle);
+        return (it == _download_tasks.end() ? nullptr : it->second);
+    }
+
     void TorrentTransferEngine::reconfigure(const boost::filesystem::path& config_file)
     {
         if (!config_file.empty() && !boost::filesystem::exists(config_file)) {
@@ -941,6 +997,7 @@ namespace decent { namespace package {
 
         libtorrent::settings_pack sp;
         detail::to_settings_pack(_config_data.settings, sp);
+        detail::add_required_alert_categories(sp);
 
         _session.pause();
         _session.apply_settings(sp);
@@ -1124,7 +1181,7 @@ namespace decent { namespace package {
         _torrent_handle = _engine._session.add_torrent(atp);
 
         if (seed_mode) {
-            _package._url = make_magnet_uri(_torrent_handle);
+            _package.set_url(make_magnet_uri(_torrent_handle));
 
             _torrent_handle.set_max_uploads(utp.max_uploads);
             _torrent_handle.set_max_connections(utp.max_connections);
@@ -1185,12 +1242,114 @@ namespace decent { namespace package {
         }
     }
 
+    void TorrentDownloadPackageTask::on_state_update(const libtorrent::torrent_status& st) {
+        std::lock_guard<std::mutex> guard(_event_mutex);
+
+        if (st.errc) {
+            _error = st.errc.message();
+        }
+
+        if (st.total_wanted != _total_wanted || st.total_wanted_done != _total_wanted_done) {
+            _total_wanted = st.total_wanted;
+            _total_wanted_done = st.total_wanted_done;
+            _progress_changed = true;
+        }
+
+        if (st.has_metadata) {
+            init_content_hashing();
+            for (int i = 0; i < st.pieces.size() && i < int(_have_pieces.size()); ++i) {
+                if (st.pieces.get_bit(i))
+                    _have_pieces[i] = true;
+            }
+            request_next_piece_read();
+        }
+
+        _event_cv.notify_all();
+    }
+
+    void TorrentDownloadPackageTask::on_finished() {
+        std::lock_guard<std::mutex> guard(_event_mutex);
+
+        init_content_hashing();
+        std::fill(_have_pieces.begin(), _have_pieces.end(), true);
+        _finished = true;
+        request_next_piece_read();
+
+        _event_cv.notify_all();
+    }
+
+    void TorrentDownloadPackageTask::on_piece_read(int piece, const boost::shared_array<char>& buffer, int size) {
+        std::lock_guard<std::mutex> guard(_event_mutex);
+        _pieces_to_hash.push_back({piece, buffer, size});
+        _event_cv.notify_all();
+    }
+
+    void TorrentDownloadPackageTask::on_error(const std::string& message) {
+        std::lock_guard<std::mutex> guard(_event_mutex);
+        _error = message;
+        _event_cv.notify_all();
+    }
+
+    // _event_mutex must be held
+    void TorrentDownloadPackageTask::init_content_hashing() {
+        if (_hashing_initialized)
+            return;
+
+        auto ti = _torrent_handle.torrent_file();
+        if (!ti)
+            return;
+
+        const libtorrent::file_storage& fs = ti->files();
+        for (int i = 0; i < fs.num_files(); ++i) {
+            if (boost::filesystem::path(fs.file_path(i)).filename() == "content.zip.aes") {
+                _content_found = true;
+                _content_offset = fs.file_offset(i);
+                _content_size = fs.file_size(i);
+                break;
+            }
+        }
+
+        _piece_length = ti->piece_length();
+        _have_pieces.assign(ti->num_pieces(), false);
+        _hashing_initialized = true;
+    }
+
+    // _event_mutex must be held
+    void TorrentDownloadPackageTask::request_next_piece_read() {
+        if (!_hashing_initialized || !_content_found || _piece_read_pending)
+            return;
+
+        const int num_pieces = int(_have_pieces.size());
+        while (_next_piece_to_hash < num_pieces && _have_pieces[_next_piece_to_hash]) {
+            const int64_t piece_begin = int64_t(_next_piece_to_hash) * _piece_length;
+            const int64_t piece_end = piece_begin + _piece_length;
+
+            if (piece_end > _content_offset && piece_begin < _content_offset + _content_size) {
+                _piece_read_pending = true;
+                _torrent_handle.read_piece(_next_piece_to_hash);
+                return;
+            }
+
+            ++_next_piece_to_hash;
+        }
+    }
+
+    void TorrentDownloadPackageTask::hash_piece(const piece_data& data) {
+        const int64_t piece_begin = int64_t(data.piece) * _piece_length;
+        const int64_t begin = std::max(piece_begin, _content_offset);
+        const int64_t end = std::min(piece_begin + data.size, _content_offset + _content_size);
+
+        if (end > begin) {
+            _content_hash.write(data.buffer.get() + (begin - piece_begin), end - begin);
+        }
+    }
+
     void TorrentDownloadPackageTask::task() {
         PACKAGE_INFO_GENERATE_EVENT(package_download_start, ( ) );
 
         using namespace boost::filesystem;
 
-        const auto temp_dir_path = unique_path(graphene::utilities::decent_path_finder::instance().get_decent_temp() / "%%%%-%%%%-%%%%-%%%%");
+        const auto temp_dir_path = _package.make_staging_dir();
         
         try {
             PACKAGE_TASK_EXIT_IF_REQUESTED;
@@ -1201,42 +1360,76 @@ namespace decent { namespace package {
 
             PACKAGE_INFO_CHANGE_TRANSFER_STATE(DOWNLOADING);
 
-            fc_ilog(_engine._transfer_logger, "torrent seeding started for package: %{hash}", ("hash", _package._hash.str()) );
+            fc_ilog(_engine._transfer_logger, "torrent download started for package: %{hash}", ("hash", _package._hash.str()) );
 
             const bool seed_mode = false;
-            initialize_handle(seed_mode, temp_dir_path);
+            {
+                // alerts may arrive as soon as the torrent is added
+                std::lock_guard<std::recursive_mutex> guard(_engine._mutex);
+                initialize_handle(seed_mode, temp_dir_path);
+                _engine.register_download_task(_torrent_handle, this);
+            }
+
+            std::unique_lock<std::mutex> lock(_event_mutex);
 
             while (true) {
                 PACKAGE_TASK_EXIT_IF_REQUESTED;
 
-                _engine._session.post_torrent_updates();
-                _engine._session.post_session_stats();
-                _engine._session.post_dht_stats();
-                _engine._session.post_torrent_updates();
+                if (!_error.empty()) {
+                    FC_THROW("torrent error: ${msg}", ("msg", _error) );
+                }
 
-                libtorrent::torrent_status st = _torrent_handle.status();
+                while (!_pieces_to_hash.empty()) {
+                    const piece_data data = _pieces_to_hash.front();
+                    _pieces_to_hash.pop_front();
 
-                const bool is_finished = (st.total_wanted != 0 && st.total_wanted_done >= st.total_wanted); // (st.state == libtorrent::torrent_status::finished || st.state == libtorrent::torrent_status::seeding);
-                const bool is_error = (st.errc != 0);
+                    lock.unlock();
+                    hash_piece(data);
+                    lock.lock();
 
-                if (is_error) {
-                    FC_THROW("torrent error: ${msg}", ("msg", st.errc.message()) );
+                    ++_next_piece_to_hash;
+                    _piece_read_pending = false;
+                    request_next_piece_read();
                 }
 
-                // Report st.total_wanted, st.total_wanted_done, st.download_rate, etc.
-//              PACKAGE_INFO_GENERATE_EVENT(package_download_progress, ( ) );
+                if (_progress_changed) {
+                    _progress_changed = false;
+                    const uint64_t total_wanted = _total_wanted;
+                    const uint64_t total_wanted_done = _total_wanted_done;
+
+                    lock.unlock();
+                    {
+                        std::lock_guard<std::recursive_mutex> guard(_package._mutex);
+                        _package._size = total_wanted;
+                        _package._downloaded_size = total_wanted_done;
+                    }
+                    PACKAGE_INFO_GENERATE_EVENT(package_download_progress, ( ) );
+                    lock.lock();
+                    continue;
+                }
 
-                if (is_finished) {
+                if (_finished && (!_content_found || (!_piece_read_pending && _next_piece_to_hash >= int(_have_pieces.size())))) {
                     break;
                 }
 
-                std::this_thread::sleep_for(std::chrono::seconds(3));
+                if (_event_cv.wait_for(lock, std::chrono::seconds(1)) == std::cv_status::timeout) {
+                    // progress comes with the state_update alerts, which are posted on request only
+                    _engine._session.post_torrent_updates(libtorrent::torrent_handle::query_pieces);
+                }
             }
 
+            lock.unlock();
+
+            _engine.unregister_download_task(_torrent_handle);
             reset_torrent_by_handle();
 
-            const auto content_file = temp_dir_path / "content.zip.aes";
-            _package._hash = detail::calculate_hash(content_file);
+            if (_content_found) {
+                _package.set_hash(_content_hash.result());
+            }
+            else {
+                _package.set_hash(detail::calculate_hash(temp_dir_path / "content.zip.aes"));
+            }
+
             const auto package_dir = _package.get_package_dir();
 
             PACKAGE_TASK_EXIT_IF_REQUESTED;
@@ -1257,6 +1450,7 @@ namespace decent { namespace package {
             paths_to_skip.insert(_package.get_package_state_dir(temp_dir_path));
             paths_to_skip.insert(_package.get_lock_file_path(temp_dir_path));
             detail::move_all_except(temp_dir_path, package_dir, paths_to_skip);
+            _package.store_files();
             
             remove_all(temp_dir_path);
             
@@ -1265,6 +1459,7 @@ namespace decent { namespace package {
             PACKAGE_INFO_GENERATE_EVENT(package_download_complete, ( ) );
         }
         catch ( const fc::exception& ex ) {
+            _engine.unregister_download_task(_torrent_handle);
             reset_torrent_by_handle();
             remove_all(temp_dir_path);
             _package.unlock_dir();
@@ -1274,6 +1469,7 @@ namespace decent { namespace package {
             throw;
         }
         catch ( const std::exception& ex ) {
+            _engine.unregister_download_task(_torrent_handle);
             reset_torrent_by_handle();
             remove_all(temp_dir_path);
             _package.unlock_dir();
@@ -1283,6 +1479,7 @@ namespace decent { namespace package {
             throw;
         }
         catch ( ... ) {
+            _engine.unregister_download_task(_torrent_handle);
             reset_torrent_by_handle();
             remove_all(temp_dir_path);
             _package.unlock_dir();
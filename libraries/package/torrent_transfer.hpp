@@ -10,10 +10,17 @@
 
 #include <boost/filesystem.hpp>
 
+#include <fc/crypto/ripemd160.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/thread/thread.hpp>
 
+#include <boost/shared_array.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 
 
 namespace decent { namespace package {
@@ -110,12 +117,54 @@ namespace decent { namespace package {
     };
 
 
+    /**
+     * Downloads a package driven by the alerts dispatched from TorrentTransferEngine::handle_torrent_alerts.
+     * The package hash is calculated while the pieces arrive, reading every verified piece once in order,
+     * so the content file does not have to be re-read after the download finishes.
+     */
     class TorrentDownloadPackageTask : public TorrentPackageTask {
     public:
         using TorrentPackageTask::TorrentPackageTask;
 
+        // called from the alert handling thread
+        void on_state_update(const libtorrent::torrent_status& st);
+        void on_finished();
+        void on_piece_read(int piece, const boost::shared_array<char>& buffer, int size);
+        void on_error(const std::string& message);
+
     protected:
         virtual void task() override;
+
+    private:
+        struct piece_data {
+            int                        piece;
+            boost::shared_array<char>  buffer;
+            int                        size;
+        };
+
+        void init_content_hashing();
+        void request_next_piece_read();
+        void hash_piece(const piece_data& data);
+
+        std::mutex                  _event_mutex;
+        std::condition_variable     _event_cv;
+        bool                        _finished = false;
+        std::string                 _error;
+        bool                        _progress_changed = false;
+        uint64_t                    _total_wanted = 0;
+        uint64_t                    _total_wanted_done = 0;
+
+        // incremental hash of content.zip.aes
+        bool                        _hashing_initialized = false;
+        bool                        _content_found = false;
+        int64_t                     _content_offset = 0;
+        int64_t                     _content_size = 0;
+        int64_t                     _piece_length = 0;
+        std::vector<bool>           _have_pieces;
+        int                         _next_piece_to_hash = 0;
+        bool                        _piece_read_pending = false;
+        std::deque<piece_data>      _pieces_to_hash;
+        fc::ripemd160::encoder      _content_hash;
     };
 
 
@@ -156,11 +205,16 @@ namespace decent { namespace package {
         void dump_config(const boost::filesystem::path& config_file);
 
     private:
+        void register_download_task(const libtorrent::torrent_handle& handle, TorrentDownloadPackageTask* task);
+        void unregister_download_task(const libtorrent::torrent_handle& handle);
+        TorrentDownloadPackageTask* find_download_task(const libtorrent::torrent_handle& handle) const;
+
         fc::logger                      _transfer_logger;
         detail::libtorrent_config_data  _config_data;
         mutable std::recursive_mutex    _mutex;
         fc::thread                      _thread;
         libtorrent::session             _session;
+        std::map<libtorrent::torrent_handle, TorrentDownloadPackageTask*> _download_tasks;
     };
     
     
@@ -30,6 +30,7 @@ class debug_api_impl
       //void debug_save_db( std::string db_path );
       void debug_stream_json_objects( const std::string& filename );
       void debug_stream_json_objects_flush();
+      graphene::debug_miner_plugin::block_state_digest debug_get_state_digest( uint32_t block_num );
       std::shared_ptr< graphene::debug_miner_plugin::debug_miner_plugin > get_plugin();
 
       graphene::app::application& app;
@@ -122,6 +123,19 @@ void debug_api_impl::debug_stream_json_objects_flush()
    get_plugin()->flush_json_object_stream();
 }
 
+graphene::debug_miner_plugin::block_state_digest debug_api_impl::debug_get_state_digest( uint32_t block_num )
+{
+   if( block_num != 0 )
+      return get_plugin()->get_state_digest( block_num );
+
+   std::shared_ptr< graphene::chain::database > db = app.chain_database();
+   graphene::debug_miner_plugin::block_state_digest result;
+   result.block_num = db->head_block_num();
+   result.block_id = db->head_block_id();
+   result.state = db->get_state_digest();
+   return result;
+}
+
 } // detail
 
 debug_api::debug_api( graphene::app::application& app )
@@ -154,5 +168,10 @@ void debug_api::debug_stream_json_objects_flush()
    my->debug_stream_json_objects_flush();
 }
 
+graphene::debug_miner_plugin::block_state_digest debug_api::debug_get_state_digest( uint32_t block_num )
+{
+   return my->debug_get_state_digest( block_num );
+}
+
 
 } } // graphene::debug_miner
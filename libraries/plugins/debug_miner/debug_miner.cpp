@@ -50,7 +50,9 @@ void debug_miner_plugin::plugin_set_program_options(
    command_line_options.add_options()
          ("private-key", bpo::value<vector<string>>()->composing()->multitoken()->
           DEFAULT_VALUE_VECTOR(std::make_pair(chain::public_key_type(default_priv_key.get_public_key()), graphene::utilities::key_to_wif(default_priv_key))),
-          "Tuple of [PublicKey, WIF private key] (may specify multiple times)");
+          "Tuple of [PublicKey, WIF private key] (may specify multiple times)")
+         ("state-digest-history", bpo::value<uint32_t>()->default_value(1000),
+          "Number of recent blocks whose state digest is kept for debug_get_state_digest");
    config_file_options.add(command_line_options);
 }
 
@@ -88,6 +90,8 @@ void debug_miner_plugin::plugin_initialize(const boost::program_options::variabl
          _private_keys[key_id_to_wif_pair.first] = *private_key;
       }
    }
+   if( options.count("state-digest-history") )
+      _state_digest_history = options["state-digest-history"].as<uint32_t>();
    ilog("debug_miner plugin:  plugin_initialize() end");
 } FC_LOG_AND_RETHROW() }
 
@@ -140,12 +144,30 @@ void debug_miner_plugin::on_removed_objects( const std::vector<const graphene::d
 
 void debug_miner_plugin::on_applied_block( const graphene::chain::signed_block& b )
 {
+   if( _state_digest_history > 0 )
+   {
+      // a block applied again after a fork switch replaces the digest of the popped one
+      block_state_digest& item = _state_digests[ b.block_num() ];
+      item.block_num = b.block_num();
+      item.block_id = b.id();
+      item.state = database().get_state_digest();
+      while( _state_digests.size() > _state_digest_history )
+         _state_digests.erase( _state_digests.begin() );
+   }
+
    if( _json_object_stream )
    {
       (*_json_object_stream) << "{\"bn\":" << fc::to_string( b.block_num() ) << "}\n";
    }
 }
 
+block_state_digest debug_miner_plugin::get_state_digest( uint32_t block_num )const
+{
+   auto itr = _state_digests.find( block_num );
+   FC_ASSERT( itr != _state_digests.end(), "State digest of block ${n} is not recorded", ("n", block_num) );
+   return itr->second;
+}
+
 void debug_miner_plugin::set_json_object_stream( const std::string& filename )
 {
    if( _json_object_stream )
@@ -29,6 +29,8 @@
 #include <fc/api.hpp>
 #include <fc/variant_object.hpp>
 
+#include <graphene/debug_miner/debug_miner.hpp>
+
 namespace graphene { namespace app {
 class application;
 } }
@@ -82,6 +84,12 @@ class debug_api
        */
       void debug_stream_json_objects_flush();
 
+      /**
+       * State digest of the database after the block was applied, with the state hash of every index.
+       * @param block_num Number of one of the recent blocks, or 0 for the current state
+       */
+      graphene::debug_miner_plugin::block_state_digest debug_get_state_digest( uint32_t block_num );
+
       std::shared_ptr< detail::debug_api_impl > my;
 };
 
@@ -93,4 +101,5 @@ FC_API(graphene::debug_miner::debug_api,
        (debug_update_object)
        (debug_stream_json_objects)
        (debug_stream_json_objects_flush)
+       (debug_get_state_digest)
      )
@@ -30,6 +30,16 @@
 
 namespace graphene { namespace debug_miner_plugin {
 
+/**
+ * State digest of the database after a block was applied
+ */
+struct block_state_digest
+{
+   uint32_t                      block_num = 0;
+   graphene::chain::block_id_type block_id;
+   graphene::db::state_digest    state;
+};
+
 class debug_miner_plugin : public graphene::app::plugin {
 public:
    ~debug_miner_plugin();
@@ -48,6 +58,12 @@ public:
    void set_json_object_stream( const std::string& filename );
    void flush_json_object_stream();
 
+   /**
+    * Returns the state digest recorded after the block was applied, the block must be one of the last
+    * state-digest-history blocks applied by this node.
+    */
+   block_state_digest get_state_digest( uint32_t block_num )const;
+
 private:
 
    void on_changed_objects( const std::vector<graphene::db::object_id_type>& ids );
@@ -59,9 +75,13 @@ private:
    std::map<chain::public_key_type, fc::ecc::private_key> _private_keys;
 
    std::shared_ptr< std::ofstream > _json_object_stream;
+   uint32_t _state_digest_history = 1000;
+   std::map< uint32_t, block_state_digest > _state_digests;
    boost::signals2::scoped_connection _applied_block_conn;
    boost::signals2::scoped_connection _changed_objects_conn;
    boost::signals2::scoped_connection _removed_objects_conn;
 };
 
 } } //graphene::debug_miner_plugin
+
+FC_REFLECT( graphene::debug_miner_plugin::block_state_digest, (block_num)(block_id)(state) )
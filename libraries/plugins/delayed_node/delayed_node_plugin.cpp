@@ -33,6 +33,8 @@
 #include <fc/api.hpp>
 #include <fc/smart_ref_impl.hpp>
 
+#include <deque>
+
 
 namespace graphene { namespace delayed_node {
 namespace bpo = boost::program_options;
@@ -46,6 +48,15 @@ struct delayed_node_plugin_impl {
    boost::signals2::scoped_connection client_connection_closed;
    graphene::chain::block_id_type last_received_remote_head;
    graphene::chain::block_id_type last_processed_remote_head;
+   uint32_t batch_size = 50;
+   uint32_t max_batches_in_flight = 4;
+};
+
+/// a get_blocks request that has been sent to the trusted node but whose blocks haven't been pushed yet
+struct block_batch_request {
+   uint32_t first_block_num;
+   uint32_t count;
+   fc::future<std::vector<graphene::chain::signed_block>> blocks;
 };
 }
 
@@ -60,6 +71,8 @@ void delayed_node_plugin::plugin_set_program_options(bpo::options_description& c
 {
    cli.add_options()
          ("trusted-node", boost::program_options::value<std::string>()->required(), "RPC endpoint of a trusted validating node (required)")
+         ("trusted-node-batch-size", boost::program_options::value<uint32_t>()->default_value(50), "Number of blocks fetched from the trusted node in a single request (1-100)")
+         ("trusted-node-batches-in-flight", boost::program_options::value<uint32_t>()->default_value(4), "Number of block requests kept outstanding while earlier blocks are being applied")
          ;
    cfg.add(cli);
 }
@@ -76,6 +89,12 @@ void delayed_node_plugin::connect()
 void delayed_node_plugin::plugin_initialize(const boost::program_options::variables_map& options)
 {
    my->remote_endpoint = "ws://" + options.at("trusted-node").as<std::string>();
+   if( options.count("trusted-node-batch-size") )
+      my->batch_size = options.at("trusted-node-batch-size").as<uint32_t>();
+   if( options.count("trusted-node-batches-in-flight") )
+      my->max_batches_in_flight = options.at("trusted-node-batches-in-flight").as<uint32_t>();
+   FC_ASSERT( my->batch_size >= 1 && my->batch_size <= 100, "trusted-node-batch-size must be between 1 and 100" );
+   FC_ASSERT( my->max_batches_in_flight >= 1, "trusted-node-batches-in-flight must be at least 1" );
 }
 
 void delayed_node_plugin::sync_with_trusted_node()
@@ -99,13 +118,60 @@ void delayed_node_plugin::sync_with_trusted_node()
          break;
       }
       pass_count++;
+
+      // Keep several get_blocks requests outstanding so the round trip to the trusted node overlaps
+      // with applying the blocks we already have.  The requests are answered in order, so the next
+      // batch to push is always at the front of the queue.
+      std::deque<detail::block_batch_request> batches_in_flight;
+      uint32_t next_block_to_request = db.head_block_num() + 1;
       while( remote_dpo.last_irreversible_block_num > db.head_block_num() )
       {
-         fc::optional<graphene::chain::signed_block> block = my->database_api->get_block( db.head_block_num()+1 );
-         FC_ASSERT(block, "Trusted node claims it has blocks it doesn't actually have.");
-         ilog("Pushing block #${n}", ("n", block->block_num()));
-         db.push_block(*block, 0, false);
-         synced_blocks++;
+         while( batches_in_flight.size() < my->max_batches_in_flight &&
+                next_block_to_request <= remote_dpo.last_irreversible_block_num )
+         {
+            uint32_t count = std::min( my->batch_size, remote_dpo.last_irreversible_block_num - next_block_to_request + 1 );
+            fc::api<graphene::app::database_api> database_api = my->database_api;
+            detail::block_batch_request request{ next_block_to_request, count,
+               fc::async( [database_api, next_block_to_request, count]() {
+                  return database_api->get_blocks( next_block_to_request, count );
+               }, "delayed_node_get_blocks" ) };
+            batches_in_flight.push_back( std::move( request ) );
+            next_block_to_request += count;
+         }
+
+         detail::block_batch_request request = std::move( batches_in_flight.front() );
+         batches_in_flight.pop_front();
+         std::vector<graphene::chain::signed_block> blocks = request.blocks.wait();
+         FC_ASSERT( !blocks.empty(), "Trusted node claims it has blocks it doesn't actually have." );
+         FC_ASSERT( request.first_block_num == db.head_block_num() + 1,
+                    "Trusted node answered with block #${n} while we need block #${h}",
+                    ("n", request.first_block_num)("h", db.head_block_num() + 1) );
+
+         for( const graphene::chain::signed_block& block : blocks )
+         {
+            ilog("Pushing block #${n}", ("n", block.block_num()));
+            db.push_block(block, 0, false);
+            synced_blocks++;
+         }
+
+         if( blocks.size() < request.count )
+         {
+            // the trusted node returned fewer blocks than it claimed to have; drop the requests that
+            // no longer line up with our head and start over from where we are
+            for( detail::block_batch_request& stale_request : batches_in_flight )
+            {
+               try
+               {
+                  stale_request.blocks.wait();
+               }
+               catch( const fc::exception& e )
+               {
+                  wlog( "Discarding stale request to trusted node: ${e}", ("e", e.to_detail_string()) );
+               }
+            }
+            batches_in_flight.clear();
+            next_block_to_request = db.head_block_num() + 1;
+         }
       }
    }
 }
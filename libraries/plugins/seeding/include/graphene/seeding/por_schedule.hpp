@@ -0,0 +1,72 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#pragma once
+#include <fc/filesystem.hpp>
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/composite_key.hpp>
+
+#include <string>
+#include <vector>
+
+namespace decent { namespace seeding {
+
+   /**
+    * @class por_schedule - Next due time of the proof of retrievability of every seeded package, by URI.
+    *
+    * Ordered by the due time, so the seeding plugin sleeps until the earliest one instead of polling every package. The
+    * schedule is saved to a file and loaded again on start, so proofs are not generated twice after a restart.
+    */
+   class por_schedule
+   {
+      public:
+         struct entry
+         {
+            std::string         URI;
+            fc::time_point_sec  due;
+         };
+
+         /** sets the due time of the URI, replacing the previous one */
+         void set( const std::string& URI, fc::time_point_sec due );
+         void erase( const std::string& URI );
+         fc::optional<fc::time_point_sec> find( const std::string& URI )const;
+
+         /** the earliest due time, if anything is scheduled */
+         fc::optional<fc::time_point_sec> next_due()const;
+         /** removes and returns at most max URIs due at now, earliest first */
+         std::vector<std::string> pop_due( fc::time_point_sec now, size_t max );
+
+         size_t size()const { return _entries.size(); }
+
+         void load( const fc::path& file );
+         void save( const fc::path& file )const;
+
+      private:
+         struct by_URI;
+         struct by_due;
+
+         typedef boost::multi_index_container<
+            entry,
+            boost::multi_index::indexed_by<
+               boost::multi_index::ordered_unique< boost::multi_index::tag<by_URI>,
+                  boost::multi_index::member<entry, std::string, &entry::URI>
+               >,
+               boost::multi_index::ordered_unique< boost::multi_index::tag<by_due>,
+                  boost::multi_index::composite_key< entry,
+                     boost::multi_index::member<entry, fc::time_point_sec, &entry::due>,
+                     boost::multi_index::member<entry, std::string, &entry::URI>
+                  >
+               >
+            >
+         > entry_set;
+
+         entry_set _entries;
+   };
+
+}}
+
+FC_REFLECT( decent::seeding::por_schedule::entry, (URI)(due) )
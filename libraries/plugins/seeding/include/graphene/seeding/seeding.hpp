@@ -7,7 +7,13 @@
 #include <graphene/db/generic_index.hpp>
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/seeding/seeding_utility.hpp>
+#include <graphene/seeding/por_schedule.hpp>
 #include <decent/package/package.hpp>
+#include <decent/encrypt/crypto_types.hpp>
+
+#include <boost/multi_index/hashed_index.hpp>
+
+#include <set>
 
 namespace decent { namespace seeding {
 
@@ -84,7 +90,7 @@ typedef multi_index_container<
       my_seeding_object,
       indexed_by<
             ordered_unique< tag<by_id>, member< object, object_id_type, &object::id >>,
-            ordered_unique< tag< by_URI >, member< my_seeding_object, string, &my_seeding_object::URI> >,
+            hashed_unique< tag< by_URI >, member< my_seeding_object, string, &my_seeding_object::URI> >,
             ordered_unique< tag< by_hash >, member< my_seeding_object, fc::ripemd160, &my_seeding_object::_hash> >
       >
 >my_seeding_object_multi_index_type;
@@ -96,7 +102,43 @@ namespace detail {
 
 class SeedingListener;
 
+/**
+ * Outcome of a PoR generation
+ */
+struct por_result
+{
+   fc::optional<fc::time_point_sec> next_due;
+   /// the package data was not on disk and had to be downloaded for the proof
+   bool downloaded = false;
+};
+
+/**
+ * A package whose data had to be downloaded again to prove it. From the second download on it is kept on disk, as long
+ * as the resident packages fit into the limit; the least recently proven ones are removed to make room.
+ */
+struct resident_package
+{
+   uint64_t           size = 0;
+   uint32_t           downloads = 0;
+   fc::time_point_sec last_used;
+   bool               resident = false;
+};
 
+/**
+ * Everything a deliver_keys_operation for a request to buy is made of, collected from the database so the key can be
+ * re-encrypted without holding it
+ */
+struct key_delivery
+{
+   account_id_type                  seeder;
+   fc::ecc::private_key             seeder_key;
+   decent::encrypt::DIntegerString  content_key;
+   decent::encrypt::Ciphertext      key_part;
+   buying_id_type                   buying;
+   block_id_type                    head_block_id;
+   fc::time_point_sec               head_block_time;
+   chain_id_type                    chain_id;
+};
 
 /**
  * @class seeding_plugin_impl This class implements the seeder functionality.
@@ -121,11 +163,45 @@ public:
    //void generate_por( my_seeding_id_type so_id, graphene::package::package_object downloaded_package );
 
    /**
-    * Generates proof of retrievability of a package
-    * @param so_id ID of the my_seeding_object
-    * @param downloaded_package Downloaded package object
+    * Adds a package to the PoR schedule. It is looked at right away, unless a due time was saved before a restart.
+    * @param so The my_seeding_object of the package
+    * @param package_handle The package, downloaded and seeding
+    */
+   void schedule_por( const my_seeding_object& so, decent::package::package_handle_t package_handle );
+
+   /**
+    * Writes the PoR schedule a few seconds after it changed, the changes made meanwhile are written with it
+    */
+   void save_por_schedule();
+
+   /**
+    * Generates and broadcasts the proof of retrievability of a package if it is due, runs on one of por_threads
+    * @param URI URI of the content
+    * @param package_handle The package
+    * @return When the schedule shall look at the package again, nothing once the content expired
     */
-   void generate_por2( const my_seeding_object& so, decent::package::package_handle_t package_handle );
+   por_result generate_por( const std::string& URI, decent::package::package_handle_t package_handle );
+
+   /**
+    * Starts the proofs that are due, as many as por_max_concurrent allows
+    */
+   void run_due_pors();
+
+   /**
+    * Puts the package back to the schedule once its proof is done, on the service thread
+    */
+   void finish_por( const std::string& URI, decent::package::package_handle_t package_handle, const por_result& result );
+
+   /**
+    * Sleeps the service thread until the earliest due proof
+    */
+   void arm_por_timer();
+
+   /**
+    * Decides whether a package downloaded again for its proof stays on disk, see resident_package. Packages whose
+    * proof is being generated are never removed to make room
+    */
+   void keep_or_remove_por_package( const std::string& URI, decent::package::package_handle_t package_handle );
 
    /**
     * Process new content, from content_object
@@ -145,13 +221,29 @@ public:
    void handle_content_submit(const content_submit_operation &op);
 
    /**
-    * Handle request to buy. If it is concerning one of content seeded by the plugin, provide decryption key parts in deliver key
+    * Handle request to buy. If it is concerning one of content seeded by the plugin, provide decryption key parts in deliver key.
+    * Must not be called on the chain thread, it waits for the chain thread to push the transaction
     * @param op_obj The operation wrapper carrying content request to buy operation
     */
    void handle_request_to_buy(const request_to_buy_operation &op);
 
    /**
-    * Called only after the highest known block has been applied. If it is request to buy or content submit, pass it to the corresponding handler
+    * Collects what is needed to deliver the key for a request to buy
+    * @param op The request to buy
+    * @return Nothing if the content is not seeded by the plugin or has expired
+    */
+   fc::optional<key_delivery> find_key_delivery(const request_to_buy_operation &op);
+
+   /**
+    * Re-encrypts the key particle for the consumer and signs the deliver keys transaction, does not touch the database
+    * @param kd Data collected by find_key_delivery
+    * @param op The request to buy
+    */
+   signed_transaction make_deliver_keys(const key_delivery &kd, const request_to_buy_operation &op);
+
+   /**
+    * Called on the plugin queue thread for every operation of a committed block. If it is request to buy or content
+    * submit, pass it to the corresponding handler
     * @param op_obj The operation wrapper
     * @param sync_mode
     */
@@ -162,6 +254,11 @@ public:
     */
    void restore_state();
 
+   /**
+    * Recreates the my_seeding_objects from the contents seeded by our seeders, runs on the chain thread
+    */
+   void rebuild_seeding_objects();
+
    /**
     * Resend all possibly missed keys
     */
@@ -177,7 +274,21 @@ public:
    seeding_plugin& _self;
 //   std::map<package_transfer_interface::transfer_id, my_seeding_id_type> active_downloads; //<List of active downloads for whose we are expecting on_download_finished callback to be called
    std::shared_ptr<fc::thread> service_thread; //The thread where the computation shall happen
-   fc::thread* main_thread; //The main thread, used mainly for DB modifications
+   std::shared_ptr<graphene::chain::committed_operation_queue> committed_operations; //The queue of committed operations handled by the plugin
+
+   por_schedule por_queue; //Next due PoR of every seeded package
+   fc::path por_schedule_file; //Where por_queue is saved
+   std::map<std::string, decent::package::package_handle_t> por_packages; //Packages in the schedule
+   std::vector<std::shared_ptr<fc::thread>> por_threads; //Threads generating the proofs
+   uint32_t next_por_thread = 0;
+   std::set<std::string> por_in_flight; //URIs of the proofs being generated, at most por_threads.size()
+   fc::future<void> por_timer; //Wakes the service thread at por_timer_due
+   fc::time_point_sec por_timer_due;
+   fc::future<void> por_save_timer; //Writes por_queue to por_schedule_file
+   bool por_restoring = false; //restore_state is adding the packages, it saves the schedule once at the end
+   std::map<std::string, resident_package> por_downloads;
+   uint64_t por_resident_limit = 0; //In bytes
+   uint64_t por_resident_size = 0;
 
 };
 
@@ -202,23 +313,35 @@ public:
       auto& pm = decent::package::PackageManager::instance();
 
       pi = _pi;
-      //we want to restart the download; however, this method is being called from pi->_download_task::Task method, so we can't restart directly, so we will start asynchronously
-      fc::thread::current().async([pi](){ pi->download(true);});
+      //events are delivered on the package manager event thread, the restart waits there for the failed task to finish
+      pi->download(false);
    };
 
    virtual void package_download_complete() {
       ilog("seeding plugin: package_download_complete(): Finished downloading package${u}", ("u", _url));
-      auto &pm = decent::package::PackageManager::instance();
-      const auto &mso_idx = _my->database().get_index_type<my_seeding_index>().indices().get<by_URI>();
-      const auto &mso_itr = mso_idx.find(_url);
+      graphene::chain::database &db = _my->database();
+      fc::optional<my_seeding_object> mso;
+      {
+         boost::shared_lock<boost::shared_mutex> lock( db.state_mutex() );
+         const auto &mso_idx = db.get_index_type<my_seeding_index>().indices().get<by_URI>();
+         const auto &mso_itr = mso_idx.find(_url);
+         if( mso_itr != mso_idx.end() )
+            mso = *mso_itr;
+      }
+      if( !mso.valid() )
+         return;
 
       decent::package::package_handle_t pi = _pi;
 
       size_t size = (_pi->get_size() + 1024 * 1024 - 1) / (1024 * 1024);
-      if( size > mso_itr->space ) {
+      if( size > mso->space ) {
          ilog("seeding plugin: package_download_complete(): Fraud detected: real content size is greater than propagated in blockchain; deleting...");
          //changing DB outside the main thread does not work properly, let's delete it from there
-         _my->main_thread->async([ &mso_itr, &pi, &pm ]() { pm.release_package(pi); database().remove(*mso_itr); });
+         my_seeding_id_type mso_id = mso->id;
+         db.committed_operations().run_on_chain_thread([ &db, mso_id, pi ]() {
+            decent::package::PackageManager::instance().release_package(pi);
+            db.apply_plugin_changes(0, [ &db, mso_id ]() { db.remove( db.get(mso_id) ); });
+         });
          _pi.reset();
          return;
       }
@@ -226,7 +349,8 @@ public:
       _pi->start_seeding();
       //Don't block package manager thread for too long.
       seeding_plugin_impl *my = _my;
-      _my->service_thread->async([ my, &mso_itr, pi ]() { my->generate_por2( *mso_itr, pi); });
+      my_seeding_object so = *mso;
+      _my->service_thread->async([ my, so, pi ]() { my->schedule_por( so, pi ); });
    };
 };
 
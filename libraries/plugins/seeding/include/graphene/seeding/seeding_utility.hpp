@@ -16,6 +16,9 @@ namespace decent { namespace seeding {
       uint64_t free_space;
       uint32_t seeding_price;
       fc::path packages_path;
+      uint32_t por_max_concurrent = 2;
+      /// in MegaBytes, see resident_package
+      uint64_t por_resident_limit = 1024;
    };
 
    extern fc::promise<seeding_plugin_startup_options>::ptr seeding_promise;
@@ -23,4 +26,5 @@ namespace decent { namespace seeding {
 }
 
 FC_REFLECT(decent::seeding::seeding_plugin_startup_options,
-           (seeder)(content_private_key)(seeder_private_key)(free_space)(seeding_price)(packages_path))
+           (seeder)(content_private_key)(seeder_private_key)(free_space)(seeding_price)(packages_path)
+           (por_max_concurrent)(por_resident_limit))
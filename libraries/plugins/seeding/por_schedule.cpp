@@ -0,0 +1,79 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#include <graphene/seeding/por_schedule.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/reflect/variant.hpp>
+
+namespace decent { namespace seeding {
+
+void por_schedule::set( const std::string& URI, fc::time_point_sec due )
+{
+   auto& idx = _entries.get<by_URI>();
+   auto itr = idx.find( URI );
+   if( itr == idx.end() )
+      _entries.insert( entry{ URI, due } );
+   else
+      idx.modify( itr, [due]( entry& e ) { e.due = due; } );
+}
+
+void por_schedule::erase( const std::string& URI )
+{
+   _entries.get<by_URI>().erase( URI );
+}
+
+fc::optional<fc::time_point_sec> por_schedule::find( const std::string& URI )const
+{
+   const auto& idx = _entries.get<by_URI>();
+   auto itr = idx.find( URI );
+   if( itr == idx.end() )
+      return fc::optional<fc::time_point_sec>();
+   return itr->due;
+}
+
+fc::optional<fc::time_point_sec> por_schedule::next_due()const
+{
+   const auto& idx = _entries.get<by_due>();
+   if( idx.empty() )
+      return fc::optional<fc::time_point_sec>();
+   return idx.begin()->due;
+}
+
+std::vector<std::string> por_schedule::pop_due( fc::time_point_sec now, size_t max )
+{
+   std::vector<std::string> result;
+   auto& idx = _entries.get<by_due>();
+   while( result.size() < max && !idx.empty() && idx.begin()->due <= now )
+   {
+      result.push_back( idx.begin()->URI );
+      idx.erase( idx.begin() );
+   }
+   return result;
+}
+
+void por_schedule::load( const fc::path& file )
+{
+   _entries.clear();
+   if( !fc::exists( file ) )
+      return;
+   try {
+      auto entries = fc::json::from_file( file ).as<std::vector<entry> >();
+      for( const entry& e : entries )
+         set( e.URI, e.due );
+   } catch( const fc::exception& e ) {
+      // the schedule can always be recomputed from the last proofs on the chain
+      wlog( "seeding plugin: ignoring unreadable PoR schedule ${f}: ${e}", ("f", file)("e", e.to_string()) );
+   }
+}
+
+void por_schedule::save( const fc::path& file )const
+{
+   const auto& idx = _entries.get<by_due>();
+   std::vector<entry> entries( idx.begin(), idx.end() );
+   fc::path tmp = file;
+   tmp.replace_extension( ".tmp" );
+   fc::json::save_to_file( entries, tmp );
+   fc::rename( tmp, file );
+}
+
+}}
@@ -11,6 +11,7 @@
 #include <decent/package/package_config.hpp>
 #include <fc/smart_ref_impl.hpp>
 #include <algorithm>
+#include <boost/thread/locks.hpp>
 #include <ipfs/client.h>
 
 namespace decent { namespace seeding {
@@ -18,6 +19,7 @@ namespace bpo = boost::program_options;
 namespace detail {
 
 #define POR_WAKEUP_INTERVAL_SEC 300
+#define POR_SAVE_DELAY_SEC 5
 
 seeding_plugin_impl::~seeding_plugin_impl() {
    return;
@@ -146,14 +148,14 @@ void seeding_plugin_impl::handle_content_submit(const content_submit_operation &
       handle_new_content(cs_op);
 }
 
-void seeding_plugin_impl::handle_request_to_buy(const request_to_buy_operation &rtb_op)
+fc::optional<key_delivery> seeding_plugin_impl::find_key_delivery(const request_to_buy_operation &rtb_op)
 {
    graphene::chain::database &db = database();
    const auto &idx = db.get_index_type<my_seeding_index>().indices().get<by_URI>();
    const auto &sitr = idx.find(rtb_op.URI);
    //Check if the content is handled by this plugin
    if( sitr == idx.end())
-      return;
+      return fc::optional<key_delivery>();
 
    const auto &sidx = db.get_index_type<my_seeder_index>().indices().get<by_seeder>();
    const auto &sritr = sidx.find(sitr->seeder);
@@ -171,43 +173,69 @@ void seeding_plugin_impl::handle_request_to_buy(const request_to_buy_operation &
    const content_object &co = *citr;
    if( co.expiration < fc::time_point::now() ){
       //if the content expired let the PoR generation cycle, return. PoR cycle will take care of the cleaning up...
-      return;
+      return fc::optional<key_delivery>();
    }
 
+   const auto &bidx = db.get_index_type<graphene::chain::buying_index>().indices().get<graphene::chain::by_content_consumer>();
+   const auto &bitr = bidx.find(std::make_tuple( co.get_id(), rtb_op.consumer ));
+   FC_ASSERT(bitr != bidx.end(), "no such buying_object for ${u}, ${c}",("u", rtb_op.URI )("c", rtb_op.consumer ));
+
+   key_delivery kd;
+   kd.seeder = seeder_account.id;
+   kd.seeder_key = sritr->privKey;
+   kd.content_key = sritr->content_privKey;
+   kd.key_part = co.key_parts.at(seeder_account.id);
+   kd.buying = bitr->id;
+   auto dyn_props = db.get_dynamic_global_properties();
+   kd.head_block_id = dyn_props.head_block_id;
+   kd.head_block_time = dyn_props.time;
+   kd.chain_id = db.get_chain_id();
+   return kd;
+}
+
+signed_transaction seeding_plugin_impl::make_deliver_keys(const key_delivery &kd, const request_to_buy_operation &rtb_op)
+{
    //Decrypt the key particle and encrypt it with consumer key
    DInteger destPubKey = decent::encrypt::DInteger::from_string(rtb_op.pubKey);
-   decent::encrypt::Ciphertext orig = co.key_parts.at(seeder_account.id);
    decent::encrypt::point message;
-   auto result = decent::encrypt::el_gamal_decrypt(orig, sritr->content_privKey, message);
+   auto result = decent::encrypt::el_gamal_decrypt(kd.key_part, kd.content_key, message);
    FC_ASSERT(result == decent::encrypt::ok);
    decent::encrypt::Ciphertext key;
    decent::encrypt::DeliveryProof proof;
-   result = decent::encrypt::encrypt_with_proof(message, sritr->content_privKey, destPubKey, orig, key, proof);
+   result = decent::encrypt::encrypt_with_proof(message, kd.content_key, destPubKey, kd.key_part, key, proof);
 
-   //construct and send out the Deliver key operation
+   //construct the Deliver key operation
    deliver_keys_operation op;
    op.key = key;
    op.proof = proof;
-   const auto &bidx = db.get_index_type<graphene::chain::buying_index>().indices().get<graphene::chain::by_URI_consumer>();
-   const auto &bitr = bidx.find(std::make_tuple( rtb_op.URI, rtb_op.consumer ));
-   FC_ASSERT(bitr != bidx.end(), "no such buying_object for ${u}, ${c}",("u", rtb_op.URI )("c", rtb_op.consumer ));
-   op.buying = bitr->id;
-
-   op.seeder = seeder_account.id;
+   op.buying = kd.buying;
+   op.seeder = kd.seeder;
 
    signed_transaction tx;
    tx.operations.push_back(op);
 
-   auto dyn_props = db.get_dynamic_global_properties();
-   tx.set_reference_block(dyn_props.head_block_id);
-   tx.set_expiration(dyn_props.time + fc::seconds(30));
+   tx.set_reference_block(kd.head_block_id);
+   tx.set_expiration(kd.head_block_time + fc::seconds(30));
    tx.validate();
 
-   chain_id_type _chain_id = db.get_chain_id();
+   tx.sign(kd.seeder_key, kd.chain_id);
+   return tx;
+}
+
+void seeding_plugin_impl::handle_request_to_buy(const request_to_buy_operation &rtb_op)
+{
+   graphene::chain::database &db = database();
+   fc::optional<key_delivery> kd;
+   {
+      boost::shared_lock<boost::shared_mutex> lock( db.state_mutex() );
+      kd = find_key_delivery(rtb_op);
+   }
+   if( !kd.valid() )
+      return;
 
-   tx.sign(sritr->privKey, _chain_id);
-   //This method is called from main thread...
-   database().push_transaction(tx);
+   //the El Gamal work is done here, only the push goes to the chain thread
+   signed_transaction tx = make_deliver_keys(*kd, rtb_op);
+   db.committed_operations().run_on_chain_thread([&db, &tx]() { db.push_transaction(tx); }).get();
    service_thread->async([this, tx]() { _self.p2p_node().broadcast_transaction(tx); });
 }
 
@@ -221,153 +249,327 @@ void seeding_plugin_impl::handle_commited_operation(const operation_history_obje
          return;
       }
       ilog("seeding plugin:  handle_commited_operation() handling request_to_buy");
-      const request_to_buy_operation &rtb_op = op_obj.op.get<request_to_buy_operation>();
-      handle_request_to_buy(rtb_op);
+      handle_request_to_buy( op_obj.op.get<request_to_buy_operation>() );
    }
 
    if( op_obj.op.which() == operation::tag<content_submit_operation>::value ) {
       ilog("seeding plugin:  handle_commited_operation() handling content_submit");
       //in case of content submit we don't really care if the sync has been finished or not...
       const content_submit_operation &cs_op = op_obj.op.get<content_submit_operation>();
-      handle_content_submit(cs_op);
+      db.committed_operations().run_on_chain_thread([this, &db, &cs_op, &op_obj]() {
+         db.apply_plugin_changes(op_obj.block_num, [this, &cs_op]() { handle_content_submit(cs_op); });
+      }).get();
+   }
+}
+
+
+/**
+ * The proof is due when the last one is about to become a day old, or shortly before the content expires
+ */
+static fc::time_point_sec por_due_time( const fc::optional<fc::time_point_sec>& last_proof_time, fc::time_point_sec expiration,
+                                        fc::time_point_sec now )
+{
+   //no proof has been delivered by us yet...
+   if( !last_proof_time.valid() )
+      return now;
+
+   fc::time_point_sec generate_time = *last_proof_time + 24*60*60 - POR_WAKEUP_INTERVAL_SEC/2;
+   if( generate_time > expiration )
+      generate_time = expiration - POR_WAKEUP_INTERVAL_SEC;
+   return generate_time - POR_WAKEUP_INTERVAL_SEC;
+}
+
+void seeding_plugin_impl::schedule_por( const my_seeding_object& mso, decent::package::package_handle_t package_handle )
+{
+   package_handle->remove_all_event_listeners();
+   por_packages[mso.URI] = package_handle;
+   if( !por_queue.find( mso.URI ).valid() )
+      por_queue.set( mso.URI, fc::time_point::now() );
+   save_por_schedule();
+   arm_por_timer();
+}
+
+void seeding_plugin_impl::save_por_schedule()
+{
+   //restore_state saves once when it is done, later changes are written together after a short delay
+   if( por_restoring || ( por_save_timer.valid() && !por_save_timer.ready() ) )
+      return;
+   por_save_timer = service_thread->schedule([this]() { por_queue.save( por_schedule_file ); },
+                                             fc::time_point::now() + fc::seconds( POR_SAVE_DELAY_SEC ), "Seeding plugin PoR schedule save");
+}
+
+void seeding_plugin_impl::arm_por_timer()
+{
+   fc::optional<fc::time_point_sec> due = por_queue.next_due();
+   //finish_por arms the timer again when a slot frees up
+   if( !due.valid() || por_in_flight.size() >= por_threads.size() )
+      return;
+   if( por_timer.valid() && !por_timer.ready() ) {
+      if( por_timer_due <= *due )
+         return;
+      por_timer.cancel();
+   }
+
+   por_timer_due = *due;
+   fc::time_point wakeup = std::max( fc::time_point( *due ), fc::time_point::now() );
+   ilog("seeding plugin_impl:  planning next PoR wake-up at ${t}",("t", wakeup) );
+   por_timer = service_thread->schedule([this]() { run_due_pors(); }, wakeup, "Seeding plugin PoR scheduler");
+}
+
+void seeding_plugin_impl::run_due_pors()
+{
+   por_timer = fc::future<void>();
+   std::vector<std::string> due = por_queue.pop_due( fc::time_point::now(), por_threads.size() - por_in_flight.size() );
+   for( const std::string& URI : due ) {
+      auto pitr = por_packages.find( URI );
+      //saved before a restart for a package we no longer seed
+      if( pitr == por_packages.end() )
+         continue;
+
+      decent::package::package_handle_t package_handle = pitr->second;
+      std::shared_ptr<fc::thread> por_thread = por_threads[next_por_thread++ % por_threads.size()];
+      por_in_flight.insert( URI );
+      por_thread->async([this, URI, package_handle]() {
+         por_result result;
+         try {
+            result = generate_por( URI, package_handle );
+         } catch( const fc::exception& e ) {
+            elog("seeding plugin_impl:  generate_por() failed for ${u}: ${e}", ("u", URI)("e", e.to_detail_string()));
+            result.next_due = fc::time_point_sec( fc::time_point::now() ) + POR_WAKEUP_INTERVAL_SEC;
+         }
+         service_thread->async([this, URI, package_handle, result]() { finish_por( URI, package_handle, result ); });
+      }, "Seeding plugin PoR generate");
+   }
+   if( !due.empty() )
+      save_por_schedule();
+   arm_por_timer();
+}
+
+void seeding_plugin_impl::finish_por( const std::string& URI, decent::package::package_handle_t package_handle, const por_result& result )
+{
+   por_in_flight.erase( URI );
+   if( result.next_due.valid() ) {
+      por_queue.set( URI, *result.next_due );
+      if( result.downloaded )
+         keep_or_remove_por_package( URI, package_handle );
+      else {
+         auto ritr = por_downloads.find( URI );
+         if( ritr != por_downloads.end() )
+            ritr->second.last_used = fc::time_point::now();
+      }
+   } else {
+      //the content expired, generate_por has released the package
+      por_packages.erase( URI );
+      auto ritr = por_downloads.find( URI );
+      if( ritr != por_downloads.end() ) {
+         if( ritr->second.resident )
+            por_resident_size -= ritr->second.size;
+         por_downloads.erase( ritr );
+      }
    }
+   save_por_schedule();
+   arm_por_timer();
 }
 
+void seeding_plugin_impl::keep_or_remove_por_package( const std::string& URI, decent::package::package_handle_t package_handle )
+{
+   resident_package& rp = por_downloads[URI];
+   ++rp.downloads;
+   rp.size = package_handle->get_size();
+   rp.last_used = fc::time_point::now();
+
+   if( rp.downloads >= 2 && rp.size <= por_resident_limit &&
+       package_handle->get_data_state() == decent::package::PackageInfo::DataState::CHECKED ) {
+      while( por_resident_size + rp.size > por_resident_limit ) {
+         auto lru = por_downloads.end();
+         for( auto itr = por_downloads.begin(); itr != por_downloads.end(); ++itr )
+            //another PoR thread may be reading the package
+            if( itr->second.resident && !por_in_flight.count( itr->first ) &&
+                ( lru == por_downloads.end() || itr->second.last_used < lru->second.last_used ) )
+               lru = itr;
+         if( lru == por_downloads.end() )
+            break;
+         ilog("seeding plugin_impl:  removing resident package ${u} to make room for ${n}", ("u", lru->first)("n", URI));
+         auto pitr = por_packages.find( lru->first );
+         if( pitr != por_packages.end() )
+            pitr->second->remove(true);
+         lru->second.resident = false;
+         por_resident_size -= lru->second.size;
+      }
+      if( por_resident_size + rp.size <= por_resident_limit ) {
+         ilog("seeding plugin_impl:  keeping package ${u} on disk for its next proofs", ("u", URI));
+         rp.resident = true;
+         por_resident_size += rp.size;
+         return;
+      }
+   }
+   package_handle->remove(true);
+}
 
-void
-seeding_plugin_impl::generate_por2(const my_seeding_object& mso, decent::package::package_handle_t package_handle)
+por_result
+seeding_plugin_impl::generate_por(const std::string& URI, decent::package::package_handle_t package_handle)
 {try{
    ilog("seeding plugin_impl:  generate_por() start");
-   package_handle->remove_all_event_listeners();
    graphene::chain::database &db = database();
+   por_result result;
 
    //Collect data first...
-   const auto &sidx = db.get_index_type<my_seeder_index>().indices().get<by_seeder>();
-   const auto &sritr = sidx.find(mso.seeder);
-   FC_ASSERT(sritr != sidx.end());
-   const auto& cidx = db.get_index_type<content_index>().indices().get<graphene::chain::by_URI>();
-   const auto& citr = cidx.find(mso.URI);
+   fc::optional<my_seeding_object> mso;
+   fc::ecc::private_key seeder_key;
+   fc::time_point_sec expiration;
+   fc::optional<fc::time_point_sec> last_proof_time;
+   block_id_type head_block_id;
+   uint32_t head_block_number;
+   fc::time_point_sec head_block_time;
+   {
+      boost::shared_lock<boost::shared_mutex> lock( db.state_mutex() );
+      const auto& msidx = db.get_index_type<my_seeding_index>().indices().get<by_URI>();
+      const auto& msitr = msidx.find(URI);
+      FC_ASSERT(msitr != msidx.end());
+      mso = *msitr;
+      const auto &sidx = db.get_index_type<my_seeder_index>().indices().get<by_seeder>();
+      const auto &sritr = sidx.find(mso->seeder);
+      FC_ASSERT(sritr != sidx.end());
+      seeder_key = sritr->privKey;
+      const auto& cidx = db.get_index_type<content_index>().indices().get<graphene::chain::by_URI>();
+      const auto& citr = cidx.find(URI);
+      FC_ASSERT(citr != cidx.end());
+      expiration = citr->expiration;
+      const auto& pidx = db.get_index_type<graphene::chain::content_proof_index>().indices().get<graphene::chain::by_content_seeder>();
+      auto pitr = pidx.find( std::make_tuple( citr->get_id(), mso->seeder ) );
+      if( pitr != pidx.end() )
+         last_proof_time = pitr->last_proof;
+      auto dyn_props = db.get_dynamic_global_properties();
+      head_block_id = dyn_props.head_block_id;
+      head_block_number = dyn_props.head_block_number;
+      head_block_time = dyn_props.time;
+   }
 
-   ilog("seeding plugin_impl:  generate_por() processing content ${c}",("c", mso.URI));
+   ilog("seeding plugin_impl:  generate_por() processing content ${c}",("c", URI));
 
-   FC_ASSERT(citr != cidx.end());
-   if( citr->expiration < fc::time_point::now() ){
+   fc::time_point_sec now = fc::time_point::now();
+   if( expiration < now ){
       ilog("seeding plugin_impl:  generate_por() - content expired, cleaning up");
       auto& pm = decent::package::PackageManager::instance();
       package_handle->stop_seeding();
       pm.release_package(package_handle);
-      return;
+      return result;
    }
 
    //calculate time when next PoR has to be sent out
-   fc::time_point_sec generate_time;
-
-   try {
-      fc::time_point_sec last_proof_time = citr->last_proof.at(mso.seeder);
-      generate_time = last_proof_time + fc::seconds(24*60*60) - fc::seconds(POR_WAKEUP_INTERVAL_SEC/2);
-      if( generate_time > citr->expiration )
-         generate_time = citr->expiration - fc::seconds(POR_WAKEUP_INTERVAL_SEC);
-   }catch (std::out_of_range e){
-      //no proof has been delivered by us yet...
-      generate_time = fc::time_point::now();
+   fc::time_point_sec due = por_due_time( last_proof_time, expiration, now );
+   ilog("seeding plugin_impl:  generate_por() - PoR for this content is due at ${t}",("t", due) );
+   if( due > now ) {
+      result.next_due = due;
+      return result;
    }
 
-   ilog("seeding plugin_impl:  generate_por() - generate time for this content is planned at ${t}",("t", generate_time) );
-   fc::time_point next_wakeup( fc::time_point::now() + fc::microseconds(POR_WAKEUP_INTERVAL_SEC * 1000000 ));
-   //If we are about to generate PoR, generate it.
-   if( fc::time_point(generate_time) - fc::seconds(POR_WAKEUP_INTERVAL_SEC) <= ( fc::time_point::now() ) )
-   {
-      ilog("seeding plugin_impl: generate_por() - generating PoR");
-
-      decent::encrypt::CustodyProof proof;
-      auto dyn_props = db.get_dynamic_global_properties();
-      if(mso.cd){
-         ilog("seeding plugin_impl: generate_por() - calculating full PoR");
-         fc::ripemd160 b_id = dyn_props.head_block_id;
-         uint32_t b_num = dyn_props.head_block_number;
-         proof.reference_block = b_num;
-         for( int i = 0; i < 5; i++ )
-            proof.seed.data[i] = b_id._hash[i]; //use the block ID as source of entrophy
-
-         if(package_handle->get_data_state() == decent::package::PackageInfo::DataState::CHECKED ) //files available on disk
-            package_handle->create_proof_of_custody(*mso.cd, proof);
-         else{
-            package_handle->download(true);
-            package_handle->create_proof_of_custody(*mso.cd, proof);
-            package_handle->remove(true);
+   ilog("seeding plugin_impl: generate_por() - generating PoR");
+   decent::encrypt::CustodyProof proof;
+   if(mso->cd){
+      ilog("seeding plugin_impl: generate_por() - calculating full PoR");
+      fc::ripemd160 b_id = head_block_id;
+      proof.reference_block = head_block_number;
+      for( int i = 0; i < 5; i++ )
+         proof.seed.data[i] = b_id._hash[i]; //use the block ID as source of entrophy
+
+      if(package_handle->get_data_state() == decent::package::PackageInfo::DataState::CHECKED ) //files available on disk
+         package_handle->create_proof_of_custody(*mso->cd, proof);
+      else{
+         //fetch just the challenged blocks if the transfer engine can, the whole package otherwise
+         bool sparse = false;
+         try {
+            sparse = package_handle->create_sparse_proof_of_custody(*mso->cd, proof);
+         } catch( const fc::exception& e ) {
+            wlog("seeding plugin_impl: generate_por() - fetching the challenged blocks of ${u} failed, downloading it: ${e}",
+                 ("u", URI)("e", e.to_string()));
+         }
+         if( !sparse ) {
+            //from here on the package may be on disk, finish_por decides whether it stays even if the proof fails
+            result.downloaded = true;
+            try {
+               package_handle->download(true);
+               package_handle->create_proof_of_custody(*mso->cd, proof);
+            } catch( const fc::exception& e ) {
+               elog("seeding plugin_impl: generate_por() - proof of the downloaded package ${u} failed: ${e}",
+                    ("u", URI)("e", e.to_detail_string()));
+               result.next_due = now + POR_WAKEUP_INTERVAL_SEC;
+               return result;
+            }
          }
       }
-      // issue PoR and plan periodic PoR generation
-      ilog("seeding plugin_impl: generate_por() - Creating operation");
-      proof_of_custody_operation op;
-
-      op.seeder = mso.seeder;
-      if(mso.cd)
-         op.proof = proof;
+   }
+   // issue PoR, the schedule looks again once it is on the chain
+   ilog("seeding plugin_impl: generate_por() - Creating operation");
+   proof_of_custody_operation op;
 
-      op.URI = mso.URI;
+   op.seeder = mso->seeder;
+   if(mso->cd)
+      op.proof = proof;
 
-      signed_transaction tx;
-      tx.operations.push_back(op);
+   op.URI = URI;
 
-      tx.set_reference_block(dyn_props.head_block_id);
-      tx.set_expiration(dyn_props.time + fc::seconds(30));
-      tx.validate();
-
-      chain_id_type _chain_id = db.get_chain_id();
+   signed_transaction tx;
+   tx.operations.push_back(op);
 
-      tx.sign(sritr->privKey, _chain_id);
-      idump((tx));
+   tx.set_reference_block(head_block_id);
+   tx.set_expiration(head_block_time + fc::seconds(30));
+   tx.validate();
 
-      main_thread->async([this, tx]() { database().push_transaction(tx); });
+   tx.sign(seeder_key, db.get_chain_id());
+   idump((tx));
 
-      ilog("broadcasting out PoR");
-      _self.p2p_node().broadcast_transaction(tx);
-   }
+   //pushed like the key deliveries, a failed push is reported by generate_por and retried
+   db.committed_operations().run_on_chain_thread([&db, &tx]() { db.push_transaction(tx); }).get();
 
-   ilog("seeding plugin_impl:  generate_por() - planning next wake-up at ${t}",("t", next_wakeup) );
-   service_thread->schedule([this, mso, package_handle]() { generate_por2(mso, package_handle); }, next_wakeup,
-                            "Seeding plugin PoR generate");
+   ilog("broadcasting out PoR");
+   _self.p2p_node().broadcast_transaction(tx);
 
+   result.next_due = now + POR_WAKEUP_INTERVAL_SEC;
    ilog("seeding plugin_impl:  generate_por() end");
-}FC_CAPTURE_AND_RETHROW((mso))}
+   return result;
+}FC_CAPTURE_AND_RETHROW((URI))}
 
 
 void seeding_plugin_impl::send_ready_to_publish()
 {
    ilog("seeding plugin_impl: send_ready_to_publish() begin");
-   const auto &sidx = database().get_index_type<my_seeder_index>().indices().get<by_seeder>();
-   auto sritr = sidx.begin();
    graphene::chain::database &db = database();
+   std::vector<my_seeder_object> seeders;
+   graphene::chain::dynamic_global_property_object dyn_props;
+   {
+      boost::shared_lock<boost::shared_mutex> lock( db.state_mutex() );
+      const auto &sidx = db.get_index_type<my_seeder_index>().indices().get<by_seeder>();
+      seeders.assign( sidx.begin(), sidx.end() );
+      dyn_props = db.get_dynamic_global_properties();
+   }
    ipfs::Client ipfs_client(decent::package::PackageManagerConfigurator::instance().get_ipfs_host(), decent::package::PackageManagerConfigurator::instance().get_ipfs_port());
    ipfs::Json json;
    ipfs_client.Id( &json );
 
-   while(sritr != sidx.end() ){
+   for( const my_seeder_object& seeder : seeders ){
       ready_to_publish_operation op;
-      op.seeder = sritr->seeder;
-      op.space = sritr->free_space;
-      op.price_per_MByte = sritr->price;
-      op.pubKey = get_public_el_gamal_key(sritr->content_privKey);
+      op.seeder = seeder.seeder;
+      op.space = seeder.free_space;
+      op.price_per_MByte = seeder.price;
+      op.pubKey = get_public_el_gamal_key(seeder.content_privKey);
       op.ipfs_ID = json["ID"];
       signed_transaction tx;
       tx.operations.push_back(op);
 
       idump((op));
 
-      auto dyn_props = database().get_dynamic_global_properties();
       tx.set_reference_block(dyn_props.head_block_id);
       tx.set_expiration(dyn_props.time + fc::seconds(30));
 
-      chain_id_type _chain_id = database().get_chain_id();
+      chain_id_type _chain_id = db.get_chain_id();
 
-      tx.sign(sritr->privKey, _chain_id);
+      tx.sign(seeder.privKey, _chain_id);
       idump((tx));
       tx.validate();
-      main_thread->async( [this, tx](){ilog("seeding plugin_impl:  send_ready_to_publish lambda - pushing transaction"); database().push_transaction(tx);} );
+      db.committed_operations().run_on_chain_thread( [&db, tx](){ilog("seeding plugin_impl:  send_ready_to_publish lambda - pushing transaction"); db.push_transaction(tx);} );
       ilog("seeding plugin_impl: send_ready_to_publish() broadcasting");
       _self.p2p_node().broadcast_transaction(tx);
-      sritr++;
    }
    fc::time_point next_wakeup(fc::time_point::now() + fc::microseconds( (uint64_t) 1000000 * (60 * 60)));
    ilog("seeding plugin_impl: planning next send_ready_to_publish at ${t}",("t",next_wakeup ));
@@ -379,109 +581,138 @@ void seeding_plugin_impl::send_ready_to_publish()
 
 
 void seeding_plugin_impl::resend_keys(){
-   //Re-send all missing keys
-   const auto& sidx = database().get_index_type<my_seeder_index>().indices().get<by_seeder>();
-   const auto& buying_range = database().get_index_type<buying_index>().indices().get<by_open_expiration>().equal_range( true );
-   const auto& content_idx = database().get_index_type<content_index>().indices().get<graphene::chain::by_URI>();
-   const auto& cidx = database().get_index_type<my_seeding_index>().indices().get<by_URI>();
-   auto sitr = sidx.begin();
-
-   while( sitr != sidx.end() )
+   //Re-send all missing keys, the requests are collected first, handle_request_to_buy locks the database itself
+   graphene::chain::database &db = database();
+   std::vector<request_to_buy_operation> requests;
    {
-      std::for_each(buying_range.first, buying_range.second, [&](const buying_object &buying_element)
-      {
-           const auto& content_itr = content_idx.find( buying_element.URI );
-           if( cidx.find(buying_element.URI) != cidx.end() ) //in case that some reason we don't have this content in the internal database, e.g. it was deleted or it is fraud
+      boost::shared_lock<boost::shared_mutex> lock( db.state_mutex() );
+      const auto& sidx = db.get_index_type<my_seeder_index>().indices().get<by_seeder>();
+      const auto& buying_range = db.get_index_type<buying_index>().indices().get<by_open_expiration>().equal_range( true );
+      const auto& cidx = db.get_index_type<my_seeding_index>().indices().get<by_URI>();
+      auto sitr = sidx.begin();
 
-              if( content_itr != content_idx.end() && buying_element.expiration_time >= database().head_block_time() )
-              {
+      while( sitr != sidx.end() )
+      {
+         std::for_each(buying_range.first, buying_range.second, [&](const buying_object &buying_element)
+         {
+              const content_object* content_itr = db.find( buying_element.content );
+              if( cidx.find(buying_element.URI) != cidx.end() ) //in case that some reason we don't have this content in the internal database, e.g. it was deleted or it is fraud
 
-                 for( const auto& seeder_element : content_itr->key_parts )
+                 if( content_itr != nullptr && buying_element.expiration_time >= db.head_block_time() )
                  {
-                    if( seeder_element.first == sitr->seeder &&
-                        std::find(buying_element.seeders_answered.begin(), buying_element.seeders_answered.end(), (sitr->seeder)) == buying_element.seeders_answered.end() )
+
+                    for( const auto& seeder_element : content_itr->key_parts )
                     {
-                       request_to_buy_operation rtb_op;
-                       rtb_op.URI = buying_element.URI;
-                       rtb_op.consumer = buying_element.consumer;
-                       rtb_op.pubKey = buying_element.pubKey;
-                       rtb_op.price = buying_element.price;
-                       rtb_op.region_code_from = buying_element.region_code_from;
-                       ilog("seeding_plugin:  restore_state() processing unhandled request to buy ${s}",("s",rtb_op));
-                       handle_request_to_buy( rtb_op );
-                       break;
+                       if( seeder_element.first == sitr->seeder &&
+                           std::find(buying_element.seeders_answered.begin(), buying_element.seeders_answered.end(), (sitr->seeder)) == buying_element.seeders_answered.end() )
+                       {
+                          request_to_buy_operation rtb_op;
+                          rtb_op.URI = buying_element.URI;
+                          rtb_op.consumer = buying_element.consumer;
+                          rtb_op.pubKey = buying_element.pubKey;
+                          rtb_op.price = buying_element.price;
+                          rtb_op.region_code_from = buying_element.region_code_from;
+                          requests.push_back( rtb_op );
+                          break;
+                       }
                     }
                  }
-              }
+         });
+         sitr++;
+      }
+   }
+
+   for( const request_to_buy_operation& rtb_op : requests )
+   {
+      ilog("seeding_plugin:  restore_state() processing unhandled request to buy ${s}",("s",rtb_op));
+      try {
+         handle_request_to_buy( rtb_op );
+      } catch( const fc::exception& e ) {
+         elog("seeding_plugin:  resend_keys() failed for ${u}: ${e}", ("u", rtb_op.URI)("e", e.to_detail_string()));
+      }
+   }
+}
+
+void seeding_plugin_impl::rebuild_seeding_objects()
+{
+   graphene::chain::database &db = database();
+   const auto& sidx = db.get_index_type<my_seeder_index>().indices().get<by_seeder>();
+   const auto& cidx = db.get_index_type<my_seeding_index>().indices().get<by_URI>();
+   const auto& c_idx = db.get_index_type<content_index>().indices().get<by_expiration>();
+   auto sitr = sidx.begin();
+   {//remove all existing entries and start over
+      const auto &sidx = db.get_index_type<my_seeding_index>();
+      sidx.inspect_all_objects([ & ](const object &o) {
+           db.remove(o);
       });
-      sitr++;
    }
+   while( sitr != sidx.end() )
+   {
+      auto content_itr = c_idx.end();
+      while( content_itr != c_idx.begin() )
+         // iterating backwards.
+         // Content objects are ordered increasingly by expiration time.
+         // This way we do not need to iterate over all ( expired ) objects
+      {
+         content_itr--;
+         if( content_itr->expiration < db.head_block_time() )
+            break;
+         auto search_itr = content_itr->key_parts.find( sitr->seeder );
+         if( search_itr != content_itr->key_parts.end() )
+         {
 
+            auto citr = cidx.find( content_itr->URI );
+            if( citr == cidx.end() )
+            {
+               const my_seeding_object& mso = db.create<my_seeding_object>([&](my_seeding_object &so) {
+                    so.URI = content_itr->URI;
+                    so.seeder = sitr->seeder;
+                    so._hash = content_itr->_hash;
+                    so.space = content_itr->size; //we allocate the whole megabytes per content
+                    so.key = search_itr->second;
+                    so.expiration = content_itr->expiration;
+                    so.cd = content_itr->cd;
+               });
+               ilog("seeding_plugin:  restore_state() creating my_seeding_object for unhandled content submit ${s}",("s",mso));
+               db.modify<my_seeder_object>(*sitr, [&](my_seeder_object &mso) {
+                    mso.free_space -= content_itr->size ; //we allocate the whole megabytes per content
+               });
+            }
+         }
+      }
+      sitr++;
+   }
 }
 
 void seeding_plugin_impl::restore_state(){
 
    elog("restoring state, main thread");
    service_thread->async([this](){
-        if( std::abs( (fc::time_point::now() - database().head_block_time()).count() ) > int64_t( 10000000 ) )
+        graphene::chain::database &db = database();
+        fc::time_point_sec head_block_time;
+        {
+           boost::shared_lock<boost::shared_mutex> lock( db.state_mutex() );
+           head_block_time = db.head_block_time();
+        }
+        if( std::abs( (fc::time_point::now() - head_block_time).count() ) > int64_t( 10000000 ) )
         {
            ilog("seeding plugin:  restoring state() waiting for sync");
            fc::usleep( fc::microseconds(1000000) );
         }
         elog("restarting downloads, service thread");
-        //start with rebuilding my_seeding_object database
-        const auto& sidx = database().get_index_type<my_seeder_index>().indices().get<by_seeder>();
-        const auto& cidx = database().get_index_type<my_seeding_index>().indices().get<by_URI>();
-
-
-        const auto& c_idx = database().get_index_type<content_index>().indices().get<by_expiration>();
-        auto sitr = sidx.begin();
-        {//remove all existing entries and start over
-           const auto &sidx = database().get_index_type<my_seeding_index>();
-           sidx.inspect_all_objects([ & ](const object &o) {
-                database().remove(o);
-           });
-        }
-        while( sitr != sidx.end() )
+        por_queue.load( por_schedule_file );
+        //start with rebuilding my_seeding_object database, the chain thread makes the changes
+        db.committed_operations().run_on_chain_thread([this, &db]() {
+           db.apply_plugin_changes(0, [this]() { rebuild_seeding_objects(); });
+        }).get();
+
+        std::vector<my_seeding_object> seeding;
         {
-           auto content_itr = c_idx.end();
-           while( content_itr != c_idx.begin() )
-              // iterating backwards.
-              // Content objects are ordered increasingly by expiration time.
-              // This way we do not need to iterate over all ( expired ) objects
-           {
-              content_itr--;
-              if( content_itr->expiration < database().head_block_time() )
-                 break;
-              auto search_itr = content_itr->key_parts.find( sitr->seeder );
-              if( search_itr != content_itr->key_parts.end() )
-              {
-
-                 auto citr = cidx.find( content_itr->URI );
-                 if( citr == cidx.end() )
-                 {
-                    const my_seeding_object& mso = database().create<my_seeding_object>([&](my_seeding_object &so) {
-                         so.URI = content_itr->URI;
-                         so.seeder = sitr->seeder;
-                         so._hash = content_itr->_hash;
-                         so.space = content_itr->size; //we allocate the whole megabytes per content
-                         so.key = search_itr->second;
-                         so.expiration = content_itr->expiration;
-                         so.cd = content_itr->cd;
-                    });
-                    auto so_id = mso.id;
-                    ilog("seeding_plugin:  restore_state() creating my_seeding_object for unhandled content submit ${s}",("s",mso));
-                    database().modify<my_seeder_object>(*sitr, [&](my_seeder_object &mso) {
-                         mso.free_space -= content_itr->size ; //we allocate the whole megabytes per content
-                    });
-                 }
-              }
-           }
-           sitr++;
+           boost::shared_lock<boost::shared_mutex> lock( db.state_mutex() );
+           const auto& cidx = db.get_index_type<my_seeding_index>().indices().get<by_URI>();
+           seeding.assign( cidx.begin(), cidx.end() );
         }
 
-
-
         //We need to rebuild the list of downloaded packages and compare it to the list of my_seeding_objects.
         //For the downloaded packages we can issue PoR right away, the others needs to be downloaded
         auto& pm = decent::package::PackageManager::instance();
@@ -495,29 +726,30 @@ void seeding_plugin_impl::restore_state(){
 
         packages = pm.get_all_known_packages();
 
-        auto citr = cidx.begin();
-        while(citr!=cidx.end()) {
-           elog("restarting downloads, dealing with package ${u}", ("u", citr->URI));
+        por_restoring = true;
+        for( const my_seeding_object& mso : seeding ) {
+           elog("restarting downloads, dealing with package ${u}", ("u", mso.URI));
            bool already_have = false;
            decent::package::package_handle_t package_handle(0);
            for( auto package : packages )
-              if( package->get_hash() == citr->_hash ) {
+              if( package->get_hash() == mso._hash ) {
                  already_have = true;
                  package_handle = package;
               }
 
            if(already_have){
-              generate_por2( *citr, package_handle );
+              schedule_por( mso, package_handle );
            }else{
-              elog("restarting downloads, re-downloading package ${u}", ("u", citr->URI));
-              package_handle = pm.get_package(citr->URI, citr->_hash);
-              decent::package::event_listener_handle_t sl = std::make_shared<SeedingListener>(*this, *citr , package_handle);
+              elog("restarting downloads, re-downloading package ${u}", ("u", mso.URI));
+              package_handle = pm.get_package(mso.URI, mso._hash);
+              decent::package::event_listener_handle_t sl = std::make_shared<SeedingListener>(*this, mso , package_handle);
               package_handle->remove_all_event_listeners();
               package_handle->add_event_listener(sl);
               package_handle->download(false);
            }
-           ++citr;
         }
+        por_restoring = false;
+        por_queue.save( por_schedule_file );
         elog("restarting downloads, service thread end");
    });
 }
@@ -596,6 +828,9 @@ void seeding_plugin::plugin_initialize( const boost::program_options::variables_
       else
          FC_THROW("missing free-space parameter");
 
+      seeding_options.por_max_concurrent = options["por-max-concurrent"].as<uint32_t>();
+      seeding_options.por_resident_limit = options["por-resident-limit"].as<uint64_t>();
+
       if( options["packages-path"].as<string>() != "" ) {
          try {
             seeding_options.packages_path = boost::filesystem::path(options["packages-path"].as<string>());
@@ -628,14 +863,18 @@ void seeding_plugin::plugin_pre_startup( const seeding_plugin_startup_options& s
    ilog("starting service thread");
    my = unique_ptr<detail::seeding_plugin_impl>( new detail::seeding_plugin_impl( *this) );
    my->service_thread = std::make_shared<fc::thread>("seeding");
-   my->main_thread = &fc::thread::current();
+   FC_ASSERT( seeding_options.por_max_concurrent > 0 );
+   for( uint32_t i = 0; i < seeding_options.por_max_concurrent; ++i )
+      my->por_threads.push_back( std::make_shared<fc::thread>( "seeding_por_" + std::to_string(i) ) );
+   my->por_schedule_file = dir_helper.get_decent_data() / "por_schedule.json";
+   my->por_resident_limit = seeding_options.por_resident_limit * 1024 * 1024;
 
-   database().on_new_commited_operation.connect( [&]( const operation_history_object& b ){ my->handle_commited_operation( b, false ); } );
-   database().on_new_commited_operation_during_sync.connect( [&]( const operation_history_object& b ){
-      my->handle_commited_operation(b, true); } );
+   my->committed_operations = database().committed_operations().subscribe( "seeding",
+      [this]( const operation_history_object& b, bool sync_mode ){ my->handle_commited_operation( b, sync_mode ); } );
 
    ilog("seeding plugin:  plugin_pre_startup() seeder prepared");
    try {
+      graphene::chain::database::write_scope scope( database() );
       {//remove all existing entries and start over
          const auto &sidx = database().get_index_type<my_seeder_index>();
          sidx.inspect_all_objects([ & ](const object &o) {
@@ -671,6 +910,8 @@ void seeding_plugin::plugin_set_program_options(
          ("free-space", bpo::value<int>(), "Allocated disk space, in MegaBytes")
          ("packages-path", bpo::value<string>()->default_value(""), "Packages storage path")
          ("seeding-price", bpo::value<int>(), "Price per MegaBytes")
+         ("por-max-concurrent", bpo::value<uint32_t>()->default_value(2), "Maximum number of proofs of retrievability generated at once")
+         ("por-resident-limit", bpo::value<uint64_t>()->default_value(1024), "Disk space, in MegaBytes, for packages downloaded again to prove them that are kept for their next proofs")
          ;
 }
 
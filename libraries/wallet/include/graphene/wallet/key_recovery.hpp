@@ -0,0 +1,105 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#pragma once
+
+#include <graphene/chain/protocol/types.hpp>
+
+#include <fc/crypto/elliptic.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace wallet {
+
+   /**
+    * Derives the sequence_number-th key of the sequence of prefix_string, which is a normalized brain key for owner
+    * keys and the WIF of the parent key for active and memo keys.
+    */
+   fc::ecc::private_key derive_private_key( const std::string& prefix_string, int sequence_number );
+
+   struct key_recovery_options
+   {
+      /** keys derived and looked up together, in one call of the lookup */
+      uint32_t batch_size = 64;
+      /** a sequence ends after this many consecutive keys no account refers to */
+      uint32_t max_gap = 10;
+   };
+
+   struct recovered_key
+   {
+      /** "owner", "active" or "memo" */
+      std::string                                  role;
+      uint32_t                                     sequence_number = 0;
+      graphene::chain::public_key_type             public_key;
+      std::string                                  wif_private_key;
+      std::vector<graphene::chain::account_id_type> accounts;
+   };
+
+   struct key_recovery_progress
+   {
+      std::string role;
+      uint32_t    keys_derived = 0;
+      uint32_t    keys_found = 0;
+      uint32_t    lookups = 0;
+   };
+
+   struct key_recovery_result
+   {
+      std::vector<recovered_key>                   keys;
+      std::set<graphene::chain::account_id_type>   accounts;
+      uint32_t                                     keys_derived = 0;
+      uint32_t                                     lookups = 0;
+   };
+
+   /**
+    * @brief Finds the keys of a brain key which accounts refer to
+    *
+    * The wallet derives the owner keys from the brain key, the active keys from an owner key and the memo keys from
+    * an active key, each as a sequence of key indices. The recovery walks these sequences in batches: the keys of a
+    * batch are derived in parallel on worker threads and looked up with one call, i.e. one round trip to
+    * database_api::get_key_references. A sequence ends after max_gap consecutive unused indices, the active and memo
+    * sequences are only walked for the keys found in use.
+    */
+   class key_recovery
+   {
+      public:
+         /** returns the accounts referring to each of the keys, like database_api::get_key_references */
+         typedef std::function< std::vector<std::vector<graphene::chain::account_id_type>>( const std::vector<graphene::chain::public_key_type>& ) > key_reference_lookup;
+         typedef std::function< void( const key_recovery_progress& ) > progress_callback;
+
+         /**
+          * @param lookup Lookup of the key references, called from the calling thread only
+          * @param thread_count Number of threads deriving the keys, 0 for the number of hardware threads
+          */
+         key_recovery( key_reference_lookup lookup, uint32_t thread_count = 0 );
+
+         key_recovery_result recover_brain_key( const std::string& brain_key,
+                                                const key_recovery_options& options = key_recovery_options(),
+                                                const progress_callback& progress = progress_callback() );
+
+      private:
+         typedef std::pair<fc::ecc::private_key, graphene::chain::public_key_type> derived_key;
+
+         /** derives the keys first .. first + count - 1 of the sequence of prefix, split among the threads */
+         std::vector<derived_key> derive_batch( const std::string& prefix, uint32_t first, uint32_t count );
+
+         /** walks the sequence of prefix and returns the keys in use */
+         std::vector<recovered_key> scan_sequence( const std::string& role, const std::string& prefix,
+                                                   const key_recovery_options& options,
+                                                   const progress_callback& progress,
+                                                   key_recovery_result& result );
+
+         key_reference_lookup                          _lookup;
+         std::vector<std::unique_ptr<fc::thread> >     _threads;
+   };
+
+} }
+
+FC_REFLECT( graphene::wallet::key_recovery_options, (batch_size)(max_gap) )
+FC_REFLECT( graphene::wallet::recovered_key, (role)(sequence_number)(public_key)(wif_private_key)(accounts) )
+FC_REFLECT( graphene::wallet::key_recovery_progress, (role)(keys_derived)(keys_found)(lookups) )
+FC_REFLECT( graphene::wallet::key_recovery_result, (keys)(accounts)(keys_derived)(lookups) )
@@ -27,7 +27,9 @@
 #include <graphene/app/api.hpp>
 #include <graphene/utilities/key_conversion.hpp>
 #include <decent/encrypt/encryptionutils.hpp>
+#include <decent/package/package.hpp>
 #include <graphene/chain/transaction_detail_object.hpp>
+#include <graphene/wallet/key_recovery.hpp>
 
 
 using namespace graphene::app;
@@ -700,6 +702,26 @@ namespace graphene { namespace wallet {
           */
          void    set_wallet_filename(string wallet_filename);
 
+         /**
+          * @brief Enables the journal of the wallet file.
+          *
+          * With the journal, a change of the wallet appends a record to the journal file next to the wallet
+          * file instead of rewriting the whole wallet file. Keys are encrypted with the wallet password like
+          * in the wallet file. The journal is compacted into the wallet file when it grows larger than the
+          * wallet file, and by \c save_wallet_file(). A journal left by an earlier run is replayed when the
+          * wallet is loaded, whether the journal is enabled or not.
+          *
+          * @param enable true to append the changes to the journal
+          */
+         void    set_wallet_journal(bool enable);
+
+         /**
+          * @brief Defers the saves of the wallet until the matching \c end_wallet_batch(), e.g. for a bulk
+          * import of keys. Batches can be nested, the changes are saved once at the end of the outermost one.
+          */
+         void    begin_wallet_batch();
+         void    end_wallet_batch();
+
          /**
           * @brief Suggests a safe brain key to use for creating your account.
           * \c create_account_with_brain_key() requires you to specify a 'brain key',
@@ -767,6 +789,20 @@ namespace graphene { namespace wallet {
           */
          bool import_account_keys( string filename, string password, string src_account_name, string dest_account_name );
 
+         /**
+          * @brief Finds the accounts whose owner, active or memo keys were derived from the brain key and imports them
+          * together with their active and memo keys.
+          *
+          * The keys are derived in parallel batches, each batch is looked up with one call of get_key_references.
+          * Every key sequence is scanned until \c max_gap consecutive keys are unused.
+          *
+          * @param brain_key Brain key the accounts were created with
+          * @param max_gap Number of consecutive unused keys ending a key sequence
+          * @return The keys found in use and their accounts, without the private keys
+          * @ingroup WalletCLI
+          */
+         key_recovery_result recover_accounts_from_brain_key( string brain_key, uint32_t max_gap );
+
          /**
           * @brief Transforms a brain key to reduce the chance of errors when re-entering the key from memory.
           *
@@ -1712,6 +1748,25 @@ namespace graphene { namespace wallet {
                                                 const string& id,
                                                 const string& type,
                                                 uint32_t count )const;
+         /**
+          * @brief Calls the callback with the changes of the contents matching a search, instead of repeating the
+          * search. The callback runs on the thread of the wallet. A new call replaces the previous subscription.
+          * @see database_api::set_content_catalogue_callback
+          * @param cb Callback receiving the changes
+          * @param term Search term
+          * @param order Order field
+          * @param user Content owner
+          * @param region_code Two letter region code
+          * @param type The application and content type to be filtered
+          */
+         void set_content_catalogue_callback(std::function<void(const graphene::app::content_catalogue_delta&)> cb,
+                                             const string& term,
+                                             const string& order,
+                                             const string& user,
+                                             const string& region_code,
+                                             const string& type);
+         void cancel_content_catalogue_callback();
+
          /**
           * @brief Get a list of contents ordered alphabetically by search term
           * @param user Content owner
@@ -1813,6 +1868,12 @@ namespace graphene { namespace wallet {
           */
          void remove_package(const std::string& package_hash) const;
 
+         /**
+          * @brief Get the numbers of packages by state and the counters of the package event delivery
+          * @ingroup WalletCLI
+          */
+         decent::package::PackageManagerStats get_package_manager_stats() const;
+
          /**
           * @brief Print statuses of all active transfers
           * @ingroup WalletCLI
@@ -1951,6 +2012,7 @@ FC_API( graphene::wallet::wallet_api,
            (import_key)
            (import_accounts)
            (import_account_keys)
+           (recover_accounts_from_brain_key)
            (suggest_brain_key)
            (get_brain_key_info)
            (register_account)
@@ -2045,6 +2107,7 @@ FC_API( graphene::wallet::wallet_api,
            (download_package)
            (upload_package)
            (remove_package)
+           (get_package_manager_stats)
            (set_transfer_logs)
            (sign_buffer)
            (verify_signature)
@@ -0,0 +1,76 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#pragma once
+
+#include <graphene/chain/account_object.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace wallet {
+
+   /**
+    * Changes of the wallet data since the previous record. Applying a record again gives the same result, so the
+    * records may be replayed over a wallet file written after them.
+    */
+   struct wallet_journal_record
+   {
+      /** new private keys, a packed map<public_key_type, string> encrypted like wallet_data::cipher_keys */
+      std::vector<char>                                                                       cipher_keys;
+      std::vector<graphene::chain::account_object>                                            accounts;
+      /** keys added to the extra keys of the accounts */
+      std::map<graphene::chain::account_id_type, std::set<graphene::chain::public_key_type> > extra_keys;
+      /** the whole map, if it changed */
+      fc::optional< std::map<std::string, std::vector<std::string> > >                        pending_account_registrations;
+      fc::optional< std::map<std::string, std::string> >                                      pending_miner_registrations;
+   };
+
+   /**
+    * @brief Append-only log of the changes of a wallet, next to the wallet file
+    *
+    * Each record is stored with its size and checksum, so a record torn by a crash while it was appended is dropped
+    * when the journal is opened. Every appended record is synced to the disk, bulk changes are batched by the wallet
+    * into one record.
+    */
+   class wallet_journal
+   {
+      public:
+         explicit wallet_journal( const fc::path& path );
+         ~wallet_journal();
+
+         static fc::path path_for( const fc::path& wallet_filename ) { return wallet_filename.string() + ".journal"; }
+
+         const fc::path& path()const { return _path; }
+         /** size of the journal file in bytes */
+         uint64_t size()const { return _size; }
+
+         /** the complete records of the journal, in the order they were appended */
+         std::vector<wallet_journal_record> read()const;
+         void append( const wallet_journal_record& record );
+         /** removes all records, after the wallet file was written */
+         void clear();
+
+         /** syncs a file written by a stream to the disk */
+         static void sync_file( const fc::path& path );
+         /** syncs the entries of a directory to the disk, new and renamed files included; a no-op on Windows */
+         static void sync_directory( const fc::path& dir );
+
+      private:
+         void open();
+         void sync();
+
+         fc::path     _path;
+         std::FILE*   _file = nullptr;
+         uint64_t     _size = 0;
+   };
+
+} }
+
+FC_REFLECT( graphene::wallet::wallet_journal_record,
+            (cipher_keys)(accounts)(extra_keys)(pending_account_registrations)(pending_miner_registrations) )
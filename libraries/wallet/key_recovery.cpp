@@ -0,0 +1,131 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#include <graphene/wallet/key_recovery.hpp>
+
+#include <graphene/utilities/key_conversion.hpp>
+
+#include <fc/crypto/sha512.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace graphene { namespace wallet {
+
+fc::ecc::private_key derive_private_key( const std::string& prefix_string, int sequence_number )
+{
+   std::string sequence_string = std::to_string(sequence_number);
+   fc::sha512 h = fc::sha512::hash(prefix_string + " " + sequence_string);
+   fc::ecc::private_key derived_key = fc::ecc::private_key::regenerate(fc::sha256::hash(h));
+   return derived_key;
+}
+
+key_recovery::key_recovery( key_reference_lookup lookup, uint32_t thread_count )
+   : _lookup( lookup )
+{
+   if( thread_count == 0 )
+      thread_count = std::max( 1u, std::thread::hardware_concurrency() );
+   for( uint32_t i = 0; i < thread_count; ++i )
+      _threads.emplace_back( new fc::thread( "key_recovery_" + std::to_string(i) ) );
+}
+
+std::vector<key_recovery::derived_key> key_recovery::derive_batch( const std::string& prefix, uint32_t first, uint32_t count )
+{
+   std::vector<derived_key> keys( count );
+   const uint32_t chunk = ( count + _threads.size() - 1 ) / _threads.size();
+
+   std::vector<fc::future<void>> done;
+   for( uint32_t begin = 0, t = 0; begin < count; begin += chunk, ++t )
+   {
+      const uint32_t end = std::min( begin + chunk, count );
+      derived_key* out = keys.data();
+      // computing the public key is the expensive part, so it is done by the worker as well
+      done.push_back( _threads[t]->async( [&prefix, first, begin, end, out]() {
+         for( uint32_t i = begin; i < end; ++i )
+         {
+            out[i].first = derive_private_key( prefix, first + i );
+            out[i].second = out[i].first.get_public_key();
+         }
+      }, "derive_keys" ) );
+   }
+   for( auto& f : done )
+      f.wait();
+   return keys;
+}
+
+std::vector<recovered_key> key_recovery::scan_sequence( const std::string& role, const std::string& prefix,
+                                                        const key_recovery_options& options,
+                                                        const progress_callback& progress,
+                                                        key_recovery_result& result )
+{
+   std::vector<recovered_key> found;
+   key_recovery_progress status;
+   status.role = role;
+
+   uint32_t unused = 0;
+   for( uint32_t first = 0; unused < options.max_gap; first += options.batch_size )
+   {
+      std::vector<derived_key> keys = derive_batch( prefix, first, options.batch_size );
+      std::vector<graphene::chain::public_key_type> public_keys;
+      public_keys.reserve( keys.size() );
+      for( const auto& key : keys )
+         public_keys.push_back( key.second );
+
+      std::vector<std::vector<graphene::chain::account_id_type>> references = _lookup( public_keys );
+      FC_ASSERT( references.size() == public_keys.size(), "Key reference lookup returned ${n} results for ${k} keys",
+                 ("n", references.size())("k", public_keys.size()) );
+
+      // used keys after the gap was reached within the batch are kept too, they cost no further lookup
+      for( uint32_t i = 0; i < keys.size(); ++i )
+      {
+         if( references[i].empty() )
+         {
+            ++unused;
+            continue;
+         }
+         unused = 0;
+
+         recovered_key item;
+         item.role = role;
+         item.sequence_number = first + i;
+         item.public_key = keys[i].second;
+         item.wif_private_key = graphene::utilities::key_to_wif( keys[i].first );
+         item.accounts = references[i];
+         result.accounts.insert( item.accounts.begin(), item.accounts.end() );
+         found.push_back( item );
+      }
+
+      status.keys_derived += keys.size();
+      status.keys_found = found.size();
+      status.lookups++;
+      result.keys_derived += keys.size();
+      result.lookups++;
+      if( progress )
+         progress( status );
+   }
+   return found;
+}
+
+key_recovery_result key_recovery::recover_brain_key( const std::string& brain_key,
+                                                     const key_recovery_options& options,
+                                                     const progress_callback& progress )
+{ try {
+   FC_ASSERT( options.batch_size > 0 && options.max_gap > 0 );
+   key_recovery_result result;
+
+   std::vector<recovered_key> owner_keys = scan_sequence( "owner", brain_key, options, progress, result );
+   result.keys.insert( result.keys.end(), owner_keys.begin(), owner_keys.end() );
+
+   for( const auto& owner_key : owner_keys )
+   {
+      std::vector<recovered_key> active_keys = scan_sequence( "active", owner_key.wif_private_key, options, progress, result );
+      result.keys.insert( result.keys.end(), active_keys.begin(), active_keys.end() );
+
+      for( const auto& active_key : active_keys )
+      {
+         std::vector<recovered_key> memo_keys = scan_sequence( "memo", active_key.wif_private_key, options, progress, result );
+         result.keys.insert( result.keys.end(), memo_keys.begin(), memo_keys.end() );
+      }
+   }
+   return result;
+} FC_CAPTURE_AND_RETHROW( (options) ) }
+
+} }
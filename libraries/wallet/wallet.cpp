@@ -75,6 +75,7 @@
 #include <graphene/wallet/wallet.hpp>
 #include <graphene/wallet/api_documentation.hpp>
 #include <graphene/wallet/reflect_util.hpp>
+#include <graphene/wallet/wallet_journal.hpp>
 #include <graphene/debug_miner/debug_api.hpp>
 
 #include <decent/package/package.hpp>
@@ -214,15 +215,6 @@ optional<T> maybe_id( const string& name_or_id )
    return optional<T>();
 }
 
-fc::ecc::private_key derive_private_key( const std::string& prefix_string,
-                                         int sequence_number )
-{
-   std::string sequence_string = std::to_string(sequence_number);
-   fc::sha512 h = fc::sha512::hash(prefix_string + " " + sequence_string);
-   fc::ecc::private_key derived_key = fc::ecc::private_key::regenerate(fc::sha256::hash(h));
-   return derived_key;
-}
-
 string normalize_brain_key( string s )
 {
    size_t i = 0, n = s.length();
@@ -342,7 +334,7 @@ private:
       FC_ASSERT(miner_private_key);
 
       auto pub_key = miner_private_key->get_public_key();
-      _keys[pub_key] = wif_key;
+      store_key( pub_key, wif_key );
       _wallet.pending_miner_registrations.erase(iter);
    }
 
@@ -766,11 +758,11 @@ public:
 
          graphene::chain::public_key_type active_pubkey = active_privkey.get_public_key();
          graphene::chain::public_key_type memo_pubkey = memo_privkey.get_public_key();
-         _keys[active_pubkey] = key_to_wif( active_privkey );
-         _keys[memo_pubkey] = key_to_wif( memo_privkey );
+         store_key( active_pubkey, key_to_wif( active_privkey ) );
+         store_key( memo_pubkey, key_to_wif( memo_privkey ) );
 
-         _wallet.extra_keys[account.id].insert( active_pubkey );
-         _wallet.extra_keys[account.id].insert( memo_pubkey );
+         add_extra_key( account.id, active_pubkey );
+         add_extra_key( account.id, memo_pubkey );
 
       }
 
@@ -778,11 +770,11 @@ public:
       std::copy(owner_keys.begin(), owner_keys.end(), std::inserter(all_keys_for_account, all_keys_for_account.end()));
       all_keys_for_account.insert(account.options.memo_key);
 
-      _keys[wif_pub_key] = wif_key;
+      store_key( wif_pub_key, wif_key );
 
-      _wallet.update_account(account);
+      update_my_account( account );
 
-      _wallet.extra_keys[account.id].insert(wif_pub_key);
+      add_extra_key( account.id, wif_pub_key );
 
       return all_keys_for_account.find(wif_pub_key) != all_keys_for_account.end();
    }
@@ -803,6 +795,8 @@ public:
             ("wallet.chain_id", _wallet.chain_id)
             ("chain_id", _chain_id) );
 
+      open_journal( wallet_filename );
+
       size_t account_pagination = 100;
       vector< account_id_type > account_ids_to_send;
       size_t n = _wallet.my_accounts.size();
@@ -841,16 +835,31 @@ public:
             if( fc::json::to_string(*acct) != fc::json::to_string(old_acct) )
             {
                wlog( "Account ${id} : \"${name}\" updated on chain", ("id", acct->id)("name", acct->name) );
+               update_my_account( *acct );
             }
-            _wallet.update_account( *acct );
             i++;
          }
       }
 
       return true;
    }
+   // saves the changes of the wallet, to the journal if it is enabled and no other file is given,
+   // or by writing the whole wallet file
    void save_wallet_file(string wallet_filename = "")
    {
+      if( wallet_filename == "" && _save_batch_depth > 0 )
+      {
+         _save_pending = true;
+         return;
+      }
+
+      if( wallet_filename == "" && _journal )
+      {
+         _save_pending = false;
+         append_journal_record();
+         return;
+      }
+
       //
       // Serialize in memory, then save to disk
       //
@@ -875,11 +884,81 @@ public:
          //
          // http://en.wikipedia.org/wiki/Most_vexing_parse
          //
-         fc::ofstream outfile{ fc::path( wallet_filename ) };
+         // the journal is only cleared after the new file replaced the old one completely
+         const fc::path temp_filename = wallet_filename + ".tmp";
+         fc::ofstream outfile{ temp_filename };
          outfile.write( data.c_str(), data.length() );
          outfile.flush();
          outfile.close();
+         wallet_journal::sync_file( temp_filename );
+         fc::rename( temp_filename, fc::path( wallet_filename ) );
+         // the rename has to reach the disk before on_wallet_file_written() clears the journal
+         wallet_journal::sync_directory( fc::path( wallet_filename ).parent_path() );
+         disable_umask_protection();
+      }
+      catch(...)
+      {
+         disable_umask_protection();
+         throw;
+      }
+
+      if( fc::path( wallet_filename ) == fc::path( _wallet_filename ) )
+         on_wallet_file_written();
+   }
+
+   void store_key( const public_key_type& key, const string& wif_key )
+   {
+      _keys[key] = wif_key;
+      _unsaved_keys[key] = wif_key;
+   }
+
+   void add_extra_key( account_id_type account, const public_key_type& key )
+   {
+      _wallet.extra_keys[account].insert( key );
+      _unsaved_extra_keys[account].insert( key );
+   }
+
+   void update_my_account( const account_object& account )
+   {
+      _wallet.update_account( account );
+      _unsaved_accounts.insert( account.id );
+   }
+
+   /// saves done within a batch are written once, at the end of the outermost batch
+   void begin_save_batch()
+   {
+      ++_save_batch_depth;
+   }
+
+   void end_save_batch()
+   {
+      FC_ASSERT( _save_batch_depth > 0 );
+      if( --_save_batch_depth == 0 && _save_pending )
+         save_wallet_file();
+   }
+
+   void set_wallet_journal( bool enable )
+   {
+      _journal_enabled = enable;
+      if( !enable )
+      {
+         // the next save writes the whole wallet file and removes the journal
+         _journal.reset();
+         return;
+      }
+      // a journal written before is replayed by load_wallet_file(), the changes from now on are appended to it
+      if( !_journal && !_wallet_filename.empty() )
+         _journal = create_journal( wallet_journal::path_for( _wallet_filename ) );
+   }
+
+   std::unique_ptr<wallet_journal> create_journal( const fc::path& journal_path )
+   {
+      try
+      {
+         enable_umask_protection();
+         std::unique_ptr<wallet_journal> journal( new wallet_journal( journal_path ) );
          disable_umask_protection();
+         return journal;
       }
       catch(...)
       {
@@ -888,6 +967,139 @@ public:
       }
    }
 
+   // replays the journal of the wallet file and keeps it open for appending if the journal is enabled
+   void open_journal( const string& wallet_filename )
+   {
+      _journal.reset();
+      _journal_cipher_keys.clear();
+      _unsaved_keys.clear();
+      _unsaved_accounts.clear();
+      _unsaved_extra_keys.clear();
+
+      const fc::path journal_path = wallet_journal::path_for( wallet_filename );
+      const bool own_file = fc::path( wallet_filename ) == fc::path( _wallet_filename );
+      if( fc::exists( journal_path ) || ( _journal_enabled && own_file ) )
+      {
+         std::unique_ptr<wallet_journal> journal = create_journal( journal_path );
+         for( const wallet_journal_record& record : journal->read() )
+         {
+            if( !record.cipher_keys.empty() )
+               _journal_cipher_keys.push_back( record.cipher_keys );
+            for( const account_object& account : record.accounts )
+               _wallet.update_account( account );
+            for( const auto& item : record.extra_keys )
+               _wallet.extra_keys[item.first].insert( item.second.begin(), item.second.end() );
+            if( record.pending_account_registrations.valid() )
+               _wallet.pending_account_registrations = *record.pending_account_registrations;
+            if( record.pending_miner_registrations.valid() )
+               _wallet.pending_miner_registrations = *record.pending_miner_registrations;
+         }
+
+         if( _journal_enabled && own_file )
+            _journal = std::move( journal );
+      }
+
+      _saved_pending_account_registrations = _wallet.pending_account_registrations;
+      _saved_pending_miner_registrations = _wallet.pending_miner_registrations;
+      if( !is_locked() )
+         apply_journal_keys();
+   }
+
+   // adds the keys of the journal to the unlocked wallet
+   void apply_journal_keys()
+   {
+      for( const vector<char>& cipher_keys : _journal_cipher_keys )
+      {
+         try
+         {
+            plain_keys data = fc::raw::unpack<plain_keys>( fc::aes_decrypt( _checksum, cipher_keys ) );
+            FC_ASSERT( data.checksum == _checksum );
+            for( const auto& item : data.keys )
+               _keys[item.first] = item.second;
+         }
+         catch( const fc::exception& e )
+         {
+            // keys saved before the password was changed are in the wallet file already
+            wlog( "skipping keys of the wallet journal encrypted with another password" );
+         }
+      }
+      _journal_cipher_keys.clear();
+   }
+
+   // appends the changes since the last save to the journal, and compacts the journal into the
+   // wallet file once it is larger than the wallet file
+   void append_journal_record()
+   {
+      wallet_journal_record record;
+      if( !_unsaved_keys.empty() && !is_locked() )
+      {
+         plain_keys data;
+         data.keys = _unsaved_keys;
+         data.checksum = _checksum;
+         record.cipher_keys = fc::aes_encrypt( _checksum, fc::raw::pack( data ) );
+      }
+      const auto& accounts_by_id = _wallet.my_accounts.get<by_id>();
+      for( const account_id_type& id : _unsaved_accounts )
+      {
+         auto itr = accounts_by_id.find( id );
+         if( itr != accounts_by_id.end() )
+            record.accounts.push_back( *itr );
+      }
+      record.extra_keys = _unsaved_extra_keys;
+      if( _wallet.pending_account_registrations != _saved_pending_account_registrations )
+         record.pending_account_registrations = _wallet.pending_account_registrations;
+      if( _wallet.pending_miner_registrations != _saved_pending_miner_registrations )
+         record.pending_miner_registrations = _wallet.pending_miner_registrations;
+
+      if( record.cipher_keys.empty() && record.accounts.empty() && record.extra_keys.empty() &&
+          !record.pending_account_registrations.valid() && !record.pending_miner_registrations.valid() )
+         return;
+
+      _journal->append( record );
+      if( !record.cipher_keys.empty() )
+         _unsaved_keys.clear();
+      _unsaved_accounts.clear();
+      _unsaved_extra_keys.clear();
+      _saved_pending_account_registrations = _wallet.pending_account_registrations;
+      _saved_pending_miner_registrations = _wallet.pending_miner_registrations;
+
+      const uint64_t wallet_file_size = fc::exists( _wallet_filename ) ? fc::file_size( _wallet_filename ) : 0;
+      if( _journal->size() > std::max<uint64_t>( wallet_file_size, uint64_t( journal_compaction_min_bytes ) ) )
+      {
+         ilog( "compacting the wallet journal ${fn}", ("fn", _journal->path()) );
+         save_wallet_file( _wallet_filename );
+      }
+   }
+
+   // everything is in the wallet file now
+   void on_wallet_file_written()
+   {
+      _save_pending = false;
+      _unsaved_keys.clear();
+      _unsaved_accounts.clear();
+      _unsaved_extra_keys.clear();
+      _saved_pending_account_registrations = _wallet.pending_account_registrations;
+      _saved_pending_miner_registrations = _wallet.pending_miner_registrations;
+
+      // keys replayed from the journal while the wallet is locked are not in the wallet file yet, so the journal is
+      // kept, and as it is replayed over this wallet file it has to end with the current registrations
+      if( !_journal_cipher_keys.empty() )
+      {
+         wallet_journal_record record;
+         record.pending_account_registrations = _wallet.pending_account_registrations;
+         record.pending_miner_registrations = _wallet.pending_miner_registrations;
+         if( _journal )
+            _journal->append( record );
+         else
+            wallet_journal( wallet_journal::path_for( _wallet_filename ) ).append( record );
+         return;
+      }
+      if( _journal )
+         _journal->clear();
+      else if( fc::exists( wallet_journal::path_for( _wallet_filename ) ) )
+         fc::remove( wallet_journal::path_for( _wallet_filename ) );
+   }
+
    transaction_handle_type begin_builder_transaction()
    {
       int trx_handle = _builder_transactions.empty()? 0
@@ -1157,6 +1369,48 @@ public:
    } FC_CAPTURE_AND_RETHROW( (account_name)(registrar_account) ) }
 
 
+   key_recovery_result recover_accounts_from_brain_key( string brain_key, uint32_t max_gap )
+   { try {
+      FC_ASSERT( !self.is_locked() );
+      key_recovery_options options;
+      options.max_gap = max_gap;
+
+      key_recovery recovery( [this]( const vector<public_key_type>& keys ) {
+         return _remote_db->get_key_references( keys );
+      });
+      key_recovery_result result = recovery.recover_brain_key( normalize_brain_key( brain_key ), options,
+         []( const key_recovery_progress& progress ) {
+            ilog( "Recovering ${role} keys: ${n} derived, ${f} in use", ("role", progress.role)("n", progress.keys_derived)("f", progress.keys_found) );
+         });
+
+      vector<account_id_type> account_ids( result.accounts.begin(), result.accounts.end() );
+      vector<optional<account_object>> accounts = _remote_db->get_accounts( account_ids );
+      for( const optional<account_object>& account : accounts )
+      {
+         if( !account.valid() )
+            continue;
+
+         // as in create_account_with_private_key, the owner key is only imported if the account also uses it as active key
+         vector<public_key_type> active_keys = account->active.get_keys();
+         for( const recovered_key& key : result.keys )
+         {
+            if( std::find( key.accounts.begin(), key.accounts.end(), account->id ) == key.accounts.end() )
+               continue;
+            if( key.public_key != account->options.memo_key &&
+                std::find( active_keys.begin(), active_keys.end(), key.public_key ) == active_keys.end() )
+               continue;
+            store_key( key.public_key, key.wif_private_key );
+            add_extra_key( account->id, key.public_key );
+         }
+         update_my_account( *account );
+      }
+      save_wallet_file();
+
+      for( recovered_key& key : result.keys )
+         key.wif_private_key.clear();
+      return result;
+   } FC_CAPTURE_AND_RETHROW( (max_gap) ) }
+
    signed_transaction create_asset(string issuer,
                                    string symbol,
                                    uint8_t precision,
@@ -2601,6 +2855,35 @@ signed_transaction content_cancellation(string author,
       }
    }
 
+   /**
+    * Asks the node for the binary-encoded API once.  Nodes that don't offer it (older versions, or
+    * an apiaccess file that doesn't list raw_api) and nodes packing the results in another layout
+    * than this wallet decodes are remembered and served through the JSON calls.
+    */
+   bool use_raw_api()
+   {
+      if( _remote_raw )
+         return true;
+      if( _remote_raw_unavailable )
+         return false;
+      try
+      {
+         fc::api<raw_api> remote_raw = _remote_api->raw();
+         const string remote_layout = remote_raw->get_layout_version();
+         if( remote_layout == raw_api::layout_version() )
+            _remote_raw = remote_raw;
+         else
+            dlog( "Binary-encoded API layout ${remote} differs from ${local}, using JSON",
+                  ("remote", remote_layout)("local", raw_api::layout_version()) );
+      }
+      catch( const fc::exception& e )
+      {
+         dlog( "Binary-encoded API not available, using JSON: ${e}", ("e", e.to_string()) );
+      }
+      _remote_raw_unavailable = !_remote_raw.valid();
+      return _remote_raw.valid();
+   }
+
    void use_debug_api()
    {
       if( _remote_debug )
@@ -2703,6 +2986,22 @@ signed_transaction content_cancellation(string author,
    map<public_key_type,string> _keys;
    fc::sha512                  _checksum;
 
+   // journal of the changes of the wallet file, see set_wallet_journal()
+   static const uint64_t               journal_compaction_min_bytes = 1024 * 1024;
+   bool                                _journal_enabled = false;
+   std::unique_ptr<wallet_journal>     _journal;
+   /// key records read from the journal while the wallet was locked
+   vector< vector<char> >              _journal_cipher_keys;
+   uint32_t                            _save_batch_depth = 0;
+   bool                                _save_pending = false;
+
+   // changes not written to the wallet file or the journal yet
+   map<public_key_type,string>                   _unsaved_keys;
+   set<account_id_type>                          _unsaved_accounts;
+   map<account_id_type, set<public_key_type> >   _unsaved_extra_keys;
+   map<string, vector<string> >                  _saved_pending_account_registrations;
+   map<string, string>                           _saved_pending_miner_registrations;
+
    chain_id_type           _chain_id;
    fc::api<login_api>      _remote_api;
    fc::api<database_api>   _remote_db;
@@ -2710,6 +3009,8 @@ signed_transaction content_cancellation(string author,
    fc::api<history_api>    _remote_hist;
    optional< fc::api<network_node_api> > _remote_net_node;
    optional< fc::api<graphene::debug_miner::debug_api> > _remote_debug;
+   optional< fc::api<raw_api> > _remote_raw;
+   bool                    _remote_raw_unavailable = false;
 
    flat_map<string, operation> _prototype_ops;
 
@@ -2725,6 +3026,37 @@ signed_transaction content_cancellation(string author,
    seeders_tracker _seeders_tracker;
 };
 
+/// groups the saves of the wallet done while it exists into one, e.g. one journal record for a bulk import
+class wallet_save_batch
+{
+public:
+   explicit wallet_save_batch( wallet_api_impl& wallet ) : _wallet( wallet ) { _wallet.begin_save_batch(); }
+   ~wallet_save_batch()
+   {
+      if( _ended )
+         return;
+      try
+      {
+         _wallet.end_save_batch();
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "unable to save the wallet: ${e}", ("e", e.to_detail_string()) );
+      }
+   }
+
+   /// saves the wallet if anything changed
+   void end()
+   {
+      _ended = true;
+      _wallet.end_save_batch();
+   }
+
+private:
+   wallet_api_impl& _wallet;
+   bool             _ended = false;
+};
+
    std::string operation_printer::fee(const asset& a)const {
       out << "   (Fee: " << wallet.get_asset(a.asset_id).amount_to_pretty_string(a) << ")";
       return "";
@@ -3095,6 +3427,8 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
 
    optional<signed_block_with_info> wallet_api::get_block(uint32_t num)
    {
+      if( my->use_raw_api() )
+         return unpack_raw_result<optional<signed_block>>( (*my->_remote_raw)->get_block(num) );
       return my->_remote_db->get_block(num);
    }
 
@@ -3145,7 +3479,11 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
          }
 
 
-         vector<operation_history_object> current = my->_remote_hist->get_account_history(account_id, "", operation_history_id_type(), std::min(100,limit), start);
+         vector<operation_history_object> current;
+         if( my->use_raw_api() )
+            current = unpack_raw_result<vector<operation_history_object>>( (*my->_remote_raw)->get_account_history(account_id, "", operation_history_id_type(), std::min(100,limit), start) );
+         else
+            current = my->_remote_hist->get_account_history(account_id, "", operation_history_id_type(), std::min(100,limit), start);
          for( auto& o : current ) {
             std::stringstream ss;
             auto memo = o.op.visit(detail::operation_printer(ss, *my, o.result));
@@ -3373,13 +3711,18 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
 
       if( my->import_key(account_name_or_id, wif_key) )
       {
-         save_wallet_file();
+         my->save_wallet_file();
    //      copy_wallet_file( "after-import-key-" + base58_public_key );
          return true;
       }
       return false;
    }
 
+   key_recovery_result wallet_api::recover_accounts_from_brain_key( string brain_key, uint32_t max_gap )
+   {
+      return my->recover_accounts_from_brain_key( brain_key, max_gap );
+   }
+
    map<string, bool> wallet_api::import_accounts( string filename, string password )
    {
       FC_ASSERT( !is_locked() );
@@ -3391,6 +3734,7 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
       FC_ASSERT( fc::sha512::hash( password_hash ) == imported_keys.password_checksum );
 
       map<string, bool> result;
+      detail::wallet_save_batch batch( *my );
       for( const auto& item : imported_keys.account_keys )
       {
           const auto import_this_account = [ & ]() -> bool
@@ -3446,6 +3790,7 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
                  elog( "failed to import ${n} keys for account ${name}", ("n", import_failures)("name", item.account_name) );
           }
       }
+      batch.end();
 
       return result;
    }
@@ -3487,10 +3832,10 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
 
               my->import_key( dest_account_name, string( graphene::utilities::key_to_wif( private_key ) ) );
           }
+          my->save_wallet_file();
 
           return true;
       }
-      save_wallet_file();
 
       FC_ASSERT( found_account );
 
@@ -3514,7 +3859,7 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
 
    fc::ecc::private_key wallet_api::derive_private_key(const std::string& prefix_string, int sequence_number) const
    {
-      return detail::derive_private_key( prefix_string, sequence_number );
+      return graphene::wallet::derive_private_key( prefix_string, sequence_number );
    }
 
    signed_transaction wallet_api::register_account(string name,
@@ -3825,7 +4170,23 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
 
    void wallet_api::save_wallet_file( string wallet_filename )
    {
-      my->save_wallet_file( wallet_filename );
+      // an explicit save writes the whole file, which also compacts the journal
+      my->save_wallet_file( wallet_filename.empty() ? my->_wallet_filename : wallet_filename );
+   }
+
+   void wallet_api::set_wallet_journal( bool enable )
+   {
+      my->set_wallet_journal( enable );
+   }
+
+   void wallet_api::begin_wallet_batch()
+   {
+      my->begin_save_batch();
+   }
+
+   void wallet_api::end_wallet_batch()
+   {
+      my->end_save_batch();
    }
 
    std::map<string,std::function<string(fc::variant,const fc::variants&)> >
@@ -3851,6 +4212,9 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
    void wallet_api::lock()
    { try {
       FC_ASSERT( !is_locked() );
+      // the new keys are encrypted into the journal while the password is known
+      if( my->_journal )
+         my->append_journal_record();
       encrypt_keys();
       for( auto & key : my->_keys )
          key.second = key_to_wif(fc::ecc::private_key());
@@ -3868,6 +4232,7 @@ std::string operation_printer::operator()(const leave_rating_and_comment_operati
       FC_ASSERT(pk.checksum == pw);
       my->_keys = std::move(pk.keys);
       my->_checksum = pk.checksum;
+      my->apply_journal_keys();
       my->self.lock_changed(false);
    } FC_CAPTURE_AND_RETHROW() }
 
@@ -4061,7 +4426,7 @@ void wallet_api::leave_rating_and_comment(string consumer,
          bobj.price = *op_price;
 
          bobj.size = content->size;
-         bobj.rating = content->AVG_rating;
+         bobj.rating = my->get_object<content_statistics_object>(content->statistics).AVG_rating;
          bobj.synopsis = content->synopsis;
 
       }
@@ -4094,12 +4459,14 @@ void wallet_api::leave_rating_and_comment(string consumer,
          result.emplace_back(buying_object_ex(bobjects[i], *status));
          buying_object_ex& bobj = result.back();
 
+         const content_statistics_object stats = my->get_object<content_statistics_object>(content->statistics);
+
          bobj.author_account = my->get_account(content->author).name;
-         bobj.times_bought = content->times_bought;
+         bobj.times_bought = stats.times_bought;
          bobj.hash = content->_hash;
-         bobj.AVG_rating = content->AVG_rating;
-         bobj.rating = content->AVG_rating;
-         bobj.average_rating = content->AVG_rating;
+         bobj.AVG_rating = stats.AVG_rating;
+         bobj.rating = stats.AVG_rating;
+         bobj.average_rating = stats.AVG_rating;
       }
 
       return result;
@@ -4141,9 +4508,29 @@ vector<content_summary> wallet_api::search_content(const string& term,
                                                    const string& type,
                                                    uint32_t count)const
 {
+   if( my->use_raw_api() )
+      return unpack_raw_result<vector<content_summary>>( (*my->_remote_raw)->search_content(term, order, user, region_code, object_id_type(id), type, count) );
    return my->_remote_db->search_content(term, order, user, region_code, object_id_type(id), type, count);
 }
 
+void wallet_api::set_content_catalogue_callback(std::function<void(const graphene::app::content_catalogue_delta&)> cb,
+                                                const string& term,
+                                                const string& order,
+                                                const string& user,
+                                                const string& region_code,
+                                                const string& type)
+{
+   my->_remote_db->set_content_catalogue_callback( [cb]( const variant& delta )
+   {
+      cb( delta.as<graphene::app::content_catalogue_delta>() );
+   }, term, order, user, region_code, type );
+}
+
+void wallet_api::cancel_content_catalogue_callback()
+{
+   my->_remote_db->cancel_content_catalogue_callback();
+}
+
 map<string, string> wallet_api::get_content_comments( const string& URI )const
 {
    return my->_remote_db->get_content_comments( URI );
@@ -4157,7 +4544,7 @@ map<string, string> wallet_api::get_content_comments( const string& URI )const
                                                            const string& type,
                                                            uint32_t count)const
    {
-      vector<content_summary> result = my->_remote_db->search_content(term, order, user, region_code, object_id_type(id), type, count);
+      vector<content_summary> result = search_content(term, order, user, region_code, id, type, count);
 
       auto packages = PackageManager::instance().get_all_known_packages();
       for (auto package: packages)
@@ -4407,6 +4794,10 @@ void graphene::wallet::detail::submit_transfer_listener::package_seed_complete()
       PackageManager::instance().release_package(fc::ripemd160(package_hash));
    }
 
+   decent::package::PackageManagerStats wallet_api::get_package_manager_stats() const {
+      return PackageManager::instance().get_stats();
+   }
+
    void wallet_api::download_package(const std::string& url) const {
       FC_ASSERT(!is_locked());
       auto content = get_content(url);
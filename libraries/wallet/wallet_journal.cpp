@@ -0,0 +1,168 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#include <graphene/wallet/wallet_journal.hpp>
+
+#include <fc/crypto/city.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#ifdef _WIN32
+# include <io.h>
+#else
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace graphene { namespace wallet {
+
+namespace {
+
+   struct record_header
+   {
+      uint32_t size = 0;
+      uint64_t checksum = 0;
+   };
+
+   const uint64_t header_size = sizeof(record_header::size) + sizeof(record_header::checksum);
+
+   /**
+    * reads the next record, false at the end of the file or at a torn or damaged record. A damaged size is not trusted
+    * further than the remaining bytes of the file.
+    */
+   bool read_record( std::FILE* file, uint64_t remaining, std::vector<char>& data )
+   {
+      record_header header;
+      if( remaining < header_size ||
+          std::fread( &header.size, sizeof(header.size), 1, file ) != 1 ||
+          std::fread( &header.checksum, sizeof(header.checksum), 1, file ) != 1 ||
+          header.size > remaining - header_size )
+         return false;
+      data.resize( header.size );
+      if( header.size > 0 && std::fread( data.data(), header.size, 1, file ) != 1 )
+         return false;
+      return fc::city_hash64( data.data(), data.size() ) == header.checksum;
+   }
+
+}
+
+wallet_journal::wallet_journal( const fc::path& path )
+   : _path( path )
+{
+   // finds the end of the last complete record and drops whatever follows it
+   const bool existed = fc::exists( _path );
+   if( existed )
+   {
+      const uint64_t file_size = boost::filesystem::file_size( _path );
+      std::FILE* file = std::fopen( _path.string().c_str(), "rb" );
+      FC_ASSERT( file != nullptr, "Unable to open the wallet journal ${p}", ("p", _path) );
+      std::vector<char> data;
+      while( read_record( file, file_size - _size, data ) )
+         _size += header_size + data.size();
+      std::fclose( file );
+
+      if( _size != file_size )
+      {
+         wlog( "dropping an incomplete record at the end of the wallet journal ${p}", ("p", _path) );
+         boost::filesystem::resize_file( _path, _size );
+      }
+   }
+   open();
+   if( !existed )
+      sync_directory( _path.parent_path() );
+}
+
+wallet_journal::~wallet_journal()
+{
+   if( _file != nullptr )
+      std::fclose( _file );
+}
+
+void wallet_journal::open()
+{
+   _file = std::fopen( _path.string().c_str(), "ab" );
+   FC_ASSERT( _file != nullptr, "Unable to open the wallet journal ${p}", ("p", _path) );
+}
+
+std::vector<wallet_journal_record> wallet_journal::read()const
+{ try {
+   std::vector<wallet_journal_record> result;
+   std::FILE* file = std::fopen( _path.string().c_str(), "rb" );
+   FC_ASSERT( file != nullptr, "Unable to open the wallet journal ${p}", ("p", _path) );
+
+   std::vector<char> data;
+   uint64_t offset = 0;
+   while( offset < _size && read_record( file, _size - offset, data ) )
+   {
+      result.push_back( fc::raw::unpack<wallet_journal_record>( data ) );
+      offset += header_size + data.size();
+   }
+   std::fclose( file );
+   return result;
+} FC_CAPTURE_AND_RETHROW( (_path) ) }
+
+void wallet_journal::append( const wallet_journal_record& record )
+{ try {
+   const std::vector<char> data = fc::raw::pack( record );
+   record_header header;
+   header.size = data.size();
+   header.checksum = fc::city_hash64( data.data(), data.size() );
+
+   FC_ASSERT( std::fwrite( &header.size, sizeof(header.size), 1, _file ) == 1 &&
+              std::fwrite( &header.checksum, sizeof(header.checksum), 1, _file ) == 1 &&
+              ( data.empty() || std::fwrite( data.data(), data.size(), 1, _file ) == 1 ),
+              "Unable to write to the wallet journal ${p}", ("p", _path) );
+   _size += sizeof(header.size) + sizeof(header.checksum) + data.size();
+   sync();
+} FC_CAPTURE_AND_RETHROW( (_path) ) }
+
+void wallet_journal::clear()
+{
+   std::fclose( _file );
+   _file = std::fopen( _path.string().c_str(), "wb" );
+   FC_ASSERT( _file != nullptr, "Unable to open the wallet journal ${p}", ("p", _path) );
+   _size = 0;
+   sync();
+}
+
+void wallet_journal::sync()
+{
+   std::fflush( _file );
+#ifdef _WIN32
+   _commit( _fileno( _file ) );
+#else
+   fsync( fileno( _file ) );
+#endif
+}
+
+void wallet_journal::sync_file( const fc::path& path )
+{
+   // appending changes nothing, but gives the write access needed to flush the file on Windows
+   std::FILE* file = std::fopen( path.string().c_str(), "ab" );
+   FC_ASSERT( file != nullptr, "Unable to open ${p}", ("p", path) );
+#ifdef _WIN32
+   const bool synced = _commit( _fileno( file ) ) == 0;
+#else
+   const bool synced = fsync( fileno( file ) ) == 0;
+#endif
+   std::fclose( file );
+   FC_ASSERT( synced, "Unable to sync ${p} to the disk", ("p", path) );
+}
+
+void wallet_journal::sync_directory( const fc::path& dir )
+{
+#ifndef _WIN32
+   // a file created or renamed in the directory survives a crash only once the directory is synced as well
+   const int fd = ::open( dir.string().empty() ? "." : dir.string().c_str(), O_RDONLY );
+   if( fd < 0 )
+   {
+      wlog( "unable to sync the directory ${d}", ("d", dir) );
+      return;
+   }
+   fsync( fd );
+   ::close( fd );
+#endif
+}
+
+} }
@@ -7,6 +7,7 @@
 #include <mutex>
 #include <vector>
 #include <chrono>
+#include <functional>
 #include <graphene/chain/protocol/types.hpp>
 
 namespace graphene
@@ -19,6 +20,10 @@ namespace chain
 {
    struct content_summary;
 }
+namespace app
+{
+   struct content_catalogue_delta;
+}
 }
 namespace fc
 {
@@ -50,6 +55,14 @@ namespace wallet_utility
       void LoadAssetInfo( string &str_symbol, uint8_t &precision, const graphene::chain::asset_id_type id = graphene::chain::asset_id_type() );
       void SaveWalletFile();
       std::vector<graphene::chain::content_summary> SearchContent(string const& str_term, uint32_t iCount);
+      // the callback runs on the wallet thread
+      void SetContentCatalogueCallback(std::function<void(graphene::app::content_catalogue_delta const&)> cb,
+                                       string const& str_term,
+                                       string const& str_order,
+                                       string const& str_user,
+                                       string const& str_region_code,
+                                       string const& str_type);
+      void CancelContentCatalogueCallback();
 
       string RunTask(string const& str_command);
 
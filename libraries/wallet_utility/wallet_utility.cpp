@@ -331,6 +331,43 @@ namespace wallet_utility
                        });
       return future_save_wallet_file.wait();
    }
+   void WalletAPI::SetContentCatalogueCallback(std::function<void(graphene::app::content_catalogue_delta const&)> cb,
+                                               string const& str_term,
+                                               string const& str_order,
+                                               string const& str_user,
+                                               string const& str_region_code,
+                                               string const& str_type)
+   {
+      if (false == Connected())
+         throw wallet_exception("not yet connected");
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      auto& pimpl = m_pimpl->m_ptr_wallet_api;
+      fc::future<void> future_set_callback =
+      m_pthread->async([&pimpl, &cb, &str_term, &str_order, &str_user, &str_region_code, &str_type] ()
+                       {
+                          return pimpl->set_content_catalogue_callback(cb, str_term, str_order, str_user, str_region_code, str_type);
+                       });
+      return future_set_callback.wait();
+   }
+
+   void WalletAPI::CancelContentCatalogueCallback()
+   {
+      if (false == Connected())
+         throw wallet_exception("not yet connected");
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      auto& pimpl = m_pimpl->m_ptr_wallet_api;
+      fc::future<void> future_cancel_callback =
+      m_pthread->async([&pimpl] ()
+                       {
+                          return pimpl->cancel_content_catalogue_callback();
+                       });
+      return future_cancel_callback.wait();
+   }
+
    /*
    std::vector<graphene::chain::content_summary> WalletAPI::SearchContent(string const& str_term, uint32_t iCount)
    {
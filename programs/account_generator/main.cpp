@@ -186,6 +186,7 @@ int main( int argc, char** argv )
        ("rpc-http-endpoint,H", bpo::value<string>()->implicit_value("127.0.0.1:8093"), "Endpoint for wallet HTTP RPC to listen on")
        ("daemon,d", "Run the wallet in daemon mode" )
        ("wallet-file,w", bpo::value<string>()->implicit_value("wallet.json"), "wallet to load")
+       ("wallet-journal", "Append the changes of the wallet to a journal instead of rewriting the wallet file")
        ("chain-id", bpo::value<string>(), "chain ID to connect to")
        ("skip", bpo::value<size_t>(), "skip accounts")
        ("testnet", bpo::value<size_t>(), "testnet version 1 or 2")
@@ -315,6 +316,7 @@ int main( int argc, char** argv )
 
       auto wapiptr = std::make_shared<wallet_api>( wdata, remote_api );
       wapiptr->set_wallet_filename( wallet_file.generic_string() );
+      wapiptr->set_wallet_journal( options.count("wallet-journal") > 0 );
       wapiptr->load_wallet_file();
        
        if (bool_override)
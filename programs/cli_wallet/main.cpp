@@ -95,6 +95,8 @@ int main( int argc, char** argv )
          ("rpc-http-endpoint,H", bpo::value<string>()->implicit_value("127.0.0.1:8093"), "Endpoint for wallet HTTP RPC to listen on")
          ("daemon,d", "Run the wallet in daemon mode" )
          ("wallet-file,w", bpo::value<string>()->implicit_value("wallet.json"), "wallet to load")
+         ("wallet-journal", "Append the changes of the wallet to a journal instead of rewriting the wallet file")
+         ("archive-version", bpo::value<uint32_t>()->default_value(1), "Version of the archive of the created content packages, version 2 is read only by upgraded nodes")
          ("chain-id", bpo::value<string>(), "chain ID to connect to");
 
       bpo::variables_map options;
@@ -215,6 +217,8 @@ int main( int argc, char** argv )
 
       auto wapiptr = std::make_shared<wallet_api>( wdata, remote_api );
       wapiptr->set_wallet_filename( wallet_file.generic_string() );
+      wapiptr->set_wallet_journal( options.count("wallet-journal") > 0 );
+      decent::package::PackageManager::instance().set_archive_version( options.at("archive-version").as<uint32_t>() );
       wapiptr->load_wallet_file();
 
       fc::api<wallet_api> wapi(wapiptr);
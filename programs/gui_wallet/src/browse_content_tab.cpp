@@ -9,6 +9,9 @@
 
 #include <boost/algorithm/string/replace.hpp>
 
+#include <algorithm>
+#include <set>
+
 #ifndef _MSC_VER
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -17,6 +20,7 @@
 #include <QSignalMapper>
 #include "json.hpp"
 
+#include <graphene/app/database_api.hpp>
 #include <graphene/chain/config.hpp>
 #include <graphene/chain/content_object.hpp>
 #include <graphene/wallet/wallet.hpp>
@@ -29,11 +33,41 @@
 
 namespace gui_wallet
 {
+namespace
+{
+   std::string content_type_filter()
+   {
+      graphene::chain::ContentObjectTypeValue type(graphene::chain::EContentObjectApplication::DecentCore);
+      string str_type;
+      type.to_string(str_type);
+      return str_type;
+   }
+
+   void set_digital_content(SDigitalContent& cont, graphene::chain::content_summary const& summary)
+   {
+      cont.type = DCT::GENERAL;
+      cont.id = summary.id;
+      cont.author = summary.author;
+      cont.synopsis = summary.synopsis;
+      cont.URI = summary.URI;
+      cont.created = summary.created.to_iso_string();
+      cont.created = cont.created.substr(0, cont.created.find("T"));
+      cont.expiration = summary.expiration.to_iso_string();
+      cont.size = summary.size;
+      cont.times_bought = summary.times_bought;
+      cont.price = Globals::instance().asset(summary.price.amount.value,
+                                             std::string(graphene::chain::object_id_type(summary.price.asset_id)));
+      cont.AVG_rating = double(summary.AVG_rating) / 1000;
+   }
+}
+
 BrowseContentTab::BrowseContentTab(QWidget* pParent,
                                    DecentLineEdit* pFilterLineEdit)
 : TabContentManager(pParent)
 , m_pTableWidget(new DecentTable(this))
 , m_pDetailsSignalMapper(nullptr)
+, m_iCatalogueSequence(0)
+, m_pCatalogueInbox(std::make_shared<CatalogueInbox>())
 {
    m_pTableWidget->set_columns({
       {tr("Title"), 20},
@@ -63,6 +97,26 @@ BrowseContentTab::BrowseContentTab(QWidget* pParent,
 
    QObject::connect(m_pTableWidget, &DecentTable::signal_SortingChanged,
                     this, &BrowseContentTab::slot_SortingChanged);
+
+   QObject::connect(this, &BrowseContentTab::signal_catalogueChanged,
+                    this, &BrowseContentTab::slot_CatalogueChanged, Qt::QueuedConnection);
+}
+
+BrowseContentTab::~BrowseContentTab()
+{
+   // a callback already queued on the wallet thread may still run after the cancel
+   {
+      std::lock_guard<std::mutex> lock(m_pCatalogueInbox->mutex);
+      m_pCatalogueInbox->bAlive = false;
+   }
+
+   if (m_strCatalogueFilter.empty())
+      return;
+
+   try {
+      Globals::instance().getWallet().CancelContentCatalogueCallback();
+   } catch (...) {
+   }
 }
 
 void BrowseContentTab::timeToUpdate(const std::string& result)
@@ -87,6 +141,7 @@ void BrowseContentTab::timeToUpdate(const std::string& result)
       auto const& json_item = contents[iIndex];
       
       cont.type = DCT::GENERAL;
+      cont.id = json_item["id"].get<std::string>();
       cont.author = json_item["author"].get<std::string>();
 
       cont.synopsis = json_item["synopsis"].get<std::string>();
@@ -115,14 +170,13 @@ void BrowseContentTab::timeToUpdate(const std::string& result)
       set_next_page_iterator(string());
    
    ShowDigitalContentsGUI();
+
+   subscribeCatalogue();
 }
 
 std::string BrowseContentTab::getUpdateCommand()
 {
-   graphene::chain::ContentObjectPropertyManager type_composer;
-   graphene::chain::ContentObjectTypeValue type(graphene::chain::EContentObjectApplication::DecentCore);
-   string str_type;
-   type.to_string(str_type);
+   string str_type = content_type_filter();
 
    return   string("search_content ") +
             "\"" + m_strSearchTerm.toStdString() + "\" " +
@@ -134,6 +188,101 @@ std::string BrowseContentTab::getUpdateCommand()
             std::to_string(m_i_page_size + 1);
 }
 
+bool BrowseContentTab::hasPushedUpdates() const
+{
+   return false == m_strCatalogueFilter.empty();
+}
+
+void BrowseContentTab::subscribeCatalogue()
+{
+   std::string str_term = m_strSearchTerm.toStdString();
+   std::string str_order = m_pTableWidget->getSortedColumn();
+   std::string str_filter = str_term + "\n" + str_order;
+   if (str_filter == m_strCatalogueFilter)
+      return;
+
+   {
+      std::lock_guard<std::mutex> lock(m_pCatalogueInbox->mutex);
+      m_pCatalogueInbox->deltas.clear();
+   }
+   m_iCatalogueSequence = 0;
+
+   try {
+      std::shared_ptr<CatalogueInbox> pInbox = m_pCatalogueInbox;
+      Globals::instance().getWallet().SetContentCatalogueCallback(
+         [pInbox, this](graphene::app::content_catalogue_delta const& delta)
+         {
+            // the destructor waits for the lock, so the tab outlives the emit
+            std::lock_guard<std::mutex> lock(pInbox->mutex);
+            if (false == pInbox->bAlive)
+               return;
+            pInbox->deltas.push_back(std::make_shared<graphene::app::content_catalogue_delta>(delta));
+            emit signal_catalogueChanged();
+         },
+         str_term, str_order, "", "", content_type_filter());
+      m_strCatalogueFilter = str_filter;
+   } catch (...) {
+      // a node without the subscription is polled
+      m_strCatalogueFilter.clear();
+   }
+}
+
+void BrowseContentTab::slot_CatalogueChanged()
+{
+   std::vector<std::shared_ptr<graphene::app::content_catalogue_delta>> deltas;
+   {
+      std::lock_guard<std::mutex> lock(m_pCatalogueInbox->mutex);
+      deltas.swap(m_pCatalogueInbox->deltas);
+   }
+
+   bool bRequery = false;
+   bool bRedraw = false;
+   for (auto const& pDelta : deltas)
+   {
+      // after a missed delta the page is searched again
+      if (pDelta->sequence != m_iCatalogueSequence + 1)
+         bRequery = true;
+      m_iCatalogueSequence = pDelta->sequence;
+
+      // where the added contents belong depends on the other pages, the server knows it
+      if (false == pDelta->added.empty())
+         bRequery = true;
+
+      for (auto const& summary : pDelta->changed)
+      {
+         for (SDigitalContent& item : _digital_contents)
+         {
+            if (item.id == summary.id)
+            {
+               set_digital_content(item, summary);
+               bRedraw = true;
+            }
+         }
+      }
+
+      std::set<std::string> gone;
+      for (auto const* pIds : {&pDelta->expired, &pDelta->blocked, &pDelta->removed})
+         for (auto const& id : *pIds)
+            gone.insert(std::string(graphene::chain::object_id_type(id)));
+
+      auto itGone = std::remove_if(_digital_contents.begin(), _digital_contents.end(),
+                                   [&gone](SDigitalContent const& item) { return gone.count(item.id) > 0; });
+      if (itGone != _digital_contents.end())
+      {
+         _digital_contents.erase(itGone, _digital_contents.end());
+         bRedraw = true;
+         // the contents of the next page move to this one
+         if (false == is_last())
+            bRequery = true;
+      }
+   }
+
+   if (bRequery)
+      tryToUpdate();
+   else if (bRedraw)
+      ShowDigitalContentsGUI();
+}
+
 void BrowseContentTab::slot_Details(int iIndex)
 {
     if (iIndex < 0 || iIndex >= _digital_contents.size()) {
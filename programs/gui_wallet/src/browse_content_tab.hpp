@@ -3,12 +3,16 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <mutex>
 #include <QString>
 
 #include "gui_wallet_tabcontentmanager.hpp"
 
 class QSignalMapper;
 
+namespace graphene { namespace app { struct content_catalogue_delta; } }
+
 namespace gui_wallet
 {
    class DecentTable;
@@ -21,12 +25,17 @@ namespace gui_wallet
    public:
       BrowseContentTab(QWidget* pParent,
                        DecentLineEdit* pFilterLineEdit);
+      ~BrowseContentTab();
       
       void ShowDigitalContentsGUI();
       
    public:
       virtual void timeToUpdate(const std::string& result) override;
       virtual std::string getUpdateCommand() override;
+      virtual bool hasPushedUpdates() const override;
+
+   signals:
+      void signal_catalogueChanged();
        
    public slots:
 
@@ -34,13 +43,29 @@ namespace gui_wallet
       void slot_Bought();
       void slot_SearchTermChanged(QString const& strSearchTerm);
       void slot_SortingChanged(int);
+      void slot_CatalogueChanged();
       
    protected:
+      void subscribeCatalogue();
+
       DecentTable*   m_pTableWidget;
       QSignalMapper* m_pDetailsSignalMapper;
       QString        m_strSearchTerm;
       
       std::vector<SDigitalContent>  _digital_contents;
+
+      // search term and order of the catalogue subscription, empty if there is none
+      std::string    m_strCatalogueFilter;
+      uint64_t       m_iCatalogueSequence;
+
+      // the deltas arrive on the wallet thread, the callback owns the inbox and signals the tab only while it is alive
+      struct CatalogueInbox
+      {
+         std::mutex mutex;
+         bool       bAlive = true;
+         std::vector<std::shared_ptr<graphene::app::content_catalogue_delta>> deltas;
+      };
+      std::shared_ptr<CatalogueInbox> m_pCatalogueInbox;
    };
    
    
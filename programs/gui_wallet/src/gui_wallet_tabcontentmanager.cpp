@@ -14,6 +14,11 @@ TabContentManager::TabContentManager(QWidget* pParent/* = nullptr*/)
 {
 }
 
+bool TabContentManager::hasPushedUpdates() const
+{
+   return false;
+}
+
 void TabContentManager::tryToUpdate() {
    try {
       std::string command = getUpdateCommand();
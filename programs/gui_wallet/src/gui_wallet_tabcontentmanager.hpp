@@ -14,6 +14,8 @@ public:
 
    virtual void timeToUpdate(const std::string& result) = 0;
    virtual std::string getUpdateCommand() = 0;
+   // true if the server pushes the changes of the content, so it does not need to be polled
+   virtual bool hasPushedUpdates() const;
    
 public:
    void tryToUpdate();
@@ -378,7 +378,7 @@ MainWindow::MainWindow()
 
    m_pTimerContents->setInterval(1000);
    QObject::connect(m_pTimerContents, &QTimer::timeout,
-                    this, &MainWindow::slot_getContents);
+                    this, &MainWindow::slot_timerContents);
 
    m_pTimerUpdateProxy->setInterval(200);
    QObject::connect(m_pTimerUpdateProxy, &QTimer::timeout,
@@ -813,21 +813,42 @@ void MainWindow::slot_getContents()
 
       pTab->tryToUpdate();
 
-      if (pTab->is_first())
-      {
-         m_pPreviousPage->setDisabled(true);
-         m_pResetPage->setDisabled(true);
-      }
-      else
-      {
-         m_pPreviousPage->setEnabled(true);
-         m_pResetPage->setEnabled(true);
-      }
-      if (pTab->is_last())
-         m_pNextPage->setDisabled(true);
-      else
-         m_pNextPage->setEnabled(true);
+      updatePageButtons(pTab);
+   }
+}
+
+void MainWindow::slot_timerContents()
+{
+   TabContentManager* pTab = activeTable();
+
+   // the server pushes the changes of such a tab, it is searched again only when the page size follows the window
+   if (pTab &&
+       pTab->hasPushedUpdates() &&
+       pTab->m_i_page_size == size_t(pTab->size().height() / 35))
+   {
+      updatePageButtons(pTab);
+      return;
    }
+
+   slot_getContents();
+}
+
+void MainWindow::updatePageButtons(TabContentManager* pTab)
+{
+   if (pTab->is_first())
+   {
+      m_pPreviousPage->setDisabled(true);
+      m_pResetPage->setDisabled(true);
+   }
+   else
+   {
+      m_pPreviousPage->setEnabled(true);
+      m_pResetPage->setEnabled(true);
+   }
+   if (pTab->is_last())
+      m_pNextPage->setDisabled(true);
+   else
+      m_pNextPage->setEnabled(true);
 }
 
 void MainWindow::slot_PreviousPage()
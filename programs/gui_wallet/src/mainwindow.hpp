@@ -42,6 +42,7 @@ protected slots:
    void slot_importKey();
    void slot_checkDownloads();
    void slot_getContents();
+   void slot_timerContents();
    void slot_PreviousPage();
    void slot_ResetPage();
    void slot_NextPage();
@@ -60,6 +61,7 @@ protected:
    void closeSplash(bool bGonnaCoverAgain);
    virtual void closeEvent(QCloseEvent* event) override;
    TabContentManager* activeTable() const;
+   void updatePageButtons(TabContentManager* pTab);
 
 protected:
    size_t m_iSplashWidgetIndex;
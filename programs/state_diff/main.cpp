@@ -0,0 +1,116 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+#include <fc/network/http/websocket.hpp>
+#include <fc/rpc/websocket_api.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <graphene/app/api.hpp>
+#include <graphene/debug_miner/debug_api.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <map>
+
+using namespace graphene::app;
+using graphene::debug_miner_plugin::block_state_digest;
+
+using namespace std;
+namespace bpo = boost::program_options;
+
+/**
+ * Reads the state digest of a block from a node's debug API, or from a JSON file saved from the output of
+ * debug_get_state_digest.
+ */
+block_state_digest load_digest( const string& source, const string& user, const string& password, uint32_t block_num )
+{
+   if( !boost::starts_with( source, "ws://" ) && !boost::starts_with( source, "wss://" ) )
+      return fc::json::from_file( fc::path( source ) ).as<block_state_digest>();
+
+   fc::http::websocket_client client;
+   auto con  = client.connect( source );
+   auto apic = std::make_shared<fc::rpc::websocket_api_connection>(*con);
+   auto remote_api = apic->get_remote_api< login_api >(1);
+   FC_ASSERT( remote_api->login( user, password ), "Login to ${s} failed", ("s", source) );
+   return remote_api->debug()->debug_get_state_digest( block_num );
+}
+
+typedef std::pair< uint8_t, uint8_t > index_key;
+
+index_key index_of( const graphene::db::index_state_hash& item )
+{
+   return index_key( item.space_id, item.type_id );
+}
+
+int main( int argc, char** argv )
+{
+   try {
+      bpo::options_description opts;
+      opts.add_options()
+         ("help,h", "Print this help message and exit.")
+         ("first", bpo::value<string>(), "Websocket RPC endpoint of the first node, or a JSON file with its state digest")
+         ("second", bpo::value<string>(), "Websocket RPC endpoint of the second node, or a JSON file with its state digest")
+         ("block,b", bpo::value<uint32_t>()->default_value(0), "Number of the block to compare, 0 for the head block")
+         ("server-rpc-user,u", bpo::value<string>()->default_value(""), "Username for the nodes")
+         ("server-rpc-password,p", bpo::value<string>()->default_value(""), "Password for the nodes")
+         ;
+
+      bpo::positional_options_description positional;
+      positional.add( "first", 1 );
+      positional.add( "second", 1 );
+
+      bpo::variables_map options;
+      bpo::store( bpo::command_line_parser( argc, argv ).options( opts ).positional( positional ).run(), options );
+
+      if( options.count("help") || !options.count("first") || !options.count("second") )
+      {
+         std::cerr << "Compares the state digests of two nodes index by index. The nodes need the debug_miner plugin\n"
+                      "and access to debug_api.\n\n"
+                      "Usage: state_diff [options] <first> <second>\n" << opts << "\n";
+         return options.count("help") ? 0 : 127;
+      }
+
+      const string user = options["server-rpc-user"].as<string>();
+      const string password = options["server-rpc-password"].as<string>();
+      const uint32_t block_num = options["block"].as<uint32_t>();
+
+      const block_state_digest first = load_digest( options["first"].as<string>(), user, password, block_num );
+      const block_state_digest second = load_digest( options["second"].as<string>(), user, password, block_num );
+
+      if( first.block_num != second.block_num )
+         std::cout << "warning: comparing block " << first.block_num << " with block " << second.block_num << "\n";
+      else if( first.block_id != second.block_id )
+         std::cout << "warning: the nodes are on different forks at block " << first.block_num << "\n";
+
+      if( first.state.digest == second.state.digest )
+      {
+         std::cout << "block " << first.block_num << ": states match, digest " << first.state.digest.str() << "\n";
+         return 0;
+      }
+
+      std::map< index_key, std::pair< string, string > > indices;
+      for( const auto& item : first.state.indices )
+         indices[ index_of( item ) ].first = string( item.hash );
+      for( const auto& item : second.state.indices )
+         indices[ index_of( item ) ].second = string( item.hash );
+
+      std::cout << "block " << first.block_num << ": states differ\n";
+      for( const auto& item : indices )
+      {
+         if( item.second.first == item.second.second )
+            continue;
+         std::cout << "  index " << int( item.first.first ) << "." << int( item.first.second ) << ": "
+                   << ( item.second.first.empty() ? string( "missing" ) : item.second.first ) << " != "
+                   << ( item.second.second.empty() ? string( "missing" ) : item.second.second ) << "\n";
+      }
+      return 1;
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   return 2;
+}
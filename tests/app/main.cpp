@@ -31,8 +31,12 @@
 #include <graphene/utilities/tempdir.hpp>
 
 #include <graphene/account_history/account_history_plugin.hpp>
+#include <graphene/delayed_node/delayed_node_plugin.hpp>
+
+#include <graphene/chain/protocol/fee_schedule.hpp>
 
 #include <fc/thread/thread.hpp>
+#include <fc/io/json.hpp>
 #include <fc/smart_ref_impl.hpp>
 
 #include <boost/filesystem/path.hpp>
@@ -142,3 +146,84 @@ BOOST_AUTO_TEST_CASE( two_node_network )
       throw;
    }
 }
+
+BOOST_AUTO_TEST_CASE( delayed_node_batch_sync )
+{
+   using namespace graphene::chain;
+   using namespace graphene::app;
+   try {
+      BOOST_TEST_MESSAGE( "Creating temporary files" );
+
+      fc::temp_directory trusted_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_directory delayed_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_file genesis_json;
+
+      fc::ecc::private_key init_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("nathan")));
+      genesis_state_type genesis_state;
+      genesis_state.initial_parameters.current_fees = fee_schedule::get_default();
+      genesis_state.initial_active_miners = GRAPHENE_DEFAULT_MIN_MINER_COUNT;
+      genesis_state.initial_timestamp = fc::time_point_sec( (fc::time_point::now().sec_since_epoch() - 86400) /
+                                                            genesis_state.initial_parameters.block_interval *
+                                                            genesis_state.initial_parameters.block_interval );
+      for( uint64_t i = 0; i < genesis_state.initial_active_miners; ++i )
+      {
+         auto name = "init"+fc::to_string(i);
+         genesis_state.initial_accounts.emplace_back(name, init_key.get_public_key(), init_key.get_public_key());
+         genesis_state.initial_miner_candidates.push_back({name, init_key.get_public_key()});
+      }
+      genesis_state.initial_chain_id = fc::sha256::hash( "delayed_node_batch_sync" );
+      fc::json::save_to_file( genesis_state, genesis_json.path() );
+
+      BOOST_TEST_MESSAGE( "Creating and initializing the trusted node" );
+
+      graphene::app::application trusted_app;
+      boost::program_options::variables_map cfg;
+      cfg.emplace("genesis-json", boost::program_options::variable_value(boost::filesystem::path(genesis_json.path().generic_string()), false));
+      cfg.emplace("p2p-endpoint", boost::program_options::variable_value(string("127.0.0.1:3941"), false));
+      cfg.emplace("rpc-endpoint", boost::program_options::variable_value(string("127.0.0.1:8095"), false));
+      trusted_app.initialize(trusted_dir.path(), cfg);
+      trusted_app.startup();
+
+      BOOST_TEST_MESSAGE( "Generating blocks on the trusted node" );
+
+      std::shared_ptr<chain::database> trusted_db = trusted_app.chain_database();
+      for( uint32_t i = 0; i < 200; ++i )
+         trusted_db->generate_block( trusted_db->get_slot_time(1),
+                                     trusted_db->get_scheduled_miner(1),
+                                     init_key,
+                                     database::skip_nothing );
+      uint32_t last_irreversible_block_num = trusted_db->get_dynamic_global_properties().last_irreversible_block_num;
+      BOOST_REQUIRE_GT( last_irreversible_block_num, 100u );
+
+      BOOST_TEST_MESSAGE( "Creating and initializing the delayed node" );
+
+      graphene::app::application delayed_app;
+      delayed_app.register_plugin<graphene::delayed_node::delayed_node_plugin>();
+      boost::program_options::variables_map cfg2;
+      cfg2.emplace("genesis-json", boost::program_options::variable_value(boost::filesystem::path(genesis_json.path().generic_string()), false));
+      cfg2.emplace("p2p-endpoint", boost::program_options::variable_value(string("127.0.0.1:4041"), false));
+      cfg2.emplace("trusted-node", boost::program_options::variable_value(string("127.0.0.1:8095"), false));
+      cfg2.emplace("trusted-node-batch-size", boost::program_options::variable_value(uint32_t(7), false));
+      cfg2.emplace("trusted-node-batches-in-flight", boost::program_options::variable_value(uint32_t(3), false));
+      delayed_app.initialize(delayed_dir.path(), cfg2);
+      delayed_app.initialize_plugins(cfg2);
+      delayed_app.startup();
+      delayed_app.startup_plugins();
+
+      // the delayed node only wakes up when the trusted node reports a newly applied block
+      trusted_db->generate_block( trusted_db->get_slot_time(1),
+                                  trusted_db->get_scheduled_miner(1),
+                                  init_key,
+                                  database::skip_nothing );
+
+      std::shared_ptr<chain::database> delayed_db = delayed_app.chain_database();
+      for( int i = 0; i < 100 && delayed_db->head_block_num() < last_irreversible_block_num; ++i )
+         fc::usleep(fc::milliseconds(100));
+
+      BOOST_CHECK_GE( delayed_db->head_block_num(), last_irreversible_block_num );
+      BOOST_CHECK( delayed_db->head_block_id() == trusted_db->get_block_id_for_num( delayed_db->head_block_num() ) );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -0,0 +1,100 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <graphene/app/api.hpp>
+#include <graphene/app/application.hpp>
+#include <graphene/utilities/key_conversion.hpp>
+#include <graphene/utilities/tempdir.hpp>
+#include <graphene/wallet/wallet.hpp>
+#include <graphene/wallet/wallet_journal.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+using namespace graphene;
+
+BOOST_AUTO_TEST_CASE( wallet_journal_replay_and_compaction )
+{
+   using namespace graphene::app;
+   using namespace graphene::wallet;
+   try {
+      fc::temp_directory app_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_directory wallet_dir( graphene::utilities::temp_directory_path() );
+
+      graphene::app::application app;
+      boost::program_options::variables_map cfg;
+      cfg.emplace("p2p-endpoint", boost::program_options::variable_value(string("127.0.0.1:3941"), false));
+      app.initialize(app_dir.path(), cfg);
+      app.startup();
+
+      auto login = std::make_shared<login_api>( std::ref( app ) );
+      BOOST_REQUIRE( login->login( "", "" ) );
+      fc::api<login_api> rapi( login );
+
+      wallet_data initial_data;
+      initial_data.chain_id = app.chain_database()->get_chain_id();
+
+      const string wallet_filename = ( wallet_dir.path() / "wallet.json" ).string();
+      const fc::path journal_path = wallet_journal::path_for( wallet_filename );
+      const fc::ecc::private_key nathan_key = fc::ecc::private_key::regenerate( fc::sha256::hash( string( "nathan" ) ) );
+      const public_key_type nathan_public_key = nathan_key.get_public_key();
+
+      auto open_wallet = [&]() -> std::unique_ptr<wallet_api> {
+         std::unique_ptr<wallet_api> wallet( new wallet_api( initial_data, rapi ) );
+         wallet->set_wallet_filename( wallet_filename );
+         wallet->set_wallet_journal( true );
+         wallet->load_wallet_file( wallet_filename );
+         return wallet;
+      };
+
+      // the key is imported into the journal only, the wallet file is left as it was before
+      {
+         std::unique_ptr<wallet_api> wallet = open_wallet();
+         wallet->set_password( "password" );
+         wallet->unlock( "password" );
+         wallet->save_wallet_file();
+         const uint64_t wallet_file_size = fc::file_size( wallet_filename );
+
+         BOOST_REQUIRE( wallet->import_key( "nathan", graphene::utilities::key_to_wif( nathan_key ) ) );
+         BOOST_CHECK_EQUAL( fc::file_size( wallet_filename ), wallet_file_size );
+         BOOST_CHECK_GT( fc::file_size( journal_path ), 0u );
+      }
+
+      // the journal is replayed when the wallet is loaded, its keys are merged once the password is known
+      {
+         std::unique_ptr<wallet_api> wallet = open_wallet();
+         BOOST_REQUIRE( wallet->is_locked() );
+         const vector<account_object> accounts = wallet->list_my_accounts();
+         BOOST_REQUIRE_EQUAL( accounts.size(), 1u );
+         BOOST_CHECK_EQUAL( accounts[0].name, "nathan" );
+
+         // saved while locked, the keys of the journal can not be written to the wallet file, so the journal is kept
+         wallet->save_wallet_file();
+         BOOST_CHECK_GT( fc::file_size( journal_path ), 0u );
+
+         wallet->unlock( "password" );
+         BOOST_CHECK( wallet->dump_private_keys().count( nathan_public_key ) == 1 );
+      }
+
+      // once the wallet is saved unlocked, the journal is compacted into the wallet file
+      {
+         std::unique_ptr<wallet_api> wallet = open_wallet();
+         wallet->unlock( "password" );
+         BOOST_CHECK( wallet->dump_private_keys().count( nathan_public_key ) == 1 );
+         wallet->save_wallet_file();
+         BOOST_CHECK( !fc::exists( journal_path ) || fc::file_size( journal_path ) == 0 );
+      }
+
+      {
+         std::unique_ptr<wallet_api> wallet = open_wallet();
+         BOOST_CHECK_EQUAL( wallet->list_my_accounts().size(), 1u );
+         wallet->unlock( "password" );
+         BOOST_CHECK( wallet->dump_private_keys().count( nathan_public_key ) == 1 );
+      }
+   } catch( fc::exception& e ) {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
@@ -0,0 +1,459 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/buying_object.hpp>
+#include <graphene/chain/content_object.hpp>
+#include <graphene/chain/protocol/decent.hpp>
+#include <graphene/chain/protocol/subscription.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <decent/encrypt/encryptionutils.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+/// peak resident set size of the process in kB, 0 where it is not available
+uint64_t max_rss_kb()
+{
+#if defined(__linux__)
+   struct rusage usage;
+   getrusage( RUSAGE_SELF, &usage );
+   return usage.ru_maxrss;
+#elif defined(__APPLE__)
+   struct rusage usage;
+   getrusage( RUSAGE_SELF, &usage );
+   return usage.ru_maxrss / 1024;
+#else
+   return 0;
+#endif
+}
+
+uint64_t index_bytes( const database& db )
+{
+   uint64_t total = 0;
+   for( const auto& stats : db.get_memory_stats() )
+      total += stats.total_bytes();
+   return total;
+}
+
+/**
+ * Collects one JSON object per measured phase.  Every result is printed on its own line to stdout
+ * and, with --bench-output=<file>, appended to that file so runs of different commits can be diffed.
+ */
+class bench_report
+{
+   public:
+      bench_report()
+      {
+         int argc = boost::unit_test::framework::master_test_suite().argc;
+         char** argv = boost::unit_test::framework::master_test_suite().argv;
+         const std::string prefix = "--bench-output=";
+         for( int i = 1; i < argc; i++ )
+         {
+            const std::string arg = argv[i];
+            if( arg.compare( 0, prefix.size(), prefix ) == 0 )
+               _output_file = arg.substr( prefix.size() );
+         }
+      }
+
+      void add( const database& db, const string& phase, uint64_t transactions, uint32_t blocks, const fc::microseconds& elapsed,
+                const fc::variant_object& extra = fc::variant_object() )
+      {
+         fc::mutable_variant_object result;
+         result( "benchmark", "chain_bench" )
+#ifdef NDEBUG
+               ( "build", "release" )
+#else
+               ( "build", "debug" )
+#endif
+               ( "phase", phase )
+               ( "transactions", transactions )
+               ( "blocks", blocks )
+               ( "elapsed_us", elapsed.count() )
+               ( "tx_per_sec", elapsed.count() > 0 ? double( transactions ) * 1000000.0 / elapsed.count() : 0.0 )
+               ( "blocks_per_sec", elapsed.count() > 0 ? double( blocks ) * 1000000.0 / elapsed.count() : 0.0 )
+               ( "max_rss_kb", max_rss_kb() )
+               ( "index_bytes", index_bytes( db ) );
+         result( extra );
+
+         const string line = fc::json::to_string( result );
+         std::cout << line << std::endl;
+         if( !_output_file.empty() )
+         {
+            std::ofstream out( _output_file, std::ios::app );
+            out << line << std::endl;
+         }
+      }
+
+   private:
+      string _output_file;
+};
+
+/**
+ * Generates the operation mix of a busy DECENT chain.  Every round submits new content, buys the content submitted
+ * in the previous round, delivers keys and proves custody of earlier purchases and submissions, rates delivered
+ * content and adds subscriptions and plain transfers on top.  Keys and names are derived from fixed seeds so
+ * every run replays the same workload.
+ */
+class decent_workload
+{
+   public:
+      struct participant
+      {
+         account_id_type            id;
+         fc::ecc::private_key       key;
+         decent::encrypt::DInteger  el_gamal_private;
+         decent::encrypt::DInteger  el_gamal_public;
+      };
+
+      decent_workload( database_fixture& f, uint32_t author_count, uint32_t consumer_count, uint32_t seeder_count )
+         : _f( f ), _db( f.db )
+      {
+         for( uint32_t i = 0; i < seeder_count; ++i )
+            _seeders.push_back( create_participant( "bench-seeder-" + fc::to_string( i ), asset() ) );
+         for( uint32_t i = 0; i < author_count; ++i )
+            _authors.push_back( create_participant( "bench-author-" + fc::to_string( i ), asset( 100000000 ) ) );
+         for( uint32_t i = 0; i < consumer_count; ++i )
+            _consumers.push_back( create_participant( "bench-consumer-" + fc::to_string( i ), asset( 100000000 ) ) );
+
+         vector<signed_transaction> setup;
+         for( const auto& s : _seeders )
+         {
+            ready_to_publish_operation op;
+            op.seeder = s.id;
+            op.pubKey = decent::encrypt::DIntegerString( s.el_gamal_public );
+            op.space = 1000000;
+            op.price_per_MByte = 1;
+            op.ipfs_ID = "chain-bench";
+            setup.push_back( make_transaction( op, s ) );
+         }
+         for( const auto& a : _authors )
+         {
+            account_update_operation op;
+            op.account = a.id;
+            op.new_options = a.id( _db ).options;
+            op.new_options->allow_subscription = true;
+            op.new_options->price_per_subscribe = asset( 10 );
+            op.new_options->subscription_period = 1;
+            setup.push_back( make_transaction( op, a ) );
+         }
+         for( const auto& tx : setup )
+            _db.push_transaction( tx );
+         _f.generate_block();
+         _operation_counts.clear();
+      }
+
+      /// transactions of the next round, signed against the current head block
+      vector<signed_transaction> next_round()
+      {
+         vector<signed_transaction> result;
+         vector<string> submitted;
+         vector<purchase> requested;
+
+         for( const string& uri : _submitted )
+         {
+            const content_object& content = get_content( uri );
+            for( const auto& key_part : content.key_parts )
+            {
+               proof_of_custody_operation op;
+               op.seeder = key_part.first;
+               op.URI = uri;
+               result.push_back( make_transaction( op, seeder( key_part.first ) ) );
+            }
+         }
+
+         const auto& buyings = _db.get_index_type<buying_index>().indices().get<by_content_consumer>();
+         for( const purchase& p : _requested )
+         {
+            const content_object& content = get_content( p.URI );
+            auto bitr = buyings.find( std::make_tuple( content.get_id(), _consumers[p.consumer].id ) );
+            if( bitr == buyings.end() )
+               continue;
+            for( const auto& key_part : content.key_parts )
+            {
+               const participant& s = seeder( key_part.first );
+               decent::encrypt::Ciphertext orig = content.key_parts.at( s.id );
+               decent::encrypt::point message;
+               FC_ASSERT( decent::encrypt::el_gamal_decrypt( orig, s.el_gamal_private, message ) == decent::encrypt::ok );
+               decent::encrypt::Ciphertext key;
+               decent::encrypt::DeliveryProof proof;
+               FC_ASSERT( decent::encrypt::encrypt_with_proof( message, s.el_gamal_private, _consumers[p.consumer].el_gamal_public,
+                                                               orig, key, proof ) == decent::encrypt::ok );
+               deliver_keys_operation op;
+               op.seeder = s.id;
+               op.buying = bitr->id;
+               op.key = key;
+               op.proof = proof;
+               result.push_back( make_transaction( op, s ) );
+            }
+         }
+
+         for( const purchase& p : _delivered )
+         {
+            auto bitr = buyings.find( std::make_tuple( get_content( p.URI ).get_id(), _consumers[p.consumer].id ) );
+            if( bitr == buyings.end() || !bitr->delivered || bitr->rated_or_commented )
+               continue;
+            leave_rating_and_comment_operation op;
+            op.URI = p.URI;
+            op.consumer = _consumers[p.consumer].id;
+            op.rating = 1 + p.consumer % 5;
+            op.comment = "chain_bench";
+            result.push_back( make_transaction( op, _consumers[p.consumer] ) );
+         }
+
+         for( const auto& a : _authors )
+         {
+            content_submit_operation op = make_submission( a );
+            submitted.push_back( op.URI );
+            result.push_back( make_transaction( op, a ) );
+         }
+
+         for( uint32_t c = 0; c < _consumers.size(); ++c )
+         {
+            const participant& consumer = _consumers[c];
+            const participant& author = _authors[( c + _round ) % _authors.size()];
+            if( !_submitted.empty() )
+            {
+               request_to_buy_operation op;
+               op.URI = _submitted[( c + _round ) % _submitted.size()];
+               op.consumer = consumer.id;
+               op.price = asset( 100 );
+               op.pubKey = decent::encrypt::DIntegerString( consumer.el_gamal_public );
+               requested.push_back( purchase{ op.URI, c } );
+               result.push_back( make_transaction( op, consumer ) );
+            }
+            if( ( c + _round ) % 4 == 0 )
+            {
+               subscribe_operation op;
+               op.from = consumer.id;
+               op.to = author.id;
+               op.price = asset( 10 );
+               result.push_back( make_transaction( op, consumer ) );
+            }
+            transfer_operation op;
+            op.from = consumer.id;
+            op.to = author.id;
+            op.amount = asset( 1 );
+            result.push_back( make_transaction( op, consumer ) );
+         }
+
+         _delivered = std::move( _requested );
+         _requested = std::move( requested );
+         _submitted = std::move( submitted );
+         ++_round;
+         return result;
+      }
+
+      /// number of operations of each kind handed out so far
+      const map<string, uint64_t>& operation_counts()const { return _operation_counts; }
+
+   private:
+      struct purchase
+      {
+         string   URI;
+         uint32_t consumer;
+      };
+
+      participant create_participant( const string& name, const asset& funds )
+      {
+         participant p;
+         p.key = database_fixture::generate_private_key( name );
+         p.id = _f.create_account( name, p.key.get_public_key() ).id;
+         p.el_gamal_private = decent::encrypt::generate_private_el_gamal_key_from_secret( p.key.get_secret() );
+         p.el_gamal_public = decent::encrypt::get_public_el_gamal_key( p.el_gamal_private );
+         if( funds.amount > 0 )
+            _f.fund( p.id( _db ), funds );
+         return p;
+      }
+
+      const participant& seeder( account_id_type id )const
+      {
+         auto itr = std::find_if( _seeders.begin(), _seeders.end(), [&]( const participant& s ) { return s.id == id; } );
+         FC_ASSERT( itr != _seeders.end() );
+         return *itr;
+      }
+
+      const content_object& get_content( const string& uri )const
+      {
+         const auto& idx = _db.get_index_type<content_index>().indices().get<by_URI>();
+         auto itr = idx.find( uri );
+         FC_ASSERT( itr != idx.end(), "content ${u} was not submitted", ("u", uri) );
+         return *itr;
+      }
+
+      content_submit_operation make_submission( const participant& author )
+      {
+         const uint32_t n = _content_count++;
+         content_submit_operation op;
+         op.author = author.id;
+         op.URI = "ipfs:chain-bench-" + fc::to_string( n );
+         op.price.push_back( regional_price{ RegionCodes::OO_none, asset( 100 ) } );
+         op.size = 1;
+         op.hash = fc::ripemd160::hash( op.URI );
+         op.quorum = 2;
+         op.expiration = _db.head_block_time() + fc::days( 30 );
+         op.publishing_fee = asset( 100 );
+
+         ContentObjectPropertyManager synopsis;
+         synopsis.set<ContentObjectTitle>( "chain_bench " + fc::to_string( n ) );
+         op.synopsis = synopsis.m_str_synopsis;
+
+         decent::encrypt::ShamirSecret ss( op.quorum, op.quorum,
+                                           decent::encrypt::generate_private_el_gamal_key_from_secret( fc::sha256::hash( op.URI ) ) );
+         ss.calculate_split();
+         for( uint32_t i = 0; i < op.quorum; ++i )
+         {
+            const participant& s = _seeders[( n + i ) % _seeders.size()];
+            decent::encrypt::Ciphertext cp;
+            decent::encrypt::el_gamal_encrypt( ss.split[i], s.el_gamal_public, cp );
+            op.seeders.push_back( s.id );
+            op.key_parts.push_back( cp );
+         }
+         return op;
+      }
+
+      signed_transaction make_transaction( const operation& op, const participant& signer )
+      {
+         ++_operation_counts[ op.visit( operation_name() ) ];
+         signed_transaction tx;
+         tx.operations.push_back( op );
+         set_expiration( _db, tx );
+         tx.validate();
+         tx.sign( signer.key, _db.get_chain_id() );
+         return tx;
+      }
+
+      struct operation_name
+      {
+         typedef string result_type;
+         template<typename Op>
+         string operator()( const Op& )const
+         {
+            string name = fc::get_typename<Op>::name();
+            auto pos = name.rfind( "::" );
+            return pos == string::npos ? name : name.substr( pos + 2 );
+         }
+      };
+
+      database_fixture&      _f;
+      database&              _db;
+      vector<participant>    _authors;
+      vector<participant>    _consumers;
+      vector<participant>    _seeders;
+      vector<string>         _submitted;
+      vector<purchase>       _requested;
+      vector<purchase>       _delivered;
+      uint32_t               _round = 0;
+      uint32_t               _content_count = 0;
+      map<string, uint64_t>  _operation_counts;
+};
+
+} // anonymous namespace
+
+/**
+ * Measures push_transaction, block production, block sync, reindex and a maintenance interval on a chain loaded
+ * with the decent_workload operation mix.  Results are reported through bench_report.
+ */
+BOOST_FIXTURE_TEST_CASE( decent_workload_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t authors = 20, consumers = 200, seeders = 10, rounds = 200;
+#else
+      const uint32_t authors = 4, consumers = 20, seeders = 4, rounds = 10;
+#endif
+      bench_report report;
+      decent_workload workload( *this, authors, consumers, seeders );
+      const uint32_t first_workload_block = db.head_block_num() + 1;
+
+      fc::microseconds push_elapsed, generate_elapsed;
+      uint64_t transactions = 0, peak_index_bytes = 0;
+      for( uint32_t r = 0; r < rounds; ++r )
+      {
+         vector<signed_transaction> txs = workload.next_round();
+
+         auto start = fc::time_point::now();
+         for( const auto& tx : txs )
+            db.push_transaction( tx );
+         push_elapsed += fc::time_point::now() - start;
+
+         start = fc::time_point::now();
+         signed_block b = generate_block();
+         generate_elapsed += fc::time_point::now() - start;
+
+         BOOST_REQUIRE_EQUAL( b.transactions.size(), txs.size() );
+         transactions += txs.size();
+         peak_index_bytes = std::max( peak_index_bytes, index_bytes( db ) );
+      }
+      report.add( db, "push_transaction", transactions, 0, push_elapsed,
+                  fc::mutable_variant_object( "operations", workload.operation_counts() ) );
+      report.add( db, "generate_block", transactions, rounds, generate_elapsed,
+                  fc::mutable_variant_object( "peak_index_bytes", peak_index_bytes ) );
+
+      // the block right at the maintenance time does the maintenance
+      const auto& params = db.get_global_properties().parameters;
+      generate_blocks( db.get_dynamic_global_properties().next_maintenance_time - params.block_interval );
+      const auto maintenance_time = db.get_dynamic_global_properties().next_maintenance_time;
+      auto start = fc::time_point::now();
+      generate_block();
+      report.add( db, "maintenance", 0, 1, fc::time_point::now() - start );
+      BOOST_CHECK( db.get_dynamic_global_properties().next_maintenance_time > maintenance_time );
+
+      fc::temp_directory sync_dir( graphene::utilities::temp_directory_path() );
+      uint64_t chain_transactions = 0;
+      {
+         database sync_db;
+         sync_db.open( sync_dir.path(), [this]{ return genesis_state; } );
+
+         // the accounts are set up by the fixture without signatures
+         while( sync_db.head_block_num() + 1 < first_workload_block )
+         {
+            optional<signed_block> b = db.fetch_block_by_number( sync_db.head_block_num() + 1 );
+            chain_transactions += b->transactions.size();
+            sync_db.push_block( *b, database::skip_miner_signature | database::skip_authority_check );
+         }
+
+         uint64_t synced_transactions = 0;
+         const uint32_t synced_blocks = db.head_block_num() - sync_db.head_block_num();
+         start = fc::time_point::now();
+         while( sync_db.head_block_num() < db.head_block_num() )
+         {
+            optional<signed_block> b = db.fetch_block_by_number( sync_db.head_block_num() + 1 );
+            synced_transactions += b->transactions.size();
+            sync_db.push_block( *b, database::skip_miner_signature );
+         }
+         report.add( sync_db, "push_block", synced_transactions, synced_blocks, fc::time_point::now() - start );
+         chain_transactions += synced_transactions;
+         BOOST_CHECK( sync_db.head_block_id() == db.head_block_id() );
+         sync_db.close();
+      }
+      {
+         database replay_db;
+         start = fc::time_point::now();
+         replay_db.reindex( sync_dir.path(), genesis_state );
+         report.add( replay_db, "reindex", chain_transactions, replay_db.head_block_num(), fc::time_point::now() - start );
+         BOOST_CHECK( replay_db.head_block_id() == db.head_block_id() );
+         replay_db.close();
+      }
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -51,6 +51,8 @@ BOOST_AUTO_TEST_CASE( genesis_and_persistence_bench )
 {
    try {
       genesis_state_type genesis_state;
+      // the schedule requires no fees, the transfers below pay more than that
+      genesis_state.initial_parameters.current_fees->zero_all_fees();
 
 #ifdef NDEBUG
       ilog("Running in release mode.");
@@ -95,17 +97,22 @@ BOOST_AUTO_TEST_CASE( genesis_and_persistence_bench )
          auto b =  db.generate_block( db.get_slot_time( 1 ), db.get_scheduled_miner( 1 ), miner_priv_key, ~0 );
 
          start_time = fc::time_point::now();
-         /* TODO: get this buliding again
          for( int i = 0; i < blocks_to_produce; ++i )
          {
+            transfer_operation op;
+            op.fee = asset(1);
+            op.from = account_id_type(i + 11);
+            op.to = account_id_type();
+            op.amount = asset(1);
             signed_transaction trx;
-            trx.operations.emplace_back(transfer_operation(asset(1), account_id_type(i + 11), account_id_type(), asset(1), memo_data()));
+            trx.operations.push_back(op);
+            trx.set_expiration( db.head_block_time() + fc::minutes(1) );
             db.push_transaction(trx, ~0);
 
             aw = db.get_global_properties().active_miners;
             b =  db.generate_block( db.get_slot_time( 1 ), db.get_scheduled_miner( 1 ), miner_priv_key, ~0 );
+            ++blocks_out;
          }
-         */
          ilog("Pushed ${c} blocks (1 op each, no validation) in ${t} milliseconds.",
               ("c", blocks_out)("t", (fc::time_point::now() - start_time).count() / 1000));
 
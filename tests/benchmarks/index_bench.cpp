@@ -0,0 +1,265 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/buying_object.hpp>
+#include <graphene/chain/content_object.hpp>
+#include <graphene/db/dense_index.hpp>
+#include <graphene/db/object_database.hpp>
+
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/io/json.hpp>
+#include <fc/time.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/test/auto_unit_test.hpp>
+
+#include <iostream>
+#include <random>
+
+using namespace graphene::chain;
+
+namespace {
+
+/// value of the argument --<name>=<n>, default_value if it is not given
+uint64_t bench_argument( const std::string& name, uint64_t default_value )
+{
+   int argc = boost::unit_test::framework::master_test_suite().argc;
+   char** argv = boost::unit_test::framework::master_test_suite().argv;
+   const std::string prefix = "--" + name + "=";
+   uint64_t result = default_value;
+   for( int i = 1; i < argc; i++ )
+   {
+      const std::string arg = argv[i];
+      if( arg.compare( 0, prefix.size(), prefix ) == 0 )
+         result = std::stoull( arg.substr( prefix.size() ) );
+   }
+   return result;
+}
+
+/// number of objects per index, 10M unless --bench-objects=<n> is given
+uint64_t bench_objects()
+{
+   return bench_argument( "bench-objects", 10000000 );
+}
+
+void fill( graphene::db::object_database& db, account_object*, uint64_t count )
+{
+   for( uint64_t i = 0; i < count; ++i )
+      db.create<account_object>( [i]( account_object& a ) {
+         a.name = "bench-account-" + fc::to_string( i );
+      });
+}
+
+void fill( graphene::db::object_database& db, content_object*, uint64_t count )
+{
+   for( uint64_t i = 0; i < count; ++i )
+      db.create<content_object>( [i]( content_object& c ) {
+         c.URI = "ipfs:bench-content-" + fc::to_string( i );
+         c.price.SetSimplePrice( asset( 1 ) );
+      });
+}
+
+/**
+ * Fills an object database holding only IndexType with objects and measures random lookups by object ID, which is
+ * the access pattern of evaluators resolving the IDs in operations.
+ */
+template<typename IndexType>
+void run_lookups( const string& index_name, const string& variant, uint64_t objects )
+{
+   typedef typename IndexType::object_type object_type;
+   BOOST_REQUIRE( objects > 0 );
+
+   graphene::db::object_database db;
+   db.add_index< IndexType >();
+   fill( db, (object_type*)nullptr, objects );
+
+   const uint64_t lookups = std::max<uint64_t>( objects, 1000000 );
+   std::mt19937_64 generator( 42 );
+   std::uniform_int_distribution<uint64_t> instance( 0, objects - 1 );
+   vector<object_id_type> ids;
+   ids.reserve( lookups );
+   for( uint64_t i = 0; i < lookups; ++i )
+      ids.push_back( object_id_type( object_type::space_id, object_type::type_id, instance( generator ) ) );
+
+   uint64_t found = 0;
+   fc::time_point start = fc::time_point::now();
+   for( const auto& id : ids )
+      if( db.find_object( id ) != nullptr )
+         ++found;
+   fc::microseconds elapsed = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( found, lookups );
+
+   fc::mutable_variant_object result;
+   result( "benchmark", "index_bench" )
+#ifdef NDEBUG
+         ( "build", "release" )
+#else
+         ( "build", "debug" )
+#endif
+         ( "index", index_name )
+         ( "variant", variant )
+         ( "objects", objects )
+         ( "lookups", lookups )
+         ( "elapsed_us", elapsed.count() )
+         ( "ns_per_lookup", double( elapsed.count() ) * 1000.0 / lookups );
+   std::cout << fc::json::to_string( result ) << std::endl;
+}
+
+struct by_URI_consumer_string;
+struct by_consumer_URI_string;
+struct by_URI_open_string;
+
+/// the buying index as it was before the composite keys referred to the content by its ID
+typedef multi_index_container<
+   buying_object,
+      indexed_by<
+         ordered_unique< tag<by_id>,
+            member< object, object_id_type, &object::id >
+         >,
+         ordered_unique< tag<by_URI_consumer_string>,
+            composite_key< buying_object,
+               member<buying_object, string, &buying_object::URI>,
+               member<buying_object, account_id_type, &buying_object::consumer>
+            >
+         >,
+         ordered_unique< tag<by_consumer_URI_string>,
+            composite_key< buying_object,
+               member<buying_object, account_id_type, &buying_object::consumer>,
+               member<buying_object, string, &buying_object::URI>
+            >
+         >,
+         ordered_non_unique< tag<by_URI_open_string>,
+            composite_key< buying_object,
+               member<buying_object, string, &buying_object::URI>,
+               const_mem_fun<buying_object, bool, &buying_object::is_open>
+            >
+         >
+      >
+> string_keyed_buying_multi_index_type;
+
+typedef generic_index< buying_object, string_keyed_buying_multi_index_type > string_keyed_buying_index;
+
+/// magnet link of the i-th content, about 120 characters like the URIs of real packages
+string bench_uri( uint64_t i )
+{
+   return "magnet:?xt=urn:btih:" + fc::ripemd160::hash( fc::to_string( i ) ).str() + "&dn=bench-content-" + fc::to_string( i ) +
+          "&tr=udp%3A%2F%2Ftracker.example.com%3A80";
+}
+
+uint64_t buying_index_bytes( const graphene::db::object_database& db )
+{
+   for( const auto& stats : db.get_memory_stats() )
+      if( stats.space_id == buying_object::space_id && stats.type_id == buying_object::type_id )
+         return stats.total_bytes();
+   return 0;
+}
+
+void report_buying_lookups( const string& variant, const graphene::db::object_database& db, uint64_t buyings, uint64_t lookups,
+                            const fc::microseconds& elapsed )
+{
+   fc::mutable_variant_object result;
+   result( "benchmark", "index_bench" )
+#ifdef NDEBUG
+         ( "build", "release" )
+#else
+         ( "build", "debug" )
+#endif
+         ( "index", "buying_index" )
+         ( "variant", variant )
+         ( "objects", buyings )
+         ( "lookups", lookups )
+         ( "elapsed_us", elapsed.count() )
+         ( "ns_per_lookup", double( elapsed.count() ) * 1000.0 / lookups )
+         ( "index_bytes", buying_index_bytes( db ) )
+         ( "bytes_per_object", double( buying_index_bytes( db ) ) / buyings );
+   std::cout << fc::json::to_string( result ) << std::endl;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( account_index_lookup_bench )
+{
+   const uint64_t objects = bench_objects();
+   run_lookups< primary_index< account_index > >( "account_index", "multi_index", objects );
+   run_lookups< primary_index< dense_index<account_index> > >( "account_index", "dense", objects );
+}
+
+BOOST_AUTO_TEST_CASE( content_index_lookup_bench )
+{
+   const uint64_t objects = bench_objects();
+   run_lookups< primary_index< content_index > >( "content_index", "multi_index", objects );
+   run_lookups< primary_index< dense_index<content_index> > >( "content_index", "dense", objects );
+}
+
+/// lookups of a purchase by consumer and URI, as done by the API and by the evaluators of ratings
+BOOST_AUTO_TEST_CASE( buying_index_lookup_bench )
+{
+   const uint64_t buyings = bench_argument( "bench-buyings", 1000000 );
+   const uint64_t contents = std::max<uint64_t>( buyings / 100, 1 );
+   BOOST_REQUIRE( buyings > 0 );
+
+   vector<string> uris;
+   uris.reserve( contents );
+   for( uint64_t i = 0; i < contents; ++i )
+      uris.push_back( bench_uri( i ) );
+
+   std::mt19937_64 generator( 42 );
+   std::uniform_int_distribution<uint64_t> purchase( 0, buyings - 1 );
+   vector<uint64_t> purchases;
+   purchases.reserve( buyings );
+   for( uint64_t i = 0; i < buyings; ++i )
+      purchases.push_back( purchase( generator ) );
+
+   {
+      graphene::db::object_database db;
+      db.add_index< primary_index< string_keyed_buying_index > >();
+      for( uint64_t i = 0; i < buyings; ++i )
+         db.create<buying_object>( [&]( buying_object& b ) {
+            b.consumer = account_id_type( i / contents );
+            b.URI = uris[i % contents];
+         });
+
+      const auto& idx = db.get_index_type<string_keyed_buying_index>().indices().get<by_consumer_URI_string>();
+      uint64_t found = 0;
+      fc::time_point start = fc::time_point::now();
+      for( uint64_t i : purchases )
+         if( idx.find( std::make_tuple( account_id_type( i / contents ), uris[i % contents] ) ) != idx.end() )
+            ++found;
+      fc::microseconds elapsed = fc::time_point::now() - start;
+      BOOST_CHECK_EQUAL( found, buyings );
+      report_buying_lookups( "uri_string", db, buyings, buyings, elapsed );
+   }
+
+   {
+      graphene::db::object_database db;
+      db.add_index< primary_index< content_index > >();
+      db.add_index< primary_index< buying_index > >();
+      vector<content_id_type> content_ids;
+      for( const string& uri : uris )
+         content_ids.push_back( db.create<content_object>( [&]( content_object& c ) {
+            c.URI = uri;
+            c.price.SetSimplePrice( asset( 1 ) );
+         }).get_id() );
+      for( uint64_t i = 0; i < buyings; ++i )
+         db.create<buying_object>( [&]( buying_object& b ) {
+            b.consumer = account_id_type( i / contents );
+            b.content = content_ids[i % contents];
+            b.URI = uris[i % contents];
+         });
+
+      // the URI is resolved once per lookup, as at the API boundary
+      const auto& cidx = db.get_index_type<content_index>().indices().get<by_URI>();
+      const auto& idx = db.get_index_type<buying_index>().indices().get<by_consumer_content>();
+      uint64_t found = 0;
+      fc::time_point start = fc::time_point::now();
+      for( uint64_t i : purchases )
+      {
+         auto citr = cidx.find( uris[i % contents] );
+         if( citr != cidx.end() && idx.find( std::make_tuple( account_id_type( i / contents ), citr->get_id() ) ) != idx.end() )
+            ++found;
+      }
+      fc::microseconds elapsed = fc::time_point::now() - start;
+      BOOST_CHECK_EQUAL( found, buyings );
+      report_buying_lookups( "content_id", db, buyings, buyings, elapsed );
+   }
+}
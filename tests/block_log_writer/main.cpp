@@ -0,0 +1,173 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+/**
+ * Writes a block log for the block_database tests of chain_test.  The tests kill the writer, or limit the size
+ * of the files it may write, neither of which they could do to their own multithreaded process.
+ *
+ *   block_log_writer crash <dir> <synced_num>
+ *      stores blocks until it is killed, writes a byte to its standard output once block synced_num is synced
+ *   block_log_writer io_error <dir> <count>
+ *      stores count blocks, the second half of them while the files can't grow.  Exits with 0 if the blocks stay
+ *      readable while their writes fail and are written once the files can grow again
+ */
+#include <graphene/chain/block_database.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace graphene::chain;
+
+namespace {
+
+signed_block make_block( const signed_block& prev, uint32_t num )
+{
+   signed_block b;
+   if( num > 1 )
+      b.previous = prev.id();
+   b.miner = miner_id_type( num );
+   b.transactions.resize( 10 );
+   return b;
+}
+
+int crash( const fc::path& dir, uint32_t synced_num )
+{
+   block_database bdb;
+   bdb.open( dir );
+   signed_block b;
+   for( uint32_t num = 1; num < 1000000; ++num )
+   {
+      b = make_block( b, num );
+      bdb.store( b.id(), b );
+      if( num == synced_num )
+      {
+         bdb.sync( synced_num );
+         char c = 1;
+         if( write( STDOUT_FILENO, &c, 1 ) != 1 )
+            return 1;
+      }
+   }
+   return 0;
+}
+
+bool all_readable( const block_database& bdb, uint32_t count )
+{
+   for( uint32_t num = 1; num <= count; ++num )
+   {
+      auto b = bdb.fetch_by_number( num );
+      if( !b.valid() || !( b->miner == miner_id_type( num ) ) )
+      {
+         std::cerr << "block " << num << " is lost\n";
+         return false;
+      }
+   }
+   return true;
+}
+
+int io_error( const fc::path& dir, uint32_t count )
+{
+   // writes past the limit fail with EFBIG instead of killing the process
+   signal( SIGXFSZ, SIG_IGN );
+   rlimit limit;
+   if( getrlimit( RLIMIT_FSIZE, &limit ) != 0 )
+      return 1;
+   const rlim_t no_limit = limit.rlim_cur;
+
+   block_database bdb;
+   bdb.open( dir );
+   signed_block b;
+   uint32_t num = 1;
+   for( ; num <= count / 2; ++num )
+   {
+      b = make_block( b, num );
+      bdb.store( b.id(), b );
+   }
+   bdb.sync( num - 1 );
+
+   limit.rlim_cur = std::max( fc::file_size( dir / "blocks" ), fc::file_size( dir / "index" ) );
+   if( setrlimit( RLIMIT_FSIZE, &limit ) != 0 )
+      return 1;
+   for( ; num <= count; ++num )
+   {
+      b = make_block( b, num );
+      bdb.store( b.id(), b );
+   }
+
+   bool failed = false;
+   try
+   {
+      bdb.sync( count );
+   }
+   catch( const fc::exception& )
+   {
+      failed = true;
+   }
+   if( !failed )
+   {
+      std::cerr << "sync() did not report the failed writes\n";
+      return 1;
+   }
+   if( !all_readable( bdb, count ) )
+      return 1;
+
+   // the I/O thread writes the journal again, sync() succeeds once it has
+   limit.rlim_cur = no_limit;
+   if( setrlimit( RLIMIT_FSIZE, &limit ) != 0 )
+      return 1;
+   for( int attempt = 0; ; ++attempt )
+   {
+      try
+      {
+         bdb.sync( count );
+         break;
+      }
+      catch( const fc::exception& e )
+      {
+         if( attempt == 100 )
+         {
+            std::cerr << "the journal was not written again: " << e.to_detail_string() << "\n";
+            return 1;
+         }
+      }
+      std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+   }
+   if( !all_readable( bdb, count ) )
+      return 1;
+   bdb.close();
+   return 0;
+}
+
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      const std::string mode = argc > 1 ? argv[1] : "";
+      if( mode == "crash" && argc == 4 )
+         return crash( fc::path( argv[2] ), std::stoul( argv[3] ) );
+      if( mode == "io_error" && argc == 4 )
+         return io_error( fc::path( argv[2] ), std::stoul( argv[3] ) );
+      std::cerr << "usage: block_log_writer crash <dir> <synced_num> | io_error <dir> <count>\n";
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   catch( const std::exception& e )
+   {
+      std::cerr << e.what() << "\n";
+   }
+   return 1;
+}
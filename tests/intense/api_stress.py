@@ -22,7 +22,7 @@ except ImportError:
 
 @asyncio.coroutine
 def mainloop():
-    ws = yield from websockets.connect('ws://localhost:8090/')
+    ws = yield from websockets.connect(URL)
     entropy = struct.unpack("<Q", os.urandom(8))[0]
     rand = random.Random(entropy)
     my_account_id = rand.randrange(0, 90000)
@@ -55,6 +55,84 @@ def mainloop():
            break
     yield from ws.close()
 
+# read-only calls issued by the latency test; start it against a node that is producing or syncing
+# blocks, once with --api-worker-threads=0 and once with worker threads, and compare the percentiles
+LATENCY_CALLS = [
+    ("search_content", ["", "-rating", "", "", "0.0.0", "", 100]),
+    ("get_full_accounts", [["1.2.15", "1.2.16", "1.2.17"], False]),
+    ("search_accounts", ["", "+name", "0.0.0", 100]),
+    ("lookup_accounts", ["", 1000]),
+]
+
+@asyncio.coroutine
+def latencyloop(results_path, duration):
+    ws = yield from websockets.connect(URL)
+    rand = random.Random(struct.unpack("<Q", os.urandom(8))[0])
+    latencies = {name: [] for name, params in LATENCY_CALLS}
+
+    @asyncio.coroutine
+    def call(call_id, method, params):
+        yield from ws.send(json.dumps({"id": call_id, "method": "call", "params": [0, method, params]}))
+        while True:
+            reply = json.loads((yield from ws.recv()))
+            if reply.get("id") == call_id:
+                return reply
+
+    start_block = (yield from call(1, "get_dynamic_global_properties", []))["result"]["head_block_number"]
+    call_id = 2
+    end_time = time.time() + duration
+    while time.time() < end_time:
+        name, params = rand.choice(LATENCY_CALLS)
+        started = time.time()
+        yield from call(call_id, name, params)
+        latencies[name].append(time.time() - started)
+        call_id += 1
+    end_block = (yield from call(call_id, "get_dynamic_global_properties", []))["result"]["head_block_number"]
+    yield from ws.close()
+
+    with open(results_path, "w") as f:
+        json.dump({"blocks_applied": end_block - start_block, "latencies": latencies}, f)
+
+def percentile(values, fraction):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * fraction))]
+
+def run_latency_test(instances, duration):
+    child_procs = {}
+    for i in range(instances):
+        results_path = "/tmp/api_stress_latency_%d_%d.json" % (os.getpid(), i)
+        pid = os.fork()
+        if pid == 0:
+            asyncio.get_event_loop().run_until_complete(latencyloop(results_path, duration))
+            os._exit(0)
+        child_procs[pid] = results_path
+
+    latencies = {name: [] for name, params in LATENCY_CALLS}
+    blocks_applied = 0
+    for pid, results_path in child_procs.items():
+        os.waitpid(pid, 0)
+        if not os.path.exists(results_path):
+            continue
+        with open(results_path) as f:
+            results = json.load(f)
+        os.remove(results_path)
+        blocks_applied = max(blocks_applied, results["blocks_applied"])
+        for name, values in results["latencies"].items():
+            latencies[name].extend(values)
+
+    print("%d blocks applied during the test" % blocks_applied)
+    print("%-20s %8s %10s %10s %10s" % ("call", "count", "p50 ms", "p99 ms", "max ms"))
+    for name, values in sorted(latencies.items()):
+        if values:
+            print("%-20s %8d %10.2f %10.2f %10.2f" % (name, len(values), percentile(values, 0.5) * 1000,
+                                                     percentile(values, 0.99) * 1000, max(values) * 1000))
+
+URL = os.environ.get("API_STRESS_URL", "ws://localhost:8090/")
+
+if len(sys.argv) > 1 and sys.argv[1] == "--latency":
+    run_latency_test(int(os.environ.get("API_STRESS_CLIENTS", "50")), int(os.environ.get("API_STRESS_DURATION", "60")))
+    sys.exit(0)
+
 child_procs = []
 
 # stress test with 200 instances
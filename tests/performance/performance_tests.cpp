@@ -32,6 +32,8 @@
 
 #include <graphene/db/simple_index.hpp>
 
+#include <graphene/app/api.hpp>
+
 #include <fc/crypto/digest.hpp>
 #include "../common/database_fixture.hpp"
 
@@ -51,6 +53,218 @@ BOOST_AUTO_TEST_CASE( sigcheck_benchmark )
    auto elapsed = end-start;
    wdump( ((100000.0*1000000.0) / elapsed.count()) );
 }
+/**
+ * Compares the server side cost and the size on the wire of the JSON API calls with their
+ * binary-encoded raw_api counterparts.  The JSON side includes building the variant and printing it,
+ * the raw side includes packing and the hex string the blob travels as.
+ */
+BOOST_FIXTURE_TEST_CASE( api_encoding_benchmark, database_fixture )
+{
+   try {
+      ACTORS((alice)(bob));
+      fund( alice, asset(100000000) );
+      for( uint32_t i = 0; i < 100; ++i )
+      {
+         transfer( alice_id, bob_id, asset(1000 + i) );
+         if( i % 10 == 9 )
+            generate_block();
+      }
+
+      graphene::app::database_api db_api( db );
+      graphene::app::history_api hist_api( app );
+      graphene::app::raw_api raw( app );
+      const uint32_t iterations = 1000;
+
+      auto measure = [&]( const char* call, const std::function<std::string()>& json_call, const std::function<std::vector<char>()>& raw_call )
+      {
+         size_t json_bytes = 0, raw_bytes = 0, raw_wire_bytes = 0;
+         auto start = fc::time_point::now();
+         for( uint32_t i = 0; i < iterations; ++i )
+            json_bytes = json_call().size();
+         auto json_elapsed = fc::time_point::now() - start;
+
+         start = fc::time_point::now();
+         for( uint32_t i = 0; i < iterations; ++i )
+         {
+            std::vector<char> packed = raw_call();
+            raw_bytes = packed.size();
+            raw_wire_bytes = fc::json::to_string( fc::variant( packed ) ).size();
+         }
+         auto raw_elapsed = fc::time_point::now() - start;
+
+         wlog( "${call}: json ${json_us} us/call ${json_bytes} bytes, raw ${raw_us} us/call ${raw_bytes} bytes (${raw_wire_bytes} on the wire)",
+               ("call", call)
+               ("json_us", json_elapsed.count() / iterations)("json_bytes", json_bytes)
+               ("raw_us", raw_elapsed.count() / iterations)("raw_bytes", raw_bytes)("raw_wire_bytes", raw_wire_bytes) );
+      };
+
+      measure( "get_block",
+               [&]() { return fc::json::to_string( fc::variant( db_api.get_block( db.head_block_num() ) ) ); },
+               [&]() { return raw.get_block( db.head_block_num() ); } );
+      measure( "get_full_accounts",
+               [&]() { return fc::json::to_string( fc::variant( db_api.get_full_accounts( {"alice", "bob"}, false ) ) ); },
+               [&]() { return raw.get_full_accounts( {"alice", "bob"} ); } );
+      measure( "get_account_history",
+               [&]() { return fc::json::to_string( fc::variant( hist_api.get_account_history( alice_id, "" ) ) ); },
+               [&]() { return raw.get_account_history( alice_id, "" ); } );
+      measure( "search_content",
+               [&]() { return fc::json::to_string( fc::variant( db_api.search_content( "", "", "", "", object_id_type(), "", 100 ) ) ); },
+               [&]() { return raw.search_content( "", "", "", "", object_id_type(), "", 100 ); } );
+
+      BOOST_CHECK( graphene::app::unpack_raw_result<optional<signed_block>>( raw.get_block( db.head_block_num() ) )->id() == db.head_block_id() );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+/**
+ * Compares the hashing done while applying a block when every consumer serializes the transactions
+ * on its own with the same work going through transaction_metadata, which serializes each of them once.
+ */
+BOOST_FIXTURE_TEST_CASE( transaction_metadata_benchmark, database_fixture )
+{
+   try {
+      ACTORS((alice)(bob));
+      fund( alice, asset(100000000) );
+
+      const uint32_t block_size = 200;
+      for( uint32_t i = 0; i < block_size; ++i )
+      {
+         transfer_operation op;
+         op.from = alice_id;
+         op.to = bob_id;
+         op.amount = asset(1000 + i);
+         db.current_fee_schedule().set_fee( op );
+         signed_transaction tx;
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         sign( tx, alice_private_key );
+         db.push_transaction( std::make_shared<transaction_metadata>( std::move( tx ) ) );
+      }
+      signed_block b = generate_block();
+      BOOST_REQUIRE_EQUAL( b.transactions.size(), block_size );
+
+      const chain_id_type& chain_id = db.get_chain_id();
+      const uint32_t iterations = 20;
+      checksum_type uncached_root, cached_root;
+
+      // block validation, signature checks and the applied_block observers each hash on their own
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < iterations; ++i )
+      {
+         uncached_root = b.calculate_merkle_root();
+         for( const auto& tx : b.transactions )
+         {
+            tx.id();
+            tx.get_signature_keys( chain_id );
+            tx.id();
+         }
+      }
+      auto uncached_elapsed = fc::time_point::now() - start;
+
+      start = fc::time_point::now();
+      for( uint32_t i = 0; i < iterations; ++i )
+      {
+         vector<digest_type> digests;
+         digests.reserve( b.transactions.size() );
+         for( const auto& tx : b.transactions )
+         {
+            auto meta = transaction_metadata::reference( tx );
+            digests.push_back( meta->merkle_digest( tx.operation_results ) );
+            meta->id();
+            meta->signature_keys( chain_id );
+            meta->id();
+         }
+         cached_root = signed_block::calculate_merkle_root( std::move( digests ) );
+      }
+      auto cached_elapsed = fc::time_point::now() - start;
+
+      wlog( "${n} transactions per block: uncached ${u} us/block, transaction_metadata ${c} us/block",
+            ("n", block_size)("u", uncached_elapsed.count() / iterations)("c", cached_elapsed.count() / iterations) );
+
+      BOOST_CHECK( uncached_root == cached_root );
+      BOOST_CHECK( cached_root == b.transaction_merkle_root );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+/**
+ * Times push_block of a 200-transaction block on the chain thread, once hashing the transactions itself and
+ * once with the block_metadata the p2p prevalidation threads compute for a sync block.
+ */
+BOOST_FIXTURE_TEST_CASE( block_apply_benchmark, database_fixture )
+{
+   try {
+      ACTORS((alice)(bob));
+      fund( alice, asset(100000000) );
+
+      const uint32_t block_size = 200;
+      for( uint32_t i = 0; i < block_size; ++i )
+      {
+         transfer_operation op;
+         op.from = alice_id;
+         op.to = bob_id;
+         op.amount = asset(1000 + i);
+         db.current_fee_schedule().set_fee( op );
+         signed_transaction tx;
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         sign( tx, alice_private_key );
+         db.push_transaction( std::make_shared<transaction_metadata>( std::move( tx ) ) );
+      }
+      const signed_block b = generate_block();
+      BOOST_REQUIRE_EQUAL( b.transactions.size(), block_size );
+
+      const uint32_t skip = database::skip_transaction_signatures;
+      const uint32_t iterations = 20;
+      fc::microseconds without_metadata, with_metadata, prevalidation;
+
+      for( uint32_t i = 0; i < iterations; ++i )
+      {
+         db.pop_block();
+         auto start = fc::time_point::now();
+         db.push_block( b, skip );
+         without_metadata += fc::time_point::now() - start;
+         BOOST_REQUIRE( db.head_block_id() == b.id() );
+      }
+
+      for( uint32_t i = 0; i < iterations; ++i )
+      {
+         db.pop_block();
+
+         // what the prevalidation threads do off the chain thread
+         auto start = fc::time_point::now();
+         std::shared_ptr<block_metadata> metadata = std::make_shared<block_metadata>();
+         vector<digest_type> merkle_digests;
+         for( const processed_transaction& tx : b.transactions )
+         {
+            auto trx_metadata = std::make_shared<transaction_metadata>( static_cast<const signed_transaction&>( tx ) );
+            merkle_digests.push_back( trx_metadata->merkle_digest( tx.operation_results ) );
+            trx_metadata->id();
+            metadata->trx_metadata.push_back( trx_metadata );
+         }
+         metadata->merkle_root = signed_block::calculate_merkle_root( std::move( merkle_digests ) );
+         prevalidation += fc::time_point::now() - start;
+
+         start = fc::time_point::now();
+         db.push_block( b, *metadata, skip );
+         with_metadata += fc::time_point::now() - start;
+         BOOST_REQUIRE( db.head_block_id() == b.id() );
+      }
+
+      wlog( "${n} transactions per block: push_block ${u} us/block, with block_metadata ${c} us/block "
+            "plus ${p} us/block on a prevalidation thread",
+            ("n", block_size)("u", without_metadata.count() / iterations)("c", with_metadata.count() / iterations)
+            ("p", prevalidation.count() / iterations) );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 /*
 BOOST_AUTO_TEST_CASE( transfer_benchmark )
 {
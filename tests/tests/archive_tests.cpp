@@ -0,0 +1,255 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <boost/test/unit_test.hpp>
+
+#include <archive.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using decent::package::detail::ArchiveEntry;
+using decent::package::detail::Archiver;
+using decent::package::detail::Dearchiver;
+
+namespace {
+
+void write_file( const fc::path& file, const std::string& data )
+{
+   fc::create_directories( file.parent_path() );
+   std::ofstream out( file.string(), std::ios::binary | std::ios::trunc );
+   out.write( data.data(), data.size() );
+}
+
+std::string read_file( const fc::path& file )
+{
+   std::ifstream in( file.string(), std::ios::binary );
+   return std::string( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+}
+
+std::string random_data( size_t size )
+{
+   std::string data( size, '\0' );
+   uint32_t x = 2463534242u;
+   for( auto& byte : data )
+   {
+      x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+      byte = char( x );
+   }
+   return data;
+}
+
+// flips one byte of the file at the offset
+void damage( const fc::path& file, uint64_t offset )
+{
+   std::fstream io( file.string(), std::ios::binary | std::ios::in | std::ios::out );
+   io.seekg( offset );
+   const char byte = char( io.get() ) ^ 0x5a;
+   io.seekp( offset );
+   io.put( byte );
+}
+
+struct archive_fixture
+{
+   archive_fixture()
+      : dir( graphene::utilities::temp_directory_path() )
+      , archive( dir.path() / "content.zip" )
+      , compressible( 3 * 1024 * 1024, 'a' )
+      , incompressible( random_data( 200 * 1024 ) )
+   {
+      for( size_t i = 0; i < compressible.size(); i += 64 )
+         compressible[i] = char( 'a' + i % 23 );
+      write_file( dir.path() / "in" / "text.txt", compressible );
+      write_file( dir.path() / "in" / "video.bin", incompressible );
+      write_file( dir.path() / "in" / "empty", std::string() );
+   }
+
+   void create( const std::string& text_name = "samples/text.txt", uint32_t version = 2 )
+   {
+      Archiver archiver( archive, version );
+      archiver.put( text_name, dir.path() / "in" / "text.txt" );
+      archiver.put( "video.bin", dir.path() / "in" / "video.bin" );
+      archiver.put( "empty", dir.path() / "in" / "empty" );
+      archiver.finalize();
+   }
+
+   const ArchiveEntry& entry( const Dearchiver& dearchiver, const std::string& name )
+   {
+      for( const auto& e : dearchiver.entries() )
+         if( e.name == name )
+            return e;
+      BOOST_FAIL( "no entry " + name );
+      return dearchiver.entries().front();
+   }
+
+   fc::temp_directory  dir;
+   fc::path            archive;
+   std::string         compressible;
+   std::string         incompressible;
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( archive_tests, archive_fixture )
+
+BOOST_AUTO_TEST_CASE( version_2_round_trip )
+{
+   create();
+
+   Dearchiver dearchiver( archive );
+   BOOST_CHECK_EQUAL( dearchiver.version(), 2 );
+   BOOST_REQUIRE_EQUAL( dearchiver.entries().size(), 3u );
+   BOOST_CHECK( entry( dearchiver, "samples/text.txt" ).compression == ArchiveEntry::GZIP );
+   BOOST_CHECK_LT( entry( dearchiver, "samples/text.txt" ).stored_size, compressible.size() );
+   BOOST_CHECK( entry( dearchiver, "video.bin" ).compression == ArchiveEntry::STORED );
+   BOOST_CHECK_EQUAL( entry( dearchiver, "video.bin" ).size, incompressible.size() );
+
+   const fc::path out = dir.path() / "out";
+   dearchiver.extract( out, 2 );
+   BOOST_CHECK( read_file( out / "samples" / "text.txt" ) == compressible );
+   BOOST_CHECK( read_file( out / "video.bin" ) == incompressible );
+   BOOST_CHECK( fc::exists( out / "empty" ) && fc::file_size( out / "empty" ) == 0 );
+
+   // single files are extracted through the index
+   const fc::path single = dir.path() / "single";
+   dearchiver.extract_file( "video.bin", single );
+   BOOST_CHECK( read_file( single / "video.bin" ) == incompressible );
+   BOOST_CHECK( !fc::exists( single / "samples" ) );
+   BOOST_CHECK_THROW( dearchiver.extract_file( "missing", single ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE( crc_mismatch )
+{
+   create();
+
+   // the index is intact, the stored data of the file is not
+   const uint64_t offset = entry( Dearchiver( archive ), "video.bin" ).offset + 1000;
+   damage( archive, offset );
+
+   Dearchiver dearchiver( archive );
+   BOOST_CHECK_THROW( dearchiver.extract_file( "video.bin", dir.path() / "out" ), fc::exception );
+   BOOST_CHECK_THROW( dearchiver.extract( dir.path() / "out" ), fc::exception );
+   dearchiver.extract_file( "samples/text.txt", dir.path() / "out" );
+   BOOST_CHECK( read_file( dir.path() / "out" / "samples" / "text.txt" ) == compressible );
+}
+
+BOOST_AUTO_TEST_CASE( truncated_and_damaged_index )
+{
+   create();
+   const std::string complete = read_file( archive );
+
+   // an archive cut anywhere in the index or the trailer is rejected
+   for( size_t cut : { size_t( 1 ), size_t( 20 ), size_t( 32 ), size_t( 40 ) } )
+   {
+      write_file( archive, complete.substr( 0, complete.size() - cut ) );
+      BOOST_CHECK_THROW( Dearchiver truncated( archive ), fc::exception );
+   }
+
+   // so is an archive with any byte of the index changed
+   write_file( archive, complete );
+   // the empty file is the last one, the index starts where its data would
+   const uint64_t index_offset = entry( Dearchiver( archive ), "empty" ).offset;
+   damage( archive, index_offset + 3 );
+   BOOST_CHECK_THROW( Dearchiver damaged( archive ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE( name_outside_of_output_dir )
+{
+   create( "../text.txt" );
+
+   const fc::path out = dir.path() / "out";
+   Dearchiver dearchiver( archive );
+   BOOST_CHECK_THROW( dearchiver.extract( out ), fc::exception );
+   BOOST_CHECK_THROW( dearchiver.extract_file( "../text.txt", out ), fc::exception );
+   BOOST_CHECK( !fc::exists( dir.path() / "text.txt" ) );
+}
+
+BOOST_AUTO_TEST_CASE( version_1_extraction )
+{
+   // version 1 is one gzip stream of 304 byte headers, each followed by the file
+   {
+      boost::iostreams::filtering_ostream out;
+      out.push( boost::iostreams::gzip_compressor() );
+      out.push( boost::iostreams::file_sink( archive.string(), std::ios::binary ) );
+      for( const auto& file : { std::make_pair( std::string( "samples/text.txt" ), compressible ),
+                                std::make_pair( std::string( "video.bin" ), incompressible ) } )
+      {
+         char header[304] = { 0 };
+         header[0] = 1;
+         std::memcpy( header + 4, file.first.data(), file.first.size() );
+         const uint32_t size = file.second.size();
+         std::memcpy( header + 260, &size, sizeof( size ) );
+         out.write( header, sizeof( header ) );
+         out.write( file.second.data(), file.second.size() );
+      }
+   }
+
+   Dearchiver dearchiver( archive );
+   BOOST_CHECK_EQUAL( dearchiver.version(), 1 );
+   BOOST_CHECK( dearchiver.entries().empty() );
+   BOOST_CHECK_THROW( dearchiver.extract_file( "video.bin", dir.path() / "out" ), fc::exception );
+
+   dearchiver.extract( dir.path() / "out" );
+   BOOST_CHECK( read_file( dir.path() / "out" / "samples" / "text.txt" ) == compressible );
+   BOOST_CHECK( read_file( dir.path() / "out" / "video.bin" ) == incompressible );
+}
+
+BOOST_AUTO_TEST_CASE( version_1_is_the_default )
+{
+   {
+      Archiver archiver( archive );
+      BOOST_CHECK_EQUAL( archiver.version(), 1u );
+   }
+   create( "samples/text.txt", 1 );
+
+   // the layout the nodes not upgraded yet read, the first header is followed by the file
+   {
+      boost::iostreams::filtering_istream in;
+      in.push( boost::iostreams::gzip_decompressor() );
+      in.push( boost::iostreams::file_source( archive.string(), std::ios::binary ) );
+      char header[304] = { 0 };
+      in.read( header, sizeof( header ) );
+      BOOST_CHECK_EQUAL( header[0], 1 );
+      BOOST_CHECK_EQUAL( std::string( header + 4 ), "samples/text.txt" );
+      int32_t size = 0;
+      std::memcpy( &size, header + 260, sizeof( size ) );
+      BOOST_CHECK_EQUAL( size_t( size ), compressible.size() );
+   }
+
+   Dearchiver dearchiver( archive );
+   BOOST_CHECK_EQUAL( dearchiver.version(), 1 );
+   dearchiver.extract( dir.path() / "out" );
+   BOOST_CHECK( read_file( dir.path() / "out" / "samples" / "text.txt" ) == compressible );
+   BOOST_CHECK( read_file( dir.path() / "out" / "video.bin" ) == incompressible );
+   BOOST_CHECK( fc::exists( dir.path() / "out" / "empty" ) && fc::file_size( dir.path() / "out" / "empty" ) == 0 );
+
+   // a name the header has no room for is refused instead of truncated
+   Archiver archiver( dir.path() / "long.zip" );
+   BOOST_CHECK_THROW( archiver.put( std::string( 256, 'n' ), dir.path() / "in" / "empty" ), fc::exception );
+   BOOST_CHECK_THROW( Archiver( dir.path() / "bad.zip", 3 ), fc::exception );
+}
+
+BOOST_AUTO_TEST_CASE( duplicate_names )
+{
+   {
+      Archiver archiver( archive, 2 );
+      archiver.put( "video.bin", dir.path() / "in" / "video.bin" );
+      archiver.put( "video.bin", dir.path() / "in" / "text.txt" );
+      archiver.finalize();
+   }
+
+   // the threads of extract() would write both entries to the same file
+   BOOST_CHECK_THROW( Dearchiver dearchiver( archive ), fc::exception );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -647,6 +647,68 @@ BOOST_FIXTURE_TEST_CASE( proposal_two_accounts, database_fixture )
    }
 } FC_LOG_AND_RETHROW() }
 
+/// the proposals of an account follow the approvals added to and removed from a proposal
+BOOST_FIXTURE_TEST_CASE( proposal_approval_index, database_fixture )
+{ try {
+   generate_block();
+
+   auto nathan_key = generate_private_key("nathan");
+   auto dan_key = generate_private_key("dan");
+   const account_object& nathan = create_account("nathan", nathan_key.get_public_key() );
+   const account_object& dan = create_account("dan", dan_key.get_public_key() );
+
+   transfer(account_id_type()(db), nathan, asset(100000));
+   transfer(account_id_type()(db), dan, asset(100000));
+
+   {
+      transfer_operation top;
+      top.from = nathan.get_id();
+      top.to = dan.get_id();
+      top.amount = asset(500);
+
+      proposal_create_operation pop;
+      pop.proposed_ops.emplace_back(top);
+      pop.fee_paying_account = nathan.get_id();
+      pop.expiration_time = db.head_block_time() + fc::days(1);
+      trx.operations.push_back(pop);
+      sign( trx, nathan_key );
+      PUSH_TX( db, trx );
+      trx.clear();
+   }
+
+   const proposal_object& prop = *db.get_index_type<proposal_index>().indices().begin();
+   const auto& pidx = dynamic_cast<const base_primary_index&>(db.get_index_type<proposal_index>());
+   const auto& proposals = pidx.get_secondary_index<required_approval_index>()._account_to_proposals;
+   auto proposals_of = [&]( account_id_type a ) -> set<proposal_id_type> {
+      auto itr = proposals.find( a );
+      return itr == proposals.end() ? set<proposal_id_type>() : itr->second;
+   };
+
+   BOOST_CHECK( proposals_of( nathan.get_id() ) == set<proposal_id_type>{ prop.id } );
+   BOOST_CHECK( proposals_of( dan.get_id() ).empty() );
+
+   proposal_update_operation uop;
+   uop.proposal = prop.id;
+   uop.active_approvals_to_add.insert(dan.get_id());
+   uop.fee_paying_account = dan.get_id();
+   trx.operations.push_back(uop);
+   sign( trx, dan_key );
+   PUSH_TX( db, trx );
+   trx.clear();
+
+   BOOST_CHECK( proposals_of( dan.get_id() ) == set<proposal_id_type>{ prop.id } );
+
+   uop.active_approvals_to_add.clear();
+   uop.active_approvals_to_remove.insert(dan.get_id());
+   trx.operations.push_back(uop);
+   sign( trx, dan_key );
+   PUSH_TX( db, trx );
+   trx.clear();
+
+   BOOST_CHECK( proposals_of( dan.get_id() ).empty() );
+   BOOST_CHECK( proposals_of( nathan.get_id() ) == set<proposal_id_type>{ prop.id } );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_FIXTURE_TEST_CASE( proposal_delete, database_fixture )
 { try {
    generate_block();
@@ -38,6 +38,19 @@
 
 #include <fc/crypto/digest.hpp>
 
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
 #include "../common/database_fixture.hpp"
 
 using namespace graphene::chain;
@@ -124,6 +137,168 @@ BOOST_AUTO_TEST_CASE( block_database_test )
    }
 }
 
+#ifndef _WIN32
+namespace {
+
+/** starts tests/block_log_writer, the block log is written in a process of its own which can be killed */
+pid_t spawn_block_log_writer( std::vector<std::string> args, int& output )
+{
+   int out[2];
+   FC_ASSERT( pipe( out ) == 0 );
+   posix_spawn_file_actions_t actions;
+   posix_spawn_file_actions_init( &actions );
+   posix_spawn_file_actions_adddup2( &actions, out[1], STDOUT_FILENO );
+   posix_spawn_file_actions_addclose( &actions, out[0] );
+   posix_spawn_file_actions_addclose( &actions, out[1] );
+
+   std::string path = BLOCK_LOG_WRITER;
+   std::vector<char*> argv( 1, &path[0] );
+   for( std::string& arg : args )
+      argv.push_back( &arg[0] );
+   argv.push_back( nullptr );
+
+   pid_t pid = 0;
+   const int result = posix_spawn( &pid, path.c_str(), &actions, nullptr, argv.data(), environ );
+   posix_spawn_file_actions_destroy( &actions );
+   close( out[1] );
+   if( result != 0 )
+   {
+      close( out[0] );
+      FC_THROW( "Unable to start ${p}", ("p", path) );
+   }
+   output = out[0];
+   return pid;
+}
+
+}
+
+/**
+ * The writer process keeps storing blocks and is killed while the block log is being written behind it.
+ * Everything up to the last synced block must survive, and the log must open with no holes or torn entries.
+ * The kill leaves what was written in the page cache, so this covers torn writes, not what fsync adds against
+ * a power loss.
+ */
+BOOST_AUTO_TEST_CASE( block_database_crash_recovery )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const uint32_t synced_num = 200;
+
+      auto make_block = []( const signed_block& prev, uint32_t num ) {
+         signed_block b;
+         if( num > 1 ) b.previous = prev.id();
+         b.miner = miner_id_type(num);
+         b.transactions.resize( 10 );
+         return b;
+      };
+
+      int output = -1;
+      pid_t child = spawn_block_log_writer( { "crash", data_dir.path().generic_string(), std::to_string( synced_num ) }, output );
+      char c = 0;
+      const bool synced = read( output, &c, 1 ) == 1;
+      close( output );
+      if( synced )
+      {
+         // give the writer some time to get into the middle of something
+         usleep( 20000 );
+         kill( child, SIGKILL );
+      }
+      int status = 0;
+      waitpid( child, &status, 0 );
+      BOOST_REQUIRE( synced );
+
+      {
+         block_database bdb;
+         bdb.open( data_dir.path() );
+         auto last = bdb.last();
+         BOOST_REQUIRE( last.valid() );
+         BOOST_CHECK_GE( last->block_num(), synced_num );
+
+         signed_block prev;
+         for( uint32_t num = 1; num <= last->block_num(); ++num )
+         {
+            auto b = bdb.fetch_by_number( num );
+            BOOST_REQUIRE( b.valid() );
+            BOOST_CHECK( b->miner == miner_id_type(num) );
+            if( num > 1 )
+               BOOST_CHECK( b->previous == prev.id() );
+            prev = *b;
+         }
+         BOOST_CHECK( !bdb.fetch_by_number( last->block_num() + 1 ).valid() );
+
+         // the log keeps working after the recovery
+         signed_block next = make_block( *last, last->block_num() + 1 );
+         bdb.store( next.id(), next );
+         bdb.close();
+         bdb.open( data_dir.path() );
+         BOOST_REQUIRE( bdb.last().valid() );
+         BOOST_CHECK( bdb.last()->id() == next.id() );
+         bdb.close();
+      }
+
+      // a torn index entry and an entry pointing past the end of the block data are both dropped
+      signed_block expected_last;
+      {
+         block_database bdb;
+         bdb.open( data_dir.path() );
+         expected_last = *bdb.last();
+         bdb.close();
+
+         std::ofstream index( (data_dir.path() / "index").generic_string().c_str(), std::ios::binary | std::ios::app );
+         const char garbage[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
+                                  33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55 };
+         index.write( garbage, sizeof(garbage) );
+      }
+      {
+         block_database bdb;
+         bdb.open( data_dir.path() );
+         BOOST_REQUIRE( bdb.last().valid() );
+         BOOST_CHECK( bdb.last()->id() == expected_last.id() );
+         BOOST_CHECK( !bdb.fetch_by_number( expected_last.block_num() + 1 ).valid() );
+         bdb.close();
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+/**
+ * The writer process stores blocks while the files can't grow.  The blocks must stay readable while their writes
+ * fail and be written once the files can grow again, the writer checks both and the log must have all of them.
+ */
+BOOST_AUTO_TEST_CASE( block_database_write_failure )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const uint32_t count = 40;
+
+      int output = -1;
+      pid_t child = spawn_block_log_writer( { "io_error", data_dir.path().generic_string(), std::to_string( count ) }, output );
+      int status = 0;
+      waitpid( child, &status, 0 );
+      close( output );
+      BOOST_REQUIRE( WIFEXITED( status ) );
+      BOOST_REQUIRE_EQUAL( WEXITSTATUS( status ), 0 );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+      BOOST_REQUIRE( bdb.last().valid() );
+      BOOST_CHECK_EQUAL( bdb.last()->block_num(), count );
+      for( uint32_t num = 1; num <= count; ++num )
+      {
+         auto b = bdb.fetch_by_number( num );
+         BOOST_REQUIRE( b.valid() );
+         BOOST_CHECK( b->miner == miner_id_type(num) );
+      }
+      bdb.close();
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+#endif
+
 BOOST_AUTO_TEST_CASE( generate_empty_blocks )
 {
    try {
@@ -0,0 +1,84 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/database_api.hpp>
+#include <graphene/chain/content_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using graphene::app::content_catalogue_delta;
+
+BOOST_FIXTURE_TEST_SUITE( content_catalogue_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( catalogue_deltas )
+{
+   try {
+      ACTOR( alice );
+
+      auto create_content = [&]( const string& uri, uint64_t size ) -> content_id_type {
+         const content_object& co = db.create<content_object>( [&]( content_object& c ) {
+            c.author = alice_id;
+            c.URI = uri;
+            c.synopsis = uri;
+            c.size = size;
+            c.price.SetSimplePrice( asset( 10 ) );
+            c.created = db.head_block_time();
+            c.expiration = fc::time_point::now() + fc::days( 1 );
+         } );
+         const content_statistics_object& stats = db.create<content_statistics_object>( [&]( content_statistics_object& s ) {
+            s.content = co.get_id();
+         } );
+         db.modify( co, [&]( content_object& c ) { c.statistics = stats.id; } );
+         return co.get_id();
+      };
+
+      content_id_type first = create_content( "ipfs:first", 2 );
+
+      // the contents of alice do not need the proofs of seeders to be listed
+      graphene::app::database_api api( db );
+      vector<content_catalogue_delta> deltas;
+      api.set_content_catalogue_callback( [&]( const variant& delta ) {
+         deltas.push_back( delta.as<content_catalogue_delta>() );
+      }, "", "+size", "alice", "", "" );
+
+      content_id_type second = create_content( "ipfs:second", 1 );
+      content_id_type third = create_content( "ipfs:third", 3 );
+      db.changed_objects( vector<object_id_type>( { first, second, third } ) );
+      // the deltas are delivered asynchronously
+      fc::usleep( fc::milliseconds( 10 ) );
+
+      BOOST_REQUIRE_EQUAL( deltas.size(), 1u );
+      BOOST_CHECK_EQUAL( deltas[0].sequence, 1u );
+      BOOST_REQUIRE_EQUAL( deltas[0].added.size(), 2u );
+      BOOST_CHECK_EQUAL( deltas[0].added[0].URI, "ipfs:second" );
+      BOOST_CHECK_EQUAL( deltas[0].added[1].URI, "ipfs:third" );
+      BOOST_REQUIRE_EQUAL( deltas[0].changed.size(), 1u );
+      BOOST_CHECK_EQUAL( deltas[0].changed[0].URI, "ipfs:first" );
+
+      db.modify( third( db ), []( content_object& co ) { co.is_blocked = true; } );
+      db.modify( first( db ), []( content_object& co ) { co.expiration = fc::time_point::now() - fc::seconds( 1 ); } );
+      db.changed_objects( vector<object_id_type>( { first, third } ) );
+      fc::usleep( fc::milliseconds( 10 ) );
+
+      BOOST_REQUIRE_EQUAL( deltas.size(), 2u );
+      BOOST_CHECK_EQUAL( deltas[1].sequence, 2u );
+      BOOST_CHECK( deltas[1].added.empty() && deltas[1].changed.empty() && deltas[1].removed.empty() );
+      BOOST_CHECK( deltas[1].expired == vector<content_id_type>( { first } ) );
+      BOOST_CHECK( deltas[1].blocked == vector<content_id_type>( { third } ) );
+
+      // changes of contents which do not match are not reported
+      db.changed_objects( vector<object_id_type>( { third } ) );
+      api.cancel_content_catalogue_callback();
+      db.changed_objects( vector<object_id_type>( { second } ) );
+      fc::usleep( fc::milliseconds( 10 ) );
+      BOOST_CHECK_EQUAL( deltas.size(), 2u );
+   } catch( fc::exception& e ) {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
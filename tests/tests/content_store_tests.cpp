@@ -0,0 +1,214 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <boost/test/unit_test.hpp>
+
+#include <content_store.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+
+using decent::package::detail::ContentStore;
+using decent::package::detail::manifest_t;
+
+namespace {
+
+void write_file( const fc::path& file, const std::string& data )
+{
+   fc::create_directories( file.parent_path() );
+   std::ofstream out( file.string(), std::ios::binary | std::ios::trunc );
+   out.write( data.data(), data.size() );
+}
+
+std::string read_file( const fc::path& file )
+{
+   std::ifstream in( file.string(), std::ios::binary );
+   return std::string( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+}
+
+// writes through the link shared with the object, the store tells a written object by its write time, which has a
+// resolution of a second
+void damage( const fc::path& file, const std::string& data )
+{
+   boost::filesystem::permissions( file, boost::filesystem::owner_read | boost::filesystem::owner_write );
+   const std::time_t write_time = boost::filesystem::last_write_time( file );
+   write_file( file, data );
+   boost::filesystem::last_write_time( file, write_time + 2 );
+}
+
+struct content_store_fixture
+{
+   content_store_fixture()
+      : dir( graphene::utilities::temp_directory_path() )
+      , store( dir.path() )
+   {
+   }
+
+   // a package directory with its state directory, which is not content
+   fc::path make_package( const std::string& name, const std::string& content )
+   {
+      const fc::path package_dir = dir.path() / name;
+      write_file( package_dir / "content.zip.aes", content );
+      write_file( package_dir / "samples" / name, "sample of " + name );
+      write_file( package_dir / ".state" / "state.json", "{}" );
+      return package_dir;
+   }
+
+   void add( const fc::path& package_dir )
+   {
+      std::set<boost::filesystem::path> paths_to_skip;
+      paths_to_skip.insert( package_dir / ".state" );
+      store.add_package( package_dir, paths_to_skip );
+   }
+
+   fc::path object_path( const fc::ripemd160& object ) const
+   {
+      const std::string name = object.str();
+      return store.get_root() / "objects" / name.substr( 0, 2 ) / name.substr( 2 );
+   }
+
+   const fc::ripemd160& content_object( const manifest_t& manifest ) const
+   {
+      for( const auto& entry : manifest )
+         if( entry.path == "content.zip.aes" )
+            return entry.object;
+      BOOST_FAIL( "no content in the manifest" );
+      return manifest.front().object;
+   }
+
+   fc::temp_directory  dir;
+   ContentStore        store;
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( content_store_tests, content_store_fixture )
+
+BOOST_AUTO_TEST_CASE( dedup_and_reference_count )
+{
+   const fc::path first = make_package( "first", "the same content" );
+   const fc::path second = make_package( "second", "the same content" );
+   add( first );
+   add( second );
+
+   BOOST_REQUIRE( ContentStore::has_manifest( first ) );
+   const manifest_t manifest = ContentStore::read_manifest( first );
+   BOOST_CHECK_EQUAL( manifest.size(), 2u );
+   const fc::ripemd160 object = content_object( manifest );
+   BOOST_CHECK( content_object( ContentStore::read_manifest( second ) ) == object );
+
+   // both packages link the one object, the samples differ and are stored apart
+   BOOST_CHECK( boost::filesystem::equivalent( first / "content.zip.aes", second / "content.zip.aes" ) );
+   BOOST_CHECK_EQUAL( boost::filesystem::hard_link_count( object_path( object ) ), 3u );
+   BOOST_CHECK( !boost::filesystem::equivalent( first / "samples" / "first", second / "samples" / "second" ) );
+   BOOST_CHECK( store.is_verified( object, first / "content.zip.aes" ) );
+#ifndef _WIN32
+   // a write through one package would change the other one
+   BOOST_CHECK( ( boost::filesystem::status( object_path( object ) ).permissions() & boost::filesystem::owner_write ) == 0 );
+#endif
+
+   // the object stays while a package links it
+   boost::filesystem::remove_all( first );
+   store.release( manifest );
+   BOOST_CHECK( fc::exists( object_path( object ) ) );
+   BOOST_CHECK_EQUAL( boost::filesystem::hard_link_count( object_path( object ) ), 2u );
+   BOOST_CHECK_EQUAL( read_file( second / "content.zip.aes" ), "the same content" );
+
+   const manifest_t second_manifest = ContentStore::read_manifest( second );
+   boost::filesystem::remove_all( second );
+   store.release( second_manifest );
+   BOOST_CHECK( !fc::exists( object_path( object ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( staged_package_moved_into_place )
+{
+   const fc::path staging = store.make_staging_dir();
+   BOOST_CHECK( staging.parent_path() == store.get_staging_dir() );
+   BOOST_CHECK( store.make_staging_dir() != staging );
+
+   // the package is assembled in the staging directory and renamed into place, on the file system of the store
+   write_file( staging / "content.zip.aes", "staged content" );
+   const fc::path package_dir = dir.path() / "staged";
+   boost::filesystem::rename( staging, package_dir );
+   add( package_dir );
+
+   const manifest_t manifest = ContentStore::read_manifest( package_dir );
+   BOOST_REQUIRE_EQUAL( manifest.size(), 1u );
+   BOOST_CHECK( boost::filesystem::equivalent( package_dir / "content.zip.aes", object_path( manifest[0].object ) ) );
+   // nothing is left of the temporary names
+   BOOST_CHECK( !fc::exists( object_path( manifest[0].object ).string() + ".tmp" ) );
+   BOOST_CHECK( !fc::exists( ( package_dir / ".state" / "manifest.json" ).string() + ".tmp" ) );
+
+   // leftovers of an interrupted assembly are removed when the store is opened again
+   write_file( store.make_staging_dir() / "partial", "partial" );
+   ContentStore reopened( dir.path() );
+   BOOST_CHECK( boost::filesystem::is_empty( reopened.get_staging_dir() ) );
+}
+
+BOOST_AUTO_TEST_CASE( scrub_finds_corrupt_object )
+{
+   const fc::path package_dir = make_package( "package", "content to be damaged" );
+   add( package_dir );
+   const fc::ripemd160 object = content_object( ContentStore::read_manifest( package_dir ) );
+   BOOST_CHECK( store.scrub( 1024 * 1024, 1000 ).empty() );
+
+   // the content changes on the disk behind the back of the store
+   damage( package_dir / "content.zip.aes", "damaged content" );
+   BOOST_CHECK( !store.is_verified( object, package_dir / "content.zip.aes" ) );
+
+   const auto corrupt = store.scrub( 1024 * 1024, 1000 );
+   BOOST_REQUIRE_EQUAL( corrupt.size(), 1u );
+   BOOST_CHECK( corrupt[0] == object );
+   BOOST_CHECK( store.is_corrupt( object ) );
+   BOOST_CHECK( !store.is_verified( object, package_dir / "content.zip.aes" ) );
+
+   // the verdict survives a restart
+   ContentStore reopened( dir.path() );
+   BOOST_CHECK( reopened.is_corrupt( object ) );
+}
+
+BOOST_AUTO_TEST_CASE( scrub_resumes_after_cursor )
+{
+   // six objects, the contents of three are damaged, a pass visits one and the next pass continues after it
+   for( int i = 0; i < 3; ++i )
+      add( make_package( "package" + std::to_string( i ), "content " + std::to_string( i ) ) );
+
+   for( int i = 0; i < 3; ++i )
+      damage( dir.path() / ( "package" + std::to_string( i ) ) / "content.zip.aes", "damaged " + std::to_string( i ) );
+
+   std::set<fc::ripemd160> found;
+   for( int pass = 0; pass < 6; ++pass )
+   {
+      const auto corrupt = store.scrub( 1024 * 1024, 1 );
+      BOOST_CHECK_LE( corrupt.size(), 1u );
+      found.insert( corrupt.begin(), corrupt.end() );
+   }
+   BOOST_CHECK_EQUAL( found.size(), 3u );
+}
+
+BOOST_AUTO_TEST_CASE( files_left_in_place_without_links )
+{
+   const fc::path package_dir = make_package( "unlinked", "content not linked" );
+
+   // a directory in the way of the link stands for a file system without hard links
+   const fc::ripemd160 object = fc::ripemd160::hash( std::string( "content not linked" ) );
+   fc::create_directories( object_path( object ).string() + ".tmp" );
+   add( package_dir );
+
+   const manifest_t manifest = ContentStore::read_manifest( package_dir );
+   BOOST_CHECK_EQUAL( manifest.size(), 2u );
+   BOOST_CHECK( content_object( manifest ) == object );
+   BOOST_CHECK( !fc::exists( object_path( object ) ) );
+   BOOST_CHECK_EQUAL( boost::filesystem::hard_link_count( package_dir / "content.zip.aes" ), 1u );
+   BOOST_CHECK_EQUAL( read_file( package_dir / "content.zip.aes" ), "content not linked" );
+   BOOST_CHECK( !store.is_verified( object, package_dir / "content.zip.aes" ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <boost/test/unit_test.hpp>
+
+#include <decent/encrypt/custodyutils.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+using decent::encrypt::CustodyData;
+using decent::encrypt::CustodyProof;
+using decent::encrypt::CustodyUtils;
+
+namespace {
+
+void write_content( const fc::path& file, size_t size )
+{
+   std::vector<char> data( size );
+   uint32_t x = 2463534242u;
+   for( auto& byte : data )
+   {
+      x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+      byte = char( x );
+   }
+   std::ofstream out( file.string(), std::ios::binary );
+   out.write( data.data(), data.size() );
+}
+
+// copies only the given ranges of source, the rest of dest stays zero
+void copy_ranges( const fc::path& source, const fc::path& dest, const std::vector<std::pair<uint64_t, uint64_t>>& ranges )
+{
+   const uint64_t size = boost::filesystem::file_size( source );
+   std::ofstream( dest.string(), std::ios::binary );
+   boost::filesystem::resize_file( dest, size );
+
+   std::ifstream in( source.string(), std::ios::binary );
+   std::fstream out( dest.string(), std::ios::binary | std::ios::in | std::ios::out );
+   std::vector<char> buffer;
+   for( const auto& range : ranges )
+   {
+      if( range.first >= size )
+         continue;
+      buffer.resize( std::min( range.second, size - range.first ) );
+      in.seekg( range.first );
+      in.read( buffer.data(), buffer.size() );
+      out.seekp( range.first );
+      out.write( buffer.data(), buffer.size() );
+   }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( custody_tests )
+
+BOOST_AUTO_TEST_CASE( sparse_proof_of_custody )
+{
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path full_dir = data_dir.path() / "full";
+   const fc::path sparse_dir = data_dir.path() / "sparse";
+   const fc::path missing_dir = data_dir.path() / "missing";
+   fc::create_directories( full_dir );
+   fc::create_directories( sparse_dir );
+   fc::create_directories( missing_dir );
+
+   CustodyUtils& utils = CustodyUtils::instance();
+   write_content( full_dir / "content.zip.aes", 300 * 1024 + 17 );
+   CustodyData cd;
+   BOOST_REQUIRE_EQUAL( utils.create_custody_data( full_dir / "content.zip.aes", cd ), 0 );
+
+   CustodyProof full_proof;
+   for( size_t i = 0; i < full_proof.seed.size(); ++i )
+      full_proof.seed.data[i] = 0x9e3779b9u * ( i + 1 );
+   CustodyProof sparse_proof = full_proof;
+   CustodyProof missing_proof = full_proof;
+   BOOST_REQUIRE_EQUAL( utils.create_proof_of_custody( full_dir / "content.zip.aes", cd, full_proof ), 0 );
+
+   std::vector<std::pair<uint64_t, uint64_t>> content_ranges;
+   std::vector<std::pair<uint64_t, uint64_t>> custody_ranges;
+   utils.get_proof_ranges( cd.n, sparse_proof, content_ranges, custody_ranges );
+   BOOST_REQUIRE( !content_ranges.empty() );
+   BOOST_REQUIRE_EQUAL( content_ranges.size(), custody_ranges.size() );
+
+   // the challenged ranges are all the proof reads, the sigmas are taken by the position of their block
+   copy_ranges( full_dir / "content.zip.aes", sparse_dir / "content.zip.aes", content_ranges );
+   copy_ranges( full_dir / "content.cus", sparse_dir / "content.cus", custody_ranges );
+   BOOST_REQUIRE_EQUAL( utils.create_proof_of_custody( sparse_dir / "content.zip.aes", cd, sparse_proof ), 0 );
+   BOOST_CHECK_EQUAL( utils.verify_by_miner( cd, sparse_proof ), 0 );
+   BOOST_CHECK( sparse_proof.sigma == full_proof.sigma );
+   BOOST_CHECK( sparse_proof.mus == full_proof.mus );
+
+   // without one of the challenged blocks the proof does not verify
+   content_ranges.pop_back();
+   copy_ranges( full_dir / "content.zip.aes", missing_dir / "content.zip.aes", content_ranges );
+   copy_ranges( full_dir / "content.cus", missing_dir / "content.cus", custody_ranges );
+   BOOST_CHECK_NE( utils.create_proof_of_custody( missing_dir / "content.zip.aes", cd, missing_proof ), 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -27,9 +27,21 @@
 #include <graphene/chain/database.hpp>
 
 #include <graphene/chain/account_object.hpp>
+#include <graphene/chain/buying_object.hpp>
+#include <graphene/chain/content_object.hpp>
+#include <graphene/chain/rating_object.hpp>
+#include <graphene/chain/subscription_object.hpp>
+
+#include <decent/encrypt/encryptionutils.hpp>
 
 #include <fc/crypto/digest.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+
 #include "../common/database_fixture.hpp"
 
 using namespace graphene::chain;
@@ -59,3 +71,623 @@ BOOST_AUTO_TEST_CASE( undo_test )
       throw;
    }
 }
+
+BOOST_AUTO_TEST_CASE( dense_index_undo_test )
+{
+   try {
+      database db;
+      const auto& idx = db.get_index_type<account_balance_index>();
+      auto ses = db._undo_db.start_undo_session();
+      auto id1 = db.create<account_balance_object>( [&]( account_balance_object& obj ){ obj.balance = 1; } ).get_id();
+      BOOST_CHECK( idx.find( id1 ) == &db.get( id1 ) );
+
+      // undoing the create clears the slot, the next create reuses the instance and fills it again
+      ses.undo();
+      BOOST_CHECK( idx.find( id1 ) == nullptr );
+      BOOST_CHECK( db.find_object( id1 ) == nullptr );
+      ses = db._undo_db.start_undo_session();
+      auto id2 = db.create<account_balance_object>( [&]( account_balance_object& obj ){ obj.balance = 2; } ).get_id();
+      BOOST_REQUIRE( id1 == id2 );
+      BOOST_REQUIRE( idx.find( id2 ) != nullptr );
+      BOOST_CHECK( idx.find( id2 ) == &db.get( id2 ) );
+      BOOST_CHECK_EQUAL( db.get( id2 ).balance.value, 2 );
+      ses.commit();
+
+      // undoing the remove inserts the object again, in a new node the slot points to
+      ses = db._undo_db.start_undo_session();
+      db.remove( db.get( id2 ) );
+      BOOST_CHECK( idx.find( id2 ) == nullptr );
+      BOOST_CHECK( db.find_object( id2 ) == nullptr );
+      ses.undo();
+      BOOST_REQUIRE( idx.find( id2 ) != nullptr );
+      BOOST_CHECK( idx.find( id2 ) == db.find_object( id2 ) );
+      BOOST_CHECK( idx.find( id2 ) == &db.get( id2 ) );
+      BOOST_CHECK_EQUAL( db.get( id2 ).balance.value, 2 );
+
+      // an id of another type with the same instance is not found in the slot
+      BOOST_CHECK( idx.find( account_id_type( id2.instance ) ) == nullptr );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( index_memory_stats_test )
+{
+   try {
+      database db;
+      auto ses = db._undo_db.start_undo_session();
+      vector<account_balance_id_type> ids;
+      for( int i = 0; i < 10; ++i )
+         ids.push_back( db.create<account_balance_object>( [&]( account_balance_object& obj ){ obj.balance = i; } ).id );
+      db.modify( db.get( ids[0] ), [&]( account_balance_object& obj ){ obj.balance = 100; } );
+      ses.commit();
+
+      ses = db._undo_db.start_undo_session();
+      db.modify( db.get( ids[1] ), [&]( account_balance_object& obj ){ obj.balance = 200; } );
+      db.remove( db.get( ids[2] ) );
+
+      bool found = false;
+      for( const auto& stats : db.get_memory_stats() )
+      {
+         if( stats.space_id != account_balance_object::space_id || stats.type_id != account_balance_object::type_id )
+            continue;
+         found = true;
+         BOOST_CHECK_EQUAL( stats.object_count, 9u );
+         BOOST_CHECK_EQUAL( stats.object_bytes, 9 * sizeof(account_balance_object) );
+         BOOST_CHECK( stats.node_overhead_bytes > 0 );
+         // the object created in the first session is not copied, the modified and removed ones are
+         BOOST_CHECK_EQUAL( stats.undo_object_count, 2u );
+         BOOST_CHECK( stats.undo_bytes >= 2 * sizeof(account_balance_object) );
+         BOOST_CHECK( stats.total_bytes() > stats.object_bytes );
+      }
+      BOOST_CHECK( found );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( content_price_index_test )
+{
+   try {
+      database db;
+      auto create_content = [&]( const string& uri, const map<uint32_t, asset>& prices ) {
+         return db.create<content_object>( [&]( content_object& co ){
+            co.URI = uri;
+            co.price.map_price = prices;
+         }).get_id();
+      };
+      // one price for all regions, a default price with a cheaper UK price, and a US only price
+      auto simple = create_content( "ipfs:simple", { { RegionCodes::OO_none, asset( 20 ) } } );
+      auto uk_discount = create_content( "ipfs:uk", { { RegionCodes::OO_all, asset( 30 ) }, { RegionCodes::UK, asset( 10 ) } } );
+      auto us_only = create_content( "ipfs:us", { { RegionCodes::US, asset( 5 ) } } );
+
+      const auto& cidx = dynamic_cast<const base_primary_index&>( db.get_index_type<content_index>() );
+      const auto& price_idx = cidx.get_secondary_index<content_price_index>();
+      auto contents_of = [&]( uint32_t region ) -> vector<content_id_type> {
+         vector<content_id_type> result;
+         auto range = price_idx.region_range( region );
+         for( auto itr = range.first; itr != range.second; ++itr )
+            result.push_back( std::get<2>( *itr ) );
+         return result;
+      };
+
+      BOOST_CHECK( contents_of( RegionCodes::UK ) == vector<content_id_type>( { uk_discount, simple } ) );
+      BOOST_CHECK( contents_of( RegionCodes::US ) == vector<content_id_type>( { us_only, simple, uk_discount } ) );
+      BOOST_CHECK( contents_of( RegionCodes::OO_all ) == vector<content_id_type>( { simple, uk_discount } ) );
+
+      db.modify( simple( db ), []( content_object& co ){ co.price.SetSimplePrice( asset( 1 ) ); } );
+      BOOST_CHECK( contents_of( RegionCodes::UK ) == vector<content_id_type>( { simple, uk_discount } ) );
+
+      db.remove( uk_discount( db ) );
+      BOOST_CHECK( contents_of( RegionCodes::UK ) == vector<content_id_type>( { simple } ) );
+      BOOST_CHECK( contents_of( RegionCodes::US ) == vector<content_id_type>( { simple, us_only } ) );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( state_hash_test )
+{
+   try {
+      database db;
+      const auto& idx = db.get_index_type<account_balance_index>();
+      auto check_state = [&]() {
+         BOOST_CHECK( idx.state_hash() == idx.hash() );
+      };
+
+      vector<account_balance_id_type> ids;
+      for( int i = 0; i < 5; ++i )
+         ids.push_back( db.create<account_balance_object>( [&]( account_balance_object& obj ){ obj.balance = i; } ).id );
+      check_state();
+      const fc::sha256 committed = db.get_state_digest().digest;
+
+      {
+         auto ses = db._undo_db.start_undo_session();
+         db.modify( db.get( ids[0] ), [&]( account_balance_object& obj ){ obj.balance = 100; } );
+         db.remove( db.get( ids[1] ) );
+         db.create<account_balance_object>( [&]( account_balance_object& obj ){ obj.balance = 7; } );
+         check_state();
+         BOOST_CHECK( db.get_state_digest().digest != committed );
+         ses.undo();
+      }
+      check_state();
+      BOOST_CHECK( db.get_state_digest().digest == committed );
+
+      // the same objects changed in another order give the same digest
+      db.modify( db.get( ids[2] ), [&]( account_balance_object& obj ){ obj.balance = 20; } );
+      db.modify( db.get( ids[3] ), [&]( account_balance_object& obj ){ obj.balance = 30; } );
+      const fc::sha256 first_order = db.get_state_digest().digest;
+      db.modify( db.get( ids[3] ), [&]( account_balance_object& obj ){ obj.balance = 3; } );
+      db.modify( db.get( ids[2] ), [&]( account_balance_object& obj ){ obj.balance = 2; } );
+      BOOST_CHECK( db.get_state_digest().digest == committed );
+      db.modify( db.get( ids[3] ), [&]( account_balance_object& obj ){ obj.balance = 30; } );
+      db.modify( db.get( ids[2] ), [&]( account_balance_object& obj ){ obj.balance = 20; } );
+      BOOST_CHECK( db.get_state_digest().digest == first_order );
+      check_state();
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( committed_operation_bus_test, database_fixture )
+{
+   try {
+      ACTORS((alice)(bob));
+      fund( alice );
+      generate_block();
+
+      const std::thread::id chain_thread = std::this_thread::get_id();
+      std::mutex records_mutex;
+      vector<operation_history_object> records;
+      std::atomic<bool> task_on_chain_thread( false );
+      // Boost.Test is not thread safe, the handler only records what is checked below
+      std::atomic<bool> handler_on_chain_thread( false );
+
+      auto queue = db.committed_operations().subscribe( "test", [&]( const operation_history_object& op, bool sync_mode ) {
+         if( std::this_thread::get_id() == chain_thread )
+            handler_on_chain_thread = true;
+         if( op.op_in_trx == 0 && op.trx_in_block == 0 )
+         {
+            // blocks the queue until the chain thread runs the task
+            db.committed_operations().run_on_chain_thread( [&]() {
+               task_on_chain_thread = std::this_thread::get_id() == chain_thread;
+            }).get();
+         }
+         std::lock_guard<std::mutex> lock( records_mutex );
+         records.push_back( op );
+      }, 2 );
+
+      for( int i = 0; i < 3; ++i )
+      {
+         transfer( alice_id, bob_id, asset( 100 + i ) );
+         trx.clear();
+      }
+      const uint32_t first_block = generate_block().block_num();
+
+      // three operations are pending for a queue of two, the next block waits and runs the chain task
+      generate_block();
+      db.committed_operations().flush();
+
+      BOOST_CHECK( task_on_chain_thread );
+      BOOST_CHECK( !handler_on_chain_thread );
+      BOOST_REQUIRE_EQUAL( records.size(), 3u );
+      for( int i = 0; i < 3; ++i )
+      {
+         BOOST_CHECK_EQUAL( records[i].block_num, first_block );
+         BOOST_CHECK_EQUAL( records[i].trx_in_block, i );
+         BOOST_CHECK( records[i].op.get<transfer_operation>().amount == asset( 100 + i ) );
+      }
+
+      auto stats = db.committed_operations().get_stats();
+      BOOST_REQUIRE_EQUAL( stats.size(), 1u );
+      BOOST_CHECK_EQUAL( stats[0].name, "test" );
+      BOOST_CHECK_EQUAL( stats[0].processed, 3u );
+      BOOST_CHECK_EQUAL( stats[0].pending, 0u );
+      BOOST_CHECK_EQUAL( stats[0].lag_blocks, 0u );
+      BOOST_CHECK_EQUAL( stats[0].stalls, 1u );
+      BOOST_CHECK_EQUAL( stats[0].max_pending, 3u );
+
+      db.committed_operations().unsubscribe( queue );
+      BOOST_CHECK( db.committed_operations().get_stats().empty() );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( committed_operation_bus_reading_handler, database_fixture )
+{
+   try {
+      ACTORS((alice)(bob));
+      fund( alice );
+      generate_block();
+
+      std::promise<void> release;
+      std::shared_future<void> released = release.get_future().share();
+      std::atomic<uint32_t> handled( 0 );
+      std::atomic<bool> lock_timed_out( false );
+
+      // reads the database like the seeding plugin does, a timeout stands for a deadlock with the chain thread
+      auto queue = db.committed_operations().subscribe( "reader", [&]( const operation_history_object& op, bool sync_mode ) {
+         released.wait();
+         if( !db.state_mutex().try_lock_shared_for( boost::chrono::seconds( 10 ) ) )
+         {
+            lock_timed_out = true;
+            return;
+         }
+         db.get( op.op.get<transfer_operation>().from );
+         db.state_mutex().unlock_shared();
+         ++handled;
+      }, 1 );
+
+      for( int i = 0; i < 3; ++i )
+      {
+         transfer( alice_id, bob_id, asset( 100 + i ) );
+         trx.clear();
+      }
+      generate_block();
+      BOOST_CHECK_GE( db.committed_operations().get_stats()[0].pending, 1u );
+
+      // the queue is full, the next block waits for it before it takes the state mutex
+      std::thread releaser( [&release]() {
+         std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+         release.set_value();
+      });
+      generate_block();
+      releaser.join();
+      db.committed_operations().flush();
+
+      BOOST_CHECK( !lock_timed_out );
+      BOOST_CHECK_EQUAL( handled.load(), 3u );
+      BOOST_CHECK_EQUAL( db.committed_operations().get_stats()[0].stalls, 1u );
+
+      db.committed_operations().unsubscribe( queue );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( plugin_changes_undone_with_their_block, database_fixture )
+{
+   try {
+      generate_block();
+      const uint32_t first_block = generate_block().block_num();
+      generate_block();
+
+      auto create_rating = [&]( uint32_t consumer ) -> rating_id_type {
+         return db.create<rating_object>( [consumer]( rating_object& o ) {
+            o.consumer = account_id_type( consumer );
+            o.rating = consumer;
+         }).id;
+      };
+
+      // the operation came with the first block, the head block is the one after it
+      rating_id_type of_first_block, not_tied;
+      db.apply_plugin_changes( first_block, [&]() { of_first_block = create_rating( 1 ); } );
+      db.apply_plugin_changes( 0, [&]() { not_tied = create_rating( 2 ); } );
+
+      db.pop_block();
+      BOOST_CHECK( db.find( of_first_block ) != nullptr );
+      BOOST_CHECK( db.find( not_tied ) == nullptr );
+
+      // the changes for an operation of a popped block are dropped
+      bool applied = false;
+      db.apply_plugin_changes( first_block + 1, [&]() { applied = true; } );
+      BOOST_CHECK( !applied );
+
+      db.pop_block();
+      BOOST_CHECK( db.find( of_first_block ) == nullptr );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( decent_housekeeping_test, database_fixture )
+{
+   try {
+      ACTORS((alice)(bob));
+      fund( bob );
+      generate_block();
+
+      const fc::time_point_sec start = db.head_block_time();
+      auto create_content = [&]( const string& uri, fc::time_point_sec expiration ) -> content_id_type {
+         const content_object& co = db.create<content_object>( [&]( content_object& c ) {
+            c.author = alice_id;
+            c.URI = uri;
+            c.price.SetSimplePrice( asset( 10 ) );
+            c.created = start;
+            c.expiration = expiration;
+         } );
+         const content_statistics_object& stats = db.create<content_statistics_object>( [&]( content_statistics_object& s ) {
+            s.content = co.get_id();
+            s.publishing_fee_escrow = asset( 100 );
+         } );
+         db.modify( co, [&]( content_object& c ) { c.statistics = stats.id; } );
+         return co.get_id();
+      };
+      auto create_buying = [&]( content_id_type content, fc::time_point_sec expiration, bool delivered ) -> buying_id_type {
+         return db.create<buying_object>( [&]( buying_object& b ) {
+            b.consumer = bob_id;
+            b.content = content;
+            b.URI = content( db ).URI;
+            b.price = asset( 50 );
+            b.paid_price = asset( 50 );
+            b.expiration_time = expiration;
+            b.delivered = delivered;
+         } ).id;
+      };
+      auto create_subscription = [&]( bool automatic_renewal ) -> subscription_id_type {
+         return db.create<subscription_object>( [&]( subscription_object& so ) {
+            so.from = bob_id;
+            so.to = alice_id;
+            so.expiration = start + 10;
+            so.automatic_renewal = automatic_renewal;
+         } ).id;
+      };
+      db.modify( alice_id( db ), []( account_object& a ) {
+         a.options.price_per_subscribe = asset( 0 );
+         a.options.subscription_period = 1;
+      } );
+
+      const content_id_type expiring = create_content( "ipfs:expiring", start + 10 );
+      const content_id_type lasting = create_content( "ipfs:lasting", start + 1000 );
+      const buying_id_type open_buying = create_buying( lasting, start + 10, false );
+      const buying_id_type delivered_buying = create_buying( lasting, start + 10, true );
+      const subscription_id_type renewing = create_subscription( true );
+      const subscription_id_type ending = create_subscription( false );
+
+      auto balance = [&]( account_id_type account ) -> int64_t {
+         return db.get_balance( account, asset_id_type() ).amount.value;
+      };
+      const int64_t alice_balance = balance( alice_id );
+      const int64_t bob_balance = balance( bob_id );
+
+      generate_blocks( start + 20 );
+      const fc::time_point_sec now = db.head_block_time();
+      db.decent_housekeeping();
+
+      BOOST_CHECK( db.get_dynamic_global_properties().last_housekeeping_time == now );
+      BOOST_CHECK_EQUAL( expiring( db ).statistics( db ).publishing_fee_escrow.amount.value, 0 );
+      BOOST_CHECK_EQUAL( lasting( db ).statistics( db ).publishing_fee_escrow.amount.value, 100 );
+      BOOST_CHECK_EQUAL( balance( alice_id ), alice_balance + 100 );
+
+      BOOST_CHECK( open_buying( db ).expired );
+      BOOST_CHECK_EQUAL( open_buying( db ).price.amount.value, 0 );
+      BOOST_CHECK( !delivered_buying( db ).expired );
+      BOOST_CHECK_EQUAL( delivered_buying( db ).price.amount.value, 50 );
+      BOOST_CHECK_EQUAL( balance( bob_id ), bob_balance + 50 );
+
+      BOOST_CHECK( renewing( db ).expiration == start + 10 + 24 * 3600 );
+      BOOST_CHECK( ending( db ).expiration == start + 10 );
+
+      // content behind the watermark is not visited again, neither are closed buyings and renewed subscriptions
+      db.modify( expiring( db ).statistics( db ), []( content_statistics_object& s ) { s.publishing_fee_escrow = asset( 100 ); } );
+      const size_t applied_ops = db.get_applied_operations().size();
+      db.decent_housekeeping();
+
+      BOOST_CHECK_EQUAL( db.get_applied_operations().size(), applied_ops );
+      BOOST_CHECK_EQUAL( expiring( db ).statistics( db ).publishing_fee_escrow.amount.value, 100 );
+      BOOST_CHECK_EQUAL( balance( alice_id ), alice_balance + 100 );
+      BOOST_CHECK_EQUAL( balance( bob_id ), bob_balance + 50 );
+      BOOST_CHECK( renewing( db ).expiration == start + 10 + 24 * 3600 );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( subscription_renewal_short_of_funds, database_fixture )
+{
+   try {
+      ACTORS((alice)(bob)(carol)(dave));
+      generate_block();
+
+      auto set_price = [&]( account_id_type author, int64_t price ) {
+         db.modify( author( db ), [&]( account_object& a ) {
+            a.options.price_per_subscribe = asset( price );
+            a.options.subscription_period = 1;
+         } );
+      };
+      set_price( alice_id, 10 );
+      set_price( carol_id, 10 );
+      set_price( dave_id, 1 );
+
+      const fc::time_point_sec now = db.head_block_time();
+      auto create_subscription = [&]( account_id_type author, fc::time_point_sec expiration ) -> subscription_id_type {
+         return db.create<subscription_object>( [&]( subscription_object& so ) {
+            so.from = bob_id;
+            so.to = author;
+            so.expiration = expiration;
+            so.automatic_renewal = true;
+         } ).id;
+      };
+      // the first subscription expired last, renewing by the expiration time would pay the second one first
+      const subscription_id_type first = create_subscription( alice_id, now - 10 );
+      const subscription_id_type second = create_subscription( carol_id, now - 20 );
+      const subscription_id_type third = create_subscription( dave_id, now - 20 );
+
+      auto balance = [&]( account_id_type account ) -> int64_t {
+         return db.get_balance( account, asset_id_type() ).amount.value;
+      };
+      db.adjust_balance( bob_id, asset( 11 - balance( bob_id ) ) );
+      const int64_t alice_balance = balance( alice_id );
+      const int64_t carol_balance = balance( carol_id );
+      const int64_t dave_balance = balance( dave_id );
+
+      // bob can pay one of the first two, the first is renewed and the run ends with the second one
+      db.decent_housekeeping();
+      BOOST_CHECK( first( db ).expiration == now - 10 + 24 * 3600 );
+      BOOST_CHECK( first( db ).automatic_renewal );
+      BOOST_CHECK( second( db ).expiration == now - 20 );
+      BOOST_CHECK( !second( db ).automatic_renewal );
+      BOOST_CHECK( third( db ).expiration == now - 20 );
+      BOOST_CHECK( third( db ).automatic_renewal );
+      BOOST_CHECK_EQUAL( balance( bob_id ), 1 );
+      BOOST_CHECK_EQUAL( balance( alice_id ), alice_balance + 10 );
+      BOOST_CHECK_EQUAL( balance( carol_id ), carol_balance );
+
+      // the next run renews the rest
+      db.decent_housekeeping();
+      BOOST_CHECK( third( db ).expiration == now - 20 + 24 * 3600 );
+      BOOST_CHECK_EQUAL( balance( bob_id ), 0 );
+      BOOST_CHECK_EQUAL( balance( dave_id ), dave_balance + 1 );
+      BOOST_CHECK( first( db ).expiration == now - 10 + 24 * 3600 );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( decent_content_statistics_test, database_fixture )
+{
+   try {
+      ACTORS((alice)(bob)(sam)(tom));
+      fund( alice );
+      fund( bob );
+      generate_block();
+
+      auto push = [&]( const operation& op ) {
+         trx.operations.push_back( op );
+         PUSH_TX( db, trx, ~0 );
+         trx.clear();
+      };
+
+      // two seeders are the least quorum, each holds a key particle encrypted with its El Gamal key
+      const vector<account_id_type> seeders( { sam_id, tom_id } );
+      vector<decent::encrypt::DInteger> seeder_keys;
+      for( const account_id_type& seeder : seeders )
+      {
+         seeder_keys.push_back( decent::encrypt::generate_private_el_gamal_key() );
+         ready_to_publish_operation op;
+         op.seeder = seeder;
+         op.pubKey = decent::encrypt::get_public_el_gamal_key( seeder_keys.back() );
+         op.space = 1000;
+         op.price_per_MByte = 10000;
+         op.ipfs_ID = "ipfs-id";
+         push( op );
+      }
+
+      {
+         decent::encrypt::ShamirSecret ss( 2, 2, decent::encrypt::generate_private_el_gamal_key() );
+         ss.calculate_split();
+         content_submit_operation op;
+         op.author = alice_id;
+         op.URI = "ipfs:statistics";
+         op.price = { regional_price{ RegionCodes::OO_none, asset( 100 ) } };
+         op.size = 1;
+         op.hash = fc::ripemd160::hash( op.URI );
+         op.seeders = seeders;
+         for( size_t i = 0; i < seeders.size(); ++i )
+         {
+            decent::encrypt::Ciphertext key_part;
+            decent::encrypt::el_gamal_encrypt( ss.split[i], decent::encrypt::get_public_el_gamal_key( seeder_keys[i] ), key_part );
+            op.key_parts.push_back( key_part );
+         }
+         op.quorum = 2;
+         op.expiration = db.head_block_time() + fc::days( 2 );
+         op.publishing_fee = asset( 100000 );
+         op.synopsis = "{\"title\":\"Statistics\"}";
+         push( op );
+      }
+
+      // the pending transactions are applied again by generate_blocks, the objects are referred to by their IDs
+      const content_id_type content_id = find_content( db, "ipfs:statistics" )->get_id();
+      const content_statistics_id_type statistics = content_id( db ).statistics;
+      BOOST_CHECK( statistics( db ).content == content_id );
+      BOOST_CHECK_EQUAL( statistics( db ).publishing_fee_escrow.amount.value, 100000 );
+      BOOST_CHECK_EQUAL( statistics( db ).times_bought, 0u );
+
+      // a purchase counts once the quorum of seeders delivered their key particles
+      const decent::encrypt::DInteger consumer_key = decent::encrypt::generate_private_el_gamal_key();
+      {
+         request_to_buy_operation op;
+         op.URI = "ipfs:statistics";
+         op.consumer = bob_id;
+         op.price = asset( 100 );
+         op.pubKey = decent::encrypt::get_public_el_gamal_key( consumer_key );
+         push( op );
+      }
+      const auto& buyings = db.get_index_type<buying_index>().indices().get<by_consumer_content>();
+      const buying_id_type buying = buyings.find( std::make_tuple( bob_id, content_id ) )->id;
+
+      for( size_t i = 0; i < seeders.size(); ++i )
+      {
+         BOOST_CHECK_EQUAL( statistics( db ).times_bought, 0u );
+         const decent::encrypt::Ciphertext key_part( content_id( db ).key_parts.at( seeders[i] ) );
+         decent::encrypt::point message;
+         BOOST_REQUIRE( decent::encrypt::el_gamal_decrypt( key_part, seeder_keys[i], message ) == decent::encrypt::ok );
+         decent::encrypt::Ciphertext key;
+         decent::encrypt::DeliveryProof proof;
+         decent::encrypt::encrypt_with_proof( message, seeder_keys[i], decent::encrypt::get_public_el_gamal_key( consumer_key ), key_part, key, proof );
+
+         deliver_keys_operation op;
+         op.seeder = seeders[i];
+         op.buying = buying;
+         op.key = key;
+         op.proof = proof;
+         push( op );
+      }
+      BOOST_CHECK( buying( db ).delivered );
+      BOOST_CHECK_EQUAL( statistics( db ).times_bought, 1u );
+
+      {
+         leave_rating_and_comment_operation op;
+         op.URI = "ipfs:statistics";
+         op.consumer = bob_id;
+         op.rating = 4;
+         push( op );
+      }
+      BOOST_CHECK_EQUAL( statistics( db ).AVG_rating, 4000u );
+      BOOST_CHECK_EQUAL( statistics( db ).num_of_ratings, 1u );
+
+      // the first proof of a seeder is recorded, the later ones are paid from the escrow
+      proof_of_custody_operation por;
+      por.seeder = sam_id;
+      por.URI = "ipfs:statistics";
+      push( por );
+
+      const auto& proofs = db.get_index_type<content_proof_index>().indices().get<by_content_seeder>();
+      auto proof = proofs.find( std::make_tuple( content_id, sam_id ) );
+      BOOST_REQUIRE( proof != proofs.end() );
+      BOOST_CHECK( proof->last_proof == db.head_block_time() );
+      BOOST_CHECK( proofs.find( std::make_tuple( content_id, tom_id ) ) == proofs.end() );
+      BOOST_CHECK_EQUAL( statistics( db ).publishing_fee_escrow.amount.value, 100000 );
+
+      generate_blocks( db.head_block_time() + fc::hours( 12 ) );
+      const int64_t sam_balance = db.get_balance( sam_id, asset_id_type() ).amount.value;
+      push( por );
+
+      const int64_t reward = db.get_balance( sam_id, asset_id_type() ).amount.value - sam_balance;
+      BOOST_CHECK_GT( reward, 0 );
+      BOOST_CHECK_EQUAL( statistics( db ).publishing_fee_escrow.amount.value, 100000 - reward );
+      proof = proofs.find( std::make_tuple( content_id, sam_id ) );
+      BOOST_REQUIRE( proof != proofs.end() );
+      BOOST_CHECK( proof->last_proof == db.head_block_time() );
+      BOOST_CHECK_EQUAL( proofs.size(), 1u );
+
+      // the statistics are the only object of the content changed by these operations
+      BOOST_CHECK( find_content( db, "ipfs:statistics" )->get_id() == content_id );
+      BOOST_CHECK( content_id( db ).statistics == statistics );
+      BOOST_CHECK_EQUAL( statistics( db ).times_bought, 1u );
+      BOOST_CHECK_EQUAL( statistics( db ).num_of_ratings, 1u );
+   } catch ( const fc::exception& e )
+   {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
@@ -0,0 +1,83 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/database_api.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/utilities/key_conversion.hpp>
+#include <graphene/wallet/key_recovery.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using graphene::utilities::key_to_wif;
+using graphene::wallet::derive_private_key;
+
+BOOST_FIXTURE_TEST_SUITE( key_recovery_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( recover_brain_key_accounts )
+{
+   try {
+      const string brain_key = "RECOVERY TEST BRAIN KEY";
+
+      // the keys of an account as the wallet derives them: owner from the brain key, active from owner, memo from active
+      auto create_derived_account = [&]( const string& name, int owner_index, int active_index, int memo_index ) -> account_id_type {
+         fc::ecc::private_key owner_key = derive_private_key( brain_key, owner_index );
+         fc::ecc::private_key active_key = derive_private_key( key_to_wif( owner_key ), active_index );
+         fc::ecc::private_key memo_key = derive_private_key( key_to_wif( active_key ), memo_index );
+
+         account_create_operation op = make_account( name, owner_key.get_public_key() );
+         op.owner = authority( 1, public_key_type( owner_key.get_public_key() ), 1 );
+         op.active = authority( 1, public_key_type( active_key.get_public_key() ), 1 );
+         op.options.memo_key = memo_key.get_public_key();
+         trx.operations.push_back( op );
+         trx.validate();
+         processed_transaction ptx = db.push_transaction( trx, ~0 );
+         trx.operations.clear();
+         return ptx.operation_results[0].get<object_id_type>();
+      };
+
+      account_id_type alice = create_derived_account( "alice", 0, 0, 0 );
+      // unused indices before the keys of bob are within the gap
+      account_id_type bob = create_derived_account( "bob", 3, 2, 1 );
+      // far beyond the gap, not found
+      create_derived_account( "carol", 30, 0, 0 );
+
+      graphene::app::database_api api( db );
+      uint32_t calls = 0;
+      graphene::wallet::key_recovery recovery( [&]( const vector<public_key_type>& keys ) -> vector<vector<account_id_type>> {
+         ++calls;
+         return api.get_key_references( keys );
+      }, 2 );
+
+      graphene::wallet::key_recovery_options options;
+      options.batch_size = 4;
+      options.max_gap = 5;
+      uint32_t progress_reports = 0;
+      graphene::wallet::key_recovery_result result = recovery.recover_brain_key( brain_key, options,
+         [&]( const graphene::wallet::key_recovery_progress& ) { ++progress_reports; } );
+
+      BOOST_CHECK( result.accounts == std::set<account_id_type>( { alice, bob } ) );
+      BOOST_REQUIRE_EQUAL( result.keys.size(), 6u );
+      BOOST_CHECK_EQUAL( result.lookups, calls );
+      BOOST_CHECK_EQUAL( progress_reports, calls );
+      BOOST_CHECK_EQUAL( result.keys_derived, calls * options.batch_size );
+
+      std::map<string, std::set<uint32_t>> found;
+      for( const auto& key : result.keys )
+      {
+         BOOST_CHECK_EQUAL( key.accounts.size(), 1u );
+         BOOST_CHECK( key.public_key == public_key_type( graphene::utilities::wif_to_key( key.wif_private_key )->get_public_key() ) );
+         found[key.role].insert( key.sequence_number );
+      }
+      BOOST_CHECK( found["owner"] == std::set<uint32_t>( { 0, 3 } ) );
+      BOOST_CHECK( found["active"] == std::set<uint32_t>( { 0, 2 } ) );
+      BOOST_CHECK( found["memo"] == std::set<uint32_t>( { 0, 1 } ) );
+   } catch( fc::exception& e ) {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
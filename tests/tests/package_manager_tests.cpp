@@ -0,0 +1,170 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <boost/test/unit_test.hpp>
+
+#include <decent/package/package.hpp>
+#include <event_dispatcher.hpp>
+#include <graphene/utilities/dirhelper.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace decent::package;
+
+namespace {
+
+// the package manager is a singleton, it is created in a temporary directory by the first test using it
+PackageManager& temp_package_manager()
+{
+   static fc::temp_directory packages_dir( graphene::utilities::temp_directory_path() );
+   graphene::utilities::decent_path_finder::instance().set_packages_path( packages_dir.path() );
+   return PackageManager::instance();
+}
+
+struct recording_listener : public EventListenerInterface
+{
+   recording_listener( const std::string& name, std::vector<std::string>& events, std::shared_future<void> gate )
+      : name( name ), events( events ), gate( gate ) {}
+
+   virtual void package_download_start() override { gate.wait(); events.push_back( name + " start" ); }
+   virtual void package_download_progress() override { events.push_back( name + " progress" ); }
+   virtual void package_download_error( const std::string& error ) override
+   {
+      events.push_back( name + " error " + error );
+      throw std::runtime_error( "listener failure" );
+   }
+   virtual void package_download_complete() override { events.push_back( name + " complete" ); }
+
+   std::string                name;
+   std::vector<std::string>&  events;
+   std::shared_future<void>   gate;
+};
+
+PackageManagerStats wait_for_delivery( const detail::EventDispatcher& dispatcher, uint64_t delivered )
+{
+   const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+   PackageManagerStats stats;
+   for( ;; )
+   {
+      dispatcher.fill_stats( stats );
+      if( ( stats.events_pending == 0 && stats.events_delivered >= delivered ) || std::chrono::steady_clock::now() > deadline )
+         return stats;
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+   }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( package_manager_tests )
+
+BOOST_AUTO_TEST_CASE( registry_lookup_and_stats )
+{
+   PackageManager& manager = temp_package_manager();
+   const PackageManagerStats before = manager.get_stats();
+
+   // enough packages to fill every shard of both indices
+   std::vector<package_handle_t> packages;
+   for( int i = 0; i < 64; ++i )
+      packages.push_back( manager.get_package( "local:" + std::to_string( i ), fc::ripemd160::hash( std::to_string( i ) ) ) );
+
+   BOOST_CHECK_EQUAL( manager.get_stats().packages, before.packages + 64 );
+   BOOST_CHECK_EQUAL( manager.get_all_known_packages().size(), before.packages + 64 );
+   for( int i = 0; i < 64; ++i )
+   {
+      BOOST_CHECK( manager.find_package( std::string( "local:" ) + std::to_string( i ) ) == packages[i] );
+      BOOST_CHECK( manager.find_package( fc::ripemd160::hash( std::to_string( i ) ) ) == packages[i] );
+   }
+   BOOST_CHECK( !manager.find_package( std::string( "local:none" ) ) );
+   BOOST_CHECK( !manager.find_package( fc::ripemd160::hash( std::string( "none" ) ) ) );
+
+   // the states are counted as the package changes them
+   package_handle_t package = packages[0];
+   package->download( true );
+   BOOST_REQUIRE( package->get_data_state() == PackageInfo::CHECKED );
+   PackageManagerStats stats = manager.get_stats();
+   BOOST_CHECK_EQUAL( stats.checked, before.checked + 1 );
+   BOOST_CHECK_EQUAL( stats.downloading, before.downloading );
+   BOOST_CHECK_EQUAL( stats.partial, before.partial );
+
+   // a checked package is reused for a new URL and moved in the URL index
+   BOOST_CHECK( manager.get_package( "local:moved", fc::ripemd160::hash( std::string( "0" ) ) ) == package );
+   BOOST_CHECK( manager.find_package( std::string( "local:moved" ) ) == package );
+   BOOST_CHECK( !manager.find_package( std::string( "local:0" ) ) );
+   BOOST_CHECK( manager.find_package( fc::ripemd160::hash( std::string( "0" ) ) ) == package );
+
+   // a package not checked yet is not reused, both are known under the hash
+   package_handle_t other = manager.get_package( "local:1-again", fc::ripemd160::hash( std::string( "1" ) ) );
+   BOOST_CHECK( other != packages[1] );
+   BOOST_CHECK_EQUAL( manager.get_stats().packages, before.packages + 65 );
+   // both are still held here
+   BOOST_CHECK( manager.release_package( fc::ripemd160::hash( std::string( "1" ) ) ) );
+   BOOST_CHECK( !manager.find_package( std::string( "local:1" ) ) );
+   BOOST_CHECK( !manager.find_package( std::string( "local:1-again" ) ) );
+
+   package.reset();
+   other.reset();
+   for( auto& known : packages )
+      manager.release_package( known );
+
+   stats = manager.get_stats();
+   BOOST_CHECK_EQUAL( stats.packages, before.packages );
+   BOOST_CHECK_EQUAL( stats.checked, before.checked );
+   BOOST_CHECK( !manager.find_package( std::string( "local:moved" ) ) );
+   BOOST_CHECK( !manager.find_package( fc::ripemd160::hash( std::string( "2" ) ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( event_order_and_coalescing )
+{
+   // only the addresses of the packages are used, as the keys of the progress events
+   const int package_a = 0, package_b = 0;
+   const PackageInfo* a = reinterpret_cast<const PackageInfo*>( &package_a );
+   const PackageInfo* b = reinterpret_cast<const PackageInfo*>( &package_b );
+
+   std::vector<std::string> events;
+   std::promise<void> open_gate;
+   std::shared_future<void> gate = open_gate.get_future().share();
+   const event_listener_handle_list_t a_listeners( 1, std::make_shared<recording_listener>( "a", events, gate ) );
+   const event_listener_handle_list_t b_listeners( 1, std::make_shared<recording_listener>( "b", events, gate ) );
+
+   detail::EventDispatcher dispatcher;
+   dispatcher.post( a, "package_download_start", a_listeners, detail::bind_event( &EventListenerInterface::package_download_start )() );
+   // the first listener blocks the delivery, the progress events of a wait behind it and are coalesced into the latest
+   for( int i = 0; i < 5; ++i )
+      dispatcher.post( a, "package_download_progress", a_listeners, [&events, i]( EventListenerInterface& ) {
+         events.push_back( "a progress " + std::to_string( i ) );
+      });
+   dispatcher.post( b, "package_download_progress", b_listeners, detail::bind_event( &EventListenerInterface::package_download_progress )() );
+   dispatcher.post( a, "package_download_error", a_listeners, detail::bind_event( &EventListenerInterface::package_download_error )( "failed" ) );
+   dispatcher.post( a, "package_download_complete", a_listeners, detail::bind_event( &EventListenerInterface::package_download_complete )() );
+   // nobody listens, nothing is queued
+   dispatcher.post( a, "package_download_start", event_listener_handle_list_t(), detail::bind_event( &EventListenerInterface::package_download_start )() );
+
+   PackageManagerStats stats;
+   dispatcher.fill_stats( stats );
+   BOOST_CHECK_EQUAL( stats.events_pending, 5u );
+   BOOST_CHECK_EQUAL( stats.events_coalesced, 4u );
+
+   open_gate.set_value();
+   stats = wait_for_delivery( dispatcher, 5 );
+   BOOST_CHECK_EQUAL( stats.events_pending, 0u );
+   BOOST_CHECK_EQUAL( stats.events_delivered, 5u );
+   // a failing listener does not stop the delivery of the later events
+   BOOST_CHECK( events == std::vector<std::string>( { "a start", "a progress 4", "b progress", "a error failed", "a complete" } ) );
+
+   // once delivered, the next progress event is queued again
+   dispatcher.post( a, "package_download_progress", a_listeners, detail::bind_event( &EventListenerInterface::package_download_progress )() );
+   stats = wait_for_delivery( dispatcher, 6 );
+   BOOST_CHECK_EQUAL( stats.events_delivered, 6u );
+   BOOST_CHECK_EQUAL( stats.events_coalesced, 4u );
+   BOOST_CHECK_EQUAL( events.size(), 6u );
+   BOOST_CHECK_EQUAL( events.back(), "a progress" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
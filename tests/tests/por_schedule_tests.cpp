@@ -0,0 +1,75 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/seeding/por_schedule.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <fstream>
+
+using decent::seeding::por_schedule;
+
+BOOST_AUTO_TEST_SUITE( por_schedule_tests )
+
+BOOST_AUTO_TEST_CASE( due_time_order )
+{
+   por_schedule schedule;
+   const fc::time_point_sec start( 1500000000 );
+   BOOST_CHECK( !schedule.next_due().valid() );
+
+   schedule.set( "ipfs:late", start + 300 );
+   schedule.set( "ipfs:early", start + 100 );
+   schedule.set( "ipfs:middle", start + 200 );
+   // a new due time replaces the previous one
+   schedule.set( "ipfs:late", start + 250 );
+   BOOST_CHECK_EQUAL( schedule.size(), 3u );
+   BOOST_CHECK( *schedule.find( "ipfs:late" ) == start + 250 );
+   BOOST_CHECK( *schedule.next_due() == start + 100 );
+
+   BOOST_CHECK( schedule.pop_due( start + 50, 10 ).empty() );
+   BOOST_CHECK( schedule.pop_due( start + 250, 1 ) == std::vector<std::string>( { "ipfs:early" } ) );
+   BOOST_CHECK( schedule.pop_due( start + 250, 10 ) == std::vector<std::string>( { "ipfs:middle", "ipfs:late" } ) );
+   BOOST_CHECK_EQUAL( schedule.size(), 0u );
+   BOOST_CHECK( !schedule.find( "ipfs:early" ).valid() );
+
+   // the same due time is ordered by URI
+   schedule.set( "ipfs:b", start );
+   schedule.set( "ipfs:a", start );
+   schedule.set( "ipfs:c", start + 1 );
+   schedule.erase( "ipfs:c" );
+   BOOST_CHECK( schedule.pop_due( start + 10, 10 ) == std::vector<std::string>( { "ipfs:a", "ipfs:b" } ) );
+}
+
+BOOST_AUTO_TEST_CASE( save_and_load )
+{
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path file = data_dir.path() / "por_schedule.json";
+   const fc::time_point_sec start( 1500000000 );
+
+   por_schedule schedule;
+   schedule.set( "ipfs:first", start + 10 );
+   schedule.set( "ipfs:second", start + 20 );
+   schedule.save( file );
+
+   por_schedule loaded;
+   loaded.set( "ipfs:stale", start );
+   loaded.load( file );
+   BOOST_CHECK_EQUAL( loaded.size(), 2u );
+   BOOST_CHECK( !loaded.find( "ipfs:stale" ).valid() );
+   BOOST_CHECK( *loaded.find( "ipfs:first" ) == start + 10 );
+   BOOST_CHECK( *loaded.next_due() == start + 10 );
+
+   // an unreadable or missing file leaves an empty schedule, it is rebuilt from the chain
+   {
+      std::ofstream out( file.string() );
+      out << "[{\"URI\":";
+   }
+   loaded.load( file );
+   BOOST_CHECK_EQUAL( loaded.size(), 0u );
+   schedule.load( data_dir.path() / "missing.json" );
+   BOOST_CHECK_EQUAL( schedule.size(), 0u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+/* (c) 2016, 2017 DECENT Services. For details refers to LICENSE.txt */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+#include <graphene/wallet/wallet_journal.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+using namespace graphene::chain;
+using graphene::wallet::wallet_journal;
+using graphene::wallet::wallet_journal_record;
+
+BOOST_AUTO_TEST_SUITE( wallet_journal_tests )
+
+BOOST_AUTO_TEST_CASE( append_read_and_torn_record )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path path = wallet_journal::path_for( data_dir.path() / "wallet.json" );
+
+      auto make_record = []( uint64_t account, const string& pending_name ) -> wallet_journal_record {
+         wallet_journal_record record;
+         record.extra_keys[account_id_type( account )].insert( public_key_type() );
+         record.pending_miner_registrations = std::map<string, string>( { { pending_name, "key" } } );
+         return record;
+      };
+
+      {
+         wallet_journal journal( path );
+         journal.append( make_record( 1, "first" ) );
+         journal.append( make_record( 2, "second" ) );
+         BOOST_CHECK_EQUAL( journal.size(), boost::filesystem::file_size( path ) );
+      }
+
+      // a crash while the third record was written leaves a part of it behind
+      const uint64_t complete_size = boost::filesystem::file_size( path );
+      {
+         std::ofstream out( path.string(), std::ios::binary | std::ios::app );
+         out.write( "\x40\x00\x00\x00\x01\x02", 6 );
+      }
+
+      wallet_journal journal( path );
+      BOOST_CHECK_EQUAL( journal.size(), complete_size );
+      BOOST_CHECK_EQUAL( boost::filesystem::file_size( path ), complete_size );
+
+      std::vector<wallet_journal_record> records = journal.read();
+      BOOST_REQUIRE_EQUAL( records.size(), 2u );
+      BOOST_CHECK( records[0].extra_keys.count( account_id_type( 1 ) ) == 1 );
+      BOOST_CHECK( records[1].pending_miner_registrations->count( "second" ) == 1 );
+
+      // records appended after the torn one was dropped are read again
+      journal.append( make_record( 3, "third" ) );
+      BOOST_CHECK_EQUAL( journal.read().size(), 3u );
+
+      journal.clear();
+      BOOST_CHECK_EQUAL( journal.size(), 0u );
+      BOOST_CHECK( journal.read().empty() );
+   } catch( fc::exception& e ) {
+      edump( (e.to_detail_string()) );
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()